@@ -0,0 +1,178 @@
+#include "alloctrack.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "logger.h"
+
+namespace {
+    //! The step to which the thread's allocations are attributed. Trivial, so it's safe to use from operator new
+    thread_local tiny::CompilationStep currentPhase = tiny::CompilationStep::None;
+
+    //! The counters of the compilation the thread works for, if any
+    thread_local tiny::AllocationCounters *currentCounters = nullptr;
+
+    //! The totals of the process. Constant-initialized so they can be used before any static constructor runs
+    tiny::AllocationCounters processCounters;
+}
+
+tiny::AllocationStats tiny::AllocationCounters::getStats(tiny::CompilationStep step) const {
+    auto &c = counters[std::size_t(step)];
+
+    return {
+            c.allocations.load(std::memory_order_relaxed),
+            c.deallocations.load(std::memory_order_relaxed),
+            c.bytes.load(std::memory_order_relaxed),
+    };
+}
+
+void tiny::AllocationCounters::reset() {
+    for (auto &c: counters) {
+        c.allocations.store(0, std::memory_order_relaxed);
+        c.deallocations.store(0, std::memory_order_relaxed);
+        c.bytes.store(0, std::memory_order_relaxed);
+    }
+}
+
+void tiny::AllocationCounters::logSummary() const {
+    tiny::info("Allocations per step (allocations, deallocations, bytes):");
+
+    for (std::size_t i = 0; i < tiny::COMPILATION_STEP_COUNT; i++) {
+        auto stats = getStats(tiny::CompilationStep(i));
+        if (stats.allocations == 0) {
+            continue;
+        }
+
+        tiny::info("  " + std::string(tiny::toString(tiny::CompilationStep(i))) + ": " + std::to_string(stats.allocations) + ", " +
+                   std::to_string(stats.deallocations) + ", " + std::to_string(stats.bytes));
+    }
+}
+
+void tiny::AllocationCounters::onAllocate(tiny::CompilationStep step, std::size_t bytes) noexcept {
+    auto &c = counters[std::size_t(step)];
+
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void tiny::AllocationCounters::onDeallocate(tiny::CompilationStep step) noexcept {
+    counters[std::size_t(step)].deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+tiny::CompilationStep tiny::AllocationTracker::getPhase() {
+    return currentPhase;
+}
+
+tiny::CompilationStep tiny::AllocationTracker::setPhase(tiny::CompilationStep step) {
+    auto previous = currentPhase;
+    currentPhase = step;
+
+    return previous;
+}
+
+tiny::AllocationCounters *tiny::AllocationTracker::getCounters() {
+    return currentCounters;
+}
+
+tiny::AllocationCounters *tiny::AllocationTracker::setCounters(tiny::AllocationCounters *counters) {
+    auto previous = currentCounters;
+    currentCounters = counters;
+
+    return previous;
+}
+
+tiny::AllocationStats tiny::AllocationTracker::getStats(tiny::CompilationStep step) {
+    return processCounters.getStats(step);
+}
+
+void tiny::AllocationTracker::reset() {
+    processCounters.reset();
+}
+
+void tiny::AllocationTracker::logSummary() {
+    processCounters.logSummary();
+}
+
+void tiny::AllocationTracker::onAllocate(std::size_t bytes) noexcept {
+    processCounters.onAllocate(currentPhase, bytes);
+    if (currentCounters != nullptr) {
+        currentCounters->onAllocate(currentPhase, bytes);
+    }
+}
+
+void tiny::AllocationTracker::onDeallocate() noexcept {
+    processCounters.onDeallocate(currentPhase);
+    if (currentCounters != nullptr) {
+        currentCounters->onDeallocate(currentPhase);
+    }
+}
+
+#if defined(TINY_TRACK_ALLOCATIONS)
+
+/*
+ * Global allocation hooks
+ *
+ * Replace the (non-aligned) global operator new and delete so every allocation gets counted. The aligned overloads are
+ * left alone: the standard library implements them on top of aligned_alloc and free, not on top of these.
+ */
+
+void *operator new(std::size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+
+    void *ptr = std::malloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    tiny::AllocationTracker::onAllocate(size);
+    return ptr;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return operator new(size);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    tiny::AllocationTracker::onDeallocate();
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    operator delete(ptr);
+}
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef TINY_ALLOCTRACK_H
+#define TINY_ALLOCTRACK_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "pipeline.h"
+
+namespace tiny {
+    //! Number of CompilationStep values. Must be kept in sync with the last CompilationStep
+    constexpr std::size_t COMPILATION_STEP_COUNT = std::size_t(tiny::CompilationStep::Serialization) + 1;
+
+    //! The heap usage attributed to a compilation step
+    struct AllocationStats {
+        //! Number of allocations
+        std::uint64_t allocations = 0;
+        //! Number of deallocations
+        std::uint64_t deallocations = 0;
+        //! Total bytes allocated
+        std::uint64_t bytes = 0;
+    };
+
+    /*!
+     * \brief The heap usage of a single compilation, per step
+     *
+     * The heap usage of a single compilation, per step. Compilations that run at once, like the projects of build-many,
+     * each count into their own counters, which threads join with an AllocationScope.
+     */
+    class AllocationCounters {
+    public:
+        //! Default constructor. Every step starts at zero
+        AllocationCounters() = default;
+
+        AllocationCounters(AllocationCounters const &) = delete;
+        void operator=(AllocationCounters const &) = delete;
+
+        /*!
+         * \brief Gets the heap usage attributed to a step
+         * \param step The step
+         * \return The allocations, deallocations and bytes attributed to the step
+         */
+        [[nodiscard]] tiny::AllocationStats getStats(tiny::CompilationStep step) const;
+
+        //! Sets the stats of every step back to zero
+        void reset();
+
+        //! Logs the heap usage of every step that allocated something
+        void logSummary() const;
+
+        /*!
+         * \brief Counts an allocation in a step
+         * \param step The step
+         * \param bytes Size of the allocation
+         */
+        void onAllocate(tiny::CompilationStep step, std::size_t bytes) noexcept;
+
+        /*!
+         * \brief Counts a deallocation in a step
+         * \param step The step
+         */
+        void onDeallocate(tiny::CompilationStep step) noexcept;
+
+    private:
+        //! Counters of a single step. Plain atomics, since operator new can't allocate nor lock
+        struct StepCounters {
+            std::atomic<std::uint64_t> allocations{0};
+            std::atomic<std::uint64_t> deallocations{0};
+            std::atomic<std::uint64_t> bytes{0};
+        };
+
+        //! The counters of every step
+        std::array<StepCounters, tiny::COMPILATION_STEP_COUNT> counters;
+    };
+
+    /*!
+     * \brief Attributes heap allocations to the compilation step that made them
+     *
+     * Attributes heap allocations to the compilation step that made them. The allocations are only counted when the
+     * compiler is built with TINY_TRACK_ALLOCATIONS, which replaces the global operator new and delete. Otherwise the
+     * tracker compiles down to nothing and all the stats are zero.
+     *
+     * The current step is kept per-thread and set with a PhaseScope. Allocations made outside of any scope are
+     * attributed to CompilationStep::None. Every allocation counts towards the totals of the process, and also towards
+     * the AllocationCounters the thread joined with an AllocationScope, if any.
+     */
+    class AllocationTracker {
+    public:
+        /*!
+         * \brief Returns whether the allocation hooks are built in
+         * \return True if the compiler was built with TINY_TRACK_ALLOCATIONS
+         */
+        static constexpr bool isBuiltIn() {
+#if defined(TINY_TRACK_ALLOCATIONS)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /*!
+         * \brief Gets the step to which the calling thread's allocations are attributed
+         * \return The current step of the thread
+         */
+        static tiny::CompilationStep getPhase();
+
+        /*!
+         * \brief Sets the step to which the calling thread's allocations are attributed
+         * \param step The new step
+         * \return The previous step of the thread
+         */
+        static tiny::CompilationStep setPhase(tiny::CompilationStep step);
+
+        /*!
+         * \brief Gets the counters to which the calling thread's allocations are also attributed
+         * \return The counters of the thread, or nullptr if it has none
+         */
+        static tiny::AllocationCounters *getCounters();
+
+        /*!
+         * \brief Sets the counters to which the calling thread's allocations are also attributed
+         * \param counters The new counters, or nullptr for none
+         * \return The previous counters of the thread
+         */
+        static tiny::AllocationCounters *setCounters(tiny::AllocationCounters *counters);
+
+        /*!
+         * \brief Gets the heap usage of the whole process attributed to a step
+         * \param step The step
+         * \return The allocations, deallocations and bytes attributed to the step
+         */
+        static tiny::AllocationStats getStats(tiny::CompilationStep step);
+
+        //! Sets the stats of the whole process back to zero
+        static void reset();
+
+        //! Logs the heap usage of the whole process of every step that allocated something
+        static void logSummary();
+
+        /*!
+         * \brief Counts an allocation in the calling thread's current step. Called by the operator new hooks
+         * \param bytes Size of the allocation
+         */
+        static void onAllocate(std::size_t bytes) noexcept;
+
+        /*!
+         * \brief Counts a deallocation in the calling thread's current step. Called by the operator delete hooks
+         */
+        static void onDeallocate() noexcept;
+    };
+
+    //! Attributes the allocations of the calling thread to a step for as long as the scope lives
+    class PhaseScope {
+    public:
+        /*!
+         * \brief Sets the step of the calling thread
+         * \param step The step
+         */
+        explicit PhaseScope(tiny::CompilationStep step) : previous(tiny::AllocationTracker::setPhase(step)) {};
+
+        //! Restores the previous step of the calling thread
+        ~PhaseScope() {
+            tiny::AllocationTracker::setPhase(previous);
+        }
+
+        PhaseScope(PhaseScope const &) = delete;
+        void operator=(PhaseScope const &) = delete;
+
+    private:
+        //! The step of the thread before the scope began
+        tiny::CompilationStep previous;
+    };
+
+    //! Attributes the allocations of the calling thread to the counters of a compilation for as long as the scope lives
+    class AllocationScope {
+    public:
+        /*!
+         * \brief Sets the counters of the calling thread
+         * \param counters The counters, or nullptr for none
+         */
+        explicit AllocationScope(tiny::AllocationCounters *counters)
+                : previous(tiny::AllocationTracker::setCounters(counters)) {};
+
+        //! Restores the previous counters of the calling thread
+        ~AllocationScope() {
+            tiny::AllocationTracker::setCounters(previous);
+        }
+
+        AllocationScope(AllocationScope const &) = delete;
+        void operator=(AllocationScope const &) = delete;
+
+    private:
+        //! The counters of the thread before the scope began
+        tiny::AllocationCounters *previous;
+    };
+}
+
+#endif //TINY_ALLOCTRACK_H
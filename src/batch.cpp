@@ -0,0 +1,101 @@
+#include "batch.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "errors.h"
+#include "logger.h"
+#include "scheduler.h"
+
+namespace {
+    //! Formats a duration as seconds with 3 decimals
+    std::string toSeconds(std::chrono::steady_clock::duration d) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3) << std::chrono::duration<double>(d).count() << "s";
+
+        return out.str();
+    }
+}
+
+std::vector<std::filesystem::path> tiny::readManifest(const std::filesystem::path &manifest) {
+    std::ifstream input(manifest);
+    if (!input) {
+        throw tiny::FileError("Unable to read the manifest '" + manifest.string() + "'");
+    }
+
+    auto base = std::filesystem::absolute(manifest).parent_path();
+
+    std::vector<std::filesystem::path> roots;
+    std::string line;
+    while (std::getline(input, line)) {
+        // Trim the line
+        auto first = line.find_first_not_of(" \t\r");
+        auto last = line.find_last_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        std::filesystem::path root(line.substr(first, last - first + 1));
+        roots.push_back(root.is_absolute() ? root : (base / root).lexically_normal());
+    }
+
+    return roots;
+}
+
+std::vector<tiny::ProjectResult> tiny::compileProjects(const std::vector<std::filesystem::path> &roots,
+                                                       tiny::ASTCache *cache) {
+    auto &scheduler = tiny::Scheduler::get();
+
+    std::vector<tiny::ProjectResult> results(roots.size());
+    std::vector<tiny::TaskHandle> tasks;
+
+    for (std::size_t i = 0; i < roots.size(); i++) {
+        tasks.push_back(scheduler.submit([&result = results[i], root = std::filesystem::absolute(roots[i]), cache]() {
+            auto begin = std::chrono::steady_clock::now();
+            result.root = root;
+
+            if (!std::filesystem::is_directory(root)) {
+                auto msg = "The project directory '" + root.string() + "' doesn't exist";
+                result.result = tiny::CompilationResult::fromDiagnostic(
+                        tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, msg));
+                return;
+            }
+
+            tiny::Compiler compiler(root);
+            compiler.setCache(cache);
+            result.result = compiler.compile();
+
+            result.time = std::chrono::steady_clock::now() - begin;
+        }));
+    }
+
+    scheduler.wait(tasks);
+    return results;
+}
+
+void tiny::logBatchSummary(const std::vector<tiny::ProjectResult> &results) {
+    std::size_t failed = 0;
+    std::chrono::steady_clock::duration total{};
+
+    tiny::info("Projects:");
+    for (auto const &r: results) {
+        total += r.time;
+
+        if (r.result.status == tiny::CompilationStatus::Ok) {
+            tiny::info("  [ok] " + r.root.string() + " (" + toSeconds(r.time) + ")");
+            continue;
+        }
+
+        failed++;
+        tiny::error("  [failed] " + r.root.string() + ": " + r.result.error.msg);
+    }
+
+    auto summary = std::to_string(results.size() - failed) + " of " + std::to_string(results.size()) +
+                   " projects compiled (" + toSeconds(total) + " of compilation time)";
+    if (failed > 0) {
+        tiny::error(summary);
+    } else {
+        tiny::info(summary);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef TINY_BATCH_H
+#define TINY_BATCH_H
+
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+#include "compiler.h"
+#include "cache.h"
+
+namespace tiny {
+    //! The result of compiling one of the projects of a batch
+    struct ProjectResult {
+        //! Directory of the project
+        std::filesystem::path root;
+        //! The result of the compilation
+        tiny::CompilationResult result;
+        //! How long the compilation took
+        std::chrono::steady_clock::duration time{};
+    };
+
+    /*!
+     * \brief Reads the project directories listed in a manifest file
+     * \param manifest Path of the manifest
+     * \return The directories, in the order they are listed
+     *
+     * A manifest lists one project directory per line. Relative directories are relative to the manifest's directory.
+     * Empty lines and lines starting with '#' are ignored. Throws FileError if the manifest can't be read.
+     */
+    std::vector<std::filesystem::path> readManifest(const std::filesystem::path &manifest);
+
+    /*!
+     * \brief Compiles several projects in the same process
+     * \param roots The directories of the projects
+     * \param cache An optional cache shared by all the compilations
+     * \return The result of every project, in the same order as the directories
+     *
+     * Each project is compiled as a task of the Scheduler, so the projects and their files share the same pool of
+     * workers. A project that can't be compiled (missing directory, no sources, invalid code) doesn't stop the rest.
+     */
+    std::vector<tiny::ProjectResult> compileProjects(const std::vector<std::filesystem::path> &roots,
+                                                     tiny::ASTCache *cache = nullptr);
+
+    /*!
+     * \brief Logs a line per project plus the totals of a batch
+     * \param results The results of the batch
+     */
+    void logBatchSummary(const std::vector<tiny::ProjectResult> &results);
+}
+
+#endif //TINY_BATCH_H
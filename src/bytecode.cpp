@@ -0,0 +1,628 @@
+#include "bytecode.h"
+
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+#include "errors.h"
+
+namespace {
+    //! Maximum number of registers of a function, since register operands are 8 bits wide
+    constexpr std::uint32_t MAX_REGISTERS = 256;
+
+    //! The name, index and number of arguments of a function
+    struct FunctionInfo {
+        std::uint32_t index;
+        std::uint8_t arity;
+    };
+
+    //! Lowers the body of a single function
+    class FunctionCompiler {
+    public:
+        FunctionCompiler(const tiny::FunctionResolver &resolver,
+                         const std::unordered_map<std::string, FunctionInfo> &functions, const tiny::ASTFile &file,
+                         tiny::BytecodeFunction &fn) : resolver(resolver), functions(functions), file(file), fn(fn) {}
+
+        void compile(const tiny::ASTNode &node) {
+            scopes.emplace_back();
+
+            for (auto const &arg: node.getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children) {
+                auto name = arg->getParam(tiny::ParameterType::Name).getStringVal(arg->meta).toString();
+                declare(name, allocate(arg->meta));
+            }
+
+            block(*node.getChild(tiny::ASTNodeType::FunctionBody)->getFirstChild());
+
+            // Functions that end without a return give no values
+            emit(tiny::Instruction::abc(tiny::OpCode::Return, 0, 0));
+        }
+
+    private:
+        // Registers and scopes
+
+        std::uint8_t allocate(const tiny::Metadata &meta) {
+            if (top >= MAX_REGISTERS) {
+                throw tiny::BytecodeError("Function '" + fn.name + "' needs more than 256 registers", meta);
+            }
+
+            fn.registers = std::max<std::uint16_t>(fn.registers, top + 1);
+            return std::uint8_t(top++);
+        }
+
+        void declare(const std::string &name, std::uint8_t reg) {
+            scopes.back()[name] = reg;
+            locals = top;
+        }
+
+        std::uint8_t lookup(const tiny::ASTNode &id) {
+            auto name = id.getStringVal().toString();
+            for (auto scope = scopes.rbegin(); scope != scopes.rend(); scope++) {
+                if (auto it = scope->find(name); it != scope->end()) {
+                    return it->second;
+                }
+            }
+
+            throw tiny::BytecodeError("Undefined variable '" + name + "'", id.meta);
+        }
+
+        // Emission
+
+        std::size_t emit(tiny::Instruction ins) {
+            fn.code.push_back(ins);
+            return fn.code.size() - 1;
+        }
+
+        std::int16_t offset(std::size_t from, std::size_t to, const tiny::Metadata &meta) {
+            // Relative to the instruction after the jump
+            auto delta = std::int64_t(to) - std::int64_t(from) - 1;
+            if (delta < std::numeric_limits<std::int16_t>::min() || delta > std::numeric_limits<std::int16_t>::max()) {
+                throw tiny::BytecodeError("Function '" + fn.name + "' is too large to jump across", meta);
+            }
+
+            return std::int16_t(delta);
+        }
+
+        //! Points the jump at index to the next instruction to be emitted
+        void patch(std::size_t index, const tiny::Metadata &meta) {
+            auto &ins = fn.code[index];
+            ins = tiny::Instruction::asbx(ins.op, ins.a, offset(index, fn.code.size(), meta));
+        }
+
+        void jumpTo(tiny::OpCode op, std::uint8_t a, std::size_t target, const tiny::Metadata &meta) {
+            emit(tiny::Instruction::asbx(op, a, offset(fn.code.size(), target, meta)));
+        }
+
+        void loadConstant(std::uint8_t target, const tiny::RuntimeValue &value, const tiny::Metadata &meta) {
+            std::size_t index = 0;
+            while (index < fn.constants.size() && fn.constants[index] != value) {
+                index++;
+            }
+
+            if (index == fn.constants.size()) {
+                if (index > std::numeric_limits<std::uint16_t>::max()) {
+                    throw tiny::BytecodeError("Function '" + fn.name + "' has too many constants", meta);
+                }
+
+                fn.constants.push_back(value);
+            }
+
+            emit(tiny::Instruction::abx(tiny::OpCode::LoadConst, target, std::uint16_t(index)));
+        }
+
+        void move(std::uint8_t target, std::uint8_t source) {
+            if (target != source) {
+                emit(tiny::Instruction::abc(tiny::OpCode::Move, target, source));
+            }
+        }
+
+        // Statements
+
+        void block(const tiny::ASTNode &node) {
+            auto savedTop = top;
+            auto savedLocals = locals;
+            scopes.emplace_back();
+
+            for (auto const &c: node.children) {
+                statement(*c);
+            }
+
+            scopes.pop_back();
+            top = savedTop;
+            locals = savedLocals;
+        }
+
+        void statement(const tiny::ASTNode &node) {
+            // Temporaries only live for the statement
+            auto savedTop = top;
+
+            switch (node.type) {
+            case tiny::ASTNodeType::ExpressionStatement:
+                expressionStatement(*node.getFirstChild());
+                break;
+            case tiny::ASTNodeType::BlockStatement:
+                block(node);
+                break;
+            case tiny::ASTNodeType::IfStatement:
+                ifStatement(node);
+                break;
+            case tiny::ASTNodeType::ForStatement:
+                forStatement(node);
+                break;
+            case tiny::ASTNodeType::FunctionReturn:
+                returnStatement(node);
+                break;
+            default:
+                unsupported(node);
+            }
+
+            // Declarations keep their register
+            top = std::max(savedTop, locals);
+        }
+
+        void expressionStatement(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::Initialization: {
+                // The value is computed before the name is declared, so it can use a variable it shadows
+                auto reg = allocate(node.meta);
+                expression(*node.getSecondChild(), reg);
+                declare(node.getFirstChild()->getStringVal().toString(), reg);
+                return;
+            }
+            case tiny::ASTNodeType::VarDeclaration: {
+                auto reg = allocate(node.meta);
+                loadConstant(reg, tiny::RuntimeValue::zero(node.getFirstChild()->getStringVal().toString()), node.meta);
+                declare(node.getStringVal().toString(), reg);
+                return;
+            }
+            case tiny::ASTNodeType::Assignment:
+                expression(*node.getSecondChild(), assignable(*node.getFirstChild()));
+                return;
+            case tiny::ASTNodeType::AssignmentSum:
+                compoundAssignment(node, tiny::OpCode::Add);
+                return;
+            case tiny::ASTNodeType::AssignmentSub:
+                compoundAssignment(node, tiny::OpCode::Sub);
+                return;
+            case tiny::ASTNodeType::AssignmentMulti:
+                compoundAssignment(node, tiny::OpCode::Mul);
+                return;
+            case tiny::ASTNodeType::AssignmentDiv:
+                compoundAssignment(node, tiny::OpCode::Div);
+                return;
+            default:
+                // Evaluated for its side effects, such as a call
+                expression(node, allocate(node.meta));
+            }
+        }
+
+        void compoundAssignment(const tiny::ASTNode &node, tiny::OpCode op) {
+            auto reg = assignable(*node.getFirstChild());
+            auto value = operand(*node.getSecondChild());
+            emit(tiny::Instruction::abc(op, reg, reg, value));
+        }
+
+        std::uint8_t assignable(const tiny::ASTNode &node) {
+            if (node.type != tiny::ASTNodeType::Identifier || !node.params.empty()) {
+                unsupported(node);
+            }
+
+            return lookup(node);
+        }
+
+        void ifStatement(const tiny::ASTNode &node) {
+            auto savedTop = top;
+            auto condition = operand(*node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild());
+            auto toAlternative = emit(tiny::Instruction::asbx(tiny::OpCode::JumpIfFalse, condition, 0));
+            top = savedTop;
+
+            block(*node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild());
+
+            if (node.children.size() < 3) {
+                patch(toAlternative, node.meta);
+                return;
+            }
+
+            auto toEnd = emit(tiny::Instruction::asbx(tiny::OpCode::Jump, 0, 0));
+            patch(toAlternative, node.meta);
+            block(*node.getChild(tiny::ASTNodeType::BranchAlternative)->getFirstChild());
+            patch(toEnd, node.meta);
+        }
+
+        void forStatement(const tiny::ASTNode &node) {
+            auto const &condition = *node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild();
+            auto const &body = *node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild();
+
+            if (condition.type == tiny::ASTNodeType::RangeExpression) {
+                rangeLoop(condition, body);
+                return;
+            }
+
+            if (condition.type == tiny::ASTNodeType::ForEachExpression) {
+                unsupported(condition);
+            }
+
+            // A while loop: check the condition before every iteration
+            auto start = fn.code.size();
+            auto savedTop = top;
+            auto reg = operand(condition);
+            auto toEnd = emit(tiny::Instruction::asbx(tiny::OpCode::JumpIfFalse, reg, 0));
+            top = savedTop;
+
+            block(body);
+            jumpTo(tiny::OpCode::Jump, 0, start, node.meta);
+            patch(toEnd, node.meta);
+        }
+
+        void rangeLoop(const tiny::ASTNode &range, const tiny::ASTNode &body) {
+            auto savedTop = top;
+            auto savedLocals = locals;
+
+            // Counter, limit, step and the variable seen by the body, in consecutive registers
+            auto base = allocate(range.meta);
+            for (int i = 0; i < 3; i++) {
+                allocate(range.meta);
+            }
+
+            expression(*range.getChild(tiny::ASTNodeType::RangeFromExpression)->getFirstChild(), base);
+
+            auto const &to = *range.getChild(tiny::ASTNodeType::RangeToExpression);
+            if (to.children.empty()) {
+                loadConstant(base + 1, tiny::RuntimeValue(), range.meta); // Open range
+            } else {
+                expression(*to.getFirstChild(), base + 1);
+            }
+
+            auto const &step = *range.getChild(tiny::ASTNodeType::RangeStepExpression);
+            if (step.children.empty()) {
+                emit(tiny::Instruction::asbx(tiny::OpCode::LoadInt, base + 2, 1));
+            } else {
+                expression(*step.getFirstChild(), base + 2);
+            }
+
+            auto prep = emit(tiny::Instruction::asbx(tiny::OpCode::ForPrep, base, 0));
+            auto start = fn.code.size();
+
+            scopes.emplace_back();
+            declare(range.getParam(tiny::ParameterType::RangeIdentifier).getStringVal(range.meta).toString(), base + 3);
+            block(body);
+            scopes.pop_back();
+
+            jumpTo(tiny::OpCode::ForLoop, base, start, range.meta);
+            patch(prep, range.meta);
+
+            top = savedTop;
+            locals = savedLocals;
+        }
+
+        void returnStatement(const tiny::ASTNode &node) {
+            auto base = top;
+            for (auto const &c: node.children) {
+                expression(*c, allocate(c->meta));
+            }
+
+            emit(tiny::Instruction::abc(tiny::OpCode::Return, std::uint8_t(base), std::uint8_t(node.children.size())));
+        }
+
+        // Expressions
+
+        //! Gets a register holding the value of an expression. Variables are used in place
+        std::uint8_t operand(const tiny::ASTNode &node) {
+            if (node.type == tiny::ASTNodeType::Identifier && node.params.empty()) {
+                return lookup(node);
+            }
+
+            auto reg = allocate(node.meta);
+            expression(node, reg);
+            return reg;
+        }
+
+        //! Computes an expression into the target register
+        void expression(const tiny::ASTNode &node, std::uint8_t target) {
+            auto savedTop = top;
+
+            switch (node.type) {
+            case tiny::ASTNodeType::LiteralInt: {
+                auto value = std::get<std::int64_t>(node.val);
+                if (value >= std::numeric_limits<std::int16_t>::min()
+                    && value <= std::numeric_limits<std::int16_t>::max()) {
+                    emit(tiny::Instruction::asbx(tiny::OpCode::LoadInt, target, std::int16_t(value)));
+                } else {
+                    loadConstant(target, tiny::RuntimeValue::fromInt(value), node.meta);
+                }
+
+                break;
+            }
+            case tiny::ASTNodeType::LiteralDecimal:
+                loadConstant(target, tiny::RuntimeValue::fromFloat(double(std::get<long double>(node.val))), node.meta);
+                break;
+            case tiny::ASTNodeType::LiteralBool:
+                loadConstant(target, tiny::RuntimeValue::fromBool(std::get<bool>(node.val)), node.meta);
+                break;
+            case tiny::ASTNodeType::LiteralNone:
+                loadConstant(target, tiny::RuntimeValue(), node.meta);
+                break;
+
+            case tiny::ASTNodeType::Identifier:
+                move(target, assignable(node));
+                break;
+
+            case tiny::ASTNodeType::OpAddition:
+                binary(node, tiny::OpCode::Add, target);
+                break;
+            case tiny::ASTNodeType::OpSubtraction:
+                binary(node, tiny::OpCode::Sub, target);
+                break;
+            case tiny::ASTNodeType::OpMultiplication:
+                binary(node, tiny::OpCode::Mul, target);
+                break;
+            case tiny::ASTNodeType::OpDivision:
+                binary(node, tiny::OpCode::Div, target);
+                break;
+            case tiny::ASTNodeType::OpExponentiate:
+                binary(node, tiny::OpCode::Pow, target);
+                break;
+            case tiny::ASTNodeType::CompareEq:
+                binary(node, tiny::OpCode::Eq, target);
+                break;
+            case tiny::ASTNodeType::CompareNeq:
+                binary(node, tiny::OpCode::Neq, target);
+                break;
+            case tiny::ASTNodeType::CompareLt:
+                binary(node, tiny::OpCode::Lt, target);
+                break;
+            case tiny::ASTNodeType::CompareLteq:
+                binary(node, tiny::OpCode::Lteq, target);
+                break;
+            case tiny::ASTNodeType::CompareGt:
+                binary(node, tiny::OpCode::Gt, target);
+                break;
+            case tiny::ASTNodeType::CompareGteq:
+                binary(node, tiny::OpCode::Gteq, target);
+                break;
+
+            case tiny::ASTNodeType::UnaryNegative:
+                emit(tiny::Instruction::abc(tiny::OpCode::Neg, target, operand(*node.getFirstChild())));
+                break;
+            case tiny::ASTNodeType::UnaryNot:
+                emit(tiny::Instruction::abc(tiny::OpCode::Not, target, operand(*node.getFirstChild())));
+                break;
+
+            case tiny::ASTNodeType::LogicalAnd:
+                logical(node, tiny::OpCode::JumpIfFalse, target);
+                break;
+            case tiny::ASTNodeType::LogicalOr:
+                logical(node, tiny::OpCode::JumpIfTrue, target);
+                break;
+
+            case tiny::ASTNodeType::FunctionCall:
+                call(node, target);
+                break;
+
+            default:
+                unsupported(node);
+            }
+
+            top = savedTop;
+        }
+
+        void binary(const tiny::ASTNode &node, tiny::OpCode op, std::uint8_t target) {
+            auto lhs = operand(*node.getFirstChild());
+            auto rhs = operand(*node.getSecondChild());
+            emit(tiny::Instruction::abc(op, target, lhs, rhs));
+        }
+
+        void logical(const tiny::ASTNode &node, tiny::OpCode shortCircuit, std::uint8_t target) {
+            // The right-hand side may read the variable being assigned, so don't write into it until the end
+            auto reg = target < locals ? allocate(node.meta) : target;
+
+            expression(*node.getFirstChild(), reg);
+            auto toEnd = emit(tiny::Instruction::asbx(shortCircuit, reg, 0));
+            expression(*node.getSecondChild(), reg);
+            patch(toEnd, node.meta);
+
+            move(target, reg);
+        }
+
+        void call(const tiny::ASTNode &node, std::uint8_t target) {
+            auto name = resolver.resolve<tiny::BytecodeError>(file, *node.getFirstChild());
+            auto it = functions.find(name);
+
+            auto const &args = node.getSecondChild()->children;
+            if (args.size() != it->second.arity) {
+                throw tiny::BytecodeError("Function '" + name + "' takes " + std::to_string(it->second.arity)
+                                          + " arguments, but got " + std::to_string(args.size()), node.meta);
+            }
+
+            // The arguments go on top of the frame, where the frame of the callee starts
+            auto base = top;
+            for (auto const &arg: args) {
+                expression(*arg, allocate(arg->meta));
+            }
+
+            if (args.empty()) {
+                allocate(node.meta); // For the result
+            }
+
+            emit(tiny::Instruction::abx(tiny::OpCode::Call, std::uint8_t(base), std::uint16_t(it->second.index)));
+            move(target, std::uint8_t(base));
+        }
+
+        [[noreturn]] void unsupported(const tiny::ASTNode &node) {
+            throw tiny::BytecodeError("'" + node.toString() + "' can't be compiled to bytecode", node.meta);
+        }
+
+        const tiny::FunctionResolver &resolver;
+        //! The functions by their qualified name
+        const std::unordered_map<std::string, FunctionInfo> &functions;
+        //! The AST the function comes from, whose module and imports resolve its calls
+        const tiny::ASTFile &file;
+        tiny::BytecodeFunction &fn;
+
+        //! Variables by name, from the outermost to the innermost block
+        std::vector<std::unordered_map<std::string, std::uint8_t>> scopes;
+        //! The next free register
+        std::uint32_t top = 0;
+        //! Registers below this one hold variables. Temporaries go above
+        std::uint32_t locals = 0;
+    };
+}
+
+std::string tiny::toString(tiny::OpCode op) {
+    switch (op) {
+    case tiny::OpCode::LoadConst:
+        return "LoadConst";
+    case tiny::OpCode::LoadInt:
+        return "LoadInt";
+    case tiny::OpCode::Move:
+        return "Move";
+    case tiny::OpCode::Add:
+        return "Add";
+    case tiny::OpCode::Sub:
+        return "Sub";
+    case tiny::OpCode::Mul:
+        return "Mul";
+    case tiny::OpCode::Div:
+        return "Div";
+    case tiny::OpCode::Pow:
+        return "Pow";
+    case tiny::OpCode::Neg:
+        return "Neg";
+    case tiny::OpCode::Not:
+        return "Not";
+    case tiny::OpCode::Eq:
+        return "Eq";
+    case tiny::OpCode::Neq:
+        return "Neq";
+    case tiny::OpCode::Lt:
+        return "Lt";
+    case tiny::OpCode::Lteq:
+        return "Lteq";
+    case tiny::OpCode::Gt:
+        return "Gt";
+    case tiny::OpCode::Gteq:
+        return "Gteq";
+    case tiny::OpCode::Jump:
+        return "Jump";
+    case tiny::OpCode::JumpIfFalse:
+        return "JumpIfFalse";
+    case tiny::OpCode::JumpIfTrue:
+        return "JumpIfTrue";
+    case tiny::OpCode::ForPrep:
+        return "ForPrep";
+    case tiny::OpCode::ForLoop:
+        return "ForLoop";
+    case tiny::OpCode::Call:
+        return "Call";
+    case tiny::OpCode::Return:
+        return "Return";
+    }
+
+    return "Unknown";
+}
+
+std::string tiny::BytecodeFunction::disassemble() const {
+    std::ostringstream out;
+    out << name << " (" << int(arity) << " arguments, " << registers << " registers)\n";
+
+    for (std::size_t i = 0; i < code.size(); i++) {
+        auto const &ins = code[i];
+        out << std::setw(5) << i << "  " << std::left << std::setw(12) << tiny::toString(ins.op) << std::right;
+
+        switch (ins.op) {
+        case tiny::OpCode::LoadConst:
+            out << "r" << int(ins.a) << ", " << constants[ins.bx()].toString();
+            break;
+        case tiny::OpCode::LoadInt:
+            out << "r" << int(ins.a) << ", " << ins.sbx();
+            break;
+        case tiny::OpCode::Jump:
+            out << "-> " << std::int64_t(i) + 1 + ins.sbx();
+            break;
+        case tiny::OpCode::JumpIfFalse:
+        case tiny::OpCode::JumpIfTrue:
+        case tiny::OpCode::ForPrep:
+        case tiny::OpCode::ForLoop:
+            out << "r" << int(ins.a) << " -> " << std::int64_t(i) + 1 + ins.sbx();
+            break;
+        case tiny::OpCode::Call:
+            out << "r" << int(ins.a) << ", #" << ins.bx();
+            break;
+        case tiny::OpCode::Return:
+            out << "r" << int(ins.a) << ", " << int(ins.b);
+            break;
+        case tiny::OpCode::Move:
+        case tiny::OpCode::Neg:
+        case tiny::OpCode::Not:
+            out << "r" << int(ins.a) << ", r" << int(ins.b);
+            break;
+        default:
+            out << "r" << int(ins.a) << ", r" << int(ins.b) << ", r" << int(ins.c);
+        }
+
+        out << "\n";
+    }
+
+    return out.str();
+}
+
+std::int32_t tiny::BytecodeProgram::find(const std::string &name) const {
+    auto qualified = resolver.find(name);
+    return qualified ? std::int32_t(byName.at(*qualified)) : -1;
+}
+
+tiny::BytecodeProgram tiny::BytecodeCompiler::compile(const std::vector<tiny::ASTFile> &files) {
+    tiny::BytecodeProgram program;
+    std::unordered_map<std::string, FunctionInfo> functions;
+    std::vector<std::pair<const tiny::ASTFile *, const tiny::ASTNode *>> declarations;
+
+    // Gather every function first, so calls can go to functions declared later or in other files
+    for (auto const &file: files) {
+        for (auto const &node: file.statements) {
+            switch (node.type) {
+            case tiny::ASTNodeType::StructDeclaration:
+            case tiny::ASTNodeType::TraitDeclaration:
+                continue; // Types don't generate code
+            case tiny::ASTNodeType::FunctionDeclaration:
+                break;
+            default:
+                throw tiny::BytecodeError("'" + node.toString() + "' can't be compiled to bytecode", node.meta);
+            }
+
+            auto name = node.getParam(tiny::ParameterType::Name).getStringVal(node.meta).toString();
+            if (!program.resolver.declare(file.mod.toString(), name)) {
+                throw tiny::BytecodeError("Function '" + name + "' is defined more than once in module '"
+                                          + file.mod.toString() + "'", node.meta);
+            }
+
+            if (functions.size() > std::numeric_limits<std::uint16_t>::max()) {
+                throw tiny::BytecodeError("Too many functions", node.meta);
+            }
+
+            auto arity = node.getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children.size();
+            if (arity >= MAX_REGISTERS) {
+                throw tiny::BytecodeError("Function '" + name + "' has too many arguments", node.meta);
+            }
+
+            auto index = std::uint32_t(declarations.size());
+            auto qualified = tiny::FunctionResolver::qualify(file.mod.toString(), name);
+            functions[qualified] = {index, std::uint8_t(arity)};
+            program.byName[qualified] = index;
+            declarations.emplace_back(&file, &node);
+        }
+    }
+
+    program.functions.resize(declarations.size());
+    for (std::size_t i = 0; i < declarations.size(); i++) {
+        auto const &[file, node] = declarations[i];
+        auto name = node->getParam(tiny::ParameterType::Name).getStringVal(node->meta).toString();
+
+        auto &fn = program.functions[i];
+        fn.name = tiny::FunctionResolver::qualify(file->mod.toString(), name);
+        fn.arity = functions[fn.name].arity;
+
+        FunctionCompiler(program.resolver, functions, *file, fn).compile(*node);
+    }
+
+    return program;
+}
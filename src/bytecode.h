@@ -0,0 +1,177 @@
+#ifndef TINY_BYTECODE_H
+#define TINY_BYTECODE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ast.h"
+#include "resolver.h"
+#include "value.h"
+
+namespace tiny {
+    /*!
+     * \brief The operations of the VM
+     *
+     * The operations of the VM. Operands are registers of the current frame, except where noted. A, B and C are 8 bits,
+     * Bx is B and C as an unsigned 16 bits index and sBx as a signed 16 bits offset, relative to the next instruction.
+     * The order must match the dispatch table of the VM.
+     */
+    enum class OpCode : std::uint8_t {
+        //! A = constants[Bx]
+        LoadConst,
+        //! A = sBx, as an integer
+        LoadInt,
+        //! A = B
+        Move,
+        //! A = B + C
+        Add,
+        //! A = B - C
+        Sub,
+        //! A = B * C
+        Mul,
+        //! A = B / C. Integer division truncates
+        Div,
+        //! A = B ** C
+        Pow,
+        //! A = -B
+        Neg,
+        //! A = not B
+        Not,
+        //! A = B == C
+        Eq,
+        //! A = B != C
+        Neq,
+        //! A = B < C
+        Lt,
+        //! A = B <= C
+        Lteq,
+        //! A = B > C
+        Gt,
+        //! A = B >= C
+        Gteq,
+        //! Jumps by sBx
+        Jump,
+        //! Jumps by sBx if A is false
+        JumpIfFalse,
+        //! Jumps by sBx if A is true
+        JumpIfTrue,
+        //! Starts a range over A (counter), A+1 (limit, None if open) and A+2 (step). Jumps by sBx if it's empty
+        ForPrep,
+        //! Steps the range of A, sets A+3 to the counter and jumps by sBx while it isn't exhausted
+        ForLoop,
+        //! Calls functions[Bx] with the arguments from A on. The first result is left in A
+        Call,
+        //! Returns the B values from A on
+        Return, // Keep last, OPCODE_COUNT depends on it
+    };
+
+    //! Number of OpCode values
+    constexpr std::size_t OPCODE_COUNT = std::size_t(tiny::OpCode::Return) + 1;
+
+    /*!
+     * \brief Gets the name of an operation
+     * \param op The operation
+     * \return The name as it's declared (for example OpCode::LoadConst will become "LoadConst")
+     */
+    [[nodiscard]] std::string toString(tiny::OpCode op);
+
+    //! A single 32 bits instruction
+    struct Instruction {
+        tiny::OpCode op;
+        std::uint8_t a = 0;
+        std::uint8_t b = 0;
+        std::uint8_t c = 0;
+
+        //! Builds an instruction out of its A, B and C operands
+        static Instruction abc(tiny::OpCode op, std::uint8_t a, std::uint8_t b = 0, std::uint8_t c = 0) {
+            return {op, a, b, c};
+        }
+
+        //! Builds an instruction out of its A and Bx operands
+        static Instruction abx(tiny::OpCode op, std::uint8_t a, std::uint16_t bx) {
+            return {op, a, std::uint8_t(bx & 0xFF), std::uint8_t(bx >> 8)};
+        }
+
+        //! Builds an instruction out of its A and sBx operands
+        static Instruction asbx(tiny::OpCode op, std::uint8_t a, std::int16_t sbx) {
+            return abx(op, a, std::uint16_t(sbx));
+        }
+
+        //! Gets the Bx operand
+        [[nodiscard]] std::uint16_t bx() const { return std::uint16_t(b | (c << 8)); }
+        //! Gets the sBx operand
+        [[nodiscard]] std::int16_t sbx() const { return std::int16_t(bx()); }
+    };
+
+    static_assert(sizeof(Instruction) == 4, "Instructions must be 32 bits wide");
+
+    //! The bytecode of a function
+    struct BytecodeFunction {
+        //! Qualified name of the function, "module.name"
+        std::string name;
+        //! Number of arguments. They are the first registers of the function
+        std::uint8_t arity = 0;
+        //! Number of registers used by the function, arguments included
+        std::uint16_t registers = 0;
+        //! The instructions
+        std::vector<tiny::Instruction> code;
+        //! The constants loaded by LoadConst
+        std::vector<tiny::RuntimeValue> constants;
+
+        /*!
+         * \brief Disassembles the function
+         * \return One line per instruction, with its index, name and operands
+         */
+        [[nodiscard]] std::string disassemble() const;
+    };
+
+    //! A set of functions that can be run by the VM. Functions call each other by their index
+    struct BytecodeProgram {
+        //! The functions, in declaration order
+        std::vector<tiny::BytecodeFunction> functions;
+
+        /*!
+         * \brief Finds a function by its name
+         * \param name The qualified name, or the bare name if only one module declares a function with that name
+         * \return The index of the function, or -1 if the name doesn't pick a single function
+         */
+        [[nodiscard]] std::int32_t find(const std::string &name) const;
+
+    private:
+        friend class BytecodeCompiler;
+
+        //! The modules of the functions
+        tiny::FunctionResolver resolver;
+        //! Maps qualified names to the index of their function
+        std::unordered_map<std::string, std::uint32_t> byName;
+    };
+
+    /*!
+     * \brief Lowers ASTs into register-based bytecode
+     *
+     * Lowers the function declarations of a set of ASTs into register-based bytecode. Function bodies can hold
+     * initializations, assignments, arithmetic, comparisons and logical operations, if blocks, for blocks over ranges
+     * or conditions, calls to the other functions and returns. Structs and traits are skipped. Anything else, including
+     * statements outside functions, is rejected with a BytecodeError.
+     *
+     * Variables live in registers, scoped to the block that declares them, and temporaries are allocated on top of them
+     * and released after every statement, so a function can use at most 256 registers.
+     */
+    class BytecodeCompiler {
+    public:
+        /*!
+         * \brief Compiles the functions of a set of ASTs
+         * \param files The ASTs. Functions can call the functions of their module and of the modules it imports
+         * \return The program
+         *
+         * Compiles the functions of a set of ASTs. Calls are resolved by the FunctionResolver. Throws BytecodeError if
+         * a node can't be lowered, a name is undefined, ambiguous or redefined in its module, or a function needs too
+         * many registers or constants.
+         */
+        static tiny::BytecodeProgram compile(const std::vector<tiny::ASTFile> &files);
+    };
+}
+
+#endif //TINY_BYTECODE_H
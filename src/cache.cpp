@@ -0,0 +1,80 @@
+#include "cache.h"
+
+std::optional<tiny::ASTFile> tiny::ASTCache::find(const tiny::File &f) {
+    auto state = getState(f.path);
+
+    std::lock_guard lock(mtx);
+    auto it = entries.find(f.path);
+    if (it == entries.end() || !state || it->second.writeTime != state->first || it->second.size != state->second) {
+        misses++;
+        return std::nullopt;
+    }
+
+    hits++;
+    return it->second.ast;
+}
+
+void tiny::ASTCache::store(const tiny::File &f, const tiny::ASTFile &ast) {
+    auto state = getState(f.path);
+    if (!state) {
+        return; // Files that can't be read can't be validated later either
+    }
+
+    std::lock_guard lock(mtx);
+    entries[f.path] = Entry{state->first, state->second, ast};
+}
+
+void tiny::ASTCache::invalidate(const std::filesystem::path &path) {
+    std::lock_guard lock(mtx);
+    entries.erase(path);
+}
+
+void tiny::ASTCache::clear() {
+    std::lock_guard lock(mtx);
+    entries.clear();
+}
+
+void tiny::ASTCache::forEach(const std::function<void(const std::filesystem::path &, const tiny::ASTFile &)> &fn) {
+    std::lock_guard lock(mtx);
+    for (auto const &[path, entry]: entries) {
+        fn(path, entry.ast);
+    }
+}
+
+std::size_t tiny::ASTCache::size() {
+    std::lock_guard lock(mtx);
+    return entries.size();
+}
+
+std::uint64_t tiny::ASTCache::getHits() {
+    std::lock_guard lock(mtx);
+    return hits;
+}
+
+std::uint64_t tiny::ASTCache::getMisses() {
+    std::lock_guard lock(mtx);
+    return misses;
+}
+
+void tiny::ASTCache::resetCounters() {
+    std::lock_guard lock(mtx);
+    hits = 0;
+    misses = 0;
+}
+
+std::optional<std::pair<std::filesystem::file_time_type, std::uintmax_t>>
+tiny::ASTCache::getState(const std::filesystem::path &path) {
+    std::error_code ec;
+
+    auto writeTime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    return std::make_pair(writeTime, size);
+}
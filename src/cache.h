@@ -0,0 +1,94 @@
+#ifndef TINY_CACHE_H
+#define TINY_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+
+#include "ast.h"
+#include "file.h"
+
+namespace tiny {
+    /*!
+     * \brief Keeps the ASTs of already compiled files, so unchanged files don't have to be lexed and parsed again
+     *
+     * Keeps the ASTs of already compiled files, so unchanged files don't have to be lexed and parsed again. An entry
+     * is valid for as long as the last write time and the size of its file stay the same. The cache is thread-safe.
+     */
+    class ASTCache {
+    public:
+        //! Builds an empty cache
+        explicit ASTCache() = default;
+
+        /*!
+         * \brief Looks for the AST of a file
+         * \param f The file
+         * \return A copy of the cached AST if the file hasn't changed since it was stored, nothing otherwise
+         */
+        std::optional<tiny::ASTFile> find(const tiny::File &f);
+
+        /*!
+         * \brief Stores the AST of a file, replacing the previous one
+         * \param f The file
+         * \param ast The AST of the file
+         */
+        void store(const tiny::File &f, const tiny::ASTFile &ast);
+
+        /*!
+         * \brief Drops the AST of a file, so it gets compiled again on its next use
+         * \param path Path of the file
+         */
+        void invalidate(const std::filesystem::path &path);
+
+        //! Drops every AST
+        void clear();
+
+        /*!
+         * \brief Calls a function with every cached AST, whether its file changed or not
+         * \param fn The function, called with the path of the file and its AST. Must not use the cache
+         */
+        void forEach(const std::function<void(const std::filesystem::path &, const tiny::ASTFile &)> &fn);
+
+        //! Gets the number of cached ASTs
+        [[nodiscard]] std::size_t size();
+
+        //! Gets the number of lookups that found a valid AST since the last resetCounters()
+        [[nodiscard]] std::uint64_t getHits();
+
+        //! Gets the number of lookups that found nothing since the last resetCounters()
+        [[nodiscard]] std::uint64_t getMisses();
+
+        //! Sets the hit and miss counters back to zero
+        void resetCounters();
+
+    private:
+        //! A cached AST plus the state of the file when it was stored
+        struct Entry {
+            std::filesystem::file_time_type writeTime;
+            std::uintmax_t size = 0;
+            tiny::ASTFile ast;
+        };
+
+        /*!
+         * \brief Reads the last write time and size of a file
+         * \param path Path of the file
+         * \return A [write time, size] pair, or nothing if the file couldn't be read
+         */
+        static std::optional<std::pair<std::filesystem::file_time_type, std::uintmax_t>>
+        getState(const std::filesystem::path &path);
+
+        //! The cached entries, by path
+        std::map<std::filesystem::path, Entry> entries;
+        //! Lookups that found a valid AST
+        std::uint64_t hits = 0;
+        //! Lookups that found nothing
+        std::uint64_t misses = 0;
+        //! Guards all of the above
+        std::mutex mtx;
+    };
+}
+
+#endif //TINY_CACHE_H
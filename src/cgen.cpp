@@ -0,0 +1,1321 @@
+#include "cgen.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "compiler.h"
+#include "errors.h"
+#include "resolver.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TINY_HAS_SPAWN
+
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+
+namespace {
+    //! A type of the language: a builtin type or a struct, behind any number of pointers
+    struct CType {
+        //! The name of the builtin type, such as "int32", or of the struct. Empty for no value
+        std::string name;
+        //! How many pointers are in front of the name. 0 for plain values
+        std::uint8_t pointers = 0;
+
+        [[nodiscard]] bool isVoid() const { return name.empty(); }
+        [[nodiscard]] bool isPointer() const { return pointers > 0; }
+        [[nodiscard]] bool isUnsigned() const { return pointers == 0 && name.rfind("uint", 0) == 0; }
+        [[nodiscard]] bool isInteger() const { return isUnsigned() || (pointers == 0 && name.rfind("int", 0) == 0); }
+        [[nodiscard]] bool isDecimal() const { return pointers == 0 && name.rfind("float", 0) == 0; }
+        [[nodiscard]] bool isNumber() const { return isInteger() || isDecimal(); }
+        [[nodiscard]] bool isBool() const { return pointers == 0 && name == "bool"; }
+        [[nodiscard]] bool isBuiltin() const { return isNumber() || isBool(); }
+
+        //! The width of a number, in bits
+        [[nodiscard]] int bits() const { return std::stoi(name.substr(name.find_first_of("123456789"))); }
+
+        [[nodiscard]] CType pointer() const { return {name, std::uint8_t(pointers + 1)}; }
+        [[nodiscard]] CType pointee() const { return {name, std::uint8_t(pointers - 1)}; }
+
+        bool operator==(const CType &other) const { return name == other.name && pointers == other.pointers; }
+        bool operator!=(const CType &other) const { return !(*this == other); }
+
+        //! Gets the type as it's written in the language, such as "*int32"
+        [[nodiscard]] std::string toString() const { return isVoid() ? "void" : std::string(pointers, '*') + name; }
+    };
+
+    const CType INT32{"int32"};
+    const CType INT64{"int64"};
+    const CType FLOAT32{"float32"};
+    const CType FLOAT64{"float64"};
+    const CType BOOL{"bool"};
+
+    //! The builtin types that have a C counterpart, by their name in the language
+    const std::unordered_map<std::string, std::string> BUILTIN_TYPES{
+            {"int8",    "int8_t"},
+            {"int16",   "int16_t"},
+            {"int32",   "int32_t"},
+            {"int64",   "int64_t"},
+            {"uint8",   "uint8_t"},
+            {"uint16",  "uint16_t"},
+            {"uint32",  "uint32_t"},
+            {"uint64",  "uint64_t"},
+            {"float32", "float"},
+            {"float64", "double"},
+            {"bool",    "bool"},
+    };
+
+    //! Names that C or the included headers already use, so variables and fields can't take them
+    const std::unordered_set<std::string> RESERVED{
+            "auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum", "extern",
+            "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return", "short", "signed",
+            "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while",
+            "bool", "true", "false", "NULL", "errno", "stdin", "stdout", "stderr", "main", "argc", "argv",
+            "int8_t", "int16_t", "int32_t", "int64_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t", "size_t",
+            "INFINITY", "NAN", "EOF", "assert",
+    };
+
+    //! Gets the C name of a struct
+    std::string globalName(const std::string &name) {
+        return "tiny_" + name;
+    }
+
+    //! Gets the C name of a function, which includes its module since modules can declare the same names
+    std::string functionName(const std::string &mod, const std::string &name) {
+        auto prefix = mod;
+        std::replace_if(prefix.begin(), prefix.end(), [](char c) {
+            return !std::isalnum(static_cast<unsigned char>(c));
+        }, '_');
+
+        return globalName(prefix + "_" + name);
+    }
+
+    //! Gets the C name of a struct field
+    std::string fieldName(const std::string &name) {
+        return RESERVED.count(name) > 0 ? name + "_" : name;
+    }
+
+    //! Gets a C declaration of a name with a type, such as "int64_t *p"
+    std::string declaration(const CType &type, const std::string &name) {
+        auto it = BUILTIN_TYPES.find(type.name);
+        auto base = it != BUILTIN_TYPES.end() ? it->second : globalName(type.name);
+        return base + " " + std::string(type.pointers, '*') + name;
+    }
+
+    //! Gets the C name of a type, such as "int64_t *"
+    std::string typeName(const CType &type) {
+        if (type.isVoid()) {
+            return "void";
+        }
+
+        auto decl = declaration(type, "");
+        return type.isPointer() ? decl : decl.substr(0, decl.size() - 1);
+    }
+
+    [[noreturn]] void unsupported(const tiny::ASTNode &node) {
+        throw tiny::CodegenError("'" + node.toString() + "' can't be translated to C", node.meta);
+    }
+
+    //! A field of a struct. Compositions are fields named after the struct they hold
+    struct Field {
+        std::string name;
+        CType type;
+        bool isComposition = false;
+    };
+
+    struct Struct {
+        std::string name;
+        std::vector<Field> fields;
+        const tiny::ASTNode *node = nullptr;
+    };
+
+    //! The parameters and results of a function. The results are unknown until a return of the function is translated
+    struct Signature {
+        std::vector<CType> params;
+        std::optional<std::vector<CType>> results;
+        //! Whether the results were declared, so they don't have to be inferred
+        bool isDeclared = false;
+        //! The name of the C function
+        std::string cName;
+    };
+
+    //! Every struct and function of the ASTs
+    struct Program {
+        std::unordered_map<std::string, Struct> structs;
+        //! The functions, by their qualified name
+        std::unordered_map<std::string, Signature> functions;
+        tiny::FunctionResolver resolver;
+
+        //! Gets the type of a Type node, or of a node whose value is a type name such as an argument declaration
+        [[nodiscard]] CType typeOf(const tiny::ASTNode &node) const {
+            auto name = node.getStringVal().toString();
+            CType type{name, std::uint8_t(node.hasParam(tiny::ParameterType::Pointer) ? 1 : 0)};
+
+            if ((BUILTIN_TYPES.count(name) == 0 && structs.count(name) == 0)
+                || node.hasParam(tiny::ParameterType::Dereference)) {
+                throw tiny::CodegenError("Type '" + name + "' can't be translated to C", node.meta);
+            }
+
+            return type;
+        }
+
+        /*!
+         * \brief Finds a field of a struct, or of the structs it's composed of
+         * \return The fields to go through to reach it, or nothing if there's no such field
+         */
+        [[nodiscard]] std::vector<const Field *> findField(const std::string &owner, const std::string &name) const {
+            auto const &fields = structs.at(owner).fields;
+            for (auto const &f: fields) {
+                if (!f.isComposition && f.name == name) {
+                    return {&f};
+                }
+            }
+
+            for (auto const &f: fields) {
+                if (f.isComposition) {
+                    if (auto path = findField(f.type.name, name); !path.empty()) {
+                        path.insert(path.begin(), &f);
+                        return path;
+                    }
+                }
+            }
+
+            return {};
+        }
+    };
+
+    //! Whether a statement can't complete, because it returns on every path or loops forever
+    bool alwaysReturns(const tiny::ASTNode &node) {
+        switch (node.type) {
+        case tiny::ASTNodeType::FunctionReturn:
+            return true;
+        case tiny::ASTNodeType::BlockStatement:
+            for (auto const &c: node.children) {
+                if (alwaysReturns(*c)) {
+                    return true;
+                }
+            }
+
+            return false;
+        case tiny::ASTNodeType::IfStatement:
+            return node.children.size() >= 3
+                   && alwaysReturns(*node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild())
+                   && alwaysReturns(*node.getChild(tiny::ASTNodeType::BranchAlternative)->getFirstChild());
+        case tiny::ASTNodeType::ForStatement: {
+            // There's no break, so loops without a condition never end
+            auto const &cond = *node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild();
+            if (cond.type == tiny::ASTNodeType::LiteralBool) {
+                return std::get<bool>(cond.val);
+            }
+
+            return cond.type == tiny::ASTNodeType::RangeExpression
+                   && cond.getChild(tiny::ASTNodeType::RangeToExpression)->children.empty();
+        }
+        default:
+            return false;
+        }
+    }
+
+    //! Whether a statement writes to a variable, or takes its address
+    bool writes(const tiny::ASTNode &node, const std::string &name) {
+        switch (node.type) {
+        case tiny::ASTNodeType::Assignment:
+        case tiny::ASTNodeType::AssignmentSum:
+        case tiny::ASTNodeType::AssignmentSub:
+        case tiny::ASTNodeType::AssignmentMulti:
+        case tiny::ASTNodeType::AssignmentDiv: {
+            auto const &lhs = *node.getFirstChild();
+            if (lhs.type == tiny::ASTNodeType::Identifier && lhs.params.empty()
+                && lhs.getStringVal().toString() == name) {
+                return true;
+            }
+
+            break;
+        }
+        case tiny::ASTNodeType::Identifier:
+            if (node.hasParam(tiny::ParameterType::Dereference) && node.getStringVal().toString() == name) {
+                return true;
+            }
+
+            break;
+        default:
+            break;
+        }
+
+        for (auto const &c: node.children) {
+            if (writes(*c, name)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //! A translated expression
+    struct Expression {
+        std::string code;
+        CType type;
+        //! The value of an integer literal
+        std::optional<std::int64_t> constant = std::nullopt;
+    };
+
+    //! A variable of the function being translated
+    struct Variable {
+        std::string name;
+        CType type;
+    };
+
+    //! Translates a single function
+    class FunctionGenerator {
+    public:
+        FunctionGenerator(const Program &program, const tiny::ASTFile &file, const std::string &name)
+                : program(program), file(file), name(name), signature(program.functions.at(name)) {
+            if (signature.isDeclared) {
+                results = signature.results;
+            }
+
+            // Variables can't take the name of anything global
+            for (auto const &[n, s]: program.structs) {
+                used.insert(globalName(n));
+            }
+
+            for (auto const &[n, s]: program.functions) {
+                used.insert(s.cName);
+            }
+        }
+
+        //! Translates the function. Returns its definition
+        std::string generate(const tiny::ASTNode &node) {
+            scopes.emplace_back();
+
+            std::string params;
+            auto const &args = node.getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children;
+            for (std::size_t i = 0; i < args.size(); i++) {
+                auto argName = args[i]->getParam(tiny::ParameterType::Name).getStringVal(args[i]->meta).toString();
+                params += (i > 0 ? ", " : "") + declaration(signature.params[i], declare(argName, signature.params[i]));
+            }
+
+            auto const &body = *node.getChild(tiny::ASTNodeType::FunctionBody)->getFirstChild();
+            indent++;
+            block(body);
+            indent--;
+
+            if (!results) {
+                results.emplace(); // Never returns a value
+            } else if (!results->empty() && !alwaysReturns(body)) {
+                throw tiny::CodegenError("Function '" + name + "' can end without returning a value", node.meta);
+            }
+
+            return "static " + (results->empty() ? "void" : typeName(results->front())) + " " + signature.cName + "("
+                   + (params.empty() ? "void" : params) + ") {\n" + out + "}\n";
+        }
+
+        //! The results of the function, once it's translated
+        [[nodiscard]] const std::vector<CType> &getResults() const { return *results; }
+
+    private:
+        void line(const std::string &code) {
+            out += std::string(indent * 4, ' ') + code + "\n";
+        }
+
+        // Variables
+
+        //! Picks a C name for a variable that doesn't clash with any other name of the function
+        std::string uniqueName(const std::string &base) {
+            auto candidate = base;
+            for (std::size_t i = 1; RESERVED.count(candidate) > 0 || used.count(candidate) > 0; i++) {
+                candidate = base + "_" + std::to_string(i);
+            }
+
+            used.insert(candidate);
+            return candidate;
+        }
+
+        //! Declares a variable in the innermost scope. Returns its C name
+        std::string declare(const std::string &variable, const CType &type) {
+            auto cName = uniqueName(variable);
+            scopes.back()[variable] = {cName, type};
+            return cName;
+        }
+
+        const Variable &lookup(const tiny::ASTNode &id) {
+            auto variable = id.getStringVal().toString();
+            for (auto scope = scopes.rbegin(); scope != scopes.rend(); scope++) {
+                if (auto it = scope->find(variable); it != scope->end()) {
+                    return it->second;
+                }
+            }
+
+            throw tiny::CodegenError("Undefined variable '" + variable + "'", id.meta);
+        }
+
+        //! Checks that a value can be stored in a type: its own type, or a number that doesn't lose its decimals
+        void expect(const Expression &value, const CType &type, const tiny::Metadata &meta) {
+            if (value.type == type || (value.type.isInteger() && type.isNumber())
+                || (value.type.isDecimal() && type.isDecimal())) {
+                return;
+            }
+
+            throw tiny::CodegenError("Expected a value of type '" + type.toString() + "', but got '"
+                                     + value.type.toString() + "'", meta);
+        }
+
+        // Statements
+
+        void block(const tiny::ASTNode &node) {
+            scopes.emplace_back();
+
+            for (auto const &c: node.children) {
+                statement(*c);
+            }
+
+            scopes.pop_back();
+        }
+
+        void statement(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::ExpressionStatement:
+                expressionStatement(*node.getFirstChild());
+                break;
+            case tiny::ASTNodeType::BlockStatement:
+                line("{");
+                indent++;
+                block(node);
+                indent--;
+                line("}");
+                break;
+            case tiny::ASTNodeType::IfStatement:
+                ifStatement(node);
+                break;
+            case tiny::ASTNodeType::ForStatement:
+                forStatement(node);
+                break;
+            case tiny::ASTNodeType::FunctionReturn:
+                returnStatement(node);
+                break;
+            default:
+                unsupported(node);
+            }
+        }
+
+        void expressionStatement(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::Initialization: {
+                // The value is computed before the name is declared, so it can use a variable it shadows
+                auto const &lhs = *node.getFirstChild();
+                auto value = this->value(*node.getSecondChild());
+                auto type = value.type;
+                if (lhs.type == tiny::ASTNodeType::TypedExpression) {
+                    type = program.typeOf(*lhs.getChild(tiny::ASTNodeType::Type));
+                    expect(value, type, node.meta);
+                }
+
+                auto name = declare(lhs.getStringVal().toString(), type);
+                line(declaration(type, name) + " = " + unparenthesized(value.code) + ";");
+                return;
+            }
+            case tiny::ASTNodeType::VarDeclaration: {
+                auto type = program.typeOf(*node.getFirstChild());
+                std::string zero = "0";
+                if (type.isPointer()) {
+                    zero = "NULL";
+                } else if (type.isBool()) {
+                    zero = "false";
+                } else if (!type.isNumber()) {
+                    zero = "{0}"; // A struct
+                }
+
+                line(declaration(type, declare(node.getStringVal().toString(), type)) + " = " + zero + ";");
+                return;
+            }
+            case tiny::ASTNodeType::Assignment: {
+                auto lhs = lvalue(*node.getFirstChild());
+                auto rhs = value(*node.getSecondChild());
+                expect(rhs, lhs.type, node.meta);
+                line(lhs.code + " = " + unparenthesized(rhs.code) + ";");
+                return;
+            }
+            case tiny::ASTNodeType::AssignmentSum:
+                compoundAssignment(node, "+");
+                return;
+            case tiny::ASTNodeType::AssignmentSub:
+                compoundAssignment(node, "-");
+                return;
+            case tiny::ASTNodeType::AssignmentMulti:
+                compoundAssignment(node, "*");
+                return;
+            case tiny::ASTNodeType::AssignmentDiv:
+                compoundAssignment(node, "/");
+                return;
+            default:
+                // Evaluated for its side effects, such as a call
+                line(unparenthesized(expression(node).code) + ";");
+            }
+        }
+
+        void compoundAssignment(const tiny::ASTNode &node, const std::string &op) {
+            auto lhs = lvalue(*node.getFirstChild());
+            auto rhs = widened(value(*node.getSecondChild()));
+            expect({"", arithmeticType(op, lhs, rhs, node.meta)}, lhs.type, node.meta);
+            line(lhs.code + " " + op + "= " + unparenthesized(rhs.code) + ";");
+        }
+
+        void ifStatement(const tiny::ASTNode &node) {
+            auto cond = condition(*node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild());
+            line("if (" + unparenthesized(cond.code) + ") {");
+            indent++;
+            block(*node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild());
+            indent--;
+
+            if (node.children.size() >= 3) {
+                line("} else {");
+                indent++;
+                block(*node.getChild(tiny::ASTNodeType::BranchAlternative)->getFirstChild());
+                indent--;
+            }
+
+            line("}");
+        }
+
+        void forStatement(const tiny::ASTNode &node) {
+            auto const &cond = *node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild();
+            auto const &body = *node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild();
+
+            if (cond.type == tiny::ASTNodeType::RangeExpression) {
+                rangeLoop(cond, body);
+                return;
+            }
+
+            if (cond.type == tiny::ASTNodeType::ForEachExpression) {
+                unsupported(cond);
+            }
+
+            line("while (" + unparenthesized(condition(cond).code) + ") {");
+            indent++;
+            block(body);
+            indent--;
+            line("}");
+        }
+
+        //! Translates a range into a counted loop, whose limit and step are computed once, before the first iteration
+        void rangeLoop(const tiny::ASTNode &range, const tiny::ASTNode &body) {
+            auto integer = [&](const tiny::ASTNode &node) {
+                auto e = value(node);
+                if (!e.type.isInteger()) {
+                    throw tiny::CodegenError("Ranges must be over integers", node.meta);
+                }
+
+                return e;
+            };
+
+            auto variable = range.getParam(tiny::ParameterType::RangeIdentifier).getStringVal(range.meta).toString();
+            auto from = integer(*range.getChild(tiny::ASTNodeType::RangeFromExpression)->getFirstChild());
+
+            auto const &toNode = *range.getChild(tiny::ASTNodeType::RangeToExpression);
+            auto to = toNode.children.empty() ? std::nullopt : std::optional(integer(*toNode.getFirstChild()));
+
+            auto const &stepNode = *range.getChild(tiny::ASTNodeType::RangeStepExpression);
+            auto step = stepNode.children.empty() ? Expression{"1", INT64, 1} : integer(*stepNode.getFirstChild());
+            if (step.constant == 0) {
+                throw tiny::CodegenError("The step of a range can't be zero", range.meta);
+            }
+
+            scopes.emplace_back();
+
+            // Writing to the variable in the body mustn't change the iterations, so it's then a copy of the counter
+            auto copies = writes(body, variable);
+            auto counter = copies ? uniqueName(variable + "_counter") : declare(variable, INT64);
+
+            auto init = declaration(INT64, counter) + " = " + unparenthesized(from.code);
+            auto limit = to ? to->code : "";
+            if (to && !to->constant) {
+                limit = uniqueName(variable + "_end");
+                init += ", " + limit + " = " + unparenthesized(to->code);
+            }
+
+            auto stepCode = step.code;
+            if (!step.constant) {
+                stepCode = uniqueName(variable + "_step");
+                init += ", " + stepCode + " = " + unparenthesized(step.code);
+            }
+
+            std::string test;
+            if (!to) {
+                test = ""; // An open range never ends
+            } else if (step.constant) {
+                test = counter + (*step.constant > 0 ? " < " : " > ") + limit;
+            } else {
+                test = stepCode + " > 0 ? " + counter + " < " + limit + " : " + counter + " > " + limit;
+            }
+
+            std::string increment = counter + " += " + stepCode;
+            if (step.constant == 1 || step.constant == -1) {
+                increment = counter + (*step.constant > 0 ? "++" : "--");
+            } else if (step.constant && *step.constant < 0 && *step.constant != INT64_MIN) {
+                increment = counter + " -= " + std::to_string(-*step.constant);
+            }
+
+            line("for (" + init + "; " + test + "; " + increment + ") {");
+            indent++;
+            if (copies) {
+                line(declaration(INT64, declare(variable, INT64)) + " = " + counter + ";");
+            }
+
+            block(body);
+            indent--;
+            line("}");
+
+            scopes.pop_back();
+        }
+
+        void returnStatement(const tiny::ASTNode &node) {
+            if (node.children.size() > 1) {
+                throw tiny::CodegenError("C functions can't return more than one value", node.meta);
+            }
+
+            std::optional<Expression> result;
+            if (!node.children.empty()) {
+                result = value(*node.getFirstChild());
+            }
+
+            // The first return gives the results of the function, and the others must match it. Inferred results widen
+            // to fit every return, since the VM never narrows what a function gives
+            if (!results) {
+                results.emplace();
+                if (result) {
+                    results->push_back(result->type);
+                }
+            } else if (results->size() != node.children.size()) {
+                throw tiny::CodegenError("Function '" + name + "' returns " + std::to_string(results->size())
+                                         + " values, but this return has " + std::to_string(node.children.size()),
+                                         node.meta);
+            } else if (result) {
+                auto &type = results->front();
+                if (!signature.isDeclared && result->type != type) {
+                    if (result->type.isInteger() && type.isInteger()) {
+                        type = INT64;
+                    } else if (result->type.isDecimal() && type.isDecimal()) {
+                        type = FLOAT64;
+                    }
+                }
+
+                expect(*result, type, node.meta);
+            }
+
+            line(result ? "return " + unparenthesized(result->code) + ";" : "return;");
+        }
+
+        // Expressions
+
+        //! Strips the parentheses around a whole expression, where the C syntax already delimits it
+        static std::string unparenthesized(const std::string &code) {
+            if (code.size() < 2 || code.front() != '(' || code.back() != ')') {
+                return code;
+            }
+
+            // Only if the first parenthesis is closed by the last one, unlike in "(a) + (b)"
+            std::size_t depth = 0;
+            for (std::size_t i = 0; i < code.size() - 1; i++) {
+                depth += code[i] == '(' ? 1 : 0;
+                depth -= code[i] == ')' ? 1 : 0;
+                if (depth == 0) {
+                    return code;
+                }
+            }
+
+            return code.substr(1, code.size() - 2);
+        }
+
+        //! Translates an expression that must give a value
+        Expression value(const tiny::ASTNode &node) {
+            auto e = expression(node);
+            if (e.type.isVoid()) {
+                throw tiny::CodegenError("'" + node.toString() + "' doesn't give a value", node.meta);
+            }
+
+            return e;
+        }
+
+        //! Translates an expression that must give a boolean
+        Expression condition(const tiny::ASTNode &node) {
+            auto e = value(node);
+            if (!e.type.isBool()) {
+                throw tiny::CodegenError("Conditions must be booleans, but got '" + e.type.toString() + "'",
+                                         node.meta);
+            }
+
+            return e;
+        }
+
+        //! Translates an expression that can be written to: a variable, a value behind a pointer, or a field
+        Expression lvalue(const tiny::ASTNode &node) {
+            if (node.type == tiny::ASTNodeType::MemberAccess
+                || (node.type == tiny::ASTNodeType::Identifier && !node.hasParam(tiny::ParameterType::Dereference))) {
+                return expression(node);
+            }
+
+            unsupported(node);
+        }
+
+        Expression expression(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::LiteralInt:
+                return integerLiteral(node);
+            case tiny::ASTNodeType::LiteralDecimal:
+                return {decimalLiteral(double(std::get<long double>(node.val))), FLOAT64};
+            case tiny::ASTNodeType::LiteralBool:
+                return {std::get<bool>(node.val) ? "true" : "false", BOOL};
+
+            case tiny::ASTNodeType::Identifier:
+                return identifier(node);
+            case tiny::ASTNodeType::MemberAccess:
+                return memberAccess(node);
+
+            case tiny::ASTNodeType::OpAddition:
+                return binary(node, "+");
+            case tiny::ASTNodeType::OpSubtraction:
+                return binary(node, "-");
+            case tiny::ASTNodeType::OpMultiplication:
+                return binary(node, "*");
+            case tiny::ASTNodeType::OpDivision:
+                return binary(node, "/");
+            case tiny::ASTNodeType::OpExponentiate:
+                return power(node);
+            case tiny::ASTNodeType::CompareEq:
+                return comparison(node, "==");
+            case tiny::ASTNodeType::CompareNeq:
+                return comparison(node, "!=");
+            case tiny::ASTNodeType::CompareLt:
+                return comparison(node, "<");
+            case tiny::ASTNodeType::CompareLteq:
+                return comparison(node, "<=");
+            case tiny::ASTNodeType::CompareGt:
+                return comparison(node, ">");
+            case tiny::ASTNodeType::CompareGteq:
+                return comparison(node, ">=");
+
+            case tiny::ASTNodeType::UnaryNegative: {
+                auto x = value(*node.getFirstChild());
+                if (!x.type.isNumber()) {
+                    throw tiny::CodegenError("Can't negate a value of type '" + x.type.toString() + "'", node.meta);
+                }
+
+                return {"(-" + widened(x).code + ")", promoted(x.type)};
+            }
+            case tiny::ASTNodeType::UnaryNot:
+                return {"(!" + condition(*node.getFirstChild()).code + ")", BOOL};
+
+            case tiny::ASTNodeType::LogicalAnd:
+                return {"(" + condition(*node.getFirstChild()).code + " && " + condition(*node.getSecondChild()).code
+                        + ")", BOOL};
+            case tiny::ASTNodeType::LogicalOr:
+                return {"(" + condition(*node.getFirstChild()).code + " || " + condition(*node.getSecondChild()).code
+                        + ")", BOOL};
+
+            case tiny::ASTNodeType::FunctionCall:
+                return call(node);
+
+            default:
+                unsupported(node);
+            }
+        }
+
+        static Expression integerLiteral(const tiny::ASTNode &node) {
+            if (std::holds_alternative<std::uint64_t>(node.val)) {
+                auto value = std::get<std::uint64_t>(node.val);
+                return {"UINT64_C(" + std::to_string(value) + ")", {"uint64"}};
+            }
+
+            auto value = std::get<std::int64_t>(node.val);
+            if (value == INT64_MIN) {
+                return {"INT64_MIN", INT64, value}; // Its magnitude doesn't fit in a literal
+            }
+
+            // Plain ints are enough for small literals, since they're converted to whatever they meet
+            auto code = value >= INT32_MIN && value <= INT32_MAX ? std::to_string(value)
+                                                                 : "INT64_C(" + std::to_string(value) + ")";
+            return {value < 0 ? "(" + code + ")" : code, INT64, value};
+        }
+
+        static std::string decimalLiteral(double value) {
+            if (std::isnan(value)) {
+                return "NAN";
+            }
+
+            if (std::isinf(value)) {
+                return value > 0 ? "INFINITY" : "(-INFINITY)";
+            }
+
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+
+            std::string code(buffer);
+            if (code.find_first_of(".e") == std::string::npos) {
+                code += ".0";
+            }
+
+            return value < 0 ? "(" + code + ")" : code;
+        }
+
+        Expression identifier(const tiny::ASTNode &node) {
+            auto const &variable = lookup(node);
+            if (node.params.empty()) {
+                return {variable.name, variable.type};
+            }
+
+            if (node.hasParam(tiny::ParameterType::ValueAt)) {
+                if (!variable.type.isPointer()) {
+                    throw tiny::CodegenError("'" + node.getStringVal().toString() + "' isn't a pointer", node.meta);
+                }
+
+                return {"(*" + variable.name + ")", variable.type.pointee()};
+            }
+
+            if (node.hasParam(tiny::ParameterType::Dereference)) {
+                return {"(&" + variable.name + ")", variable.type.pointer()};
+            }
+
+            unsupported(node);
+        }
+
+        //! Reads a field of a struct, or of a struct a pointer points to
+        Expression memberAccess(const tiny::ASTNode &node) {
+            auto object = value(*node.getFirstChild());
+            auto const &member = *node.getSecondChild();
+            if (member.type != tiny::ASTNodeType::Identifier || !member.params.empty()) {
+                unsupported(member);
+            }
+
+            auto type = object.type.pointers == 1 ? object.type.pointee() : object.type;
+            if (type.isPointer() || type.isBuiltin()) {
+                throw tiny::CodegenError("Can't access '" + member.getStringVal().toString() + "' of a value of type '"
+                                         + object.type.toString() + "'", node.meta);
+            }
+
+            auto path = program.findField(type.name, member.getStringVal().toString());
+            if (path.empty()) {
+                throw tiny::CodegenError("Struct '" + type.name + "' has no field '"
+                                         + member.getStringVal().toString() + "'", member.meta);
+            }
+
+            auto code = object.code + (object.type.isPointer() ? "->" : ".");
+            for (std::size_t i = 0; i < path.size(); i++) {
+                code += (i > 0 ? "." : "") + fieldName(path[i]->name);
+            }
+
+            return {code, path.back()->type};
+        }
+
+        //! Integers narrower than 64 bits become int64 when used in arithmetic, like in the VM
+        static CType promoted(const CType &type) {
+            return type.isInteger() && type.bits() < 64 ? INT64 : type;
+        }
+
+        //! Casts an integer narrower than 64 bits to int64, since C would compute with it as an int
+        static Expression widened(const Expression &e) {
+            if (promoted(e.type) == e.type) {
+                return e;
+            }
+
+            return {"((int64_t) " + e.code + ")", INT64, e.constant};
+        }
+
+        //! Gets the type C gives to an arithmetic operation
+        static CType arithmeticType(const std::string &op, const Expression &x, const Expression &y,
+                                    const tiny::Metadata &meta) {
+            if (!x.type.isNumber() || !y.type.isNumber()) {
+                throw tiny::CodegenError("Invalid operands for '" + op + "' ('" + x.type.toString() + "' and '"
+                                         + y.type.toString() + "')", meta);
+            }
+
+            // Integers become the decimal they meet
+            if (x.type.isDecimal() || y.type.isDecimal()) {
+                return x.type == FLOAT64 || y.type == FLOAT64 ? FLOAT64 : FLOAT32;
+            }
+
+            // Both are 64 bits wide by now, and unsigned ones win over signed ones
+            auto a = promoted(x.type);
+            auto b = promoted(y.type);
+            return a.isUnsigned() ? a : b;
+        }
+
+        Expression binary(const tiny::ASTNode &node, const std::string &op) {
+            auto x = widened(value(*node.getFirstChild()));
+            auto y = widened(value(*node.getSecondChild()));
+            auto type = arithmeticType(op, x, y, node.meta);
+            return {"(" + x.code + " " + op + " " + y.code + ")", type};
+        }
+
+        //! Powers of integers by non-negative constants stay integers. Anything else is a decimal, through pow()
+        Expression power(const tiny::ASTNode &node) {
+            auto x = value(*node.getFirstChild());
+            auto y = value(*node.getSecondChild());
+            arithmeticType("**", x, y, node.meta);
+
+            if (x.type.isInteger() && y.constant && *y.constant >= 0) {
+                return {"tiny_powi(" + unparenthesized(x.code) + ", " + unparenthesized(y.code) + ")", INT64};
+            }
+
+            return {"pow(" + unparenthesized(x.code) + ", " + unparenthesized(y.code) + ")", FLOAT64};
+        }
+
+        Expression comparison(const tiny::ASTNode &node, const std::string &op) {
+            // Widened, so signed and unsigned integers compare by their values like in the VM
+            auto x = widened(value(*node.getFirstChild()));
+            auto y = widened(value(*node.getSecondChild()));
+
+            auto comparable = x.type.isNumber() && y.type.isNumber();
+            if (!comparable && x.type == y.type && (op == "==" || op == "!=")) {
+                comparable = x.type.isBool() || x.type.isPointer(); // Structs have no comparisons in C
+            }
+
+            if (!comparable) {
+                throw tiny::CodegenError("Invalid operands for '" + op + "' ('" + x.type.toString() + "' and '"
+                                         + y.type.toString() + "')", node.meta);
+            }
+
+            return {"(" + x.code + " " + op + " " + y.code + ")", BOOL};
+        }
+
+        Expression call(const tiny::ASTNode &node) {
+            auto const &callee = *node.getFirstChild();
+            if (callee.type == tiny::ASTNodeType::Identifier && !callee.params.empty()) {
+                unsupported(callee);
+            }
+
+            auto function = program.resolver.resolve<tiny::CodegenError>(file, callee);
+            auto const &target = program.functions.at(function);
+            auto const &args = node.getSecondChild()->children;
+            if (args.size() != target.params.size()) {
+                throw tiny::CodegenError("Function '" + function + "' takes " + std::to_string(target.params.size())
+                                         + " arguments, but got " + std::to_string(args.size()), node.meta);
+            }
+
+            std::string code = target.cName + "(";
+            for (std::size_t i = 0; i < args.size(); i++) {
+                auto arg = value(*args[i]);
+                expect(arg, target.params[i], args[i]->meta);
+                code += (i > 0 ? ", " : "") + unparenthesized(arg.code);
+            }
+
+            // Until a return of the function is translated, guess that it gives an integer
+            auto type = INT64;
+            if (target.results) {
+                type = target.results->empty() ? CType() : target.results->front();
+            }
+
+            return {code + ")", type};
+        }
+
+        const Program &program;
+        const tiny::ASTFile &file;
+        const std::string &name;
+        const Signature &signature;
+
+        //! The body, as it's translated
+        std::string out;
+        std::size_t indent = 0;
+
+        //! The types of the values returned so far. Unknown until the first return, unless they're declared
+        std::optional<std::vector<CType>> results;
+
+        //! Variables by name, from the outermost to the innermost block
+        std::vector<std::unordered_map<std::string, Variable>> scopes;
+        //! The C names taken, by variables or anything global
+        std::unordered_set<std::string> used;
+    };
+
+    //! Gathers the structs and their fields, and checks that no struct contains itself
+    void gatherStructs(Program &program, const std::vector<const tiny::ASTNode *> &declarations) {
+        for (auto const *node: declarations) {
+            auto name = node->getParam(tiny::ParameterType::Name).getStringVal(node->meta).toString();
+            if (program.structs.count(name) > 0) {
+                throw tiny::CodegenError("Struct '" + name + "' is defined more than once", node->meta);
+            }
+
+            program.structs[name] = {name, {}, node};
+        }
+
+        // Fields are resolved once every struct is known, so they can use structs declared later
+        for (auto &[name, s]: program.structs) {
+            for (auto const &f: s.node->getChild(tiny::ASTNodeType::StructFieldList)->children) {
+                if (f->type == tiny::ASTNodeType::Composition) {
+                    auto composed = f->getStringVal().toString();
+                    if (program.structs.count(composed) == 0) {
+                        throw tiny::CodegenError("Undefined struct '" + composed + "'", f->meta);
+                    }
+
+                    s.fields.push_back({composed, {composed}, true});
+                } else {
+                    s.fields.push_back({f->getStringVal().toString(),
+                                        program.typeOf(*f->getChild(tiny::ASTNodeType::Type))});
+                }
+            }
+        }
+    }
+
+    //! Orders the structs so that every struct comes after the structs it holds by value, which C needs complete
+    void orderStructs(const Program &program, const std::string &name, std::unordered_set<std::string> &visiting,
+                      std::unordered_set<std::string> &done, std::vector<const Struct *> &order) {
+        if (done.count(name) > 0) {
+            return;
+        }
+
+        auto const &s = program.structs.at(name);
+        if (!visiting.insert(name).second) {
+            throw tiny::CodegenError("Struct '" + name + "' contains itself", s.node->meta);
+        }
+
+        for (auto const &f: s.fields) {
+            if (!f.type.isPointer() && !f.type.isBuiltin()) {
+                orderStructs(program, f.type.name, visiting, done, order);
+            }
+        }
+
+        visiting.erase(name);
+        done.insert(name);
+        order.push_back(&s);
+    }
+
+    //! The helpers of the generated code, which don't depend on the program
+    const char *RUNTIME = R"(// Integer exponentiation by squaring. Wraps around on overflow
+static inline int64_t tiny_powi(int64_t base, int64_t exponent) {
+    uint64_t result = 1;
+    uint64_t b = (uint64_t) base;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result *= b;
+        }
+
+        b *= b;
+        exponent >>= 1;
+    }
+
+    return (int64_t) result;
+}
+)";
+
+    //! The helpers of the entry point that parse the arguments of the command line, by the types they parse
+    const char *PARSE_INT = R"(static bool tiny_parse_int(const char *str, int64_t *out) {
+    char *end;
+    errno = 0;
+    *out = (int64_t) strtoll(str, &end, 0);
+    if (*str == '\0' || *end != '\0' || errno != 0) {
+        fprintf(stderr, "Invalid argument ('%s') for 'main'\n", str);
+        return false;
+    }
+
+    return true;
+}
+)";
+
+    const char *PARSE_FLOAT = R"(static bool tiny_parse_float(const char *str, double *out) {
+    char *end;
+    errno = 0;
+    *out = strtod(str, &end);
+    if (*str == '\0' || *end != '\0' || errno != 0) {
+        fprintf(stderr, "Invalid argument ('%s') for 'main'\n", str);
+        return false;
+    }
+
+    return true;
+}
+)";
+
+    const char *PARSE_BOOL = R"(static bool tiny_parse_bool(const char *str, bool *out) {
+    *out = strcmp(str, "True") == 0;
+    if (!*out && strcmp(str, "False") != 0) {
+        fprintf(stderr, "Invalid argument ('%s') for 'main'\n", str);
+        return false;
+    }
+
+    return true;
+}
+)";
+
+    //! Generates a C main that calls the main function with the arguments of the command line, and prints its result
+    std::string entryPoint(const Signature &signature, const tiny::ASTNode &node) {
+        auto const &results = *signature.results;
+        for (auto const &t: signature.params) {
+            if (!t.isBuiltin()) {
+                throw tiny::CodegenError("Function 'main' can only take numbers and booleans", node.meta);
+            }
+        }
+
+        if (!results.empty() && !results.front().isBuiltin()) {
+            throw tiny::CodegenError("Function 'main' can only return a number or a boolean", node.meta);
+        }
+
+        std::string code = "int main(int argc, char **argv) {\n";
+        code += "    if (argc != " + std::to_string(signature.params.size() + 1) + ") {\n";
+        code += "        fprintf(stderr, \"'main' takes " + std::to_string(signature.params.size())
+                + " arguments, but got %d\\n\", argc - 1);\n";
+        code += "        return 1;\n";
+        code += "    }\n\n";
+
+        // Only the parsers of the types main takes are included, since C warns about unused functions
+        std::string helpers;
+        std::string args;
+        std::string parses;
+        for (std::size_t i = 0; i < signature.params.size(); i++) {
+            auto const &t = signature.params[i];
+            auto arg = "arg" + std::to_string(i);
+            auto parse = t.isBool() ? "tiny_parse_bool" : t.isDecimal() ? "tiny_parse_float" : "tiny_parse_int";
+            if (helpers.find(parse) == std::string::npos) {
+                helpers += std::string(t.isBool() ? PARSE_BOOL : t.isDecimal() ? PARSE_FLOAT : PARSE_INT) + "\n";
+            }
+
+            code += "    " + declaration(t.isBool() ? BOOL : t.isDecimal() ? FLOAT64 : INT64, arg) + ";\n";
+            parses += std::string(parses.empty() ? "" : " || ") + "!" + parse + "(argv[" + std::to_string(i + 1)
+                      + "], &" + arg + ")";
+            args += (i > 0 ? ", " : "") + arg;
+        }
+
+        if (!parses.empty()) {
+            code += "    if (" + parses + ") {\n";
+            code += "        return 1;\n";
+            code += "    }\n\n";
+        }
+
+        auto callCode = signature.cName + "(" + args + ")";
+        if (results.empty()) {
+            code += "    " + callCode + ";\n";
+        } else if (results.front().isBool()) {
+            code += "    puts(" + callCode + " ? \"True\" : \"False\");\n";
+        } else if (results.front().isDecimal()) {
+            code += "    printf(\"%.17g\\n\", (double) " + callCode + ");\n";
+        } else if (results.front().isUnsigned()) {
+            code += "    printf(\"%\" PRIu64 \"\\n\", (uint64_t) " + callCode + ");\n";
+        } else {
+            code += "    printf(\"%\" PRId64 \"\\n\", (int64_t) " + callCode + ");\n";
+        }
+
+        return helpers + code + "    return 0;\n}\n";
+    }
+}
+
+std::string tiny::CGenerator::generate(const std::vector<tiny::ASTFile> &files) {
+    Program program;
+    std::vector<const tiny::ASTNode *> structs;
+    std::vector<std::pair<const tiny::ASTFile *, const tiny::ASTNode *>> functions;
+
+    for (auto const &file: files) {
+        for (auto const &node: file.statements) {
+            switch (node.type) {
+            case tiny::ASTNodeType::StructDeclaration:
+                structs.push_back(&node);
+                break;
+            case tiny::ASTNodeType::FunctionDeclaration:
+                functions.emplace_back(&file, &node);
+                break;
+            case tiny::ASTNodeType::TraitDeclaration:
+                break; // Traits don't generate code
+            default:
+                unsupported(node);
+            }
+        }
+    }
+
+    gatherStructs(program, structs);
+
+    // C names of the structs and functions, which can't be shared
+    std::unordered_map<std::string, std::string> cNames;
+    for (auto const &[name, s]: program.structs) {
+        cNames[globalName(name)] = "struct '" + name + "'";
+    }
+
+    // Gather every function first, so calls can go to functions declared later or in other files
+    for (auto const &[file, node]: functions) {
+        auto mod = file->mod.toString();
+        auto name = node->getParam(tiny::ParameterType::Name).getStringVal(node->meta).toString();
+        if (!program.resolver.declare(mod, name)) {
+            throw tiny::CodegenError("Function '" + name + "' is defined more than once in module '" + mod + "'",
+                                     node->meta);
+        }
+
+        auto qualified = tiny::FunctionResolver::qualify(mod, name);
+        auto cName = functionName(mod, name);
+        if (auto [it, inserted] = cNames.emplace(cName, "function '" + qualified + "'"); !inserted) {
+            throw tiny::CodegenError("Function '" + qualified + "' and " + it->second + " have the same C name ('"
+                                     + cName + "')", node->meta);
+        }
+
+        auto &signature = program.functions[qualified];
+        signature.cName = cName;
+        for (auto const &arg: node->getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children) {
+            signature.params.push_back(program.typeOf(*arg));
+        }
+
+        auto const &returns = node->getChild(tiny::ASTNodeType::FunctionReturnDeclList)->children;
+        if (returns.size() > 1) {
+            throw tiny::CodegenError("C functions can't return more than one value", node->meta);
+        }
+
+        if (!returns.empty()) {
+            signature.results = std::vector<CType>{program.typeOf(*returns.front())};
+            signature.isDeclared = true;
+        }
+    }
+
+    // Calls to functions whose results aren't known yet are guessed, so translate everything again until no results
+    // change. Errors only count once they do, since they may come from a wrong guess
+    std::vector<std::string> definitions;
+    for (std::size_t round = 0;; round++) {
+        definitions.clear();
+        std::optional<tiny::CodegenError> error;
+        auto changed = false;
+
+        for (auto const &[file, node]: functions) {
+            auto name = tiny::FunctionResolver::qualify(file->mod.toString(), node->getParam(tiny::ParameterType::Name)
+                    .getStringVal(node->meta).toString());
+
+            try {
+                FunctionGenerator generator(program, *file, name);
+                definitions.push_back(generator.generate(*node));
+
+                auto &results = program.functions[name].results;
+                if (results != generator.getResults()) {
+                    results = generator.getResults();
+                    changed = true;
+                }
+            } catch (const tiny::CodegenError &e) {
+                if (!error) {
+                    error = e;
+                }
+            }
+        }
+
+        if (!changed) {
+            if (error) {
+                throw *error;
+            }
+
+            break;
+        }
+
+        if (round > functions.size()) {
+            throw tiny::CodegenError("The results of the functions can't be inferred", tiny::Metadata());
+        }
+    }
+
+    std::string code = "// Generated by " + tiny::Compiler::getSignature() + "\n\n";
+    for (auto const *header: {"errno.h", "inttypes.h", "math.h", "stdbool.h", "stdint.h", "stdio.h", "stdlib.h",
+                              "string.h"}) {
+        code += "#include <" + std::string(header) + ">\n";
+    }
+
+    code += "\n" + std::string(RUNTIME);
+
+    // Every struct is named first, so pointers can go to structs defined later
+    if (!structs.empty()) {
+        code += "\n";
+        for (auto const *node: structs) {
+            auto name = globalName(node->getParam(tiny::ParameterType::Name).getStringVal(node->meta).toString());
+            code += "typedef struct " + name + " " + name + ";\n";
+        }
+    }
+
+    std::unordered_set<std::string> visiting;
+    std::unordered_set<std::string> done;
+    std::vector<const Struct *> order;
+    for (auto const *node: structs) {
+        orderStructs(program, node->getParam(tiny::ParameterType::Name).getStringVal(node->meta).toString(), visiting,
+                     done, order);
+    }
+
+    for (auto const *s: order) {
+        code += "\nstruct " + globalName(s->name) + " {\n";
+        for (auto const &f: s->fields) {
+            code += "    " + declaration(f.type, fieldName(f.name)) + ";\n";
+        }
+
+        if (s->fields.empty()) {
+            code += "    char unused; // C doesn't allow empty structs\n";
+        }
+
+        code += "};\n";
+    }
+
+    // Prototypes first, so functions can call functions defined after them
+    if (!functions.empty()) {
+        code += "\n";
+    }
+
+    for (auto const &[file, node]: functions) {
+        auto const &signature = program.functions.at(tiny::FunctionResolver::qualify(
+                file->mod.toString(), node->getParam(tiny::ParameterType::Name).getStringVal(node->meta).toString()));
+
+        std::string params;
+        for (auto const &t: signature.params) {
+            params += (params.empty() ? "" : ", ") + typeName(t);
+        }
+
+        code += "static " + (signature.results->empty() ? "void" : typeName(signature.results->front())) + " "
+                + signature.cName + "(" + (params.empty() ? "void" : params) + ");\n";
+    }
+
+    for (auto const &definition: definitions) {
+        code += "\n" + definition;
+    }
+
+    // The entry point calls main like 'tiny run' does, so only if a single module declares it
+    if (auto main = program.resolver.find("main")) {
+        auto const &[file, node] = *std::find_if(functions.begin(), functions.end(), [&](const auto &f) {
+            return tiny::FunctionResolver::qualify(f.first->mod.toString(), f.second->getParam(
+                    tiny::ParameterType::Name).getStringVal(f.second->meta).toString()) == *main;
+        });
+
+        code += "\n" + entryPoint(program.functions.at(*main), *node);
+    }
+
+    return code;
+}
+
+void tiny::CGenerator::compileNative(const std::filesystem::path &source, const std::filesystem::path &executable) {
+#if defined(TINY_HAS_SPAWN)
+    auto const *cc = std::getenv("CC");
+    std::string compiler = cc != nullptr && *cc != '\0' ? cc : "cc";
+
+    std::vector<std::string> args{compiler, "-std=c11", "-O2", "-fwrapv", "-o", executable.string(), source.string(),
+                                  "-lm"};
+    std::vector<char *> argv;
+    for (auto &arg: args) {
+        argv.push_back(arg.data());
+    }
+
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    if (auto err = posix_spawnp(&pid, compiler.c_str(), nullptr, nullptr, argv.data(), environ); err != 0) {
+        throw tiny::NativeCompileError("Unable to start the C compiler ('" + compiler + "'): " + std::strerror(err));
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            throw tiny::NativeCompileError("Unable to wait for the C compiler ('" + compiler + "'): "
+                                           + std::strerror(errno));
+        }
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw tiny::NativeCompileError("The C compiler ('" + compiler + "') failed to compile '" + source.string()
+                                       + "'");
+    }
+#else
+    throw tiny::NativeCompileError("Unable to compile '" + source.string() + "' into '" + executable.string()
+                                   + "': starting the C compiler is only available on POSIX systems");
+#endif
+}
@@ -0,0 +1,65 @@
+#ifndef TINY_CGEN_H
+#define TINY_CGEN_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "ast.h"
+
+namespace tiny {
+    /*!
+     * \brief Translates ASTs into a portable C11 program
+     *
+     * Translates the function and struct declarations of a set of ASTs, as they come out of the Compiler, into a single
+     * C11 translation unit. Builtin types become their <stdint.h> and <stdbool.h> counterparts (int32 is int32_t,
+     * float64 is double), structs become C structs, with the structs they're composed of as members named after them,
+     * and functions become static C functions. Ranges in for statements become counted for loops, whose bounds are
+     * computed once, and other for statements become while loops.
+     *
+     * Nothing gives expressions a type before this, so they follow the rules of C: literals are int64 or float64, and
+     * arithmetic converts its operands like C does. Unlike in C, integers compute with 64 bits like in the VM, so
+     * narrower ones are widened first and only keep their width where they're stored: arguments, typed variables and
+     * fields. A power is only an integer if both operands are integers and its exponent is a non-negative constant, and
+     * decimals never silently become integers. A function without declared results returns the type of its returns,
+     * widened to int64 (or float64) when they disagree, found by translating every function again until the results of
+     * calls stop changing.
+     *
+     * Functions and structs are prefixed with "tiny_", so they can't clash with the C library, and functions also get
+     * the name of their module ("tiny_main_sum"), since calls are resolved by module like the BytecodeCompiler does.
+     * Variables that would clash with a C keyword or another name get a suffix. If a single module declares a function
+     * called main, the program also gets a C main that parses the arguments of the command line like 'tiny run' does,
+     * calls it, and prints what it returns.
+     *
+     * It accepts the same subset of the language as the IRBuilder, plus structs and member accesses. Like in the VM,
+     * 64 bits integers wrap around, but only if the C compiler is told so (-fwrapv), since C leaves signed overflow
+     * undefined. Divisions by zero aren't checked.
+     */
+    class CGenerator {
+    public:
+        /*!
+         * \brief Translates a set of ASTs
+         * \param files The ASTs. Functions can use any struct of any of them, and call the functions of their module
+         * and of the modules it imports
+         * \return The C source
+         *
+         * Translates a set of ASTs. Throws CodegenError if a node can't be translated, if a name is undefined or
+         * redefined, or if types don't match, for example in a condition that isn't a boolean or in an assignment of a
+         * decimal to an integer.
+         */
+        static std::string generate(const std::vector<tiny::ASTFile> &files);
+
+        /*!
+         * \brief Compiles a C source into an executable with the C compiler of the system
+         * \param source The C source file
+         * \param executable Where to write the executable
+         *
+         * Compiles a C source into an executable with the C compiler in the CC environment variable, or 'cc' if it's
+         * not set, with "-std=c11 -O2 -fwrapv". Its diagnostics go to stderr. Throws NativeCompileError if the compiler
+         * can't be started or fails, or if the system can't start processes, since it's only supported on POSIX.
+         */
+        static void compileNative(const std::filesystem::path &source, const std::filesystem::path &executable);
+    };
+}
+
+#endif //TINY_CGEN_H
@@ -1,51 +1,150 @@
+#include <sstream>
+#include <iomanip>
+
 #include "compiler.h"
 #include "config.h"
 #include "symtab.h"
 #include "errors.h"
+#include "profiler.h"
+#include "stats.h"
+#include "alloctrack.h"
+#include "scheduler.h"
+#include "loader.h"
+#include "project.h"
+#include "folding.h"
+
+namespace {
+    //! Builds a DiagnosticEngine with the limits of the settings
+    tiny::DiagnosticEngine makeDiagnosticEngine() {
+        auto maxErrors = tiny::getSetting<tiny::Option::MaxErrors>();
+        return tiny::DiagnosticEngine(maxErrors ? std::size_t(*maxErrors) : tiny::DiagnosticEngine::DEFAULT_MAX_ERRORS);
+    }
+}
 
 std::string tiny::Compiler::getSignature() {
     return TINY_NAME + " " + TINY_VERSION + " (" + TINY_VERSION_NICKNAME + ")";
 }
 
+tiny::Pipeline tiny::Compiler::makePipeline() {
+    tiny::Pipeline pipeline;
+
+    // Folding runs before any added stage, so those see the simplified ASTs
+    pipeline.addParseStage(tiny::ConstantFolder::stage());
+    return pipeline;
+}
+
+tiny::Pipeline &tiny::Compiler::getPipeline() {
+    return pl;
+}
+
+void tiny::Compiler::setCache(tiny::ASTCache *c) {
+    cache = c;
+}
+
+void tiny::Compiler::setProject(std::optional<tiny::ProjectSettings> settings) {
+    projectSettings = std::move(settings);
+}
+
+tiny::CompilationResult tiny::CompilationResult::fromDiagnostic(tiny::Diagnostic diagnostic) {
+    tiny::CompilationResult result;
+    result.status = tiny::CompilationStatus::Error;
+    result.error = {diagnostic.step, diagnostic.msg};
+    result.diagnostics.push_back(std::move(diagnostic));
+
+    return result;
+}
+
+void tiny::Compiler::setKeepASTs(bool keep) {
+    keepASTs = keep;
+}
+
 tiny::CompilationResult tiny::Compiler::compile() const {
     // Run the compilation steps in sequence, and then apply the pipeline to the stage
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    tiny::ProfileScope compileScope("compile", "compiler");
+
+    // Other compilations can run at once, so this one counts its allocations apart
+    tiny::AllocationCounters allocations;
+    tiny::AllocationScope allocationScope(&allocations);
 
     tiny::debug(getSignature());
     tiny::debug("Selecting files..");
 
     tiny::File meta;
+    tiny::ProjectSettings project;
+    std::vector<tiny::File> files;
 
     /*
      * File-selection step
      *
-     * The file selection stage uses the FileSelector to pick the files targeted by the compiler, and fetches the metadata
-     * file. If no metadata or/and source files are found error out.
+     * The file selection stage fetches the metadata file, reads the project settings out of it (unless they were
+     * given with setProject), and then uses the FileSelector to pick the files targeted by the compiler. If no
+     * metadata or/and source files are found, or the metadata file is invalid, error out.
      */
 
-    try {
-        meta = fileSelector.getMetaFile();
-    } catch (const tiny::MetaNotFoundError &e) {
-        tiny::fatal(e.what());
-        return {tiny::CompilationStatus::Error, {tiny::CompilationStep::FileSelection, e.what()}};
-    }
+    {
+        tiny::ProfileScope stepScope(tiny::toString(tiny::CompilationStep::FileSelection), "step");
+        tiny::PhaseScope phaseScope(tiny::CompilationStep::FileSelection);
 
-    std::vector<tiny::File> sources;
-    try {
-        sources = fileSelector.getLocalSourceFiles();
-    } catch (const tiny::SourcesNotFoundError &e) {
-        tiny::fatal( e.what());
-        return {tiny::CompilationStatus::Error, {tiny::CompilationStep::FileSelection, e.what()}};
-    }
+        try {
+            meta = fileSelector.getMetaFile();
+        } catch (const tiny::MetaNotFoundError &e) {
+            tiny::fatal(e.what());
+            return tiny::CompilationResult::fromDiagnostic(
+                    tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, e.what()));
+        } catch (const std::filesystem::filesystem_error &e) {
+            tiny::fatal(e.what());
+            return tiny::CompilationResult::fromDiagnostic(
+                    tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, e.what()));
+        }
 
-    std::vector<tiny::File> files(sources.begin(), sources.end());
-    files.push_back(meta);
+        try {
+            project = projectSettings ? *projectSettings : tiny::ProjectSettings::load(meta.path);
+        } catch (const tiny::TomlError &e) {
+            auto file = meta.getRelativePath().string();
+            tiny::fatal(file + ":" + std::to_string(e.line) + ":" + std::to_string(e.column) + ": " + e.msg);
+            auto diagnostic = tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, e.msg, file);
+            diagnostic.line = e.line;
+            diagnostic.column = e.column;
+            return tiny::CompilationResult::fromDiagnostic(std::move(diagnostic));
+        } catch (const tiny::FileError &e) {
+            tiny::fatal(e.what());
+            return tiny::CompilationResult::fromDiagnostic(
+                    tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, e.what()));
+        }
 
-    /*
-    tiny::debug("Running file selection pipe with length " +
-                            std::to_string(pl.getPipeLength(tiny::CompilationStep::FileSelection)));
-    files = pl.runFileSelectionPipe(files);
-     */
+        auto selector = fileSelector;
+
+        try {
+            selector.setPatterns(project.include, project.exclude);
+            files = selector.getLocalSourceFiles();
+        } catch (const tiny::SourcesNotFoundError &e) {
+            tiny::fatal(e.what());
+            return tiny::CompilationResult::fromDiagnostic(
+                    tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, e.what()));
+        } catch (const tiny::GlobError &e) {
+            // Settings given with setProject skip the checks of ProjectSettings::parse
+            tiny::fatal(e.what());
+            return tiny::CompilationResult::fromDiagnostic(
+                    tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, e.what()));
+        } catch (const std::filesystem::filesystem_error &e) {
+            tiny::fatal(e.what());
+            return tiny::CompilationResult::fromDiagnostic(
+                    tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, e.what()));
+        }
+
+        files.push_back(meta);
+
+        tiny::debug("Running file selection pipe with length " +
+                    std::to_string(pl.getPipeLength(tiny::CompilationStep::FileSelection)));
+        try {
+            pl.runFileSelectionPipe(files);
+        } catch (const tiny::PipelineError &e) {
+            tiny::fatal(e.what());
+            return tiny::CompilationResult::fromDiagnostic(
+                    tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, e.what()));
+        }
+    }
 
     tiny::debug("Got " + std::to_string(files.size()) + " files: ");
     for (auto const &f: files) {
@@ -53,94 +152,300 @@ tiny::CompilationResult tiny::Compiler::compile() const {
     }
 
     // With the sources selected we run each one of them in the compiler
-    std::vector<tiny::ASTFile> astFiles;
+    std::vector<tiny::File> sources;
     for (auto const &f: files) {
         if (f.type == tiny::FileType::Meta) {
-            // TODO Parse metafile
-            continue;
+            continue; // Already read
         }
 
-        tiny::debug(f, "Running compiler..");
+        sources.push_back(f);
+    }
 
-        std::ifstream filestream(f.path);
-        tiny::Stream charStream(filestream);
+    bool serialize = tiny::getSetting<tiny::Option::OutputASTJSON>() || project.outputASTJSON;
+    auto engine = makeDiagnosticEngine();
+    auto outcomes = compileFiles(sources, nullptr, serialize, engine);
 
-        tiny::Lexer lexer(charStream);
-        lexer.setMetadataFile(f);
-        std::vector<tiny::Lexeme> lexemes;
+    if (!engine.empty()) {
+        auto diagnostics = engine.finish();
+        tiny::fatal("Invalid program");
 
-        tiny::debug(f, "Lexing..");
+        auto const &first = diagnostics.front();
+        tiny::CompilationResult result;
+        result.status = tiny::CompilationStatus::Error;
+        result.error = {first.step, first.msg};
+        result.diagnostics = std::move(diagnostics);
+        return result;
+    }
 
-        /*
-         * Lexing stage
-         *
-         * Separate every file in lexemes that can be used to build the parse tree
-         */
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::ostringstream runtime;
+    runtime << std::fixed << std::setprecision(3) << std::chrono::duration<double>(end - begin).count();
+    tiny::info("Done (" + runtime.str() + "s)");
+
+    if constexpr (tiny::AllocationTracker::isBuiltIn()) {
+        allocations.logSummary();
+
+        auto &stats = tiny::Statistics::get();
+        for (std::size_t i = 0; i < tiny::COMPILATION_STEP_COUNT; i++) {
+            auto allocs = allocations.getStats(tiny::CompilationStep(i));
+            stats.add(tiny::Counter::HeapAllocations, allocs.allocations);
+            stats.add(tiny::Counter::HeapBytes, allocs.bytes);
+        }
+    }
 
-        try {
-            lexemes = lexer.lexAll();
-        } catch (const tiny::LexError &e) {
-            tiny::error(e.what());
-            e.log(charStream);
-            tiny::fatal("Invalid program");
+    tiny::CompilationResult result;
+    if (keepASTs) {
+        result.files.reserve(outcomes.size());
+        for (auto &outcome: outcomes) {
+            if (outcome.ast) {
+                result.files.push_back(std::move(*outcome.ast));
+            }
+        }
+    }
+
+    return result;
+}
 
-            return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Lexer, e.what()}};
+tiny::SourceCompilationResult tiny::Compiler::compile(const std::vector<tiny::Source> &sources) const {
+    tiny::ProfileScope compileScope("compile", "compiler");
+    tiny::debug(getSignature());
+
+    std::vector<tiny::File> files;
+    files.reserve(sources.size());
+    for (auto const &source: sources) {
+        files.push_back({tiny::FileType::Source, source.name});
+    }
+
+    tiny::SourceCompilationResult result;
+    auto engine = makeDiagnosticEngine();
+    for (auto &outcome: compileFiles(files, &sources, false, engine)) {
+        if (outcome.failed) {
+            result.status = tiny::CompilationStatus::Error;
+            break;
         }
 
-        /*
-        tiny::debug("Running lex pipe with length " + std::to_string(pl.getPipeLength(tiny::CompilationStep::Lexer)));
-        lexemes = pl.runLexPipe(lexemes);
-         */
+        result.files.push_back(std::move(*outcome.ast));
+    }
 
-        tiny::Stream<tiny::Lexeme> lexemeStream(lexemes);
-        tiny::Parser parser(lexemeStream);
+    if (!engine.empty()) {
+        result.status = tiny::CompilationStatus::Error;
+        result.diagnostics = engine.finish();
+        tiny::fatal("Invalid program");
+    }
 
-        tiny::debug(f, "Parsing..");
+    return result;
+}
 
-        /*
-         * Parse stage
-         *
-         * Use the lexemes to build an AST (Parse tree) that can represent the relationship between the lexemes
-         */
+std::vector<tiny::Compiler::FileOutcome> tiny::Compiler::compileFiles(const std::vector<tiny::File> &files,
+                                                                      const std::vector<tiny::Source> *sources,
+                                                                      bool serialize,
+                                                                      tiny::DiagnosticEngine &engine) const {
+    auto &scheduler = tiny::Scheduler::get();
+    serialize = serialize && sources == nullptr;
 
-        tiny::ASTFile astFile;
-        try {
-            astFile = parser.file(f);
-        } catch (const tiny::ParseError &e) {
-            tiny::error(e.what());
-            e.log(charStream);
-            tiny::fatal("Invalid program");
+    // The tasks run on other threads, which count their allocations into the counters of this compilation
+    auto *allocations = tiny::AllocationTracker::getCounters();
 
-            return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Parser, e.what()}};
+    std::vector<FileOutcome> outcomes(files.size());
+    std::vector<tiny::TaskHandle> tasks;
 
-        } catch (const std::exception &e) {
-            tiny::error("Exception encountered while parsing");
-            tiny::error(e.what());
-            tiny::fatal("Invalid program");
+    /*
+     * File loading stage
+     *
+     * Look the files up in the cache first, then start reading every file that changed at once, so the next files
+     * load while the first ones get lexed
+     */
+
+    std::vector<std::size_t> loadIndices(files.size(), 0);
+    std::vector<std::filesystem::path> toLoad;
+
+    if (sources == nullptr) {
+        for (std::size_t i = 0; i < files.size(); i++) {
+            if (cache != nullptr) {
+                if (auto ast = cache->find(files[i])) {
+                    tiny::debug(files[i], "Unchanged, reusing the cached AST");
+                    outcomes[i].ast = std::move(*ast);
+                    outcomes[i].cached = true;
+                    continue;
+                }
+            }
+
+            loadIndices[i] = toLoad.size();
+            toLoad.push_back(files[i].path);
+        }
+    }
+
+    std::optional<tiny::FileLoader> loader;
+    if (!toLoad.empty()) {
+        loader.emplace(toLoad);
+    }
+
+    for (std::size_t i = 0; i < files.size(); i++) {
+        auto const &f = files[i];
+        auto &outcome = outcomes[i];
 
-            return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Parser, e.what()}};
+        if (outcome.cached) {
+            continue;
         }
 
+        auto parse = scheduler.submit([this, &f, &outcome, &loader, &loadIndices, &engine, sources, allocations, i]() {
+            tiny::ProfileScope fileScope(f.path.native(), "file");
+            tiny::AllocationScope allocationScope(allocations);
+            tiny::debug(f, "Running compiler..");
+
+            std::string_view content;
+            if (sources != nullptr) {
+                content = (*sources)[i].content;
+            } else {
+                try {
+                    content = loader->wait(loadIndices[i]);
+                } catch (const tiny::FileError &e) {
+                    engine.report(tiny::Diagnostic::fromMessage(tiny::CompilationStep::FileSelection, e.what(),
+                                                                f.getRelativePath().string()));
+                    outcome.failed = true;
+                    return;
+                }
+            }
+
+            tiny::Stream<std::uint32_t> charStream(tiny::String(content).data());
+
+            auto &stats = tiny::Statistics::get();
+            if (stats.isEnabled()) {
+                stats.add(tiny::Counter::FilesCompiled);
+                stats.add(tiny::Counter::BytesRead, content.size());
+                stats.add(tiny::Counter::CodepointsDecoded, charStream.length());
+            }
+
+            tiny::ASTFile ast;
+            outcome.failed = !parseFile(f, content, charStream, ast, engine);
+            if (!outcome.failed) {
+                stats.addAST(ast);
+                outcome.ast = std::move(ast);
+            }
+        });
+
+        tasks.push_back(parse);
+
         /*
-        tiny::debug("Running parse pipe with length " + std::to_string(pl.getPipeLength(tiny::CompilationStep::Parser)));
-        astFile = pl.runParsePipe(astFile);
+         * Serialization and symbol table steps
+         *
+         * Both only read the AST, so they run as separate tasks once the file is parsed
          */
 
-        if (tiny::getSetting(tiny::Option::OutputASTJSON).isEnabled) {
-            astFile.dumpJson(f.path.filename().string() + ".ast.json");
+        if (serialize) {
+            tasks.push_back(scheduler.submit([&f, &outcome, allocations]() {
+                if (!outcome.ast || outcome.cached) {
+                    return;
+                }
+
+                tiny::ProfileScope dumpScope("Dump AST JSON", "step");
+                tiny::AllocationScope allocationScope(allocations);
+                tiny::PhaseScope phaseScope(tiny::CompilationStep::Serialization);
+
+                // Next to the source, so projects compiled at once don't write over each other's dumps
+                outcome.ast->dumpJson(f.path.string() + ".ast.json");
+            }, {parse}));
         }
 
-        astFiles.push_back(astFile);
+        tasks.push_back(scheduler.submit([this, &f, &outcome, sources, allocations]() {
+            if (!outcome.ast || outcome.cached) {
+                return;
+            }
+
+            tiny::AllocationScope allocationScope(allocations);
+            tiny::debug(f, "Building symbol table..");
 
-        tiny::debug(f, "Building symbol table..");
+            {
+                tiny::ProfileScope stepScope(tiny::toString(tiny::CompilationStep::SymbolTable), "step");
+                tiny::PhaseScope phaseScope(tiny::CompilationStep::SymbolTable);
 
-        tiny::SymbolTable symtab(astFile);
-        symtab.build();
+                tiny::SymbolTable symtab(*outcome.ast);
+                symtab.build();
+            }
+
+            if (cache != nullptr && sources == nullptr) {
+                cache->store(f, *outcome.ast);
+            }
+        }, {parse}));
     }
 
-    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-    std::string runtime(std::to_string(std::chrono::duration_cast<std::chrono::seconds>(end - begin).count()));
-    tiny::info("Done (" + runtime + "s)");
+    scheduler.wait(tasks);
+    return outcomes;
+}
+
+bool tiny::Compiler::parseFile(const tiny::File &f, std::string_view content, tiny::Stream<std::uint32_t> &charStream,
+                               tiny::ASTFile &astFile, tiny::DiagnosticEngine &engine) const {
+    tiny::Lexer lexer(charStream);
+    lexer.setMetadataFile(f);
+    std::vector<tiny::Lexeme> lexemes;
+
+    tiny::debug(f, "Lexing..");
+
+    /*
+     * Lexing stage
+     *
+     * Separate every file in lexemes that can be used to build the parse tree
+     */
+
+    {
+        tiny::ProfileScope stepScope(tiny::toString(tiny::CompilationStep::Lexer), "step");
+        tiny::PhaseScope phaseScope(tiny::CompilationStep::Lexer);
+
+        try {
+            lexemes = lexer.lexAll();
+        } catch (const tiny::LexError &e) {
+            engine.report(tiny::CompilationStep::Lexer, e, content);
+            return false;
+        }
+
+        tiny::debug(f, "Running lex pipe with length " +
+                       std::to_string(pl.getPipeLength(tiny::CompilationStep::Lexer)));
+        try {
+            pl.runLexPipe(lexemes);
+        } catch (const tiny::PipelineError &e) {
+            engine.report(tiny::Diagnostic::fromMessage(tiny::CompilationStep::Lexer, e.what(),
+                                                        f.getRelativePath().string()));
+            return false;
+        }
+    }
+
+    tiny::Stream<tiny::Lexeme> lexemeStream(std::move(lexemes));
+    tiny::Parser parser(lexemeStream);
+
+    tiny::debug(f, "Parsing..");
+
+    /*
+     * Parse stage
+     *
+     * Use the lexemes to build an AST (Parse tree) that can represent the relationship between the lexemes
+     */
+
+    {
+        tiny::ProfileScope stepScope(tiny::toString(tiny::CompilationStep::Parser), "step");
+        tiny::PhaseScope phaseScope(tiny::CompilationStep::Parser);
+
+        try {
+            astFile = parser.file(f);
+        } catch (const tiny::ParseError &e) {
+            engine.report(tiny::CompilationStep::Parser, e, content);
+            return false;
+        } catch (const std::exception &e) {
+            engine.report(tiny::Diagnostic::fromMessage(tiny::CompilationStep::Parser,
+                                                        std::string("Exception encountered while parsing: ") + e.what(),
+                                                        f.getRelativePath().string()));
+            return false;
+        }
+
+        tiny::debug(f, "Running parse pipe with length " +
+                       std::to_string(pl.getPipeLength(tiny::CompilationStep::Parser)));
+        try {
+            pl.runParsePipe(astFile);
+        } catch (const tiny::PipelineError &e) {
+            engine.report(tiny::Diagnostic::fromMessage(tiny::CompilationStep::Parser, e.what(),
+                                                        f.getRelativePath().string()));
+            return false;
+        }
+    }
 
-    return {tiny::CompilationStatus::Ok};
+    return true;
 }
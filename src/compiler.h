@@ -1,10 +1,15 @@
 #ifndef TINY_COMPILER_H
 #define TINY_COMPILER_H
 
+#include <optional>
+
 #include "logger.h"
 #include "pipeline.h"
 #include "parser.h"
 #include "file.h"
+#include "diagnostics.h"
+#include "cache.h"
+#include "project.h"
 
 const std::string TINY_NAME("Tiny Compiler");
 const std::string TINY_VERSION("v0.1");
@@ -36,6 +41,37 @@ namespace tiny {
 
         //! If an error was encountered, a description of the error
         tiny::CompilationErrorDetail error{};
+
+        //! The problems found while compiling, with their location when known
+        std::vector<tiny::Diagnostic> diagnostics{};
+
+        //! The ASTs of the compiled files, in the order they were selected. Only kept if asked with setKeepASTs()
+        std::vector<tiny::ASTFile> files{};
+
+        /*!
+         * \brief Builds the result of a compilation that failed with a single problem
+         * \param diagnostic The problem
+         * \return A result with status Error, whose error detail and only diagnostic describe the problem
+         */
+        static tiny::CompilationResult fromDiagnostic(tiny::Diagnostic diagnostic);
+    };
+
+    //! A source file held in memory. It gets compiled without ever touching the filesystem
+    struct Source {
+        //! Name of the source, used in place of a path in the AST and the diagnostics
+        std::string name;
+        //! UTF-8 encoded source code
+        std::string content;
+    };
+
+    //! The result of compiling in-memory sources
+    struct SourceCompilationResult {
+        //! Status of the compilation
+        tiny::CompilationStatus status = tiny::CompilationStatus::Ok;
+        //! The ASTs of the sources compiled so far, in the same order as the sources
+        std::vector<tiny::ASTFile> files;
+        //! The problems found while compiling. Non-empty if the status is Error
+        std::vector<tiny::Diagnostic> diagnostics;
     };
 
     // TODO Compilation settings
@@ -45,9 +81,15 @@ namespace tiny {
      */
     class Compiler {
     public:
-        //! Default builder, no parameters
+        //! Default builder, no parameters. Compiles the project in the current working directory
         explicit Compiler() = default;
 
+        /*!
+         * \brief Builds a compiler for the project in the provided directory
+         * \param root The directory of the project
+         */
+        explicit Compiler(const std::filesystem::path &root) : fileSelector(root) {};
+
         /*!
          * \brief Gets a brief signature of the compiler instance, including name and version data
          * \return A string containing the signature
@@ -67,11 +109,99 @@ namespace tiny {
          */
         tiny::CompilationResult compile() const;
 
+        /*!
+         * \brief Compiles a set of in-memory sources
+         * \param sources The sources to compile
+         * \return The ASTs of the sources plus the diagnostics reported while compiling them
+         *
+         * Runs the same steps and pipeline as compile(), but reads the code from the provided buffers instead of
+         * selecting and opening files, and doesn't write anything to disk. Every source is compiled and its errors are
+         * reported, but the result only holds the ASTs of the sources before the first one with errors.
+         */
+        tiny::SourceCompilationResult compile(const std::vector<tiny::Source> &sources) const;
+
+        /*!
+         * \brief Gets the compilation Pipeline, so stages can be added to it
+         * \return A reference to the compiler's Pipeline
+         */
+        tiny::Pipeline &getPipeline();
+
+        /*!
+         * \brief Sets a cache for the ASTs of the compiled files
+         * \param c The cache. Must outlive the compiler. Null disables caching
+         *
+         * When a cache is set, compile() reuses the cached AST of every file that hasn't changed since it was last
+         * compiled, skipping its lexing, parsing and symbol table steps, and stores the AST of every file it compiles.
+         */
+        void setCache(tiny::ASTCache *c);
+
+        /*!
+         * \brief Sets the project settings to compile with, instead of reading them from the tiny.toml on every compile
+         * \param settings The settings, already read from the tiny.toml of the project. Nullopt reads the file again
+         *
+         * Saves reading the tiny.toml twice when the caller already read it, like main does to apply its settings. The
+         * file must still exist, since it marks the root of the project.
+         */
+        void setProject(std::optional<tiny::ProjectSettings> settings);
+
+        /*!
+         * \brief Sets whether compile() returns the ASTs of the files it compiled
+         * \param keep True to move the ASTs into the result when the compilation succeeds
+         */
+        void setKeepASTs(bool keep);
+
     private:
+        //! What became of a file after compiling it
+        struct FileOutcome {
+            //! The AST of the file, if it could be parsed
+            std::optional<tiny::ASTFile> ast;
+            //! Whether the AST came from the cache
+            bool cached = false;
+            //! Whether the file had errors. They are reported to the DiagnosticEngine of the compilation
+            bool failed = false;
+        };
+
+        /*!
+         * \brief Compiles a set of files as tasks in the Scheduler, and waits for all of them
+         * \param files The files
+         * \param sources The in-memory code of every file, in the same order. If null, the files are read from disk
+         * \param serialize Whether to dump the AST of every file read from disk as JSON
+         * \param engine Where the errors of the files get reported
+         * \return The outcome of every file, in the same order as the files
+         *
+         * Every file gets a parse task (lexer and parser steps) and, depending on it, a symbol table task and a
+         * serialization task. Files read from disk can be reused from and stored in the cache, and only those get
+         * serialized. The ones not in the cache are all loaded ahead by a FileLoader, while the parse tasks run.
+         */
+        std::vector<FileOutcome> compileFiles(const std::vector<tiny::File> &files,
+                                              const std::vector<tiny::Source> *sources, bool serialize,
+                                              tiny::DiagnosticEngine &engine) const;
+
+        /*!
+         * \brief Runs the lexer and parser steps (and their pipes) over a single file
+         * \param f The file being compiled
+         * \param content The UTF-8 code of the file
+         * \param charStream The decoded code of the file
+         * \param astFile Where the AST of the file gets stored
+         * \param engine Where the errors get reported
+         * \return Whether the file could be parsed
+         */
+        bool parseFile(const tiny::File &f, std::string_view content, tiny::Stream<std::uint32_t> &charStream,
+                       tiny::ASTFile &astFile, tiny::DiagnosticEngine &engine) const;
+
+        //! Builds the Pipeline of a new compiler, with the built-in stages
+        static tiny::Pipeline makePipeline();
+
         //! The compilation Pipeline to support scripting
-        tiny::Pipeline pl = tiny::Pipeline();
+        tiny::Pipeline pl = makePipeline();
         //! The file selector to choose which files should be targeted by the compiler
         tiny::FileSelector fileSelector{};
+        //! Where the ASTs are cached between compilations. Null if caching is disabled
+        tiny::ASTCache *cache = nullptr;
+        //! The settings of the project, if already read. Otherwise compile() reads them from the tiny.toml
+        std::optional<tiny::ProjectSettings> projectSettings;
+        //! Whether compile() returns the ASTs of the files
+        bool keepASTs = false;
     };
 }
 
@@ -1,30 +1,108 @@
 #include "config.h"
+
+#include <algorithm>
+#include <stdexcept>
+
 #include "stream.h"
 #include "comparator.h"
 #include "logger.h"
 #include "errors.h"
 
-tiny::Setting tiny::Configuration::getSetting(tiny::Option opt)
-{
-    for (auto const &s: settings) {
-        if (s.option == opt) {
-            return s;
+namespace {
+    // Converts the state of a Setting into the typed value of its option
+
+    void assign(std::monostate &, const tiny::Setting &) {}
+
+    void assign(bool &out, const tiny::Setting &s) {
+        out = s.isEnabled;
+    }
+
+    void assign(tiny::LogLevel &out, const tiny::Setting &s) {
+        out = tiny::LogLevel(std::get<std::int32_t>(s.param));
+    }
+
+    void assign(std::int32_t &out, const tiny::Setting &s) {
+        out = s.isEnabled ? std::get<std::int32_t>(s.param) : 0;
+    }
+
+    void assign(std::optional<std::int32_t> &out, const tiny::Setting &s) {
+        out = s.isEnabled ? std::optional(std::get<std::int32_t>(s.param)) : std::nullopt;
+    }
+
+    void assign(std::optional<std::string> &out, const tiny::Setting &s) {
+        out = s.isEnabled ? std::optional(std::get<tiny::String>(s.param).toString()) : std::nullopt;
+    }
+
+    void assign(std::vector<std::string> &out, const tiny::Setting &s) {
+        out.clear();
+        for (auto const &str: std::get<std::vector<tiny::String>>(s.param)) {
+            out.push_back(str.toString());
+        }
+    }
+
+    //! Parses a whole argument as an integer. Returns nullopt if it isn't one
+    std::optional<std::int32_t> toInteger(const std::string &str) {
+        try {
+            std::size_t end = 0;
+            auto value = std::stoi(str, &end);
+            if (end == str.size()) {
+                return value;
+            }
+        } catch (const std::exception &) {}
+
+        return std::nullopt;
+    }
+
+    //! Takes the argument of a setting, which must be a non-negative integer. Throws CLIError otherwise
+    std::int32_t toCount(tiny::Stream<tiny::String> &s, const std::string &setting) {
+        if (!s) {
+            throw tiny::CLIError("Missing the value for the '" + setting + "' setting");
+        }
+
+        auto str = s.get().toString();
+        auto value = toInteger(str);
+        if (!value || *value < 0) {
+            throw tiny::CLIError("Invalid argument ('" + str + "') for the '" + setting + "' setting");
         }
+
+        return *value;
     }
 
-    return {}; // Should be unreachable
+    //! Updates the typed value of the option of a setting
+    template<std::size_t... I>
+    void assignValue(tiny::Configuration::Values &values, const tiny::Setting &s, std::index_sequence<I...>) {
+        ((std::size_t(s.option) == I ? assign(std::get<I>(values), s) : void()), ...);
+    }
+}
+
+tiny::Configuration::Configuration() {
+    for (auto const &s: settings) {
+        assignValue(values, s, std::make_index_sequence<OPTION_COUNT>());
+    }
+}
+
+const tiny::Setting &tiny::Configuration::getSetting(tiny::Option opt) const
+{
+    return settings[std::size_t(opt)];
 }
 
 void tiny::Configuration::setSetting(const tiny::Setting &stng)
 {
-    for (auto &setting : settings) {
-        if (setting.option == stng.option) {
-            setting = stng;
-            return;
-        }
+    if (frozen) {
+        throw std::logic_error("The settings can't change once frozen");
     }
+
+    settings[std::size_t(stng.option)] = stng;
+    assignValue(values, stng, std::make_index_sequence<OPTION_COUNT>());
 }
 
+void tiny::Configuration::freeze() {
+    frozen = true;
+}
+
+bool tiny::Configuration::isFrozen() const {
+    return frozen;
+}
 
 void tiny::Configuration::parseArguments(int argc, char *argv[])
 {
@@ -36,45 +114,261 @@ void tiny::Configuration::parseArguments(int argc, char *argv[])
     vec.reserve(argc-1);
 
     for (std::int32_t i = 1; i < argc; i++) {
-        vec.emplace_back(argv[i]);
+        std::string_view arg(argv[i]);
+
+        // Accept both '--option value' and '--option=value'
+        if (auto eq = arg.find('='); arg.substr(0, 2) == "--" && eq != std::string_view::npos) {
+            vec.emplace_back(arg.substr(0, eq));
+            vec.emplace_back(arg.substr(eq + 1));
+            continue;
+        }
+
+        vec.emplace_back(arg);
     }
 
     tiny::Stream<tiny::String> s(vec);
     tiny::StreamComparator comparator(s);
     while (s) {
-        switch(comparator.match(CMD_TABLE)) {
-        case Option::Invalid:
+        auto option = comparator.match(CMD_TABLE);
+        commandLine.push_back(option);
+
+        switch(option) {
+        case Option::Invalid: {
+            // Settings can go anywhere after 'run', so anything else after it is still the function or its arguments
+            auto const &run = getSetting(Option::Run);
+            if (run.isEnabled && s.peek().toString().rfind("--", 0) != 0) {
+                auto call = std::get<std::vector<tiny::String>>(run.param);
+                call.push_back(s.get());
+                setSetting(tiny::Setting{Option::Run, true, call});
+                break;
+            }
+
             throw tiny::CLIError("Invalid setting '" + s.peek().toString() + "'");
+        }
         case Option::PrintVersion: {
             setSetting(tiny::Setting{Option::PrintVersion, true});
             return; // Since this is an operating mode whe can return immediately because no other configs matter
         }
         case Option::Log: {
             auto levelStr = s.get();
-            static std::map<tiny::String, std::int32_t> levelTable {
-                    {"debug", std::int32_t(tiny::LogLevel::Debug)},
-                    {"info", std::int32_t(tiny::LogLevel::Info)},
-                    {"warn", std::int32_t(tiny::LogLevel::Warning)},
-                    {"warning", std::int32_t(tiny::LogLevel::Warning)},
-                    {"warnings", std::int32_t(tiny::LogLevel::Warning)},
-                    {"error", std::int32_t(tiny::LogLevel::Error)},
-                    {"errors", std::int32_t(tiny::LogLevel::Error)},
-                    {"fatal", std::int32_t(tiny::LogLevel::Fatal)},
-                    {"disable", std::int32_t(tiny::LogLevel::Disable)},
-                    {"disabled", std::int32_t(tiny::LogLevel::Disable)},
-            };
-
-            if (levelTable.count(levelStr) < 1) {
+            auto level = tiny::toLogLevel(levelStr.toString());
+            if (!level) {
                 throw tiny::CLIError("Invalid argument ('" + levelStr.toString() + "') for the '--log' setting");
             }
 
-            setSetting(tiny::Setting{Option::Log, true, levelTable[levelStr]});
+            setSetting(tiny::Setting{Option::Log, true, std::int32_t(*level)});
             break;
         }
 
         case Option::OutputASTJSON:
             setSetting(tiny::Setting{Option::OutputASTJSON, true});
             break;
+
+        case Option::Profile:
+            setSetting(tiny::Setting{Option::Profile, true});
+            break;
+
+        case Option::TraceOut: {
+            if (!s) {
+                throw tiny::CLIError("Missing the output file for the '--trace-out' setting");
+            }
+
+            setSetting(tiny::Setting{Option::TraceOut, true, s.get()});
+            break;
+        }
+
+        case Option::Stats:
+            setSetting(tiny::Setting{Option::Stats, true});
+            break;
+
+        case Option::Serve:
+            setSetting(tiny::Setting{Option::Serve, true});
+            break;
+
+        case Option::Build:
+            setSetting(tiny::Setting{Option::Build, true});
+            break;
+
+        case Option::Socket: {
+            if (!s) {
+                throw tiny::CLIError("Missing the socket path for the '--socket' setting");
+            }
+
+            setSetting(tiny::Setting{Option::Socket, true, s.get()});
+            break;
+        }
+
+        case Option::Server: {
+            if (!s) {
+                throw tiny::CLIError("Missing the socket path for the '--server' setting");
+            }
+
+            setSetting(tiny::Setting{Option::Server, true, s.get()});
+            break;
+        }
+
+        case Option::Watch:
+            setSetting(tiny::Setting{Option::Watch, true});
+            break;
+
+        case Option::Jobs: {
+            if (!s) {
+                throw tiny::CLIError("Missing the number of jobs for the '--jobs' setting");
+            }
+
+            auto jobsStr = s.get().toString();
+            auto jobs = toInteger(jobsStr);
+            if (!jobs || *jobs < 1) {
+                throw tiny::CLIError("Invalid argument ('" + jobsStr + "') for the '--jobs' setting");
+            }
+
+            setSetting(tiny::Setting{Option::Jobs, true, *jobs});
+            break;
+        }
+
+        case Option::BuildMany: {
+            // Every argument up to the next option is a project directory
+            std::vector<tiny::String> roots;
+            while (s && s.peek().toString().rfind('-', 0) != 0) {
+                roots.push_back(s.get());
+            }
+
+            setSetting(tiny::Setting{Option::BuildMany, true, roots});
+            break;
+        }
+
+        case Option::Manifest: {
+            if (!s) {
+                throw tiny::CLIError("Missing the manifest file for the '--manifest' setting");
+            }
+
+            setSetting(tiny::Setting{Option::Manifest, true, s.get()});
+            break;
+        }
+
+        case Option::DiagnosticsFd: {
+            if (!s) {
+                throw tiny::CLIError("Missing the file descriptor for the '--diagnostics-fd' setting");
+            }
+
+            auto fdStr = s.get().toString();
+            auto fd = toInteger(fdStr);
+            if (!fd || *fd < 0) {
+                throw tiny::CLIError("Invalid argument ('" + fdStr + "') for the '--diagnostics-fd' setting");
+            }
+
+            setSetting(tiny::Setting{Option::DiagnosticsFd, true, *fd});
+            break;
         }
+
+        case Option::Corpus: {
+            if (!s) {
+                throw tiny::CLIError("Missing the output directory for the 'corpus' mode");
+            }
+
+            setSetting(tiny::Setting{Option::Corpus, true, s.get()});
+            break;
+        }
+
+        case Option::CorpusFiles:
+            setSetting(tiny::Setting{Option::CorpusFiles, true, toCount(s, "--files")});
+            break;
+
+        case Option::CorpusFileSize:
+            setSetting(tiny::Setting{Option::CorpusFileSize, true, toCount(s, "--file-size")});
+            break;
+
+        case Option::CorpusDepth:
+            setSetting(tiny::Setting{Option::CorpusDepth, true, toCount(s, "--depth")});
+            break;
+
+        case Option::CorpusSeed:
+            setSetting(tiny::Setting{Option::CorpusSeed, true, toCount(s, "--seed")});
+            break;
+
+        case Option::Run: {
+            // The function to run, then its arguments, up to the next option. The rest may follow the options
+            std::vector<tiny::String> call;
+            while (s && s.peek().toString().rfind("--", 0) != 0) {
+                call.push_back(s.get());
+            }
+
+            setSetting(tiny::Setting{Option::Run, true, call});
+            break;
+        }
+
+        case Option::Tier: {
+            if (!s) {
+                throw tiny::CLIError("Missing the execution tier for the '--tier' setting");
+            }
+
+            auto tier = s.get();
+            if (tier != "bytecode" && tier != "closure") {
+                throw tiny::CLIError("Invalid argument ('" + tier.toString() + "') for the '--tier' setting");
+            }
+
+            setSetting(tiny::Setting{Option::Tier, true, tier});
+            break;
+        }
+
+        case Option::EmitIR:
+            setSetting(tiny::Setting{Option::EmitIR, true});
+            break;
+
+        case Option::EmitC: {
+            if (!s) {
+                throw tiny::CLIError("Missing the output file for the '--emit-c' setting");
+            }
+
+            setSetting(tiny::Setting{Option::EmitC, true, s.get()});
+            break;
+        }
+
+        case Option::Native: {
+            if (!s) {
+                throw tiny::CLIError("Missing the executable for the '--native' setting");
+            }
+
+            setSetting(tiny::Setting{Option::Native, true, s.get()});
+            break;
+        }
+
+        case Option::MaxErrors: {
+            if (!s) {
+                throw tiny::CLIError("Missing the number of diagnostics for the '--max-errors' setting");
+            }
+
+            auto maxStr = s.get().toString();
+            auto max = toInteger(maxStr);
+            if (!max || *max < 0) {
+                throw tiny::CLIError("Invalid argument ('" + maxStr + "') for the '--max-errors' setting");
+            }
+
+            setSetting(tiny::Setting{Option::MaxErrors, true, *max});
+            break;
+        }
+        }
+    }
+}
+
+void tiny::Configuration::applyProject(const tiny::ProjectSettings &project) {
+    if (project.jobs && !isSetByCommandLine(Option::Jobs)) {
+        setSetting(tiny::Setting{Option::Jobs, true, *project.jobs});
+    }
+
+    if (project.log && !isSetByCommandLine(Option::Log)) {
+        setSetting(tiny::Setting{Option::Log, true, std::int32_t(*project.log)});
+    }
+
+    if (project.maxErrors && !isSetByCommandLine(Option::MaxErrors)) {
+        setSetting(tiny::Setting{Option::MaxErrors, true, *project.maxErrors});
     }
+
+    if (project.outputASTJSON && !isSetByCommandLine(Option::OutputASTJSON)) {
+        setSetting(tiny::Setting{Option::OutputASTJSON, true});
+    }
+}
+
+bool tiny::Configuration::isSetByCommandLine(tiny::Option opt) const {
+    return std::find(commandLine.begin(), commandLine.end(), opt) != commandLine.end();
 }
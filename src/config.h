@@ -1,22 +1,52 @@
 #ifndef TINY_CONFIG_H
 #define TINY_CONFIG_H
 
+#include <array>
+#include <optional>
+#include <tuple>
 #include <utility>
 #include <variant>
 #include <map>
 
 #include "unicode.h"
 #include "logger.h"
+#include "project.h"
 
 namespace tiny{
-    //! The different configurable settings for the compiler
+    //! The different configurable settings for the compiler. The values index Configuration::Values
     enum class Option {
         Invalid,
         PrintVersion,
         Log,
         OutputASTJSON,
+        Profile,
+        TraceOut,
+        Stats,
+        Serve,
+        Build,
+        Socket,
+        Server,
+        Watch,
+        Jobs,
+        BuildMany,
+        Manifest,
+        DiagnosticsFd,
+        Corpus,
+        CorpusFiles,
+        CorpusFileSize,
+        CorpusDepth,
+        CorpusSeed,
+        Run,
+        Tier,
+        EmitIR,
+        EmitC,
+        Native,
+        MaxErrors, // Keep last, OPTION_COUNT depends on it
     };
 
+    //! The number of options, Invalid included
+    constexpr std::size_t OPTION_COUNT = std::size_t(tiny::Option::MaxErrors) + 1;
+
     //! Holds the current state of a setting
     struct Setting {
         //! The option this state corresponds to
@@ -26,12 +56,61 @@ namespace tiny{
         bool isEnabled = false;
 
         //! A variant containing an optional parameter for the setting
-        std::variant<tiny::String, std::int32_t> param = "";
+        std::variant<tiny::String, std::int32_t, std::vector<tiny::String>> param = "";
     };
 
-    //! A singleton that contains the current settings for the runtime
+    /*!
+     * \brief A singleton that contains the current settings for the runtime
+     *
+     * A singleton that contains the current settings for the runtime. Every setting is kept both as a Setting, for the
+     * code that handles options generically, and as a plain typed value that get<Option>() reads in constant time,
+     * without copies. Once the arguments and the project file are applied the configuration gets frozen, so it can be
+     * read from any thread without locks.
+     */
     class Configuration {
     public:
+        /*!
+         * \brief The typed value of every option, in the order of the Option enum
+         *
+         * The typed value of every option, in the order of the Option enum. Switches are a bool, options with a
+         * parameter hold it (or nothing, for the optional ones), and Jobs is 0 when not set.
+         */
+        using Values = std::tuple<
+                std::monostate,                 // Invalid
+                bool,                           // PrintVersion
+                tiny::LogLevel,                 // Log
+                bool,                           // OutputASTJSON
+                bool,                           // Profile
+                std::optional<std::string>,     // TraceOut
+                bool,                           // Stats
+                bool,                           // Serve
+                bool,                           // Build
+                std::optional<std::string>,     // Socket
+                std::optional<std::string>,     // Server
+                bool,                           // Watch
+                std::int32_t,                   // Jobs
+                std::vector<std::string>,       // BuildMany
+                std::optional<std::string>,     // Manifest
+                std::optional<std::int32_t>,    // DiagnosticsFd
+                std::optional<std::string>,     // Corpus
+                std::optional<std::int32_t>,    // CorpusFiles
+                std::optional<std::int32_t>,    // CorpusFileSize
+                std::optional<std::int32_t>,    // CorpusDepth
+                std::optional<std::int32_t>,    // CorpusSeed
+                std::vector<std::string>,       // Run
+                std::optional<std::string>,     // Tier
+                bool,                           // EmitIR
+                std::optional<std::string>,     // EmitC
+                std::optional<std::string>,     // Native
+                std::optional<std::int32_t>     // MaxErrors
+        >;
+
+        static_assert(std::tuple_size_v<Values> == OPTION_COUNT, "Every option needs a typed value");
+
+        //! The type of the value of an option
+        template<tiny::Option O>
+        using ValueType = std::tuple_element_t<std::size_t(O), Values>;
+
         Configuration(Configuration const &) = delete;       // Meyers' singleton pattern. Don't Implement
         void operator=(Configuration const &) = delete;      // Ibidem
 
@@ -42,34 +121,118 @@ namespace tiny{
         }
 
         //! Gets a setting by its option
-        tiny::Setting getSetting(tiny::Option opt);
-        //! Sets a setting by replacing the state of the setting with the matching
+        [[nodiscard]] const tiny::Setting &getSetting(tiny::Option opt) const;
+        //! Sets a setting by replacing the state of the setting with the matching. Throws std::logic_error if frozen
         void setSetting(const tiny::Setting &stng);
 
+        //! Gets the typed value of an option
+        template<tiny::Option O>
+        [[nodiscard]] const ValueType<O> &get() const {
+            return std::get<std::size_t(O)>(values);
+        }
+
+        //! Forbids any further change, so the settings can be read from any thread
+        void freeze();
+
+        //! Whether the settings were frozen
+        [[nodiscard]] bool isFrozen() const;
+
         //! Parses the command-line arguments
         void parseArguments(int argc, char *argv[]);
 
+        /*!
+         * \brief Applies the settings of a project file
+         * \param project The settings
+         *
+         * Applies the settings of a project file. Settings given on the command line are kept, since they take
+         * precedence over the ones of the file.
+         */
+        void applyProject(const tiny::ProjectSettings &project);
+
+        //! Whether an option was given on the command line
+        [[nodiscard]] bool isSetByCommandLine(tiny::Option opt) const;
+
     private:
-        //! Default constructor
-        Configuration() = default;
+        //! Builds the typed values out of the default settings
+        Configuration();
+
+        //! The options given on the command line
+        std::vector<tiny::Option> commandLine;
+
+        //! Whether the settings can't change anymore
+        bool frozen = false;
 
-        //! Current settings. Starts as the default settings
-        std::vector<tiny::Setting> settings {
+        //! The typed values of the options
+        Values values;
+
+        //! Current settings, indexed by their option. Starts as the default settings
+        std::array<tiny::Setting, OPTION_COUNT> settings {{
+                {Option::Invalid, false},
                 {Option::PrintVersion, false},
                 {Option::Log, true, std::int32_t(tiny::LogLevel::Info)},
                 {Option::OutputASTJSON, false},
-        };
+                {Option::Profile, false},
+                {Option::TraceOut, false},
+                {Option::Stats, false},
+                {Option::Serve, false},
+                {Option::Build, false},
+                {Option::Socket, false},
+                {Option::Server, false},
+                {Option::Watch, false},
+                {Option::Jobs, false, std::int32_t(0)},
+                {Option::BuildMany, false, std::vector<tiny::String>{}},
+                {Option::Manifest, false},
+                {Option::DiagnosticsFd, false, std::int32_t(-1)},
+                {Option::Corpus, false},
+                {Option::CorpusFiles, false, std::int32_t(0)},
+                {Option::CorpusFileSize, false, std::int32_t(0)},
+                {Option::CorpusDepth, false, std::int32_t(0)},
+                {Option::CorpusSeed, false, std::int32_t(0)},
+                {Option::Run, false, std::vector<tiny::String>{}},
+                {Option::Tier, false},
+                {Option::EmitIR, false},
+                {Option::EmitC, false},
+                {Option::Native, false},
+                {Option::MaxErrors, false, std::int32_t(0)},
+        }};
 
         //! Maps parameters to their respective option for use in argument parsing
         const std::map<std::vector<tiny::String>, tiny::Option> CMD_TABLE {
                 {{"version"}, Option::PrintVersion},
                 {{"--log"}, Option::Log},
                 {{"--ast-json"}, Option::OutputASTJSON},
+                {{"--profile"}, Option::Profile},
+                {{"--trace-out"}, Option::TraceOut},
+                {{"--stats"}, Option::Stats},
+                {{"serve"}, Option::Serve},
+                {{"build"}, Option::Build},
+                {{"--socket"}, Option::Socket},
+                {{"--server"}, Option::Server},
+                {{"watch"}, Option::Watch},
+                {{"--jobs"}, Option::Jobs},
+                {{"-j"}, Option::Jobs},
+                {{"build-many"}, Option::BuildMany},
+                {{"--manifest"}, Option::Manifest},
+                {{"--diagnostics-fd"}, Option::DiagnosticsFd},
+                {{"corpus"}, Option::Corpus},
+                {{"--files"}, Option::CorpusFiles},
+                {{"--file-size"}, Option::CorpusFileSize},
+                {{"--depth"}, Option::CorpusDepth},
+                {{"--seed"}, Option::CorpusSeed},
+                {{"run"}, Option::Run},
+                {{"--tier"}, Option::Tier},
+                {{"--emit-ir"}, Option::EmitIR},
+                {{"--emit-c"}, Option::EmitC},
+                {{"--native"}, Option::Native},
+                {{"--max-errors"}, Option::MaxErrors},
         };
     };
 
 #if !defined(TINY_DISABLE_COMPACT_CONFIG)
-    inline auto getSetting(tiny::Option opt) { return tiny::Configuration::get().getSetting(opt); }
+    inline const tiny::Setting &getSetting(tiny::Option opt) { return tiny::Configuration::get().getSetting(opt); }
+
+    template<tiny::Option O>
+    inline const auto &getSetting() { return tiny::Configuration::get().get<O>(); }
 #endif
 }
 
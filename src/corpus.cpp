@@ -0,0 +1,329 @@
+#include "corpus.h"
+
+#include <atomic>
+#include <fstream>
+#include <utility>
+
+#include "errors.h"
+#include "scheduler.h"
+
+namespace {
+    //! Writes the code of a single file
+    class FileWriter {
+    public:
+        FileWriter(const tiny::CorpusOptions &options, std::uint32_t index) : options(options), index(index) {
+            // Mix the index into the seed, so every file gets its own sequence
+            std::seed_seq seq{std::uint32_t(options.seed), std::uint32_t(options.seed >> 32), index};
+            rng.seed(seq);
+        }
+
+        std::string file() {
+            out.reserve(options.fileSize + 1024);
+            out += "module m" + std::to_string(index) + "\n\n";
+
+            imports();
+
+            // Keep adding declarations until the file is big enough. Every file has at least one function
+            std::uint32_t declaration = 0;
+            do {
+                auto kind = pick(10);
+                if (kind == 0) {
+                    structDeclaration(declaration);
+                } else if (kind == 1) {
+                    traitDeclaration(declaration);
+                } else {
+                    functionDeclaration(declaration);
+                }
+
+                declaration++;
+            } while (out.size() < options.fileSize);
+
+            return std::move(out);
+        }
+
+    private:
+        std::uint32_t pick(std::uint32_t n) {
+            return std::uniform_int_distribution<std::uint32_t>(0, n - 1)(rng);
+        }
+
+        bool chance(std::uint32_t percent) {
+            return pick(100) < percent;
+        }
+
+        void indent(std::uint32_t level) {
+            out.append(level * 4, ' ');
+        }
+
+        std::string type() {
+            static const char *types[] = {"int32", "int64", "uint32", "float64", "bool", "string", "char", "int"};
+            return types[pick(sizeof(types) / sizeof(types[0]))];
+        }
+
+        void imports() {
+            if (index == 0) {
+                return;
+            }
+
+            // The previous module, plus a few others from before it
+            std::vector<std::uint32_t> modules{index - 1};
+            for (std::uint32_t i = pick(4); i > 0 && index > 1; i--) {
+                modules.push_back(pick(index - 1));
+            }
+
+            out += "import (\n";
+            for (std::size_t i = 0; i < modules.size(); i++) {
+                out += "    m" + std::to_string(modules[i]);
+                if (chance(30)) {
+                    out += " as d" + std::to_string(i);
+                }
+
+                out += i + 1 < modules.size() ? ",\n" : "\n";
+            }
+
+            out += ")\n\n";
+        }
+
+        //! Name of a declaration. Tagged with the index of the module, so no two modules declare the same name
+        std::string name(char prefix, std::uint32_t n) const {
+            return prefix + std::to_string(index) + "_" + std::to_string(n);
+        }
+
+        void structDeclaration(std::uint32_t n) {
+            out += "struct " + name('S', n);
+            if (chance(30)) {
+                out += " [T" + std::to_string(pick(n + 1)) + "]";
+            }
+
+            out += " {\n";
+
+            // Compositions need a field after them, so only put them first
+            if (!structs.empty() && chance(40)) {
+                out += "    " + name('S', structs[pick(std::uint32_t(structs.size()))]) + ",\n";
+            }
+
+            structs.push_back(n);
+
+            auto fields = 1 + pick(6);
+            for (std::uint32_t i = 0; i < fields; i++) {
+                out += "    " + type() + " f" + std::to_string(i);
+                out += i + 1 < fields ? ",\n" : "\n";
+            }
+
+            out += "}\n\n";
+        }
+
+        void traitDeclaration(std::uint32_t n) {
+            out += "trait " + name('T', n) + " {\n";
+
+            // Only typed fields. The symbol table still takes method prototypes for function declarations
+            auto fields = 1 + pick(4);
+            for (std::uint32_t i = 0; i < fields; i++) {
+                out += "    " + type() + " f" + std::to_string(i);
+                out += i + 1 < fields ? ",\n" : "\n";
+            }
+
+            out += "}\n\n";
+        }
+
+        void functionDeclaration(std::uint32_t n) {
+            arguments = 1 + pick(4);
+            variables = 0;
+
+            // Declared before its body, so it can call itself
+            functions.push_back({n, arguments});
+
+            out += "func " + name('f', n) + "(";
+            for (std::uint32_t i = 0; i < arguments; i++) {
+                out += (i > 0 ? ", " : "") + std::string("int32 a") + std::to_string(i);
+            }
+
+            out += ") {\n";
+            block(1, 3 + pick(8));
+            indent(1);
+            out += "return " + operand() + "\n";
+            out += "}\n\n";
+        }
+
+        void block(std::uint32_t level, std::uint32_t statements) {
+            // Variables declared inside the block go out of scope with it
+            auto outer = variables;
+            for (std::uint32_t i = 0; i < statements; i++) {
+                statement(level);
+            }
+
+            variables = outer;
+        }
+
+        void statement(std::uint32_t level) {
+            auto nested = level <= options.depth;
+            auto kind = pick(nested ? 10 : 6);
+
+            indent(level);
+
+            if (kind < 3 || variables == 0) {
+                // Declare a new variable
+                out += "v" + std::to_string(variables++) + " := " + arithmetic() + "\n";
+            } else if (kind < 5) {
+                out += variable() + " = " + arithmetic() + "\n";
+            } else if (kind < 6) {
+                out += call() + "\n";
+            } else if (kind < 8) {
+                out += "if " + condition() + " {\n";
+                block(level + 1, 1 + pick(3));
+                indent(level);
+
+                if (chance(40)) {
+                    out += "} else {\n";
+                    block(level + 1, 1 + pick(3));
+                    indent(level);
+                }
+
+                out += "}\n";
+            } else {
+                auto counter = "i" + std::to_string(level);
+                out += "for " + counter + " := 0.." + std::to_string(1 + pick(100));
+                if (chance(20)) {
+                    out += " -> " + std::to_string(1 + pick(4));
+                }
+
+                out += " {\n";
+                block(level + 1, 1 + pick(3));
+                indent(level);
+                out += "}\n";
+            }
+        }
+
+        std::string variable() {
+            if (variables == 0 || chance(30)) {
+                return "a" + std::to_string(pick(arguments));
+            }
+
+            return "v" + std::to_string(pick(variables));
+        }
+
+        std::string call() {
+            // Any function declared so far, this one included, with as many arguments as it takes
+            auto const &[n, arity] = functions[pick(std::uint32_t(functions.size()))];
+            std::string str = name('f', n) + "(";
+            for (std::uint32_t i = 0; i < arity; i++) {
+                str += (i > 0 ? ", " : "") + operand();
+            }
+
+            return str + ")";
+        }
+
+        std::string operand() {
+            auto kind = pick(10);
+            if (kind < 4) {
+                return variable();
+            }
+
+            if (kind < 8) {
+                return std::to_string(1 + pick(999)); // Never zero, so divisions are always valid
+            }
+
+            return "(" + variable() + " + " + std::to_string(1 + pick(9)) + ")";
+        }
+
+        std::string arithmetic() {
+            static const char *operators[] = {" + ", " - ", " * ", " / "};
+
+            auto str = operand();
+            for (std::uint32_t i = pick(options.expressionLength); i > 0; i--) {
+                str += operators[pick(4)];
+                str += operand();
+            }
+
+            return str;
+        }
+
+        std::string condition() {
+            static const char *comparators[] = {" > ", " < ", " == ", " != ", " >= ", " <= "};
+            static const char *connectors[] = {" and ", " or "};
+
+            auto str = variable() + comparators[pick(6)] + operand();
+            for (std::uint32_t i = pick(3); i > 0; i--) {
+                str += connectors[pick(2)];
+                str += variable() + comparators[pick(6)] + operand();
+            }
+
+            return str;
+        }
+
+        const tiny::CorpusOptions &options;
+        std::uint32_t index;
+        std::mt19937_64 rng;
+        std::string out;
+
+        //! Arguments and variables of the current function
+        std::uint32_t arguments = 0;
+        std::uint32_t variables = 0;
+
+        //! Numbers of the structs declared so far, and numbers and arities of the functions
+        std::vector<std::uint32_t> structs;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> functions;
+    };
+}
+
+std::string tiny::CorpusGenerator::generateFile(std::uint32_t index) const {
+    return FileWriter(options, index).file();
+}
+
+std::string tiny::CorpusGenerator::getFileName(std::uint32_t index) {
+    return "m" + std::to_string(index) + ".ty";
+}
+
+std::vector<tiny::Source> tiny::CorpusGenerator::generate() const {
+    std::vector<tiny::Source> sources;
+    sources.reserve(options.files);
+
+    for (std::uint32_t i = 0; i < options.files; i++) {
+        sources.push_back({getFileName(i), generateFile(i)});
+    }
+
+    return sources;
+}
+
+std::uint64_t tiny::CorpusGenerator::write(const std::filesystem::path &root) const {
+    if (std::error_code ec; !std::filesystem::create_directories(root, ec) && ec) {
+        throw tiny::FileError("Unable to create '" + root.string() + "': " + ec.message());
+    }
+
+    if (std::ofstream meta(root / "tiny.toml"); !meta) {
+        throw tiny::FileError("Unable to write '" + (root / "tiny.toml").string() + "'");
+    }
+
+    auto &scheduler = tiny::Scheduler::get();
+    std::vector<tiny::TaskHandle> tasks;
+    std::vector<std::string> failed(options.files);
+    std::atomic<std::uint64_t> bytes{0};
+
+    for (std::uint32_t i = 0; i < options.files; i++) {
+        tasks.push_back(scheduler.submit([this, &root, &failed, &bytes, i]() {
+            auto path = root / getFileName(i);
+            auto code = generateFile(i);
+
+            std::ofstream output(path, std::ios::binary);
+            if (!output.write(code.data(), std::streamsize(code.size()))) {
+                failed[i] = path.string();
+                return;
+            }
+
+            bytes += code.size();
+        }));
+    }
+
+    scheduler.wait(tasks);
+
+    for (auto const &path: failed) {
+        if (!path.empty()) {
+            throw tiny::FileError("Unable to write '" + path + "'");
+        }
+    }
+
+    return bytes;
+}
+
+const tiny::CorpusOptions &tiny::CorpusGenerator::getOptions() const {
+    return options;
+}
@@ -0,0 +1,85 @@
+#ifndef TINY_CORPUS_H
+#define TINY_CORPUS_H
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "compiler.h"
+
+namespace tiny {
+    //! The shape of a generated corpus
+    struct CorpusOptions {
+        //! Number of source files
+        std::uint32_t files = 16;
+        //! Approximate size of every file, in bytes. Files stop growing at the first declaration past it
+        std::uint64_t fileSize = 16 * 1024;
+        //! Maximum nesting of for and if blocks inside functions
+        std::uint32_t depth = 3;
+        //! Maximum number of operands of an expression
+        std::uint32_t expressionLength = 8;
+        //! Seed of the generator. The same options always generate the same corpus
+        std::uint64_t seed = 1;
+    };
+
+    /*!
+     * \brief Generates synthetic Tiny projects to benchmark the compiler at scale
+     *
+     * Generates synthetic Tiny projects to benchmark the compiler at scale. Every file is a module that imports some of
+     * the modules before it and declares structs, traits and functions, named after the module so no two modules
+     * declare the same name. Function bodies mix initializations, long arithmetic and logical expressions, calls with
+     * as many arguments as the callee takes, and for and if blocks nested up to the configured depth.
+     *
+     * Each file only depends on the options and its index, so files can be generated in any order or in parallel, and
+     * a bigger corpus starts with the files of a smaller one.
+     */
+    class CorpusGenerator {
+    public:
+        /*!
+         * \brief Builds a generator
+         * \param options The shape of the corpus
+         */
+        explicit CorpusGenerator(tiny::CorpusOptions options) : options(options) {};
+
+        /*!
+         * \brief Generates the code of a file
+         * \param index Index of the file, from 0 to the number of files
+         * \return The UTF-8 code of the file
+         */
+        [[nodiscard]] std::string generateFile(std::uint32_t index) const;
+
+        /*!
+         * \brief Gets the name of a file
+         * \param index Index of the file
+         * \return The name, relative to the root of the project
+         */
+        [[nodiscard]] static std::string getFileName(std::uint32_t index);
+
+        /*!
+         * \brief Generates every file of the corpus in memory
+         * \return The sources, ready for Compiler::compile()
+         */
+        [[nodiscard]] std::vector<tiny::Source> generate() const;
+
+        /*!
+         * \brief Writes the corpus as a project: a tiny.toml plus the sources
+         * \param root Directory of the project. Gets created if missing
+         * \return The number of bytes of source written
+         *
+         * Writes the corpus as a project. The files are generated and written in parallel by the Scheduler, and only
+         * a few of them are held in memory at once, so corpora of any size fit. Throws FileError if a file can't be
+         * written.
+         */
+        std::uint64_t write(const std::filesystem::path &root) const;
+
+        //! Gets the options of the generator
+        [[nodiscard]] const tiny::CorpusOptions &getOptions() const;
+
+    private:
+        tiny::CorpusOptions options;
+    };
+}
+
+#endif //TINY_CORPUS_H
@@ -0,0 +1,208 @@
+#include "diagnostics.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "logger.h"
+
+std::string tiny::Diagnostic::toString() const {
+    std::string out;
+
+    if (!file.empty()) {
+        out += file + ":";
+        if (line != 0) {
+            out += std::to_string(line) + ":" + std::to_string(column) + ":";
+        }
+
+        out += " ";
+    }
+
+    return out + msg;
+}
+
+nlohmann::json tiny::Diagnostic::toJson() const {
+    return nlohmann::json{
+            {"step", std::int32_t(step)},
+            {"file", file},
+            {"line", line},
+            {"column", column},
+            {"msg", msg},
+            {"context", context},
+            {"severity", std::int32_t(severity)},
+            {"id", std::int32_t(id)},
+            {"args", args},
+            {"begin", begin},
+            {"end", end},
+    };
+}
+
+tiny::Diagnostic tiny::Diagnostic::fromJson(const nlohmann::json &json) {
+    return {
+            tiny::CompilationStep(json.value("step", 0)),
+            json.value("file", ""),
+            json.value("line", std::uint64_t(0)),
+            json.value("column", std::uint64_t(0)),
+            json.value("msg", ""),
+            json.value("context", ""),
+            tiny::Severity(json.value("severity", 0)),
+            tiny::DiagnosticId(json.value("id", 0)),
+            json.value("args", std::vector<std::string>{}),
+            json.value("begin", std::uint64_t(0)),
+            json.value("end", std::uint64_t(0)),
+    };
+}
+
+tiny::Diagnostic tiny::Diagnostic::fromMessage(tiny::CompilationStep step, std::string msg, std::string file) {
+    tiny::Diagnostic diagnostic;
+    diagnostic.step = step;
+    diagnostic.file = std::move(file);
+    diagnostic.msg = std::move(msg);
+
+    return diagnostic;
+}
+
+tiny::DiagnosticEngine::DiagnosticEngine(std::size_t maxErrors, std::size_t maxPerFile) : maxErrors(maxErrors),
+                                                                                         maxPerFile(maxPerFile) {}
+
+void tiny::DiagnosticEngine::report(tiny::CompilationStep step, const tiny::CompilerError &e,
+                                    std::string_view source) {
+    Record record;
+    record.diagnostic.step = step;
+    record.diagnostic.file = e.meta.file.getRelativePath().string();
+    record.diagnostic.id = e.id;
+    record.diagnostic.args = e.args;
+    record.start = e.meta.start;
+    record.end = e.meta.end;
+
+    auto key = record.diagnostic.file + '\0' + std::to_string(record.start) + ':' + std::to_string(record.end) + ':' +
+               std::to_string(std::int32_t(e.id));
+
+    std::lock_guard lock(mutex);
+
+    // Every error of a file shares a single copy of its code
+    auto &shared = sources[record.diagnostic.file];
+    if (!shared) {
+        shared = std::make_shared<const std::string>(source);
+    }
+
+    record.source = shared;
+    add(std::move(record), std::move(key));
+}
+
+void tiny::DiagnosticEngine::report(tiny::Diagnostic diagnostic) {
+    auto key = diagnostic.file + '\0' + std::to_string(diagnostic.line) + ':' + std::to_string(diagnostic.column) +
+               ':' + diagnostic.msg;
+
+    Record record;
+    record.diagnostic = std::move(diagnostic);
+
+    std::lock_guard lock(mutex);
+    add(std::move(record), std::move(key));
+}
+
+void tiny::DiagnosticEngine::add(Record record, std::string key) {
+    if (!seen.insert(std::move(key)).second) {
+        duplicates++;
+        return;
+    }
+
+    if (auto &count = perFile[record.diagnostic.file]; maxErrors != 0 && count >= maxPerFile) {
+        capped++;
+        return;
+    } else {
+        count++;
+    }
+
+    records.push_back(std::move(record));
+}
+
+std::vector<tiny::Diagnostic> tiny::DiagnosticEngine::finish(bool log) {
+    std::lock_guard lock(mutex);
+
+    // Reports arrive in whatever order the files finish, so sort them to always show the same ones
+    std::stable_sort(records.begin(), records.end(), [](const Record &a, const Record &b) {
+        return std::tie(a.diagnostic.file, a.start, a.diagnostic.line) <
+               std::tie(b.diagnostic.file, b.start, b.diagnostic.line);
+    });
+
+    if (maxErrors != 0 && records.size() > maxErrors) {
+        capped += records.size() - maxErrors;
+        records.resize(maxErrors);
+    }
+
+    std::vector<tiny::Diagnostic> result;
+    result.reserve(records.size());
+
+    // Decoding each file once is enough, since its records are next to each other
+    std::shared_ptr<const std::string> decoded;
+    tiny::Stream<std::uint32_t> charStream;
+
+    for (auto &record: records) {
+        auto &d = record.diagnostic;
+
+        if (!record.source) {
+            if (log) {
+                tiny::error(d.toString());
+            }
+
+            result.push_back(std::move(d));
+            continue;
+        }
+
+        if (decoded != record.source) {
+            decoded = record.source;
+            charStream = tiny::Stream<std::uint32_t>(tiny::String(*decoded).data());
+        }
+
+        tiny::Metadata meta(tiny::File{}, record.start, record.end);
+
+        charStream.seek(0);
+        std::tie(d.line, d.column) = meta.getPosition(charStream);
+        auto [context, pos] = meta.getContext(charStream);
+        std::tie(d.begin, d.end) = meta.getByteRange(charStream);
+        d.context = context;
+        d.msg = tiny::renderMessage(d.id, d.args);
+
+        if (log) {
+            tiny::error(d.msg);
+            tiny::error("In file \"" + d.file + "\" in line " + std::to_string(d.line) + ", column " +
+                        std::to_string(d.column) + ": ");
+            tiny::error("\t" + context);
+            tiny::error("\t" + std::string((std::max)(pos - 2, 0), ' ') + std::string(3, '^'));
+        }
+
+        result.push_back(std::move(d));
+    }
+
+    if (log && capped != 0) {
+        tiny::error(std::to_string(capped) + " more diagnostic" + (capped == 1 ? "" : "s") +
+                    " not shown (see '--max-errors')");
+    }
+
+    if (log && duplicates != 0) {
+        tiny::error(std::to_string(duplicates) + " duplicate diagnostic" + (duplicates == 1 ? "" : "s") + " not shown");
+    }
+
+    records.clear();
+    return result;
+}
+
+bool tiny::DiagnosticEngine::empty() const {
+    std::lock_guard lock(mutex);
+    return seen.empty();
+}
+
+std::size_t tiny::DiagnosticEngine::getCount() const {
+    std::lock_guard lock(mutex);
+    return seen.size();
+}
+
+std::size_t tiny::DiagnosticEngine::getSuppressed() const {
+    std::lock_guard lock(mutex);
+    return duplicates + capped;
+}
+
+std::size_t tiny::DiagnosticEngine::getDuplicates() const {
+    std::lock_guard lock(mutex);
+    return duplicates;
+}
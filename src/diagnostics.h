@@ -0,0 +1,168 @@
+#ifndef TINY_DIAGNOSTICS_H
+#define TINY_DIAGNOSTICS_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "pipeline.h"
+#include "messages.h"
+#include "errors.h"
+
+namespace tiny {
+    //! A problem found while compiling, together with where it was found
+    struct Diagnostic {
+        //! The step which reported the problem
+        tiny::CompilationStep step = tiny::CompilationStep::None;
+        //! Name of the file in which the problem was found. Empty if it isn't tied to a file
+        std::string file;
+        //! Line of the problem, starting at 1. Zero if unknown
+        std::uint64_t line = 0;
+        //! Column of the problem, starting at 1. Zero if unknown
+        std::uint64_t column = 0;
+        //! A message describing the problem
+        std::string msg;
+        //! The source line around the problem. Empty if unknown
+        std::string context;
+        //! How serious the problem is
+        tiny::Severity severity = tiny::Severity::Error;
+        //! Identifies the message. Generic diagnostics only have their message
+        tiny::DiagnosticId id = tiny::DiagnosticId::Generic;
+        //! The arguments of the message
+        std::vector<std::string> args;
+        //! Byte offset of the start of the problem in the file
+        std::uint64_t begin = 0;
+        //! Byte offset past the end of the problem in the file. Equal to begin if unknown
+        std::uint64_t end = 0;
+
+        /*!
+         * \brief Formats the diagnostic as a single line
+         * \return A string in the form "file:line:column: message"
+         */
+        [[nodiscard]] std::string toString() const;
+
+        /*!
+         * \brief Serializes the diagnostic into a JSON object
+         * \return A nlohmann::json with the data of the diagnostic
+         */
+        [[nodiscard]] nlohmann::json toJson() const;
+
+        /*!
+         * \brief Deserializes a diagnostic from a JSON object made by toJson()
+         * \param json The JSON object
+         * \return The diagnostic
+         */
+        static tiny::Diagnostic fromJson(const nlohmann::json &json);
+
+        /*!
+         * \brief Builds a diagnostic that only has a message, without a position in the source
+         * \param step The step which reported the problem
+         * \param msg A message describing the problem
+         * \param file Name of the file in which the problem was found. Empty if it isn't tied to a file
+         * \return The diagnostic
+         */
+        static tiny::Diagnostic fromMessage(tiny::CompilationStep step, std::string msg, std::string file = "");
+    };
+
+    /*!
+     * \brief Collects the diagnostics of a compilation, and renders the ones worth showing
+     *
+     * Collects the diagnostics of a compilation as unrendered records: their id, arguments and location. Reporting the
+     * same message at the same location again is ignored, and each file keeps at most maxPerFile diagnostics. Once the
+     * compilation is done finish() sorts them by file and position, keeps the first maxErrors, and only then works out
+     * their lines, columns and source context, logging them. Reports can come from any thread.
+     */
+    class DiagnosticEngine {
+    public:
+        //! Default maximum number of diagnostics shown per compilation
+        static constexpr std::size_t DEFAULT_MAX_ERRORS = 20;
+        //! Default maximum number of diagnostics kept per file
+        static constexpr std::size_t DEFAULT_MAX_PER_FILE = 5;
+
+        /*!
+         * \brief Builds an engine with the provided limits
+         * \param maxErrors Maximum number of diagnostics shown. Zero for no limit, neither per compilation nor per file
+         * \param maxPerFile Maximum number of diagnostics kept per file
+         */
+        explicit DiagnosticEngine(std::size_t maxErrors = DEFAULT_MAX_ERRORS,
+                                  std::size_t maxPerFile = DEFAULT_MAX_PER_FILE);
+
+        /*!
+         * \brief Reports an error thrown while compiling a file
+         * \param step The step which threw the error
+         * \param e The error
+         * \param source The UTF-8 code of the file. Only copied the first time the file reports an error
+         */
+        void report(tiny::CompilationStep step, const tiny::CompilerError &e, std::string_view source);
+
+        /*!
+         * \brief Reports a diagnostic that has no position in the source, such as a pipeline rejection
+         * \param diagnostic The diagnostic
+         */
+        void report(tiny::Diagnostic diagnostic);
+
+        /*!
+         * \brief Renders the diagnostics that make it through the limits
+         * \param log Whether to log them
+         * \return The rendered diagnostics, sorted by file and position
+         */
+        std::vector<tiny::Diagnostic> finish(bool log = true);
+
+        //! Whether anything was reported
+        [[nodiscard]] bool empty() const;
+
+        //! Number of distinct diagnostics reported, shown or not
+        [[nodiscard]] std::size_t getCount() const;
+
+        //! Number of diagnostics left out, either as duplicates or because of the limits
+        [[nodiscard]] std::size_t getSuppressed() const;
+
+        //! Number of diagnostics left out because the same one was already reported
+        [[nodiscard]] std::size_t getDuplicates() const;
+
+    private:
+        //! A diagnostic that still has to be rendered
+        struct Record {
+            //! The diagnostic, without its position, context nor message if it has a source
+            tiny::Diagnostic diagnostic;
+            //! Codepoint indices of the start and end of the problem in the source
+            std::uint64_t start = 0, end = 0;
+            //! The code of the file. Null for the diagnostics without a position
+            std::shared_ptr<const std::string> source;
+        };
+
+        /*!
+         * \brief Adds a record, unless it's a duplicate or its file already has too many
+         * \param record The record
+         * \param key Identifies the record for deduplication
+         */
+        void add(Record record, std::string key);
+
+        std::size_t maxErrors;
+        std::size_t maxPerFile;
+
+        //! The records kept so far
+        std::vector<Record> records;
+        //! Keys of every record reported, to spot duplicates
+        std::set<std::string> seen;
+        //! Number of records kept per file
+        std::map<std::string, std::size_t> perFile;
+        //! The code of the files that reported errors
+        std::map<std::string, std::shared_ptr<const std::string>> sources;
+        //! Number of records left out as duplicates
+        std::size_t duplicates = 0;
+        //! Number of records left out because of the limits
+        std::size_t capped = 0;
+        //! Serializes the reports
+        mutable std::mutex mutex;
+    };
+}
+
+#endif //TINY_DIAGNOSTICS_H
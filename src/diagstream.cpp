@@ -0,0 +1,318 @@
+#include "diagstream.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "errors.h"
+#include "logger.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Little-endian encoding of the fields of the records
+
+    template<typename T>
+    void put(std::string &out, T value) {
+        for (std::size_t i = 0; i < sizeof(T); i++) {
+            out += char((std::uint64_t(value) >> (8 * i)) & 0xFF);
+        }
+    }
+
+    void putString(std::string &out, std::string_view str) {
+        put(out, std::uint32_t(str.size()));
+        out += str;
+    }
+
+    //! Reads the fields of a record, throwing if it ends early
+    class Cursor {
+    public:
+        explicit Cursor(std::string_view data) : data(data) {};
+
+        template<typename T>
+        T get() {
+            need(sizeof(T));
+
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < sizeof(T); i++) {
+                value |= std::uint64_t(std::uint8_t(data[pos + i])) << (8 * i);
+            }
+
+            pos += sizeof(T);
+            return T(value);
+        }
+
+        std::string getString() {
+            auto length = get<std::uint32_t>();
+            need(length);
+
+            std::string str(data.substr(pos, length));
+            pos += length;
+            return str;
+        }
+
+        [[nodiscard]] std::size_t remaining() const {
+            return data.size() - pos;
+        }
+
+    private:
+        void need(std::size_t n) const {
+            if (remaining() < n) {
+                throw tiny::DiagnosticStreamError("Truncated record in the diagnostics stream");
+            }
+        }
+
+        std::string_view data;
+        std::size_t pos = 0;
+    };
+
+    template<typename T>
+    T clamp(std::uint64_t value) {
+        return T(std::min<std::uint64_t>(value, std::numeric_limits<T>::max()));
+    }
+
+#if !defined(_WIN32)
+    /*!
+     * \brief Blocks SIGPIPE in the calling thread while in scope
+     *
+     * Blocks SIGPIPE in the calling thread while in scope, so writing to a pipe whose reader is gone fails with EPIPE
+     * instead of killing the process. A SIGPIPE raised meanwhile is consumed before the mask is restored, unless one
+     * was already pending.
+     */
+    class PipeSignalBlocker {
+    public:
+        PipeSignalBlocker() {
+            sigemptyset(&pipeSet);
+            sigaddset(&pipeSet, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipeSet, &previous);
+            wasPending = isPending();
+        }
+
+        ~PipeSignalBlocker() {
+            if (!wasPending && isPending()) {
+                int signal;
+                sigwait(&pipeSet, &signal);
+            }
+
+            pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+        }
+
+        PipeSignalBlocker(const PipeSignalBlocker &) = delete;
+        PipeSignalBlocker &operator=(const PipeSignalBlocker &) = delete;
+
+    private:
+        static bool isPending() {
+            sigset_t pending;
+            sigemptyset(&pending);
+            return sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE);
+        }
+
+        sigset_t pipeSet{};
+        sigset_t previous{};
+        bool wasPending = false;
+    };
+#endif
+}
+
+void tiny::DiagnosticWriter::write(const tiny::Diagnostic &diagnostic, const std::filesystem::path &root) {
+    std::lock_guard lock(mutex);
+
+    auto fileId = NO_FILE;
+    if (!diagnostic.file.empty()) {
+        auto path = root.empty() ? diagnostic.file : (root / diagnostic.file).string();
+
+        auto it = files.find(path);
+        if (it == files.end()) {
+            it = files.emplace(path, std::uint32_t(files.size())).first;
+
+            std::string record;
+            put(record, Record::File);
+            put(record, it->second);
+            putString(record, path);
+            send(record);
+        }
+
+        fileId = it->second;
+    }
+
+    send(encode(diagnostic, fileId));
+    count++;
+}
+
+void tiny::DiagnosticWriter::write(const tiny::CompilationResult &result, const std::filesystem::path &root) {
+    for (auto const &d: result.diagnostics) {
+        write(d, root);
+    }
+
+    std::lock_guard lock(mutex);
+
+    std::string record;
+    put(record, Record::End);
+    put(record, std::uint8_t(result.status == tiny::CompilationStatus::Ok ? 0 : 1));
+    put(record, count);
+    send(record);
+
+    count = 0;
+}
+
+std::string tiny::DiagnosticWriter::encode(const tiny::Diagnostic &diagnostic, std::uint32_t fileId) {
+    std::string record;
+    record.reserve(64 + diagnostic.msg.size());
+
+    put(record, Record::Diagnostic);
+    put(record, diagnostic.severity);
+    put(record, std::uint8_t(diagnostic.step));
+    put(record, fileId);
+    put(record, diagnostic.begin);
+    put(record, std::max(diagnostic.begin, diagnostic.end));
+    put(record, clamp<std::uint32_t>(diagnostic.line));
+    put(record, clamp<std::uint32_t>(diagnostic.column));
+    put(record, diagnostic.id);
+
+    // Diagnostics built out of plain text only carry their message
+    if (diagnostic.id == tiny::DiagnosticId::Generic && diagnostic.args.empty()) {
+        put(record, std::uint16_t(1));
+        putString(record, diagnostic.msg);
+        return record;
+    }
+
+    put(record, clamp<std::uint16_t>(diagnostic.args.size()));
+    for (std::size_t i = 0; i < std::min<std::size_t>(diagnostic.args.size(), 0xFFFF); i++) {
+        putString(record, diagnostic.args[i]);
+    }
+
+    return record;
+}
+
+void tiny::DiagnosticWriter::send(const std::string &record) {
+    if (failed) {
+        return;
+    }
+
+    std::string buffer;
+    if (!started) {
+        buffer += MAGIC;
+        put(buffer, VERSION);
+        started = true;
+    }
+
+    put(buffer, std::uint32_t(record.size()));
+    buffer += record;
+
+#if !defined(_WIN32)
+    PipeSignalBlocker blocker;
+#endif
+
+    std::size_t written = 0;
+    while (written < buffer.size()) {
+#if defined(_WIN32)
+        auto n = ::_write(fd, buffer.data() + written, unsigned(buffer.size() - written));
+#else
+        auto n = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (n <= 0) {
+            tiny::error("Unable to write to the diagnostics descriptor " + std::to_string(fd) +
+                        ". No more diagnostics will be sent");
+            failed = true;
+            return;
+        }
+
+        written += std::size_t(n);
+    }
+}
+
+tiny::DiagnosticStream tiny::readDiagnostics(std::string_view data) {
+    auto header = tiny::DiagnosticWriter::MAGIC.size() + sizeof(tiny::DiagnosticWriter::VERSION);
+    if (data.size() < header || data.substr(0, tiny::DiagnosticWriter::MAGIC.size()) != tiny::DiagnosticWriter::MAGIC) {
+        throw tiny::DiagnosticStreamError("Not a diagnostics stream");
+    }
+
+    Cursor stream(data.substr(tiny::DiagnosticWriter::MAGIC.size()));
+    if (auto version = stream.get<std::uint16_t>(); version != tiny::DiagnosticWriter::VERSION) {
+        throw tiny::DiagnosticStreamError("Unsupported diagnostics stream version " + std::to_string(version));
+    }
+
+    tiny::DiagnosticStream result;
+    std::map<std::uint32_t, std::string> files;
+    data = data.substr(header);
+
+    while (data.size() >= sizeof(std::uint32_t)) {
+        auto length = Cursor(data).get<std::uint32_t>();
+        if (data.size() - sizeof(std::uint32_t) < length) {
+            break; // The writer might not be done with it
+        }
+
+        Cursor record(data.substr(sizeof(std::uint32_t), length));
+        data = data.substr(sizeof(std::uint32_t) + length);
+
+        if (result.builds.empty() || result.complete) {
+            result.builds.emplace_back();
+            result.complete = false;
+        }
+
+        auto &build = result.builds.back();
+
+        switch (tiny::DiagnosticWriter::Record(record.get<std::uint8_t>())) {
+        case tiny::DiagnosticWriter::Record::File: {
+            auto id = record.get<std::uint32_t>();
+            files[id] = record.getString();
+            break;
+        }
+
+        case tiny::DiagnosticWriter::Record::Diagnostic: {
+            tiny::Diagnostic d;
+            d.severity = tiny::Severity(record.get<std::uint8_t>());
+            d.step = tiny::CompilationStep(record.get<std::uint8_t>());
+
+            if (auto fileId = record.get<std::uint32_t>(); fileId != tiny::DiagnosticWriter::NO_FILE) {
+                auto it = files.find(fileId);
+                if (it == files.end()) {
+                    throw tiny::DiagnosticStreamError("Unknown file id " + std::to_string(fileId));
+                }
+
+                d.file = it->second;
+            }
+
+            d.begin = record.get<std::uint64_t>();
+            d.end = record.get<std::uint64_t>();
+            d.line = record.get<std::uint32_t>();
+            d.column = record.get<std::uint32_t>();
+            d.id = tiny::DiagnosticId(record.get<std::uint16_t>());
+
+            auto args = record.get<std::uint16_t>();
+            for (std::uint16_t i = 0; i < args; i++) {
+                d.args.push_back(record.getString());
+            }
+
+            d.msg = tiny::renderMessage(d.id, d.args);
+            build.diagnostics.push_back(std::move(d));
+            break;
+        }
+
+        case tiny::DiagnosticWriter::Record::End:
+            build.status = record.get<std::uint8_t>() == 0 ? tiny::CompilationStatus::Ok
+                                                            : tiny::CompilationStatus::Error;
+            result.complete = true;
+            break;
+
+        default:
+            break; // Added by a later version
+        }
+    }
+
+    // Leftovers are a record the writer is still sending
+    if (!data.empty()) {
+        result.complete = false;
+    }
+
+    return result;
+}
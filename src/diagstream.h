@@ -0,0 +1,122 @@
+#ifndef TINY_DIAGSTREAM_H
+#define TINY_DIAGSTREAM_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "diagnostics.h"
+#include "compiler.h"
+
+namespace tiny {
+    /*!
+     * \brief Writes diagnostics to a file descriptor as length-prefixed binary records
+     *
+     * Writes diagnostics to a file descriptor as length-prefixed binary records, so build orchestrators can consume
+     * them without parsing text. Every integer is little-endian, and strings are a u32 length followed by UTF-8 bytes.
+     * The stream starts with the "TDIA" magic and a u16 format version. Then comes a sequence of records, each a u32
+     * length (kind included) followed by a u8 kind and its payload:
+     *
+     *  - File (1): u32 file id, string path. Sent once per file, before the first diagnostic that refers to it
+     *  - Diagnostic (2): u8 severity, u8 compilation step, u32 file id (0xFFFFFFFF if none), u64 begin byte, u64 end
+     *    byte, u32 line, u32 column, u16 message id, u16 argument count, and the arguments as strings
+     *  - End (3): u8 status (0 ok, 1 error), u32 number of diagnostics of the build
+     *
+     * The message ids are the values of DiagnosticId, so the text never needs to be sent. Unknown record kinds must be
+     * skipped by readers, which lets later versions add records.
+     */
+    class DiagnosticWriter {
+    public:
+        //! The bytes that start every stream
+        static constexpr std::string_view MAGIC = "TDIA";
+        //! Version of the format
+        static constexpr std::uint16_t VERSION = 1;
+        //! File id of the diagnostics not tied to a file
+        static constexpr std::uint32_t NO_FILE = 0xFFFFFFFF;
+
+        //! The kinds of records
+        enum class Record : std::uint8_t {
+            File = 1,
+            Diagnostic = 2,
+            End = 3,
+        };
+
+        /*!
+         * \brief Builds a writer over a file descriptor. The descriptor is not closed by the writer
+         * \param fd The file descriptor
+         */
+        explicit DiagnosticWriter(int fd) : fd(fd) {};
+
+        DiagnosticWriter(DiagnosticWriter const &) = delete;
+        void operator=(DiagnosticWriter const &) = delete;
+
+        /*!
+         * \brief Writes a diagnostic, preceded by the record of its file if it wasn't sent yet
+         * \param diagnostic The diagnostic
+         * \param root Directory the file of the diagnostic is relative to. Prepended to its path if not empty
+         */
+        void write(const tiny::Diagnostic &diagnostic, const std::filesystem::path &root = {});
+
+        /*!
+         * \brief Writes every diagnostic of a compilation followed by an End record
+         * \param result The result of the compilation
+         * \param root Directory the files of the diagnostics are relative to. Prepended to their path if not empty
+         */
+        void write(const tiny::CompilationResult &result, const std::filesystem::path &root = {});
+
+        /*!
+         * \brief Encodes a diagnostic record, without its length prefix
+         * \param diagnostic The diagnostic
+         * \param fileId The id of its file
+         * \return The record
+         */
+        static std::string encode(const tiny::Diagnostic &diagnostic, std::uint32_t fileId);
+
+    private:
+        /*!
+         * \brief Writes a record, with the header of the stream first if nothing was written yet
+         * \param record The record, without its length prefix
+         *
+         * Writes a record. Errors are logged once and the rest of the records dropped, since a closed descriptor
+         * shouldn't stop the build.
+         */
+        void send(const std::string &record);
+
+        //! The file descriptor
+        int fd;
+        //! Whether the header was written
+        bool started = false;
+        //! Whether writing failed
+        bool failed = false;
+        //! The ids of the files sent so far
+        std::map<std::string, std::uint32_t> files;
+        //! Number of diagnostics written since the last End record
+        std::uint32_t count = 0;
+        //! Serializes the writes
+        std::mutex mutex;
+    };
+
+    //! The contents of a binary diagnostics stream
+    struct DiagnosticStream {
+        //! The builds in the stream, in order, as their status and diagnostics
+        std::vector<tiny::CompilationResult> builds;
+        //! Whether the stream ends right after an End record
+        bool complete = false;
+    };
+
+    /*!
+     * \brief Decodes a stream written by DiagnosticWriter
+     * \param data The bytes of the stream
+     * \return The builds in the stream. Messages are rendered from their ids and arguments
+     *
+     * Decodes a stream written by DiagnosticWriter. Throws DiagnosticStreamError if the data is malformed. A truncated
+     * last record is ignored, since the writer might still be running.
+     */
+    tiny::DiagnosticStream readDiagnostics(std::string_view data);
+}
+
+#endif //TINY_DIAGSTREAM_H
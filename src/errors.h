@@ -2,8 +2,10 @@
 #define TINY_ERRORS_H
 
 #include <utility>
+#include <vector>
 
 #include "metadata.h"
+#include "messages.h"
 
 namespace tiny {
     /*!
@@ -12,24 +14,54 @@ namespace tiny {
      * throwing.
      */
     struct CompilerError : public std::exception {
-        //! Explanation of the error
-        std::string msg;
+        //! Explanation of the error. Empty for errors made out of a message id, until getMessage() renders it
+        mutable std::string msg;
         //! Information about the error, that might include the file and fragment that triggered it
         tiny::Metadata meta;
+        //! Identifies the message of the error
+        tiny::DiagnosticId id = tiny::DiagnosticId::Generic;
+        //! The arguments of the message
+        std::vector<std::string> args;
 
         /*!
          * \brief Creates a new CompilerError error exception
          * \param msg Explanation of the error
          * \param md Information about the error
          */
-        explicit CompilerError(std::string msg, tiny::Metadata md) : msg(std::move(msg)), meta(std::move(md)) {};
+        explicit CompilerError(std::string msg, tiny::Metadata md) : msg(msg), meta(std::move(md)), args({msg}) {};
+
+        /*!
+         * \brief Creates a new CompilerError error exception out of a message id
+         * \param id Identifies the message of the error
+         * \param args The arguments of the message
+         * \param md Information about the error
+         */
+        explicit CompilerError(tiny::DiagnosticId id, std::vector<std::string> args, tiny::Metadata md)
+                : meta(std::move(md)), id(id), args(std::move(args)) {};
+
+        /*!
+         * \brief Gets the explanation of the error
+         * \return The message. Errors made out of a message id render it the first time it's asked for, so the
+         * compiler doesn't format text that nothing shows
+         */
+        [[nodiscard]] const std::string &getMessage() const {
+            if (msg.empty() && id != tiny::DiagnosticId::Generic) {
+                msg = tiny::renderMessage(id, args);
+            }
+
+            return msg;
+        }
 
         /*!
          * \brief Returns a C-string detailing the error
          * \return A C-string with an explanation of the error
          */
         [[nodiscard]] const char *what() const noexcept override {
-            return msg.c_str();
+            try {
+                return getMessage().c_str();
+            } catch (...) {
+                return "Compiler error"; // Unable to render the message
+            }
         }
 
         /*!
@@ -69,6 +101,26 @@ namespace tiny {
         using SemanticError::SemanticError; // Inherit the constructor
     };
 
+    //! Gets thrown when an AST can't be lowered into bytecode, for example because it uses an unsupported construct
+    struct BytecodeError : tiny::CompilerError {
+        using CompilerError::CompilerError; // Inherit the constructor
+    };
+
+    //! Gets thrown when an AST can't be compiled into closures, for example because it uses an unsupported construct
+    struct InterpreterError : tiny::CompilerError {
+        using CompilerError::CompilerError; // Inherit the constructor
+    };
+
+    //! Gets thrown when an AST can't be lowered into IR, or when IR fails verification
+    struct IRError : tiny::CompilerError {
+        using CompilerError::CompilerError; // Inherit the constructor
+    };
+
+    //! Gets thrown when an AST can't be translated into C
+    struct CodegenError : tiny::CompilerError {
+        using CompilerError::CompilerError; // Inherit the constructor
+    };
+
     //! Base error for failed fetch operations over an AST. Narrower errors should be preferred over this generic one
     struct BadASTError : tiny::CompilerError {
         using CompilerError::CompilerError; // Inherit the constructor
@@ -183,6 +235,153 @@ namespace tiny {
         using FileError::FileError; // Inherit the constructor
     };
 
+    //! Gets thrown when the compile server or its client can't set up or use their socket
+    struct ServerError : public std::exception {
+        //! A message describing the error
+        std::string msg = "Server error";
+
+        /*!
+         * \brief Creates a new ServerError
+         * \param msg A message that describes the error
+         */
+        explicit ServerError(std::string msg) : msg(std::move(msg)) {};
+
+        /*!
+         * \brief Returns a C-string detailing the error
+         * \return A C-string with an explanation of the error
+         */
+        [[nodiscard]] const char *what() const noexcept override {
+            return msg.c_str();
+        }
+    };
+
+    //! Gets thrown when the watch mode can't watch the project directories
+    struct WatchError : public std::exception {
+        //! A message describing the error
+        std::string msg = "Watch error";
+
+        /*!
+         * \brief Creates a new WatchError
+         * \param msg A message that describes the error
+         */
+        explicit WatchError(std::string msg) : msg(std::move(msg)) {};
+
+        /*!
+         * \brief Returns a C-string detailing the error
+         * \return A C-string with an explanation of the error
+         */
+        [[nodiscard]] const char *what() const noexcept override {
+            return msg.c_str();
+        }
+    };
+
+    //! Gets thrown when a TOML document is malformed, or has settings of the wrong type
+    struct TomlError : public std::exception {
+        //! A message describing the error
+        std::string msg = "Invalid TOML";
+        //! Line of the error, starting at 1
+        std::size_t line = 0;
+        //! Column of the error, starting at 1
+        std::size_t column = 0;
+
+        /*!
+         * \brief Creates a new TomlError
+         * \param msg A message that describes the error
+         * \param line Line of the error
+         * \param column Column of the error
+         */
+        explicit TomlError(const std::string &msg, std::size_t line, std::size_t column)
+                : msg(msg), line(line), column(column) {};
+
+        /*!
+         * \brief Returns a C-string detailing the error
+         * \return A C-string with an explanation of the error
+         */
+        [[nodiscard]] const char *what() const noexcept override {
+            return msg.c_str();
+        }
+    };
+
+    //! Gets thrown when a glob pattern is malformed
+    struct GlobError : public std::exception {
+        //! A message describing the error
+        std::string msg = "Invalid glob pattern";
+
+        /*!
+         * \brief Creates a new GlobError
+         * \param msg A message that describes the error
+         */
+        explicit GlobError(std::string msg) : msg(std::move(msg)) {};
+
+        /*!
+         * \brief Returns a C-string detailing the error
+         * \return A C-string with an explanation of the error
+         */
+        [[nodiscard]] const char *what() const noexcept override {
+            return msg.c_str();
+        }
+    };
+
+    //! Gets thrown when a binary diagnostics stream is malformed
+    struct DiagnosticStreamError : public std::exception {
+        //! A message describing the error
+        std::string msg = "Malformed diagnostics stream";
+
+        /*!
+         * \brief Creates a new DiagnosticStreamError
+         * \param msg A message that describes the error
+         */
+        explicit DiagnosticStreamError(std::string msg) : msg(std::move(msg)) {};
+
+        /*!
+         * \brief Returns a C-string detailing the error
+         * \return A C-string with an explanation of the error
+         */
+        [[nodiscard]] const char *what() const noexcept override {
+            return msg.c_str();
+        }
+    };
+
+    //! Gets thrown by the VM when a program fails while running, such as on a division by zero
+    struct ExecutionError : public std::exception {
+        //! A message describing the error
+        std::string msg = "Execution error";
+
+        /*!
+         * \brief Creates a new ExecutionError
+         * \param msg A message that describes the error
+         */
+        explicit ExecutionError(std::string msg) : msg(std::move(msg)) {};
+
+        /*!
+         * \brief Returns a C-string detailing the error
+         * \return A C-string with an explanation of the error
+         */
+        [[nodiscard]] const char *what() const noexcept override {
+            return msg.c_str();
+        }
+    };
+
+    //! Gets thrown when the C compiler of the system can't be started, or fails to compile generated C
+    struct NativeCompileError : public std::exception {
+        //! A message describing the error
+        std::string msg = "Native compilation error";
+
+        /*!
+         * \brief Creates a new NativeCompileError
+         * \param msg A message that describes the error
+         */
+        explicit NativeCompileError(std::string msg) : msg(std::move(msg)) {};
+
+        /*!
+         * \brief Returns a C-string detailing the error
+         * \return A C-string with an explanation of the error
+         */
+        [[nodiscard]] const char *what() const noexcept override {
+            return msg.c_str();
+        }
+    };
+
     struct CLIError : public std::exception {
         //! A message describing the error
         std::string msg = "Command error";
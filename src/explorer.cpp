@@ -1,6 +1,152 @@
 #include "explorer.h"
 
 #include <algorithm>
+#include <memory>
+#include <mutex>
+
+#include "scheduler.h"
+#include "glob.h"
+#include "alloctrack.h"
+
+#if defined(__linux__)
+
+#include <cerrno>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    //! A directory entry as returned by getdents64
+    struct LinuxDirent64 {
+        ino64_t d_ino;
+        off64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[];
+    };
+
+    //! Closes a directory when it goes out of scope
+    struct DirectoryCloser {
+        int fd;
+
+        ~DirectoryCloser() {
+            close(fd);
+        }
+    };
+
+    /*!
+     * \brief Walks a directory, and its subdirectories as separate tasks
+     * \param fd The directory, opened. Closed by the walk
+     * \param path Path of the directory
+     * \param depth Depth of the entries of the directory
+     * \param maxDepth The maximum depth of the walk
+     *
+     * Walks a directory, and its subdirectories as separate tasks. Each task opens its subdirectory with openat,
+     * relative to the directory, which is shared by its subdirectories and closed once they've all been opened. So only
+     * the directories being read, or whose subdirectories are yet to be opened, are open at once no matter how wide
+     * the tree is. Throws std::filesystem::filesystem_error if a directory can't be opened or read.
+     */
+    template<typename DirectoryVisitor, typename FileVisitor>
+    void walkDirectory(int fd, const std::filesystem::path &path, std::int32_t depth, std::int32_t maxDepth,
+                       const DirectoryVisitor &onDirectory, const FileVisitor &onFile) {
+        auto directory = std::shared_ptr<DirectoryCloser>(new DirectoryCloser{fd});
+
+        std::vector<std::string> subdirectories;
+        {
+            // On the heap: walks of nested directories can run on the same stack while this one waits for them
+            std::vector<std::uint64_t> storage(32 * 1024 / sizeof(std::uint64_t));
+            auto *buffer = reinterpret_cast<char *>(storage.data());
+
+            while (true) {
+                auto len = syscall(SYS_getdents64, fd, buffer, storage.size() * sizeof(std::uint64_t));
+                if (len < 0) {
+                    throw std::filesystem::filesystem_error("Unable to read the directory", path,
+                                                            std::error_code(errno, std::system_category()));
+                }
+
+                if (len == 0) {
+                    break;
+                }
+
+                for (long offset = 0; offset < len;) {
+                    auto *entry = reinterpret_cast<LinuxDirent64 *>(buffer + offset);
+                    offset += entry->d_reclen;
+
+                    std::string_view name(entry->d_name);
+                    if (name == "." || name == "..") {
+                        continue;
+                    }
+
+                    // Only stat when the type is unknown or a link. Links to files are followed, links to directories
+                    // aren't, whether or not the filesystem fills in the types
+                    auto type = entry->d_type;
+                    struct stat st{};
+                    if (type == DT_UNKNOWN) {
+                        if (fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                            continue;
+                        }
+
+                        if (S_ISLNK(st.st_mode)) {
+                            type = DT_LNK;
+                        } else if (S_ISREG(st.st_mode)) {
+                            type = DT_REG;
+                        } else if (S_ISDIR(st.st_mode)) {
+                            type = DT_DIR;
+                        } else {
+                            continue;
+                        }
+                    }
+
+                    if (type == DT_LNK) {
+                        if (fstatat(fd, entry->d_name, &st, 0) != 0 || !S_ISREG(st.st_mode)) {
+                            continue;
+                        }
+
+                        type = DT_REG;
+                    }
+
+                    if (type == DT_REG) {
+                        onFile(path / name, depth);
+                    } else if (type == DT_DIR && depth < maxDepth && onDirectory(path / name, depth)) {
+                        subdirectories.emplace_back(name);
+                    }
+                }
+            }
+        }
+
+        // The tasks run on other threads, which count their allocations like the thread that started the walk
+        auto *allocations = tiny::AllocationTracker::getCounters();
+        auto phase = tiny::AllocationTracker::getPhase();
+
+        auto &scheduler = tiny::Scheduler::get();
+        std::vector<tiny::TaskHandle> tasks;
+        for (auto const &name: subdirectories) {
+            tasks.push_back(scheduler.submit([=, &onDirectory, &onFile]() mutable {
+                tiny::AllocationScope allocationScope(allocations);
+                tiny::PhaseScope phaseScope(phase);
+
+                int child = openat(directory->fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                auto error = errno;
+                directory.reset(); // The last subdirectory to be opened closes this one
+
+                if (child < 0) {
+                    throw std::filesystem::filesystem_error("Unable to open the directory", path / name,
+                                                            std::error_code(error, std::system_category()));
+                }
+
+                walkDirectory(child, path / name, depth + 1, maxDepth, onDirectory, onFile);
+            }));
+        }
+
+        directory.reset();
+        scheduler.wait(tasks);
+    }
+}
+
+#endif
 
 std::int32_t tiny::Explorer::getSearchDepth() const {
     return searchDepth;
@@ -10,61 +156,138 @@ void tiny::Explorer::setSearchDepth(std::int32_t depth) {
     searchDepth = depth;
 }
 
-std::vector<std::filesystem::directory_entry> tiny::Explorer::search(const std::string &term) const {
-    return search(std::vector<std::string>{term});
+void tiny::Explorer::setExcludes(const std::vector<std::string> &patterns) {
+    excludes = tiny::IgnoreList();
+    for (auto const &p: patterns) {
+        excludes.add(p);
+    }
 }
 
-std::vector<std::filesystem::directory_entry> tiny::Explorer::search(const std::vector<std::string> &terms,
-                                                                     const std::vector<std::string> &folders) const {
-    // Prepare filetype wildcards (ex. *.txt -> txt)
-    std::vector<std::string> extensions;
-    for (const auto &term: terms) {
-        if (term.length() < 3) {
-            continue;
+std::string tiny::Explorer::getRelativePath(const std::filesystem::path &p) const {
+    // The walk builds every path by appending to the base directory, so usually stripping the prefix is enough
+    auto const &full = p.native();
+    auto const &base = path.native();
+    if (full.size() > base.size() && full.compare(0, base.size(), base) == 0) {
+        auto start = base.size() + (base.back() == '/' ? 0 : 1);
+        return full.substr(start);
+    }
+
+    return p.lexically_relative(path).generic_string();
+}
+
+void tiny::Explorer::walk(const DirectoryVisitor &visitDirectory, const FileVisitor &visitFile) const {
+    auto ignore = excludes;
+    ignore.append(tiny::IgnoreList::load(path / IGNORE_FILE));
+
+    // Ignored directories are pruned before they're opened, so nothing below them gets read
+    DirectoryVisitor onDirectory = [&](const std::filesystem::path &p, std::int32_t depth) {
+        if (!ignore.empty() && ignore.isIgnored(getRelativePath(p), true)) {
+            return false;
         }
 
-        if (term.substr(0, 2) == "*.") {
-            extensions.push_back(term.substr(1, term.length()));
+        return visitDirectory(p, depth);
+    };
+
+    FileVisitor onFile = [&](const std::filesystem::path &p, std::int32_t depth) {
+        if (!ignore.empty() && ignore.isIgnored(getRelativePath(p), false)) {
+            return;
         }
+
+        visitFile(p, depth);
+    };
+
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::filesystem::filesystem_error("Unable to open the directory", path,
+                                                std::error_code(errno, std::system_category()));
     }
 
-    // Iterate over the file tree
-    std::vector<std::filesystem::directory_entry> matches;
+    walkDirectory(fd, path, 0, searchDepth, onDirectory, onFile);
+#else
     auto i = std::filesystem::recursive_directory_iterator(path);
     for (auto &p: i) {
-        if (i.depth() > searchDepth) {
+        if (p.is_directory()) {
+            // Don't even open the directories whose contents are beyond the depth
+            if (i.depth() >= searchDepth || !onDirectory(p.path(), i.depth())) {
+                i.disable_recursion_pending();
+            }
+
             continue;
         }
 
-        if (!p.is_regular_file()) {
-            continue;
+        if (p.is_regular_file()) {
+            onFile(p.path(), i.depth());
         }
+    }
+#endif
+}
+
+std::vector<std::filesystem::path> tiny::Explorer::getDirectories() const {
+    std::vector<std::filesystem::path> directories;
+    std::mutex mtx;
+
+    walk([&](const std::filesystem::path &dir, std::int32_t) {
+        std::lock_guard lock(mtx);
+        directories.push_back(dir);
 
-        if (!folders.empty() && i.depth() > 1) {
+        return true;
+    }, [](const std::filesystem::path &, std::int32_t) {});
+
+    std::sort(directories.begin(), directories.end());
+    directories.insert(directories.begin(), path);
+
+    return directories;
+}
+
+std::vector<std::filesystem::directory_entry> tiny::Explorer::search(const std::string &term) const {
+    return search(std::vector<std::string>{term});
+}
+
+std::vector<std::filesystem::directory_entry> tiny::Explorer::search(const std::vector<std::string> &terms,
+                                                                     const std::vector<std::string> &folders) const {
+    // Compile every pattern once, before walking
+    std::vector<tiny::Glob> termGlobs(terms.begin(), terms.end());
+    std::vector<tiny::Glob> folderGlobs(folders.begin(), folders.end());
+
+    // Walk the file tree
+    std::vector<std::filesystem::path> matches;
+    std::mutex mtx;
+
+    walk([](const std::filesystem::path &, std::int32_t) { return true; },
+         [&](const std::filesystem::path &p, std::int32_t depth) {
+        auto relative = getRelativePath(p);
+
+        if (!folderGlobs.empty() && depth > 1) {
             // Folders whitelist
+            auto slash = relative.rfind('/');
+            std::string_view parent(relative.data(), slash == std::string::npos ? 0 : slash);
 
-            auto parent = std::filesystem::path(p).parent_path();
-            if (std::find(folders.begin(), folders.end(), parent) == folders.end()) {
-                continue; // Not in whitelist
+            auto allowed = std::any_of(folderGlobs.begin(), folderGlobs.end(), [&](const tiny::Glob &g) {
+                return g.matches(parent, true);
+            });
+
+            if (!allowed) {
+                return; // Not in whitelist
             }
         }
 
-        // Try to match the extension
-        for (auto const &ext: extensions) {
-            if (p.path().extension() == ext) {
-                matches.push_back(p);
-                break;
+        // Like in an IgnoreList the last term to match decides, so a negated term drops what earlier ones matched
+        bool matched = false;
+        for (auto const &g: termGlobs) {
+            if (g.isNegated() == matched && g.matches(relative)) {
+                matched = !g.isNegated();
             }
         }
 
-        // Try to match full filenames
-        for (auto &term: terms) {
-            if (p.path().filename() == term) {
-                matches.push_back(p);
-                break;
-            }
+        if (matched) {
+            std::lock_guard lock(mtx);
+            matches.push_back(p);
         }
-    }
+    });
+
+    // Sort, since the walk order is undefined
+    std::sort(matches.begin(), matches.end());
 
-    return matches;
+    return {matches.begin(), matches.end()};
 }
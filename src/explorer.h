@@ -4,8 +4,11 @@
 #include <string>
 #include <utility>
 #include <filesystem>
+#include <functional>
 #include <vector>
 
+#include "glob.h"
+
 namespace tiny {
 
     //! The Explorer class navigates, finds and filters files. Under the hood it wraps std::filesystem.
@@ -33,25 +36,38 @@ namespace tiny {
         explicit Explorer(std::filesystem::path path, std::int32_t depth = 1) : path(std::move(path)), searchDepth(depth) {};
 
         /*!
-         * \brief Iterates over the set directory and searches for a matching filename
-         * \param term A full filename or an extension wildcard
+         * \brief Iterates over the set directory and searches for files matching a glob pattern
+         * \param term A glob pattern (see tiny::Glob), like a full filename or an extension wildcard
          * \return A vector with the results of the search. Empty vector if no matches where found.
          *
-         * Iterates over the set directory and searches for a matching filename. The term might be a full filename
-         * like example.txt or an extension wildcard like *.txt. The search will enter folders recursively for the depth
-         * set with the setSearchDepth() function (defaults to 1).
+         * Iterates over the set directory and searches for files matching a glob pattern. The term might be a full
+         * filename like example.txt, an extension wildcard like *.txt, or a path pattern with '**' wildcards.
+         * Patterns are matched against the path relative to the base directory. The search will enter folders
+         * recursively for the depth set with the setSearchDepth() function (defaults to 1). Directories beyond that
+         * depth, or ignored by the .tinyignore file of the base directory, are never opened. The results are sorted by
+         * path. Throws std::filesystem::filesystem_error if a directory within the search depth can't be read, rather
+         * than skipping the files in it.
          */
         [[nodiscard]] std::vector<std::filesystem::directory_entry> search(const std::string &term) const;
 
         /*!
          * \brief Executes a search over multiple terms. See the documentation for the 'search' function.
-         * \param terms A full filename or an extension wildcard
-         * \param folders A vector of folders allowed to be searched on. If empty, all folders are allowed
+         * \param terms Glob patterns, like full filenames or extension wildcards. Checked in order, and the last one to
+         * match a file decides: a negated term ('!') drops the files the terms before it matched
+         * \param folders Glob patterns of the folders allowed to be searched on, matched against the folder path
+         * relative to the base directory. Only apply beyond depth 1. If empty, all folders are allowed
          * \return A vector with the results of the search. Empty vector if no matches where found.
          */
         [[nodiscard]] std::vector<std::filesystem::directory_entry>
         search(const std::vector<std::string> &terms, const std::vector<std::string> &folders = {}) const;
 
+        /*!
+         * \brief Lists the directories a search walks through: the base directory, plus its subdirectories up to the
+         * search depth
+         * \return A vector with the paths of the directories, starting with the base directory
+         */
+        [[nodiscard]] std::vector<std::filesystem::path> getDirectories() const;
+
         /*!
          * \brief Returns the current search depth.
          * \return The current search depth.
@@ -64,12 +80,45 @@ namespace tiny {
          */
         void setSearchDepth(std::int32_t depth);
 
+        /*!
+         * \brief Sets glob patterns of paths to skip, on top of the ones of the .tinyignore file
+         * \param patterns The patterns, with the syntax of the .tinyignore file. Checked before the ones of the file
+         */
+        void setExcludes(const std::vector<std::string> &patterns);
+
+        //! Name of the file, in the base directory, listing the glob patterns of the paths to skip
+        static constexpr const char *IGNORE_FILE = ".tinyignore";
+
     private:
+        //! Called with every directory within the search depth, and its depth. Returns whether to walk into it
+        using DirectoryVisitor = std::function<bool(const std::filesystem::path &, std::int32_t)>;
+        //! Called with every regular file within the search depth, and its depth
+        using FileVisitor = std::function<void(const std::filesystem::path &, std::int32_t)>;
+
+        /*!
+         * \brief Walks the directory tree up to the search depth
+         * \param visitDirectory Called for every directory whose contents are within the search depth
+         * \param visitFile Called for every regular file (or link to one) within the search depth
+         *
+         * Walks the directory tree up to the search depth, skipping the excluded paths and the ones ignored by the
+         * .tinyignore file of the base directory. Entries directly inside the base directory have depth 0.
+         * Sibling directories are walked in parallel as Scheduler tasks, so the visitors must be thread-safe. On Linux
+         * the directories are read with openat and getdents64, using the entry types to avoid a stat per entry.
+         * Throws std::filesystem::filesystem_error if any directory it walks into can't be opened or read.
+         */
+        void walk(const DirectoryVisitor &visitDirectory, const FileVisitor &visitFile) const;
+
+        //! Gets a path within the base directory as a path relative to it, with '/' as the separator
+        [[nodiscard]] std::string getRelativePath(const std::filesystem::path &p) const;
+
         //! The root directory for the search.
         std::filesystem::path path = std::filesystem::current_path();
 
         //! The maximum allowed search depth. Defaults to 1.
         std::int32_t searchDepth = 1;
+
+        //! Patterns of the paths to skip, set by setExcludes()
+        tiny::IgnoreList excludes;
     };
 }
 
@@ -1,5 +1,7 @@
 #include "file.h"
 
+#include <limits>
+
 #include "errors.h"
 
 tiny::File tiny::FileSelector::getMetaFile() const {
@@ -16,7 +18,7 @@ tiny::File tiny::FileSelector::getMetaFile() const {
 }
 
 std::vector<tiny::File> tiny::FileSelector::getLocalSourceFiles() const {
-    auto matches = explorer.search({"*.ty"}, {"src"});
+    auto matches = includes.empty() ? explorer.search({"*.ty"}, {"src"}) : explorer.search(includes);
     if (matches.empty()) {
         throw tiny::SourcesNotFoundError("No source files found in the current directory");
     }
@@ -37,7 +39,22 @@ std::vector<tiny::File> tiny::FileSelector::getFiles() const {
     return files;
 }
 
+void tiny::FileSelector::setPatterns(std::vector<std::string> include, const std::vector<std::string> &exclude) {
+    includes = std::move(include);
+    explorer.setExcludes(exclude);
+    explorer.setSearchDepth(includes.empty() ? 0 : std::numeric_limits<std::int32_t>::max());
+}
+
+std::vector<std::filesystem::path> tiny::FileSelector::getDirectories() const {
+    return explorer.getDirectories();
+}
+
 std::filesystem::path tiny::File::getRelativePath() const
 {
+    // Relative paths (such as the names of in-memory sources) are kept as they are, without touching the filesystem
+    if (path.is_relative()) {
+        return path;
+    }
+
     return std::filesystem::relative(path, std::filesystem::current_path());
 }
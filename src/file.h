@@ -21,7 +21,7 @@ namespace tiny {
         tiny::FileType type = tiny::FileType::Source;
         std::filesystem::path path;
 
-        //! Gets the path relative to the current working directory
+        //! Gets the path relative to the current working directory. Relative paths are returned as they are
         std::filesystem::path getRelativePath() const;
     };
 
@@ -51,7 +51,7 @@ namespace tiny {
          * \return A vector of File detailing the found sources
          *
          * Tries to find the source files (*.ty). If none is found SourcesNotFoundError is raised. It searches inside
-         * the current directory and inside a "src" folder if present.
+         * the current directory and inside a "src" folder if present, or for the include patterns if they were set.
          */
         [[nodiscard]] std::vector<tiny::File> getLocalSourceFiles() const;
 
@@ -64,11 +64,29 @@ namespace tiny {
          */
         [[nodiscard]] std::vector<tiny::File> getFiles() const;
 
+        /*!
+         * \brief Lists the directories in which the files are searched for
+         * \return A vector with the paths of the directories
+         */
+        [[nodiscard]] std::vector<std::filesystem::path> getDirectories() const;
+
+        /*!
+         * \brief Sets the glob patterns of the source files, as set in a project's tiny.toml
+         * \param include Globs of the source files. If empty, the default selection is used
+         * \param exclude Globs of the files and directories to skip. Excluded directories are never read
+         *
+         * Sets the glob patterns of the source files, as set in a project's tiny.toml. Include patterns can select
+         * files at any depth, so setting them lifts the depth limit of the search.
+         */
+        void setPatterns(std::vector<std::string> include, const std::vector<std::string> &exclude);
+
     private:
         //! The Explorer used to search for the files
         tiny::Explorer explorer = tiny::Explorer(std::filesystem::current_path(), 0);
         //! Current search path. Defaults to the current path.
         std::filesystem::path path = std::filesystem::current_path();
+        //! Globs of the source files. If empty, the *.ty files of the search path are selected
+        std::vector<std::string> includes;
     };
 }
 
@@ -0,0 +1,266 @@
+#include "folding.h"
+
+#include <optional>
+
+#include "errors.h"
+#include "stats.h"
+#include "value.h"
+
+namespace {
+    //! Gets the value of a literal. Returns nullopt if the node isn't an integer, decimal or boolean literal
+    std::optional<tiny::RuntimeValue> toValue(const tiny::ASTNode &node) {
+        switch (node.type) {
+        case tiny::ASTNodeType::LiteralInt:
+            return tiny::RuntimeValue::fromInt(std::get<std::int64_t>(node.val));
+        case tiny::ASTNodeType::LiteralDecimal:
+            return tiny::RuntimeValue::fromFloat(double(std::get<long double>(node.val)));
+        case tiny::ASTNodeType::LiteralBool:
+            return tiny::RuntimeValue::fromBool(std::get<bool>(node.val));
+        default:
+            return std::nullopt;
+        }
+    }
+
+    //! Builds the literal of a value
+    tiny::ASTNode toLiteral(const tiny::RuntimeValue &value, const tiny::Metadata &meta) {
+        switch (value.kind) {
+        case tiny::ValueKind::Int:
+            return tiny::ASTNode(meta, tiny::ASTNodeType::LiteralInt, value.i);
+        case tiny::ValueKind::Float:
+            return tiny::ASTNode(meta, tiny::ASTNodeType::LiteralDecimal, static_cast<long double>(value.f));
+        case tiny::ValueKind::Bool:
+            return tiny::ASTNode(meta, tiny::ASTNodeType::LiteralBool, value.b);
+        default:
+            return tiny::ASTNode(meta, tiny::ASTNodeType::LiteralNone);
+        }
+    }
+
+    //! Whether a node is the given integer literal
+    bool isInteger(const tiny::ASTNode &node, std::int64_t value) {
+        return node.type == tiny::ASTNodeType::LiteralInt && std::get<std::int64_t>(node.val) == value;
+    }
+
+    //! Whether a node is a boolean literal
+    bool isBool(const tiny::ASTNode &node) {
+        return node.type == tiny::ASTNodeType::LiteralBool;
+    }
+
+    //! Whether a node always gives a boolean: a boolean literal, a comparison, or '!' or a logical operation over those
+    bool isBoolean(const tiny::ASTNode &node) {
+        switch (node.type) {
+        case tiny::ASTNodeType::LiteralBool:
+        case tiny::ASTNodeType::CompareEq:
+        case tiny::ASTNodeType::CompareNeq:
+        case tiny::ASTNodeType::CompareLt:
+        case tiny::ASTNodeType::CompareLteq:
+        case tiny::ASTNodeType::CompareGt:
+        case tiny::ASTNodeType::CompareGteq:
+            return true;
+        case tiny::ASTNodeType::UnaryNot:
+            return isBoolean(*node.getFirstChild());
+        case tiny::ASTNodeType::LogicalAnd:
+        case tiny::ASTNodeType::LogicalOr:
+            return isBoolean(*node.getFirstChild()) && isBoolean(*node.getSecondChild());
+        default:
+            return false;
+        }
+    }
+
+    //! Whether a node gives a number or fails at run time: a numeric literal, an arithmetic operation or a negation
+    bool isNumeric(const tiny::ASTNode &node) {
+        switch (node.type) {
+        case tiny::ASTNodeType::LiteralInt:
+        case tiny::ASTNodeType::LiteralDecimal:
+        case tiny::ASTNodeType::OpAddition:
+        case tiny::ASTNodeType::OpSubtraction:
+        case tiny::ASTNodeType::OpMultiplication:
+        case tiny::ASTNodeType::OpDivision:
+        case tiny::ASTNodeType::OpExponentiate:
+        case tiny::ASTNodeType::UnaryNegative:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    //! Gets the operator of an arithmetic or comparison node, if it's one
+    std::optional<tiny::Operator> toOperator(tiny::ASTNodeType type) {
+        switch (type) {
+        case tiny::ASTNodeType::OpAddition:
+            return tiny::Operator::Add;
+        case tiny::ASTNodeType::OpSubtraction:
+            return tiny::Operator::Sub;
+        case tiny::ASTNodeType::OpMultiplication:
+            return tiny::Operator::Mul;
+        case tiny::ASTNodeType::OpDivision:
+            return tiny::Operator::Div;
+        case tiny::ASTNodeType::OpExponentiate:
+            return tiny::Operator::Pow;
+        case tiny::ASTNodeType::CompareEq:
+            return tiny::Operator::Eq;
+        case tiny::ASTNodeType::CompareNeq:
+            return tiny::Operator::Neq;
+        case tiny::ASTNodeType::CompareLt:
+            return tiny::Operator::Lt;
+        case tiny::ASTNodeType::CompareLteq:
+            return tiny::Operator::Lteq;
+        case tiny::ASTNodeType::CompareGt:
+            return tiny::Operator::Gt;
+        case tiny::ASTNodeType::CompareGteq:
+            return tiny::Operator::Gteq;
+        default:
+            return std::nullopt;
+        }
+    }
+
+    //! Replaces a node by one of its children
+    void replaceWith(tiny::ASTNode &node, const std::shared_ptr<tiny::ASTNode> &child) {
+        auto keep = child; // The child is owned by the node being replaced
+        node = std::move(*keep);
+    }
+
+    //! Computes a binary operation over two literals. Returns nullopt if it would fail at run time
+    std::optional<tiny::RuntimeValue> evaluate(tiny::Operator op, const tiny::RuntimeValue &x,
+                                               const tiny::RuntimeValue &y) {
+        try {
+            if (op >= tiny::Operator::Eq) { // Comparisons come after the arithmetic operators
+                return tiny::RuntimeValue::fromBool(tiny::applyComparison(op, x, y));
+            }
+
+            return tiny::applyArithmetic(op, x, y);
+        } catch (const tiny::ExecutionError &) {
+            return std::nullopt;
+        }
+    }
+
+    //! Folds a binary operation whose operands were already folded. Returns whether it changed
+    bool foldBinary(tiny::ASTNode &node, tiny::Operator op) {
+        auto lhs = node.getFirstChild();
+        auto rhs = node.getSecondChild();
+
+        auto x = toValue(*lhs);
+        auto y = toValue(*rhs);
+        if (x && y) {
+            auto result = evaluate(op, *x, *y);
+            if (!result) {
+                return false;
+            }
+
+            node = toLiteral(*result, node.meta);
+            return true;
+        }
+
+        // Identities. The literal is an integer, so it doesn't turn an integer operand into a decimal. Nothing checks
+        // the types before running, so the operand must be sure to be a number, or 'True * 1' would become True
+        switch (op) {
+        case tiny::Operator::Add:
+            if (isInteger(*rhs, 0) && isNumeric(*lhs)) {
+                replaceWith(node, lhs);
+                return true;
+            }
+
+            if (isInteger(*lhs, 0) && isNumeric(*rhs)) {
+                replaceWith(node, rhs);
+                return true;
+            }
+
+            return false;
+        case tiny::Operator::Mul:
+            if (isInteger(*rhs, 1) && isNumeric(*lhs)) {
+                replaceWith(node, lhs);
+                return true;
+            }
+
+            if (isInteger(*lhs, 1) && isNumeric(*rhs)) {
+                replaceWith(node, rhs);
+                return true;
+            }
+
+            return false;
+        case tiny::Operator::Sub:
+        case tiny::Operator::Div:
+        case tiny::Operator::Pow:
+            if (isInteger(*rhs, op == tiny::Operator::Sub ? 0 : 1) && isNumeric(*lhs)) {
+                replaceWith(node, lhs);
+                return true;
+            }
+
+            return false;
+        default:
+            return false;
+        }
+    }
+
+    //! Folds a node whose children were already folded. Returns whether it changed
+    bool foldNode(tiny::ASTNode &node) {
+        if (auto op = toOperator(node.type); op && node.children.size() == 2) {
+            return foldBinary(node, *op);
+        }
+
+        switch (node.type) {
+        case tiny::ASTNodeType::UnaryNegative: {
+            auto x = toValue(*node.getFirstChild());
+            if (!x || x->kind == tiny::ValueKind::Bool) {
+                return false;
+            }
+
+            node = toLiteral(tiny::applyNegation(*x), node.meta);
+            return true;
+        }
+        case tiny::ASTNodeType::UnaryNot: {
+            auto const &x = *node.getFirstChild();
+            if (!isBool(x)) {
+                return false;
+            }
+
+            node = toLiteral(tiny::RuntimeValue::fromBool(!std::get<bool>(x.val)), node.meta);
+            return true;
+        }
+        case tiny::ASTNodeType::LogicalAnd:
+        case tiny::ASTNodeType::LogicalOr: {
+            // The left-hand side decides whether to give it or the right-hand side. The right-hand side isn't checked
+            // when it runs, so it must be known to be a boolean, or 'True and 5' would become 5
+            auto lhs = node.getFirstChild();
+            if (!isBool(*lhs) || !isBoolean(*node.getSecondChild())) {
+                return false;
+            }
+
+            auto givesLhs = std::get<bool>(lhs->val) == (node.type == tiny::ASTNodeType::LogicalOr);
+            replaceWith(node, givesLhs ? lhs : node.getSecondChild());
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+}
+
+std::size_t tiny::ConstantFolder::fold(tiny::ASTNode &node) {
+    std::size_t folded = 0;
+    for (auto &c: node.children) {
+        folded += fold(*c);
+    }
+
+    // A node replaced by one of its operands was already folded
+    if (foldNode(node)) {
+        folded++;
+    }
+
+    return folded;
+}
+
+std::size_t tiny::ConstantFolder::fold(tiny::ASTFile &file) {
+    std::size_t folded = 0;
+    for (auto &statement: file.statements) {
+        folded += fold(statement);
+    }
+
+    return folded;
+}
+
+tiny::PipelineStage<tiny::ASTFile> tiny::ConstantFolder::stage() {
+    return {"fold", [](tiny::ASTFile file) {
+        tiny::Statistics::get().add(tiny::Counter::NodesFolded, fold(file));
+        return tiny::StageResult<tiny::ASTFile>(std::move(file));
+    }};
+}
@@ -0,0 +1,51 @@
+#ifndef TINY_FOLDING_H
+#define TINY_FOLDING_H
+
+#include <cstddef>
+
+#include "ast.h"
+#include "pipeline.h"
+
+namespace tiny {
+    /*!
+     * \brief Folds the operations over literals in ASTs, and drops the operations that leave their operand unchanged
+     *
+     * Folds the operations over literals in ASTs. Arithmetic, comparisons, logical operations, negations and '!' over
+     * integer, decimal and boolean literals are replaced by the literal they evaluate to, using the same rules as the
+     * VM: integers wrap around on overflow, integer division truncates, and mixing integers and decimals gives a
+     * decimal. Operations that would fail when run, such as a division by zero, are left as they are, so the error
+     * still happens at run time.
+     *
+     * Operations with an integer literal that leaves the other operand unchanged (x + 0, 0 + x, x - 0, x * 1, 1 * x,
+     * x / 1 and x ** 1) are replaced by the operand, as long as it's sure to be a number: a numeric literal, or an
+     * arithmetic operation or negation, which fail when run over anything else. Types aren't checked before running, so
+     * other operands keep the operation and its run-time error. So are
+     * logical operations whose left-hand side is a boolean literal, which either give it (False and x, True or x) or
+     * give the right-hand side (True and x, False or x), as long as the right-hand side is sure to be a boolean: a
+     * comparison, or a boolean literal or logical operation over those.
+     */
+    class ConstantFolder {
+    public:
+        /*!
+         * \brief Folds a node and its descendants, in place
+         * \param node The node
+         * \return The number of operations that were folded or dropped
+         */
+        static std::size_t fold(tiny::ASTNode &node);
+
+        /*!
+         * \brief Folds every statement of an AST, in place
+         * \param file The AST
+         * \return The number of operations that were folded or dropped
+         */
+        static std::size_t fold(tiny::ASTFile &file);
+
+        /*!
+         * \brief Gets the parse stage that folds every AST. Built into every Compiler
+         * \return The stage, named "fold"
+         */
+        static tiny::PipelineStage<tiny::ASTFile> stage();
+    };
+}
+
+#endif //TINY_FOLDING_H
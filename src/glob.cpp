@@ -0,0 +1,265 @@
+#include "glob.h"
+
+#include <fstream>
+
+#include "errors.h"
+#include "logger.h"
+
+tiny::Glob::Glob(std::string_view pat) : pattern(pat) {
+    if (!pat.empty() && pat.front() == '!') {
+        negated = true;
+        pat.remove_prefix(1);
+    }
+
+    if (!pat.empty() && pat.back() == '/') {
+        directoryOnly = true;
+        pat.remove_suffix(1);
+    }
+
+    // A pattern without a '/' (other than a trailing one) matches at any depth, a leading '/' anchors it to the root
+    bool anchored = pat.find('/') != std::string_view::npos;
+    if (!pat.empty() && pat.front() == '/') {
+        pat.remove_prefix(1);
+    }
+
+    if (pat.empty()) {
+        throw tiny::GlobError("Empty glob pattern '" + pattern + "'");
+    }
+
+    std::string expanded = anchored ? std::string(pat) : "**/" + std::string(pat);
+
+    std::size_t current = addState();
+    for (std::size_t i = 0; i < expanded.size(); i++) {
+        char c = expanded[i];
+
+        if (c == '*' && i + 1 < expanded.size() && expanded[i + 1] == '*') {
+            bool atStart = i == 0 || expanded[i - 1] == '/';
+            bool slashAfter = i + 2 < expanded.size() && expanded[i + 2] == '/';
+
+            if (atStart && slashAfter) {
+                // '**/': zero or more directories. Either skip it, or consume anything that ends in a '/'
+                auto inside = addState();
+                auto next = addState();
+
+                states[current].epsilons.push_back(next);
+                states[current].edges.push_back({Edge::Kind::Any, 0, 0, inside});
+                states[inside].edges.push_back({Edge::Kind::Any, 0, 0, inside});
+                states[inside].edges.push_back({Edge::Kind::Literal, '/', 0, next});
+
+                current = next;
+                i += 2;
+                continue;
+            }
+
+            // Any other '**': any sequence of characters, including '/'
+            auto next = addState();
+            states[current].epsilons.push_back(next);
+            states[next].edges.push_back({Edge::Kind::Any, 0, 0, next});
+
+            current = next;
+            i += 1;
+            continue;
+        }
+
+        if (c == '*') {
+            auto next = addState();
+            states[current].epsilons.push_back(next);
+            states[next].edges.push_back({Edge::Kind::AnyButSlash, 0, 0, next});
+
+            current = next;
+            continue;
+        }
+
+        auto next = addState();
+
+        if (c == '?') {
+            states[current].edges.push_back({Edge::Kind::AnyButSlash, 0, 0, next});
+        } else if (c == '[') {
+            CharClass cls;
+            std::size_t j = i + 1;
+
+            bool negatedClass = j < expanded.size() && (expanded[j] == '!' || expanded[j] == '^');
+            if (negatedClass) {
+                j++;
+            }
+
+            bool first = true;
+            for (; j < expanded.size() && (expanded[j] != ']' || first); j++) {
+                first = false;
+
+                unsigned char lo = expanded[j];
+                if (lo == '\\' && j + 1 < expanded.size()) {
+                    lo = expanded[++j];
+                }
+
+                unsigned char hi = lo;
+                if (j + 2 < expanded.size() && expanded[j + 1] == '-' && expanded[j + 2] != ']') {
+                    hi = expanded[j + 2];
+                    j += 2;
+                }
+
+                if (hi < lo) {
+                    throw tiny::GlobError("Invalid range in glob pattern '" + pattern + "'");
+                }
+
+                for (unsigned c2 = lo; c2 <= hi; c2++) {
+                    cls.add(c2);
+                }
+            }
+
+            if (j >= expanded.size()) {
+                throw tiny::GlobError("Unterminated character class in glob pattern '" + pattern + "'");
+            }
+
+            if (negatedClass) {
+                for (auto &b: cls.bits) {
+                    b = ~b;
+                }
+            }
+
+            // Classes never match the separator
+            cls.bits['/' / 64] &= ~(std::uint64_t(1) << ('/' % 64));
+
+            classes.push_back(cls);
+            states[current].edges.push_back({Edge::Kind::Class, 0, classes.size() - 1, next});
+            i = j;
+        } else {
+            if (c == '\\') {
+                if (i + 1 >= expanded.size()) {
+                    throw tiny::GlobError("Trailing escape in glob pattern '" + pattern + "'");
+                }
+
+                c = expanded[++i];
+            }
+
+            states[current].edges.push_back({Edge::Kind::Literal, c, 0, next});
+        }
+
+        current = next;
+    }
+
+    accept = current;
+}
+
+std::size_t tiny::Glob::addState() {
+    states.emplace_back();
+    return states.size() - 1;
+}
+
+void tiny::Glob::closure(std::vector<bool> &set, std::size_t state) const {
+    if (set[state]) {
+        return;
+    }
+
+    set[state] = true;
+    for (auto next: states[state].epsilons) {
+        closure(set, next);
+    }
+}
+
+bool tiny::Glob::matches(std::string_view path, bool isDirectory) const {
+    if (directoryOnly && !isDirectory) {
+        return false;
+    }
+
+    std::vector<bool> current(states.size(), false);
+    std::vector<bool> next(states.size(), false);
+    closure(current, 0);
+
+    for (char ch: path) {
+        auto c = static_cast<unsigned char>(ch);
+        bool any = false;
+
+        for (std::size_t s = 0; s < states.size(); s++) {
+            if (!current[s]) {
+                continue;
+            }
+
+            for (auto const &e: states[s].edges) {
+                bool ok = false;
+                switch (e.kind) {
+                case Edge::Kind::Literal:
+                    ok = e.c == ch;
+                    break;
+                case Edge::Kind::AnyButSlash:
+                    ok = ch != '/';
+                    break;
+                case Edge::Kind::Any:
+                    ok = true;
+                    break;
+                case Edge::Kind::Class:
+                    ok = classes[e.cls].has(c);
+                    break;
+                }
+
+                if (ok) {
+                    closure(next, e.target);
+                    any = true;
+                }
+            }
+        }
+
+        if (!any) {
+            return false;
+        }
+
+        current.swap(next);
+        std::fill(next.begin(), next.end(), false);
+    }
+
+    return current[accept];
+}
+
+bool tiny::Glob::isNegated() const {
+    return negated;
+}
+
+const std::string &tiny::Glob::getPattern() const {
+    return pattern;
+}
+
+tiny::IgnoreList tiny::IgnoreList::load(const std::filesystem::path &file) {
+    tiny::IgnoreList list;
+
+    std::ifstream input(file);
+    std::string line;
+    for (std::size_t number = 1; std::getline(input, line); number++) {
+        // Trailing whitespace (and the carriage return of CRLF files) isn't part of the pattern
+        auto last = line.find_last_not_of(" \t\r");
+        if (last == std::string::npos || line[0] == '#') {
+            continue;
+        }
+
+        try {
+            list.add(std::string_view(line).substr(0, last + 1));
+        } catch (const tiny::GlobError &e) {
+            // A typo in the file shouldn't stop the build, so skip the line
+            tiny::warn(file.string() + ":" + std::to_string(number) + ": " + e.msg + ". Skipping it");
+        }
+    }
+
+    return list;
+}
+
+void tiny::IgnoreList::add(std::string_view pattern) {
+    globs.emplace_back(pattern);
+}
+
+void tiny::IgnoreList::append(const tiny::IgnoreList &other) {
+    globs.insert(globs.end(), other.globs.begin(), other.globs.end());
+}
+
+bool tiny::IgnoreList::isIgnored(std::string_view path, bool isDirectory) const {
+    bool ignored = false;
+    for (auto const &g: globs) {
+        if (g.isNegated() == ignored && g.matches(path, isDirectory)) {
+            ignored = !g.isNegated();
+        }
+    }
+
+    return ignored;
+}
+
+bool tiny::IgnoreList::empty() const {
+    return globs.empty();
+}
@@ -0,0 +1,158 @@
+#ifndef TINY_GLOB_H
+#define TINY_GLOB_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tiny {
+    /*!
+     * \brief A glob pattern compiled into an automaton
+     *
+     * A glob pattern compiled into an automaton (a Thompson NFA), so matching a path is a single pass over its
+     * characters no matter how many wildcards the pattern has. Paths are matched relative to a root, with '/' as the
+     * separator. The syntax follows .gitignore:
+     *
+     *  - '*' matches any sequence of characters except '/', '?' matches any character except '/'
+     *  - '**' matches any sequence of characters including '/'. As '**' + '/' it matches zero or more directories
+     *  - '[abc]', '[a-z]' match one character of a class, '[!abc]' or '[^abc]' one character out of it
+     *  - '\\' escapes the next character
+     *  - A leading '!' negates the pattern (see IgnoreList)
+     *  - A leading '/' anchors the pattern to the root. Patterns without any other '/' match at any depth
+     *  - A trailing '/' only matches directories
+     *
+     * Throws GlobError if the pattern is malformed.
+     */
+    class Glob {
+    public:
+        /*!
+         * \brief Compiles a pattern
+         * \param pattern The pattern
+         */
+        explicit Glob(std::string_view pattern);
+
+        /*!
+         * \brief Matches a path against the pattern
+         * \param path The path, relative to the root
+         * \param isDirectory Whether the path is a directory
+         * \return True if the pattern matches the path
+         */
+        [[nodiscard]] bool matches(std::string_view path, bool isDirectory = false) const;
+
+        //! Whether the pattern started with '!'
+        [[nodiscard]] bool isNegated() const;
+
+        //! Gets the pattern the glob was compiled from
+        [[nodiscard]] const std::string &getPattern() const;
+
+    private:
+        //! What a transition of the automaton accepts
+        struct Edge {
+            enum class Kind {
+                Literal,
+                AnyButSlash,
+                Any,
+                Class
+            };
+
+            Kind kind = Kind::Literal;
+            //! The character, for Literal edges
+            char c = 0;
+            //! Index of the class, for Class edges
+            std::size_t cls = 0;
+            //! State reached by the transition
+            std::size_t target = 0;
+        };
+
+        //! A set of characters, as a bitmap over the 256 byte values
+        struct CharClass {
+            std::uint64_t bits[4] = {0, 0, 0, 0};
+
+            void add(unsigned char c) {
+                bits[c / 64] |= std::uint64_t(1) << (c % 64);
+            }
+
+            [[nodiscard]] bool has(unsigned char c) const {
+                return bits[c / 64] & (std::uint64_t(1) << (c % 64));
+            }
+        };
+
+        //! A state of the automaton
+        struct State {
+            std::vector<Edge> edges;
+            //! States reachable without consuming a character
+            std::vector<std::size_t> epsilons;
+        };
+
+        //! Adds a state and returns its index
+        std::size_t addState();
+
+        //! Adds the states reachable from a state without consuming characters to a set of states
+        void closure(std::vector<bool> &set, std::size_t state) const;
+
+        //! The source pattern
+        std::string pattern;
+        //! Whether the pattern started with '!'
+        bool negated = false;
+        //! Whether the pattern only matches directories
+        bool directoryOnly = false;
+
+        //! The automaton. State 0 is the start
+        std::vector<State> states;
+        //! The accepting state
+        std::size_t accept = 0;
+        //! The character classes used by the Class edges
+        std::vector<CharClass> classes;
+    };
+
+    /*!
+     * \brief A list of ignore patterns, such as the ones of a .tinyignore file
+     *
+     * A list of ignore patterns, such as the ones of a .tinyignore file. The patterns are checked in order and the last
+     * one to match decides: a plain pattern ignores the path, a negated one ('!') includes it again. Like in
+     * .gitignore, a path inside an ignored directory can't be included again, since the directory is never read.
+     */
+    class IgnoreList {
+    public:
+        //! Builds an empty list, which ignores nothing
+        explicit IgnoreList() = default;
+
+        /*!
+         * \brief Reads the patterns of an ignore file. Empty lines and lines starting with '#' are skipped
+         * \param file Path of the file
+         * \return The list. Empty if the file doesn't exist. Malformed patterns are left out with a warning
+         */
+        static tiny::IgnoreList load(const std::filesystem::path &file);
+
+        /*!
+         * \brief Adds a pattern at the end of the list
+         * \param pattern The pattern
+         */
+        void add(std::string_view pattern);
+
+        /*!
+         * \brief Adds the patterns of another list at the end of this one
+         * \param other The other list
+         */
+        void append(const tiny::IgnoreList &other);
+
+        /*!
+         * \brief Checks whether a path is ignored
+         * \param path The path, relative to the root
+         * \param isDirectory Whether the path is a directory
+         * \return True if the path is ignored
+         */
+        [[nodiscard]] bool isIgnored(std::string_view path, bool isDirectory) const;
+
+        //! Whether the list has no patterns
+        [[nodiscard]] bool empty() const;
+
+    private:
+        //! The patterns, in order
+        std::vector<tiny::Glob> globs;
+    };
+}
+
+#endif //TINY_GLOB_H
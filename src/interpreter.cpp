@@ -0,0 +1,717 @@
+#include "interpreter.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "errors.h"
+
+namespace {
+    //! The state of a running call
+    struct Frame {
+        //! The variables of the function, arguments first
+        tiny::RuntimeValue *slots;
+        //! Number of calls below this one
+        std::uint32_t depth = 0;
+        //! The first value returned, which is the value of a call
+        tiny::RuntimeValue result;
+        //! Where every returned value goes. Only set for the outermost call
+        std::vector<tiny::RuntimeValue> *results = nullptr;
+    };
+
+    //! Computes the value of an expression
+    using Expression = std::function<tiny::RuntimeValue(Frame &)>;
+    //! Computes a condition, which must be a boolean
+    using Condition = std::function<bool(Frame &)>;
+    //! Runs a statement. Returns whether the function returned
+    using Statement = std::function<bool(Frame &)>;
+}
+
+struct tiny::ClosureProgram::Function {
+    //! Name of the function
+    std::string name;
+    //! Number of arguments. They are the first slots of the function
+    std::uint32_t arity = 0;
+    //! Number of slots used by the function, arguments included
+    std::uint32_t slots = 0;
+    //! The body
+    Statement body;
+};
+
+namespace {
+    using Function = tiny::ClosureProgram::Function;
+
+    //! Calls of functions with up to this many slots keep them on the native stack instead of the heap
+    constexpr std::uint32_t SMALL_FRAME = 16;
+
+    //! An ExecutionError that already names the function that failed, so the callers don't rename it
+    struct LocatedError : tiny::ExecutionError {
+        using ExecutionError::ExecutionError; // Inherit the constructor
+    };
+
+    // The operands of the specialized operations. Literals are known to be numbers of their kind, so the checks on
+    // their kind fold away
+
+    struct IntLiteral {
+        std::int64_t value;
+        tiny::RuntimeValue operator()(Frame &) const { return tiny::RuntimeValue::fromInt(value); }
+    };
+
+    struct FloatLiteral {
+        double value;
+        tiny::RuntimeValue operator()(Frame &) const { return tiny::RuntimeValue::fromFloat(value); }
+    };
+
+    struct Variable {
+        std::uint32_t slot;
+        const tiny::RuntimeValue &operator()(Frame &f) const { return f.slots[slot]; }
+    };
+
+    struct Computed {
+        Expression expression;
+        tiny::RuntimeValue operator()(Frame &f) const { return expression(f); }
+    };
+
+    template<tiny::Operator op>
+    constexpr bool isArithmetic() {
+        return op == tiny::Operator::Add || op == tiny::Operator::Sub || op == tiny::Operator::Mul
+               || op == tiny::Operator::Div || op == tiny::Operator::Pow;
+    }
+
+    //! Compares two values. Integers are compared inline
+    template<tiny::Operator op>
+    bool test(const tiny::RuntimeValue &x, const tiny::RuntimeValue &y) {
+        if (x.kind != tiny::ValueKind::Int || y.kind != tiny::ValueKind::Int) {
+            return tiny::applyComparison(op, x, y);
+        }
+
+        if constexpr (op == tiny::Operator::Eq) {
+            return x.i == y.i;
+        } else if constexpr (op == tiny::Operator::Neq) {
+            return x.i != y.i;
+        } else if constexpr (op == tiny::Operator::Lt) {
+            return x.i < y.i;
+        } else if constexpr (op == tiny::Operator::Lteq) {
+            return x.i <= y.i;
+        } else if constexpr (op == tiny::Operator::Gt) {
+            return x.i > y.i;
+        } else {
+            return x.i >= y.i;
+        }
+    }
+
+    //! Applies a binary operator. Addition, subtraction, multiplication and comparisons of integers are inline
+    template<tiny::Operator op>
+    tiny::RuntimeValue apply(const tiny::RuntimeValue &x, const tiny::RuntimeValue &y) {
+        if constexpr (!isArithmetic<op>()) {
+            return tiny::RuntimeValue::fromBool(test<op>(x, y));
+        } else if constexpr (op == tiny::Operator::Div || op == tiny::Operator::Pow) {
+            return tiny::applyArithmetic(op, x, y);
+        } else {
+            if (x.kind != tiny::ValueKind::Int || y.kind != tiny::ValueKind::Int) {
+                return tiny::applyArithmetic(op, x, y);
+            }
+
+            // Unsigned arithmetic, so overflows wrap around instead of being undefined
+            auto a = std::uint64_t(x.i);
+            auto b = std::uint64_t(y.i);
+
+            if constexpr (op == tiny::Operator::Add) {
+                return tiny::RuntimeValue::fromInt(std::int64_t(a + b));
+            } else if constexpr (op == tiny::Operator::Sub) {
+                return tiny::RuntimeValue::fromInt(std::int64_t(a - b));
+            } else {
+                return tiny::RuntimeValue::fromInt(std::int64_t(a * b));
+            }
+        }
+    }
+
+    //! Runs the body of a function, naming the function in the errors it throws
+    void run(const Function &fn, Frame &frame) {
+        try {
+            fn.body(frame);
+        } catch (const LocatedError &) {
+            throw;
+        } catch (const tiny::ExecutionError &e) {
+            throw LocatedError("In '" + fn.name + "': " + e.msg);
+        }
+    }
+
+    //! Calls a function with its slots at the given address. The arguments are computed in the frame of the caller
+    tiny::RuntimeValue invoke(const Function &callee, const std::vector<Expression> &args, Frame &caller,
+                              tiny::RuntimeValue *slots) {
+        for (std::size_t i = 0; i < args.size(); i++) {
+            slots[i] = args[i](caller);
+        }
+
+        Frame frame{slots, caller.depth + 1, {}, nullptr};
+        run(callee, frame);
+        return frame.result;
+    }
+
+    //! Compiles the body of a single function
+    class FunctionCompiler {
+    public:
+        FunctionCompiler(const tiny::FunctionResolver &resolver,
+                         const std::unordered_map<std::string, const Function *> &functions, const tiny::ASTFile &file,
+                         Function &fn) : resolver(resolver), functions(functions), file(file), fn(fn) {}
+
+        void compile(const tiny::ASTNode &node) {
+            scopes.emplace_back();
+
+            for (auto const &arg: node.getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children) {
+                declare(arg->getParam(tiny::ParameterType::Name).getStringVal(arg->meta).toString(), allocate());
+            }
+
+            fn.body = block(*node.getChild(tiny::ASTNodeType::FunctionBody)->getFirstChild());
+        }
+
+    private:
+        // Slots and scopes
+
+        std::uint32_t allocate() {
+            fn.slots = std::max(fn.slots, top + 1);
+            return top++;
+        }
+
+        void declare(const std::string &name, std::uint32_t slot) {
+            scopes.back()[name] = slot;
+        }
+
+        std::uint32_t lookup(const tiny::ASTNode &id) {
+            auto name = id.getStringVal().toString();
+            for (auto scope = scopes.rbegin(); scope != scopes.rend(); scope++) {
+                if (auto it = scope->find(name); it != scope->end()) {
+                    return it->second;
+                }
+            }
+
+            throw tiny::InterpreterError("Undefined variable '" + name + "'", id.meta);
+        }
+
+        std::uint32_t assignable(const tiny::ASTNode &node) {
+            if (node.type != tiny::ASTNodeType::Identifier || !node.params.empty()) {
+                unsupported(node);
+            }
+
+            return lookup(node);
+        }
+
+        // Statements
+
+        Statement block(const tiny::ASTNode &node) {
+            // Variables of the block are released at its end
+            auto savedTop = top;
+            scopes.emplace_back();
+
+            std::vector<Statement> statements;
+            for (auto const &c: node.children) {
+                statements.push_back(statement(*c));
+            }
+
+            scopes.pop_back();
+            top = savedTop;
+
+            if (statements.size() == 1) {
+                return std::move(statements.front());
+            }
+
+            return [statements = std::move(statements)](Frame &f) {
+                for (auto const &s: statements) {
+                    if (s(f)) {
+                        return true;
+                    }
+                }
+
+                return false;
+            };
+        }
+
+        Statement statement(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::ExpressionStatement:
+                return expressionStatement(*node.getFirstChild());
+            case tiny::ASTNodeType::BlockStatement:
+                return block(node);
+            case tiny::ASTNodeType::IfStatement:
+                return ifStatement(node);
+            case tiny::ASTNodeType::ForStatement:
+                return forStatement(node);
+            case tiny::ASTNodeType::FunctionReturn:
+                return returnStatement(node);
+            default:
+                unsupported(node);
+            }
+        }
+
+        Statement expressionStatement(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::Initialization: {
+                // The value is compiled before the name is declared, so it can use a variable it shadows
+                auto value = expression(*node.getSecondChild());
+                auto slot = allocate();
+                declare(node.getFirstChild()->getStringVal().toString(), slot);
+                return assignment(slot, std::move(value));
+            }
+            case tiny::ASTNodeType::VarDeclaration: {
+                auto slot = allocate();
+                auto zero = tiny::RuntimeValue::zero(node.getFirstChild()->getStringVal().toString());
+                declare(node.getStringVal().toString(), slot);
+                return [slot, zero](Frame &f) {
+                    f.slots[slot] = zero;
+                    return false;
+                };
+            }
+            case tiny::ASTNodeType::Assignment: {
+                auto value = expression(*node.getSecondChild());
+                return assignment(assignable(*node.getFirstChild()), std::move(value));
+            }
+            case tiny::ASTNodeType::AssignmentSum:
+                return compoundAssignment<tiny::Operator::Add>(node);
+            case tiny::ASTNodeType::AssignmentSub:
+                return compoundAssignment<tiny::Operator::Sub>(node);
+            case tiny::ASTNodeType::AssignmentMulti:
+                return compoundAssignment<tiny::Operator::Mul>(node);
+            case tiny::ASTNodeType::AssignmentDiv:
+                return compoundAssignment<tiny::Operator::Div>(node);
+            default:
+                // Computed for its side effects, such as a call
+                return [value = expression(node)](Frame &f) {
+                    value(f);
+                    return false;
+                };
+            }
+        }
+
+        static Statement assignment(std::uint32_t slot, Expression value) {
+            return [slot, value = std::move(value)](Frame &f) {
+                f.slots[slot] = value(f);
+                return false;
+            };
+        }
+
+        template<tiny::Operator op>
+        Statement compoundAssignment(const tiny::ASTNode &node) {
+            auto slot = assignable(*node.getFirstChild());
+            return withOperand(*node.getSecondChild(), [slot](auto value) -> Statement {
+                return [slot, value = std::move(value)](Frame &f) {
+                    auto const &y = value(f);
+                    f.slots[slot] = apply<op>(f.slots[slot], y);
+                    return false;
+                };
+            });
+        }
+
+        Statement ifStatement(const tiny::ASTNode &node) {
+            auto test = condition(*node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild());
+            auto consequent = block(*node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild());
+
+            if (node.children.size() < 3) {
+                return [test = std::move(test), consequent = std::move(consequent)](Frame &f) {
+                    return test(f) && consequent(f);
+                };
+            }
+
+            auto alternative = block(*node.getChild(tiny::ASTNodeType::BranchAlternative)->getFirstChild());
+            return [test = std::move(test), consequent = std::move(consequent),
+                    alternative = std::move(alternative)](Frame &f) {
+                return test(f) ? consequent(f) : alternative(f);
+            };
+        }
+
+        Statement forStatement(const tiny::ASTNode &node) {
+            auto const &head = *node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild();
+            auto const &body = *node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild();
+
+            if (head.type == tiny::ASTNodeType::RangeExpression) {
+                return rangeLoop(head, body);
+            }
+
+            if (head.type == tiny::ASTNodeType::ForEachExpression) {
+                unsupported(head);
+            }
+
+            // A while loop: check the condition before every iteration
+            return [test = condition(head), body = block(body)](Frame &f) {
+                while (test(f)) {
+                    if (body(f)) {
+                        return true;
+                    }
+                }
+
+                return false;
+            };
+        }
+
+        Statement rangeLoop(const tiny::ASTNode &range, const tiny::ASTNode &body) {
+            auto from = expression(*range.getChild(tiny::ASTNodeType::RangeFromExpression)->getFirstChild());
+
+            // Open ranges have no upper bound, and the step is 1 by default
+            Expression to, step;
+            if (auto const &node = *range.getChild(tiny::ASTNodeType::RangeToExpression); !node.children.empty()) {
+                to = expression(*node.getFirstChild());
+            }
+
+            if (auto const &node = *range.getChild(tiny::ASTNodeType::RangeStepExpression); !node.children.empty()) {
+                step = expression(*node.getFirstChild());
+            }
+
+            // The counter lives in the closure, so the body can change the variable without changing the iterations
+            auto savedTop = top;
+            scopes.emplace_back();
+            auto slot = allocate();
+            declare(range.getParam(tiny::ParameterType::RangeIdentifier).getStringVal(range.meta).toString(), slot);
+            auto loop = block(body);
+            scopes.pop_back();
+            top = savedTop;
+
+            return [from = std::move(from), to = std::move(to), step = std::move(step), slot,
+                    loop = std::move(loop)](Frame &f) {
+                auto first = from(f);
+                auto limit = to ? to(f) : tiny::RuntimeValue();
+                auto increment = step ? step(f) : tiny::RuntimeValue::fromInt(1);
+
+                if (first.kind != tiny::ValueKind::Int || increment.kind != tiny::ValueKind::Int
+                    || (limit.kind != tiny::ValueKind::Int && limit.kind != tiny::ValueKind::None)) {
+                    throw tiny::ExecutionError("Ranges must be over integers");
+                }
+
+                if (increment.i == 0) {
+                    throw tiny::ExecutionError("The step of a range can't be zero");
+                }
+
+                auto open = limit.kind == tiny::ValueKind::None;
+                auto up = increment.i > 0;
+
+                for (auto i = first.i; open || (up ? i < limit.i : i > limit.i);) {
+                    f.slots[slot] = tiny::RuntimeValue::fromInt(i);
+                    if (loop(f)) {
+                        return true;
+                    }
+
+                    // Stop instead of wrapping around
+                    auto next = std::int64_t(std::uint64_t(i) + std::uint64_t(increment.i));
+                    if (up ? next < i : next > i) {
+                        break;
+                    }
+
+                    i = next;
+                }
+
+                return false;
+            };
+        }
+
+        Statement returnStatement(const tiny::ASTNode &node) {
+            std::vector<Expression> values;
+            for (auto const &c: node.children) {
+                values.push_back(expression(*c));
+            }
+
+            return [values = std::move(values)](Frame &f) {
+                // Every value is computed, but calls only see the first one
+                for (std::size_t i = 0; i < values.size(); i++) {
+                    auto value = values[i](f);
+                    if (i == 0) {
+                        f.result = value;
+                    }
+
+                    if (f.results) {
+                        f.results->push_back(value);
+                    }
+                }
+
+                return true;
+            };
+        }
+
+        // Expressions
+
+        //! Calls then with the operand specialized for the kind of node
+        template<class Then>
+        auto withOperand(const tiny::ASTNode &node, Then then) {
+            switch (node.type) {
+            case tiny::ASTNodeType::LiteralInt:
+                return then(IntLiteral{std::get<std::int64_t>(node.val)});
+            case tiny::ASTNodeType::LiteralDecimal:
+                return then(FloatLiteral{double(std::get<long double>(node.val))});
+            case tiny::ASTNodeType::Identifier:
+                if (node.params.empty()) {
+                    return then(Variable{lookup(node)});
+                }
+                break;
+            default:
+                break;
+            }
+
+            return then(Computed{expression(node)});
+        }
+
+        template<class Then>
+        auto withOperands(const tiny::ASTNode &node, Then then) {
+            return withOperand(*node.getFirstChild(), [&](auto lhs) {
+                return withOperand(*node.getSecondChild(), [&](auto rhs) {
+                    return then(std::move(lhs), std::move(rhs));
+                });
+            });
+        }
+
+        template<tiny::Operator op>
+        Expression binary(const tiny::ASTNode &node) {
+            return withOperands(node, [](auto lhs, auto rhs) -> Expression {
+                return [lhs = std::move(lhs), rhs = std::move(rhs)](Frame &f) {
+                    auto const &x = lhs(f);
+                    auto const &y = rhs(f);
+                    return apply<op>(x, y);
+                };
+            });
+        }
+
+        //! Compiles an expression used as a condition. Comparisons give their result without making a value
+        Condition condition(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::CompareEq:
+                return comparison<tiny::Operator::Eq>(node);
+            case tiny::ASTNodeType::CompareNeq:
+                return comparison<tiny::Operator::Neq>(node);
+            case tiny::ASTNodeType::CompareLt:
+                return comparison<tiny::Operator::Lt>(node);
+            case tiny::ASTNodeType::CompareLteq:
+                return comparison<tiny::Operator::Lteq>(node);
+            case tiny::ASTNodeType::CompareGt:
+                return comparison<tiny::Operator::Gt>(node);
+            case tiny::ASTNodeType::CompareGteq:
+                return comparison<tiny::Operator::Gteq>(node);
+            case tiny::ASTNodeType::LogicalAnd:
+                return [lhs = condition(*node.getFirstChild()), rhs = condition(*node.getSecondChild())](Frame &f) {
+                    return lhs(f) && rhs(f);
+                };
+            case tiny::ASTNodeType::LogicalOr:
+                return [lhs = condition(*node.getFirstChild()), rhs = condition(*node.getSecondChild())](Frame &f) {
+                    return lhs(f) || rhs(f);
+                };
+            case tiny::ASTNodeType::UnaryNot:
+                return [operand = condition(*node.getFirstChild())](Frame &f) {
+                    return !operand(f);
+                };
+            default:
+                return [value = expression(node)](Frame &f) {
+                    return tiny::toCondition(value(f));
+                };
+            }
+        }
+
+        template<tiny::Operator op>
+        Condition comparison(const tiny::ASTNode &node) {
+            return withOperands(node, [](auto lhs, auto rhs) -> Condition {
+                return [lhs = std::move(lhs), rhs = std::move(rhs)](Frame &f) {
+                    auto const &x = lhs(f);
+                    auto const &y = rhs(f);
+                    return test<op>(x, y);
+                };
+            });
+        }
+
+        Expression expression(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::LiteralInt:
+                return [value = tiny::RuntimeValue::fromInt(std::get<std::int64_t>(node.val))](Frame &) {
+                    return value;
+                };
+            case tiny::ASTNodeType::LiteralDecimal:
+                return [value = tiny::RuntimeValue::fromFloat(double(std::get<long double>(node.val)))](Frame &) {
+                    return value;
+                };
+            case tiny::ASTNodeType::LiteralBool:
+                return [value = tiny::RuntimeValue::fromBool(std::get<bool>(node.val))](Frame &) {
+                    return value;
+                };
+            case tiny::ASTNodeType::LiteralNone:
+                return [](Frame &) {
+                    return tiny::RuntimeValue();
+                };
+
+            case tiny::ASTNodeType::Identifier:
+                return [slot = assignable(node)](Frame &f) {
+                    return f.slots[slot];
+                };
+
+            case tiny::ASTNodeType::OpAddition:
+                return binary<tiny::Operator::Add>(node);
+            case tiny::ASTNodeType::OpSubtraction:
+                return binary<tiny::Operator::Sub>(node);
+            case tiny::ASTNodeType::OpMultiplication:
+                return binary<tiny::Operator::Mul>(node);
+            case tiny::ASTNodeType::OpDivision:
+                return binary<tiny::Operator::Div>(node);
+            case tiny::ASTNodeType::OpExponentiate:
+                return binary<tiny::Operator::Pow>(node);
+            case tiny::ASTNodeType::CompareEq:
+                return binary<tiny::Operator::Eq>(node);
+            case tiny::ASTNodeType::CompareNeq:
+                return binary<tiny::Operator::Neq>(node);
+            case tiny::ASTNodeType::CompareLt:
+                return binary<tiny::Operator::Lt>(node);
+            case tiny::ASTNodeType::CompareLteq:
+                return binary<tiny::Operator::Lteq>(node);
+            case tiny::ASTNodeType::CompareGt:
+                return binary<tiny::Operator::Gt>(node);
+            case tiny::ASTNodeType::CompareGteq:
+                return binary<tiny::Operator::Gteq>(node);
+
+            case tiny::ASTNodeType::UnaryNegative:
+                return withOperand(*node.getFirstChild(), [](auto operand) -> Expression {
+                    return [operand = std::move(operand)](Frame &f) {
+                        return tiny::applyNegation(operand(f));
+                    };
+                });
+            case tiny::ASTNodeType::UnaryNot:
+                return [operand = condition(*node.getFirstChild())](Frame &f) {
+                    return tiny::RuntimeValue::fromBool(!operand(f));
+                };
+
+            // The left-hand side must be a boolean, and decides whether to give it or the right-hand side
+            case tiny::ASTNodeType::LogicalAnd:
+                return [lhs = expression(*node.getFirstChild()), rhs = expression(*node.getSecondChild())](Frame &f) {
+                    auto x = lhs(f);
+                    return tiny::toCondition(x) ? rhs(f) : x;
+                };
+            case tiny::ASTNodeType::LogicalOr:
+                return [lhs = expression(*node.getFirstChild()), rhs = expression(*node.getSecondChild())](Frame &f) {
+                    auto x = lhs(f);
+                    return tiny::toCondition(x) ? x : rhs(f);
+                };
+
+            case tiny::ASTNodeType::FunctionCall:
+                return call(node);
+
+            default:
+                unsupported(node);
+            }
+        }
+
+        Expression call(const tiny::ASTNode &node) {
+            auto name = resolver.resolve<tiny::InterpreterError>(file, *node.getFirstChild());
+            auto it = functions.find(name);
+
+            auto const &nodes = node.getSecondChild()->children;
+            if (nodes.size() != it->second->arity) {
+                throw tiny::InterpreterError("Function '" + name + "' takes " + std::to_string(it->second->arity)
+                                             + " arguments, but got " + std::to_string(nodes.size()), node.meta);
+            }
+
+            std::vector<Expression> args;
+            for (auto const &arg: nodes) {
+                args.push_back(expression(*arg));
+            }
+
+            // The slots of the callee are only known once it's compiled, so they're read on every call
+            return [fn = it->second, args = std::move(args)](Frame &f) {
+                if (f.depth + 1 >= tiny::ClosureProgram::MAX_DEPTH) {
+                    throw tiny::ExecutionError("Stack overflow");
+                }
+
+                if (fn->slots <= SMALL_FRAME) {
+                    tiny::RuntimeValue slots[SMALL_FRAME];
+                    return invoke(*fn, args, f, slots);
+                }
+
+                std::vector<tiny::RuntimeValue> slots(fn->slots);
+                return invoke(*fn, args, f, slots.data());
+            };
+        }
+
+        [[noreturn]] void unsupported(const tiny::ASTNode &node) {
+            throw tiny::InterpreterError("'" + node.toString() + "' can't be interpreted", node.meta);
+        }
+
+        const tiny::FunctionResolver &resolver;
+        //! The functions by their qualified name
+        const std::unordered_map<std::string, const Function *> &functions;
+        //! The AST the function comes from, whose module and imports resolve its calls
+        const tiny::ASTFile &file;
+        Function &fn;
+
+        //! Variables by name, from the outermost to the innermost block
+        std::vector<std::unordered_map<std::string, std::uint32_t>> scopes;
+        //! The next free slot
+        std::uint32_t top = 0;
+    };
+}
+
+tiny::ClosureProgram::ClosureProgram() = default;
+tiny::ClosureProgram::~ClosureProgram() = default;
+tiny::ClosureProgram::ClosureProgram(tiny::ClosureProgram &&) noexcept = default;
+tiny::ClosureProgram &tiny::ClosureProgram::operator=(tiny::ClosureProgram &&) noexcept = default;
+
+std::int32_t tiny::ClosureProgram::find(const std::string &name) const {
+    auto qualified = resolver.find(name);
+    return qualified ? std::int32_t(byName.at(*qualified)) : -1;
+}
+
+std::vector<tiny::RuntimeValue> tiny::ClosureProgram::call(const std::string &name,
+                                                           const std::vector<tiny::RuntimeValue> &args) const {
+    auto index = find(name);
+    if (index < 0) {
+        throw tiny::ExecutionError("Undefined function '" + name + "'. Qualify it as 'module." + name
+                                   + "' if more than one module declares it");
+    }
+
+    auto const &fn = *functions[index];
+    if (args.size() != fn.arity) {
+        throw tiny::ExecutionError("Function '" + fn.name + "' takes " + std::to_string(fn.arity)
+                                   + " arguments, but got " + std::to_string(args.size()));
+    }
+
+    std::vector<tiny::RuntimeValue> slots(std::max<std::size_t>(fn.slots, 1));
+    std::copy(args.begin(), args.end(), slots.begin());
+
+    std::vector<tiny::RuntimeValue> results;
+    Frame frame{slots.data(), 0, {}, &results};
+
+    run(fn, frame);
+    return results;
+}
+
+tiny::ClosureProgram tiny::ClosureCompiler::compile(const std::vector<tiny::ASTFile> &files) {
+    tiny::ClosureProgram program;
+    std::unordered_map<std::string, const Function *> functions;
+    std::vector<std::pair<const tiny::ASTFile *, const tiny::ASTNode *>> declarations;
+
+    // Gather every function first, so calls can go to functions declared later or in other files
+    for (auto const &file: files) {
+        for (auto const &node: file.statements) {
+            switch (node.type) {
+            case tiny::ASTNodeType::StructDeclaration:
+            case tiny::ASTNodeType::TraitDeclaration:
+                continue; // Types don't run
+            case tiny::ASTNodeType::FunctionDeclaration:
+                break;
+            default:
+                throw tiny::InterpreterError("'" + node.toString() + "' can't be interpreted", node.meta);
+            }
+
+            auto name = node.getParam(tiny::ParameterType::Name).getStringVal(node.meta).toString();
+            if (!program.resolver.declare(file.mod.toString(), name)) {
+                throw tiny::InterpreterError("Function '" + name + "' is defined more than once in module '"
+                                             + file.mod.toString() + "'", node.meta);
+            }
+
+            auto fn = std::make_unique<Function>();
+            fn->name = tiny::FunctionResolver::qualify(file.mod.toString(), name);
+            fn->arity = std::uint32_t(node.getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children.size());
+
+            functions[fn->name] = fn.get();
+            program.byName[fn->name] = std::uint32_t(program.functions.size());
+            program.functions.push_back(std::move(fn));
+            declarations.emplace_back(&file, &node);
+        }
+    }
+
+    for (std::size_t i = 0; i < declarations.size(); i++) {
+        auto const &[file, node] = declarations[i];
+        FunctionCompiler(program.resolver, functions, *file, *program.functions[i]).compile(*node);
+    }
+
+    return program;
+}
@@ -0,0 +1,91 @@
+#ifndef TINY_INTERPRETER_H
+#define TINY_INTERPRETER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ast.h"
+#include "resolver.h"
+#include "value.h"
+
+namespace tiny {
+    /*!
+     * \brief A set of functions compiled into closures, ready to be run
+     *
+     * A set of functions compiled into closures, ready to be run. Every node of the ASTs became a C++ closure bound to
+     * its children, the slots of its variables and the functions it calls, so running a function just calls closures,
+     * without looking at the nodes or any name again. Programs can run any number of calls, from any thread.
+     *
+     * Values behave as in the VM: integers wrap around on overflow, integer division truncates, and errors such as a
+     * division by zero or a non-boolean condition throw ExecutionError.
+     */
+    class ClosureProgram {
+    public:
+        ClosureProgram();
+        ~ClosureProgram();
+        ClosureProgram(ClosureProgram &&) noexcept;
+        ClosureProgram &operator=(ClosureProgram &&) noexcept;
+
+        /*!
+         * \brief Runs a function
+         * \param name Name of the function. See find()
+         * \param args The arguments
+         * \return The values returned by the function
+         *
+         * Runs a function. Throws ExecutionError if the name doesn't pick a single function, the number of arguments
+         * doesn't match, or the program fails while running.
+         */
+        std::vector<tiny::RuntimeValue> call(const std::string &name,
+                                             const std::vector<tiny::RuntimeValue> &args) const;
+
+        /*!
+         * \brief Finds a function by its name
+         * \param name The qualified name, or the bare name if only one module declares a function with that name
+         * \return The index of the function, or -1 if the name doesn't pick a single function
+         */
+        [[nodiscard]] std::int32_t find(const std::string &name) const;
+
+        //! Maximum number of nested calls. Calls run on the native stack, so it's kept well below its size
+        static constexpr std::uint32_t MAX_DEPTH = 1000;
+
+        //! A compiled function. Defined by the interpreter
+        struct Function;
+
+    private:
+        friend class ClosureCompiler;
+
+        //! The functions, in declaration order. Closures point to the functions they call, so they never move
+        std::vector<std::unique_ptr<Function>> functions;
+        //! The modules of the functions
+        tiny::FunctionResolver resolver;
+        //! Maps qualified names to the index of their function
+        std::unordered_map<std::string, std::uint32_t> byName;
+    };
+
+    /*!
+     * \brief Compiles ASTs into closures, a tier that starts faster than bytecode
+     *
+     * Compiles the function declarations of a set of ASTs into closures. It accepts the same subset of the language as
+     * the BytecodeCompiler, but makes a single pass over the ASTs with no register allocation or jump patching, so it's
+     * the cheaper tier to start for programs that only run briefly. Variables are resolved to slots of their function
+     * at compile time, and operations over a literal or a variable get closures specialized for that operand, so the
+     * common integer cases don't go through any other closure.
+     */
+    class ClosureCompiler {
+    public:
+        /*!
+         * \brief Compiles the functions of a set of ASTs
+         * \param files The ASTs. Functions can call the functions of their module and of the modules it imports
+         * \return The program
+         *
+         * Compiles the functions of a set of ASTs. Calls are resolved by the FunctionResolver, like in bytecode. Throws
+         * InterpreterError if a node can't be compiled, or if a name is undefined, ambiguous or redefined in its module.
+         */
+        static tiny::ClosureProgram compile(const std::vector<tiny::ASTFile> &files);
+    };
+}
+
+#endif //TINY_INTERPRETER_H
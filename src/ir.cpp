@@ -0,0 +1,755 @@
+#include "ir.h"
+
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    //! Prints an operand, such as "%3"
+    std::string value(const tiny::IRInstruction *ins) {
+        return "%" + std::to_string(ins->id);
+    }
+
+    //! Prints a block label, such as "bb2"
+    std::string label(const tiny::IRBlock *block) {
+        return "bb" + std::to_string(block->id);
+    }
+
+    //! Prints a single instruction, without indentation
+    std::string print(const tiny::IRInstruction &ins) {
+        std::ostringstream out;
+        if (!ins.type.isVoid()) {
+            out << value(&ins) << " = ";
+        }
+
+        out << tiny::toString(ins.op);
+        if (!ins.type.isVoid()) {
+            out << " " << ins.type.toString();
+        }
+
+        switch (ins.op) {
+        case tiny::IROp::Const:
+            out << " " << (ins.type.isPointer() ? "null" : ins.constant.toString());
+            return out.str();
+        case tiny::IROp::Arg:
+            out << " " << ins.constant.i;
+            return out.str();
+        case tiny::IROp::Phi:
+            for (std::size_t i = 0; i < ins.operands.size(); i++) {
+                out << (i == 0 ? " [" : ", [") << value(ins.operands[i]) << ", "
+                    << (i < ins.targets.size() ? label(ins.targets[i]) : "?") << "]";
+            }
+
+            return out.str();
+        case tiny::IROp::Call:
+            out << " @" << ins.callee << "(";
+            for (std::size_t i = 0; i < ins.operands.size(); i++) {
+                out << (i == 0 ? "" : ", ") << value(ins.operands[i]);
+            }
+
+            out << ")";
+            return out.str();
+        default:
+            break;
+        }
+
+        auto separator = " ";
+        for (auto const *operand: ins.operands) {
+            out << separator << value(operand);
+            separator = ", ";
+        }
+
+        for (auto const *target: ins.targets) {
+            out << separator << label(target);
+            separator = ", ";
+        }
+
+        return out.str();
+    }
+
+    //! Checks a single function of a module
+    class Verifier {
+    public:
+        Verifier(const tiny::IRModule &module, const tiny::IRFunction &fn, std::vector<std::string> &problems)
+                : module(module), fn(fn), problems(problems) {}
+
+        void verify() {
+            if (fn.blocks.empty()) {
+                problems.push_back("'" + fn.name + "' has no blocks");
+                return;
+            }
+
+            for (auto const &block: fn.blocks) {
+                blocks.insert(block.get());
+                for (auto const &ins: block->instructions) {
+                    defined.insert(ins.get());
+                }
+            }
+
+            // Dominance is only meaningful once every block has consistent edges
+            auto consistent = true;
+            for (auto const &block: fn.blocks) {
+                consistent = structure(*block) && consistent;
+            }
+
+            if (!fn.blocks.front()->predecessors.empty()) {
+                report(*fn.blocks.front(), "The entry block can't have predecessors");
+                consistent = false;
+            }
+
+            for (auto const &block: fn.blocks) {
+                for (auto const &ins: block->instructions) {
+                    if (broken.count(ins.get()) == 0) {
+                        types(*block, *ins);
+                    }
+                }
+            }
+
+            if (consistent) {
+                dominance();
+            }
+        }
+
+    private:
+        void report(const tiny::IRBlock &block, const std::string &problem) {
+            problems.push_back("'" + fn.name + "', " + label(&block) + ": " + problem);
+        }
+
+        void report(const tiny::IRInstruction &ins, const std::string &problem) {
+            problems.push_back("'" + fn.name + "', " + label(ins.block) + ", '" + print(ins) + "': " + problem);
+        }
+
+        //! Checks terminators, phis and edges. Returns whether the edges of the block can be trusted
+        bool structure(const tiny::IRBlock &block) {
+            auto valid = true;
+            if (block.instructions.empty() || !block.instructions.back()->isTerminator()) {
+                report(block, "The block doesn't end with a terminator");
+                valid = false;
+            }
+
+            auto phis = true;
+            for (std::size_t i = 0; i < block.instructions.size(); i++) {
+                auto const &ins = *block.instructions[i];
+                if (ins.block != &block) {
+                    report(ins, "The instruction doesn't point to its block");
+                    valid = false;
+                }
+
+                if (ins.isTerminator() && i + 1 < block.instructions.size()) {
+                    report(ins, "Terminators must be the last instruction of their block");
+                    valid = false;
+                }
+
+                if (ins.op == tiny::IROp::Phi && !phis) {
+                    report(ins, "Phis must come before every other instruction of their block");
+                }
+
+                phis = phis && ins.op == tiny::IROp::Phi;
+
+                // Dangling operands and targets can't even be printed
+                for (auto const *target: ins.targets) {
+                    if (blocks.count(target) == 0) {
+                        report(block, "A target of instruction " + std::to_string(i) + " isn't in the function");
+                        broken.insert(&ins);
+                        valid = false;
+                    }
+                }
+
+                for (auto const *operand: ins.operands) {
+                    if (defined.count(operand) == 0) {
+                        report(block, "An operand of instruction " + std::to_string(i) + " isn't in the function");
+                        broken.insert(&ins);
+                        valid = false;
+                    }
+                }
+            }
+
+            if (!valid) {
+                return false;
+            }
+
+            // The predecessors are exactly the blocks that jump here, counting a block once per edge
+            std::vector<const tiny::IRBlock *> expected;
+            for (auto const &other: fn.blocks) {
+                for (auto const *successor: other->successors()) {
+                    if (successor == &block) {
+                        expected.push_back(other.get());
+                    }
+                }
+            }
+
+            std::vector<const tiny::IRBlock *> actual(block.predecessors.begin(), block.predecessors.end());
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            if (expected != actual) {
+                report(block, "The predecessors don't match the blocks that jump to it");
+                return false;
+            }
+
+            for (auto const &ins: block.instructions) {
+                if (ins->op != tiny::IROp::Phi) {
+                    break;
+                }
+
+                std::vector<const tiny::IRBlock *> incoming(ins->targets.begin(), ins->targets.end());
+                std::sort(incoming.begin(), incoming.end());
+                if (ins->operands.size() != ins->targets.size() || incoming != actual) {
+                    report(*ins, "Phis need an operand for every predecessor");
+                    valid = false;
+                }
+            }
+
+            return valid;
+        }
+
+        //! Checks that the operands and result of an instruction have the types of its operation
+        void types(const tiny::IRBlock &block, const tiny::IRInstruction &ins) {
+            auto const &ops = ins.operands;
+            auto operands = [&](std::size_t count) {
+                if (ops.size() != count) {
+                    report(ins, "Expected " + std::to_string(count) + " operands");
+                    return false;
+                }
+
+                return true;
+            };
+
+            auto targets = [&](std::size_t count) {
+                if (ins.targets.size() != count) {
+                    report(ins, "Expected " + std::to_string(count) + " targets");
+                }
+            };
+
+            auto expect = [&](bool condition, const std::string &problem) {
+                if (!condition) {
+                    report(ins, problem);
+                }
+            };
+
+            // Narrower integers have to be widened before arithmetic
+            auto wide = [](const tiny::IRType &type) {
+                return type == tiny::IRType{tiny::IRTypeKind::Int} || type == tiny::IRType{tiny::IRTypeKind::Float};
+            };
+
+            switch (ins.op) {
+            case tiny::IROp::Const:
+                operands(0);
+                expect(!ins.type.isVoid(), "Constants need a type");
+                if (!ins.type.isPointer()) {
+                    auto kind = ins.constant.kind;
+                    expect((ins.type.kind == tiny::IRTypeKind::Int && kind == tiny::ValueKind::Int)
+                           || (ins.type.kind == tiny::IRTypeKind::Float && kind == tiny::ValueKind::Float)
+                           || (ins.type.kind == tiny::IRTypeKind::Bool && kind == tiny::ValueKind::Bool),
+                           "The constant doesn't have the type of the instruction");
+                }
+
+                break;
+            case tiny::IROp::Arg:
+                operands(0);
+                expect(&block == fn.blocks.front().get(), "Arguments must be in the entry block");
+                expect(ins.constant.kind == tiny::ValueKind::Int && ins.constant.i >= 0
+                       && std::size_t(ins.constant.i) < fn.params.size()
+                       && fn.params[std::size_t(ins.constant.i)] == ins.type,
+                       "The argument doesn't match the parameters of the function");
+                break;
+            case tiny::IROp::Add:
+            case tiny::IROp::Sub:
+            case tiny::IROp::Mul:
+            case tiny::IROp::Div:
+            case tiny::IROp::Pow:
+                if (operands(2)) {
+                    expect(wide(ins.type) && ops[0]->type == ins.type && ops[1]->type == ins.type,
+                           "Arithmetic needs two f64 or two i64, of the type of its result");
+                }
+
+                break;
+            case tiny::IROp::Neg:
+                if (operands(1)) {
+                    expect(wide(ins.type) && ops[0]->type == ins.type, "Negations need an f64 or an i64");
+                }
+
+                break;
+            case tiny::IROp::Not:
+                if (operands(1)) {
+                    expect(ins.type == tiny::IRType{tiny::IRTypeKind::Bool} && ops[0]->type == ins.type,
+                           "'not' needs a boolean");
+                }
+
+                break;
+            case tiny::IROp::Eq:
+            case tiny::IROp::Neq:
+            case tiny::IROp::Lt:
+            case tiny::IROp::Lteq:
+            case tiny::IROp::Gt:
+            case tiny::IROp::Gteq:
+                if (operands(2)) {
+                    auto ordered = ins.op != tiny::IROp::Eq && ins.op != tiny::IROp::Neq;
+                    expect(ins.type == tiny::IRType{tiny::IRTypeKind::Bool} && ops[0]->type == ops[1]->type
+                           && !ops[0]->type.isVoid() && (!ops[0]->type.isNumber() || wide(ops[0]->type))
+                           && (!ordered || ops[0]->type.isNumber()),
+                           "Comparisons need two operands of the same type and give a boolean. Numbers must be f64 or "
+                           "i64");
+                }
+
+                break;
+            case tiny::IROp::IntToFloat:
+                if (operands(1)) {
+                    expect(ops[0]->type == tiny::IRType{tiny::IRTypeKind::Int}
+                           && ins.type == tiny::IRType{tiny::IRTypeKind::Float},
+                           "Conversions turn an i64 into an f64");
+                }
+
+                break;
+            case tiny::IROp::IntCast:
+                if (operands(1)) {
+                    expect(ops[0]->type.isInteger() && ins.type.isInteger(), "Casts turn an integer into another one");
+                }
+
+                break;
+            case tiny::IROp::Alloca:
+                operands(0);
+                expect(ins.type.isPointer(), "Allocations give a pointer");
+                break;
+            case tiny::IROp::Load:
+                if (operands(1)) {
+                    expect(ops[0]->type.isPointer() && ops[0]->type.pointee() == ins.type,
+                           "Loads read a pointer into a value of the type it points to");
+                }
+
+                break;
+            case tiny::IROp::Store:
+                if (operands(2)) {
+                    expect(ins.type.isVoid() && ops[0]->type.isPointer() && ops[0]->type.pointee() == ops[1]->type,
+                           "Stores write a value of the type the pointer points to");
+                }
+
+                break;
+            case tiny::IROp::Phi:
+                expect(!ins.type.isVoid(), "Phis need a type");
+                for (auto const *operand: ops) {
+                    expect(operand->type == ins.type, "Every operand of a phi needs its type");
+                }
+
+                break;
+            case tiny::IROp::Call: {
+                auto const *callee = module.find(ins.callee);
+                if (callee == nullptr) {
+                    report(ins, "No such function");
+                    break;
+                }
+
+                auto matches = ops.size() == callee->params.size();
+                for (std::size_t i = 0; matches && i < ops.size(); i++) {
+                    matches = ops[i]->type == callee->params[i];
+                }
+
+                expect(matches, "The arguments don't match the parameters of '" + ins.callee + "'");
+                expect(ins.type == (callee->results.empty() ? tiny::IRType() : callee->results.front()),
+                       "Calls give the first result of their function");
+                break;
+            }
+            case tiny::IROp::Jump:
+                operands(0);
+                targets(1);
+                break;
+            case tiny::IROp::Branch:
+                if (operands(1)) {
+                    expect(ops[0]->type == tiny::IRType{tiny::IRTypeKind::Bool}, "Branches need a boolean");
+                }
+
+                targets(2);
+                break;
+            case tiny::IROp::Return: {
+                auto matches = ops.size() == fn.results.size();
+                for (std::size_t i = 0; matches && i < ops.size(); i++) {
+                    matches = ops[i]->type == fn.results[i];
+                }
+
+                expect(matches, "The values don't match the results of the function");
+                break;
+            }
+            }
+
+            if (ins.op != tiny::IROp::Phi && ins.op != tiny::IROp::Branch && ins.op != tiny::IROp::Jump) {
+                expect(ins.targets.empty(), "Only phis and jumps have targets");
+            }
+        }
+
+        //! Checks that every value dominates its uses. Uses in unreachable blocks aren't checked
+        void dominance() {
+            auto idom = fn.dominators();
+            std::unordered_map<const tiny::IRBlock *, std::size_t> index;
+            std::unordered_map<const tiny::IRInstruction *, std::size_t> position;
+            for (std::size_t i = 0; i < fn.blocks.size(); i++) {
+                index[fn.blocks[i].get()] = i;
+                for (std::size_t j = 0; j < fn.blocks[i]->instructions.size(); j++) {
+                    position[fn.blocks[i]->instructions[j].get()] = j;
+                }
+            }
+
+            auto reachable = [&](const tiny::IRBlock *block) {
+                return block == fn.blocks.front().get() || idom[index[block]] != nullptr;
+            };
+
+            auto dominates = [&](const tiny::IRBlock *a, const tiny::IRBlock *b) {
+                for (auto const *block = b; block != nullptr; block = idom[index[block]]) {
+                    if (block == a) {
+                        return true;
+                    }
+                }
+
+                return false;
+            };
+
+            for (auto const &block: fn.blocks) {
+                if (!reachable(block.get())) {
+                    continue;
+                }
+
+                for (auto const &ins: block->instructions) {
+                    for (std::size_t i = 0; i < ins->operands.size(); i++) {
+                        auto const *def = ins->operands[i];
+
+                        // Phis use their operands at the end of the block they come from
+                        auto const *use = ins->op == tiny::IROp::Phi ? ins->targets[i] : block.get();
+                        if (!reachable(use)) {
+                            continue;
+                        }
+
+                        auto valid = def->block == use
+                                     ? ins->op == tiny::IROp::Phi || position[def] < position[ins.get()]
+                                     : dominates(def->block, use);
+
+                        if (!valid) {
+                            report(*ins, value(def) + " doesn't dominate its use");
+                        }
+                    }
+                }
+            }
+        }
+
+        const tiny::IRModule &module;
+        const tiny::IRFunction &fn;
+        std::vector<std::string> &problems;
+
+        std::unordered_set<const tiny::IRBlock *> blocks;
+        std::unordered_set<const tiny::IRInstruction *> defined;
+        //! Instructions with dangling operands or targets
+        std::unordered_set<const tiny::IRInstruction *> broken;
+    };
+}
+
+std::string tiny::IRType::toString() const {
+    std::string name;
+    switch (kind) {
+    case tiny::IRTypeKind::Void:
+        name = "void";
+        break;
+    case tiny::IRTypeKind::Bool:
+        name = "bool";
+        break;
+    case tiny::IRTypeKind::Int:
+        name = (isUnsigned ? "u" : "i") + std::to_string(bits);
+        break;
+    case tiny::IRTypeKind::Float:
+        name = "f64";
+        break;
+    }
+
+    return std::string(pointers, '*') + name;
+}
+
+tiny::IRType tiny::IRType::fromName(const std::string &name, std::uint8_t pointers) {
+    if (name.rfind("float", 0) == 0) {
+        return {tiny::IRTypeKind::Float, pointers};
+    }
+
+    if (name == "bool") {
+        return {tiny::IRTypeKind::Bool, pointers};
+    }
+
+    auto isUnsigned = name.rfind("uint", 0) == 0;
+    if (name.rfind("int", 0) == 0 || isUnsigned) {
+        auto width = name.substr(isUnsigned ? 4 : 3);
+        if (width == "8" || width == "16" || width == "32" || width == "64") {
+            return {tiny::IRTypeKind::Int, pointers, std::uint8_t(std::stoi(width)), isUnsigned};
+        }
+    }
+
+    return {};
+}
+
+std::string tiny::toString(tiny::IROp op) {
+    switch (op) {
+    case tiny::IROp::Const:
+        return "const";
+    case tiny::IROp::Arg:
+        return "arg";
+    case tiny::IROp::Add:
+        return "add";
+    case tiny::IROp::Sub:
+        return "sub";
+    case tiny::IROp::Mul:
+        return "mul";
+    case tiny::IROp::Div:
+        return "div";
+    case tiny::IROp::Pow:
+        return "pow";
+    case tiny::IROp::Neg:
+        return "neg";
+    case tiny::IROp::Not:
+        return "not";
+    case tiny::IROp::Eq:
+        return "eq";
+    case tiny::IROp::Neq:
+        return "neq";
+    case tiny::IROp::Lt:
+        return "lt";
+    case tiny::IROp::Lteq:
+        return "lteq";
+    case tiny::IROp::Gt:
+        return "gt";
+    case tiny::IROp::Gteq:
+        return "gteq";
+    case tiny::IROp::IntToFloat:
+        return "inttofloat";
+    case tiny::IROp::IntCast:
+        return "intcast";
+    case tiny::IROp::Alloca:
+        return "alloca";
+    case tiny::IROp::Load:
+        return "load";
+    case tiny::IROp::Store:
+        return "store";
+    case tiny::IROp::Phi:
+        return "phi";
+    case tiny::IROp::Call:
+        return "call";
+    case tiny::IROp::Jump:
+        return "jmp";
+    case tiny::IROp::Branch:
+        return "br";
+    case tiny::IROp::Return:
+        return "ret";
+    }
+
+    return "unknown";
+}
+
+tiny::IRInstruction *tiny::IRBlock::terminator() const {
+    if (instructions.empty() || !instructions.back()->isTerminator()) {
+        return nullptr;
+    }
+
+    return instructions.back().get();
+}
+
+std::vector<tiny::IRBlock *> tiny::IRBlock::successors() const {
+    auto const *last = terminator();
+    return last == nullptr ? std::vector<tiny::IRBlock *>() : last->targets;
+}
+
+tiny::IRInstruction *tiny::IRBlock::append(tiny::IROp op, tiny::IRType type,
+                                           std::vector<tiny::IRInstruction *> operands) {
+    auto ins = std::make_unique<tiny::IRInstruction>();
+    ins->op = op;
+    ins->type = type;
+    ins->operands = std::move(operands);
+    ins->block = this;
+
+    instructions.push_back(std::move(ins));
+    return instructions.back().get();
+}
+
+tiny::IRInstruction *tiny::IRBlock::prepend(tiny::IROp op, tiny::IRType type) {
+    auto ins = std::make_unique<tiny::IRInstruction>();
+    ins->op = op;
+    ins->type = type;
+    ins->block = this;
+
+    // Keep instructions of the same operation in the order they were added
+    auto at = std::find_if(instructions.begin(), instructions.end(), [op](const auto &other) {
+        return other->op != tiny::IROp::Phi && other->op != tiny::IROp::Arg && other->op != op;
+    });
+
+    return instructions.insert(at, std::move(ins))->get();
+}
+
+tiny::IRBlock *tiny::IRFunction::addBlock() {
+    blocks.push_back(std::make_unique<tiny::IRBlock>());
+    blocks.back()->id = std::uint32_t(blocks.size() - 1);
+    return blocks.back().get();
+}
+
+void tiny::IRFunction::renumber() {
+    std::uint32_t next = 0;
+    for (std::size_t i = 0; i < blocks.size(); i++) {
+        blocks[i]->id = std::uint32_t(i);
+        for (auto &ins: blocks[i]->instructions) {
+            ins->id = ins->type.isVoid() ? 0 : next++;
+        }
+    }
+}
+
+std::size_t tiny::IRFunction::replaceUses(const tiny::IRInstruction *value, tiny::IRInstruction *replacement) {
+    std::size_t replaced = 0;
+    for (auto &block: blocks) {
+        for (auto &ins: block->instructions) {
+            for (auto &operand: ins->operands) {
+                if (operand == value) {
+                    operand = replacement;
+                    replaced++;
+                }
+            }
+        }
+    }
+
+    return replaced;
+}
+
+std::vector<tiny::IRBlock *> tiny::IRFunction::dominators() const {
+    // "A Simple, Fast Dominance Algorithm" (Cooper, Harvey and Kennedy), over the reverse postorder of the blocks
+    std::unordered_map<const tiny::IRBlock *, std::size_t> index;
+    for (std::size_t i = 0; i < blocks.size(); i++) {
+        index[blocks[i].get()] = i;
+    }
+
+    constexpr auto NONE = std::size_t(-1);
+    std::vector<std::size_t> postorder(blocks.size(), NONE);
+    std::vector<std::size_t> order;
+    std::vector<bool> visited(blocks.size(), false);
+    std::vector<std::pair<std::size_t, std::size_t>> stack; // Block, and next successor to visit
+
+    if (!blocks.empty()) {
+        stack.emplace_back(0, 0);
+        visited[0] = true;
+    }
+
+    while (!stack.empty()) {
+        auto &[block, next] = stack.back();
+        auto successors = blocks[block]->successors();
+        if (next < successors.size()) {
+            auto successor = index[successors[next++]];
+            if (!visited[successor]) {
+                visited[successor] = true;
+                stack.emplace_back(successor, 0);
+            }
+
+            continue;
+        }
+
+        postorder[block] = order.size();
+        order.push_back(block);
+        stack.pop_back();
+    }
+
+    std::vector<std::size_t> idom(blocks.size(), NONE);
+    if (!blocks.empty()) {
+        idom[0] = 0;
+    }
+
+    auto intersect = [&](std::size_t a, std::size_t b) {
+        while (a != b) {
+            while (postorder[a] < postorder[b]) {
+                a = idom[a];
+            }
+
+            while (postorder[b] < postorder[a]) {
+                b = idom[b];
+            }
+        }
+
+        return a;
+    };
+
+    for (auto changed = true; changed;) {
+        changed = false;
+        for (auto it = order.rbegin(); it != order.rend(); it++) {
+            if (*it == 0) {
+                continue;
+            }
+
+            auto dominator = NONE;
+            for (auto const *pred: blocks[*it]->predecessors) {
+                auto p = index[pred];
+                if (idom[p] != NONE) {
+                    dominator = dominator == NONE ? p : intersect(p, dominator);
+                }
+            }
+
+            if (idom[*it] != dominator) {
+                idom[*it] = dominator;
+                changed = true;
+            }
+        }
+    }
+
+    std::vector<tiny::IRBlock *> result(blocks.size(), nullptr);
+    for (std::size_t i = 1; i < blocks.size(); i++) {
+        if (idom[i] != NONE) {
+            result[i] = blocks[idom[i]].get();
+        }
+    }
+
+    return result;
+}
+
+std::string tiny::IRFunction::toString() const {
+    std::ostringstream out;
+    out << "func " << name << "(";
+    for (std::size_t i = 0; i < params.size(); i++) {
+        out << (i == 0 ? "" : ", ") << params[i].toString();
+    }
+
+    out << ")";
+    if (results.size() == 1) {
+        out << " -> " << results.front().toString();
+    } else if (results.size() > 1) {
+        out << " -> (";
+        for (std::size_t i = 0; i < results.size(); i++) {
+            out << (i == 0 ? "" : ", ") << results[i].toString();
+        }
+
+        out << ")";
+    }
+
+    out << " {\n";
+    for (auto const &block: blocks) {
+        out << label(block.get()) << ":\n";
+        for (auto const &ins: block->instructions) {
+            out << "    " << print(*ins) << "\n";
+        }
+    }
+
+    out << "}\n";
+    return out.str();
+}
+
+const tiny::IRFunction *tiny::IRModule::find(const std::string &name) const {
+    for (auto const &fn: functions) {
+        if (fn.name == name) {
+            return &fn;
+        }
+    }
+
+    return nullptr;
+}
+
+std::vector<std::string> tiny::IRModule::verify() const {
+    std::vector<std::string> problems;
+    for (auto const &fn: functions) {
+        Verifier(*this, fn, problems).verify();
+    }
+
+    return problems;
+}
+
+std::string tiny::IRModule::toString() const {
+    std::string dump;
+    for (auto const &fn: functions) {
+        dump += (dump.empty() ? "" : "\n") + fn.toString();
+    }
+
+    return dump;
+}
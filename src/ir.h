@@ -0,0 +1,266 @@
+#ifndef TINY_IR_H
+#define TINY_IR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "value.h"
+
+namespace tiny {
+    //! The kinds of values of the IR
+    enum class IRTypeKind : std::uint8_t {
+        //! No value, given by instructions such as stores, jumps or calls to functions that return nothing
+        Void,
+        Bool,
+        //! An integer, of the width and signedness of its type
+        Int,
+        //! A 64 bits floating point number
+        Float,
+    };
+
+    /*!
+     * \brief The type of an IR value: a kind, behind any number of pointers
+     *
+     * The type of an IR value: a kind, behind any number of pointers. Integers keep the width and signedness they're
+     * declared with, but arithmetic and comparisons only take i64, the integers of the VM, so narrower integers are
+     * widened with IntCast when they're read, and narrowed when they're written to arguments or memory of their type.
+     */
+    struct IRType {
+        tiny::IRTypeKind kind = tiny::IRTypeKind::Void;
+        //! How many pointers are in front of the kind. 0 for plain values
+        std::uint8_t pointers = 0;
+        //! The width of an integer, in bits
+        std::uint8_t bits = 64;
+        bool isUnsigned = false;
+
+        [[nodiscard]] bool isVoid() const { return kind == tiny::IRTypeKind::Void && pointers == 0; }
+        [[nodiscard]] bool isInteger() const { return pointers == 0 && kind == tiny::IRTypeKind::Int; }
+        [[nodiscard]] bool isNumber() const {
+            return isInteger() || (pointers == 0 && kind == tiny::IRTypeKind::Float);
+        }
+        [[nodiscard]] bool isPointer() const { return pointers > 0; }
+
+        //! Gets the type of a pointer to this type
+        [[nodiscard]] tiny::IRType pointer() const { return {kind, std::uint8_t(pointers + 1), bits, isUnsigned}; }
+        //! Gets the type this pointer points to
+        [[nodiscard]] tiny::IRType pointee() const { return {kind, std::uint8_t(pointers - 1), bits, isUnsigned}; }
+
+        bool operator==(const tiny::IRType &other) const {
+            return kind == other.kind && pointers == other.pointers && bits == other.bits
+                   && isUnsigned == other.isUnsigned;
+        }
+        bool operator!=(const tiny::IRType &other) const { return !(*this == other); }
+
+        /*!
+         * \brief Gets the type as it's printed
+         * \return "void", "bool", "f64", or an integer such as "i32" or "u8", with a '*' in front for every pointer
+         * (for example "*i64")
+         */
+        [[nodiscard]] std::string toString() const;
+
+        /*!
+         * \brief Gets the type of a type name of the language
+         * \param name The name, such as "int32" or "float64"
+         * \param pointers How many pointers are in front of it
+         * \return The type. Integers keep their width and signedness, and decimals of every width become Float. Void
+         * if there's no such IR type
+         */
+        static tiny::IRType fromName(const std::string &name, std::uint8_t pointers = 0);
+    };
+
+    //! The operations of IR instructions
+    enum class IROp : std::uint8_t {
+        //! A constant. Pointer constants are always null
+        Const,
+        //! An argument of the function
+        Arg,
+        //! Arithmetic over two f64 or two i64. Integers wrap around and their division truncates
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Pow,
+        //! Arithmetic negation of an f64 or an i64
+        Neg,
+        //! Logical negation of a boolean
+        Not,
+        //! Comparisons of two operands of the same type. f64 and i64 compare in every way, others only for equality
+        Eq,
+        Neq,
+        Lt,
+        Lteq,
+        Gt,
+        Gteq,
+        //! Converts an i64 into an f64
+        IntToFloat,
+        //! Converts an integer into another width or signedness. Narrowing keeps the low bits, and widening extends the
+        //! sign of signed integers
+        IntCast,
+        //! Reserves a slot in the frame of the function, whose address is the result
+        Alloca,
+        //! Reads the value an address points to
+        Load,
+        //! Writes its second operand where its first operand, an address, points to
+        Store,
+        //! Picks the operand that comes from the block the function came from. Only at the start of blocks
+        Phi,
+        //! Calls a function with the operands as arguments. Gives its first result, if any
+        Call,
+        //! Terminator. Jumps to its only target
+        Jump,
+        //! Terminator. Jumps to its first target if its operand is true, and to its second one otherwise
+        Branch,
+        //! Terminator. Returns its operands
+        Return,
+    };
+
+    /*!
+     * \brief Gets the name of an operation
+     * \param op The operation
+     * \return The name as it's printed, in lowercase (for example IROp::IntToFloat will become "inttofloat")
+     */
+    [[nodiscard]] std::string toString(tiny::IROp op);
+
+    struct IRBlock;
+
+    //! An instruction. Instructions are their own result, so operands point to the instructions that compute them
+    struct IRInstruction {
+        tiny::IROp op;
+        //! Type of the result. Void if there's none
+        tiny::IRType type;
+        //! Numbers the values of a function, in the order they're printed
+        std::uint32_t id = 0;
+        std::vector<tiny::IRInstruction *> operands;
+        //! The targets of a terminator, or the block every operand of a Phi comes from
+        std::vector<tiny::IRBlock *> targets;
+        //! The value of a Const, or the index of an Arg as an integer
+        tiny::RuntimeValue constant;
+        //! The function a Call calls
+        std::string callee;
+        //! The block the instruction is in
+        tiny::IRBlock *block = nullptr;
+
+        //! Whether the instruction ends its block
+        [[nodiscard]] bool isTerminator() const {
+            return op == tiny::IROp::Jump || op == tiny::IROp::Branch || op == tiny::IROp::Return;
+        }
+
+        //! Whether the instruction does something other than computing its result, so it can't be removed if unused
+        [[nodiscard]] bool hasSideEffects() const {
+            return isTerminator() || op == tiny::IROp::Store || op == tiny::IROp::Call;
+        }
+    };
+
+    //! A basic block: instructions that run from the first to the last one, which is a terminator
+    struct IRBlock {
+        //! Numbers the blocks of a function, in the order they're printed
+        std::uint32_t id = 0;
+        std::vector<std::unique_ptr<tiny::IRInstruction>> instructions;
+        //! The blocks that jump to this one
+        std::vector<tiny::IRBlock *> predecessors;
+
+        /*!
+         * \brief Gets the last instruction, if it's a terminator
+         * \return The terminator, or nullptr if the block doesn't have one yet
+         */
+        [[nodiscard]] tiny::IRInstruction *terminator() const;
+
+        //! Gets the targets of the terminator
+        [[nodiscard]] std::vector<tiny::IRBlock *> successors() const;
+
+        /*!
+         * \brief Adds an instruction at the end of the block
+         * \param op The operation
+         * \param type Type of the result
+         * \param operands The operands
+         * \return The instruction, owned by the block
+         */
+        tiny::IRInstruction *append(tiny::IROp op, tiny::IRType type, std::vector<tiny::IRInstruction *> operands = {});
+
+        /*!
+         * \brief Adds an instruction at the start of the block, after the phis, arguments and same operations
+         * \param op The operation
+         * \param type Type of the result
+         * \return The instruction, owned by the block
+         */
+        tiny::IRInstruction *prepend(tiny::IROp op, tiny::IRType type);
+    };
+
+    //! A function in SSA form: every value is defined by a single instruction, that dominates its uses
+    struct IRFunction {
+        //! The qualified name, "module.name"
+        std::string name;
+        std::vector<tiny::IRType> params;
+        std::vector<tiny::IRType> results;
+        //! The blocks. The first one is the entry
+        std::vector<std::unique_ptr<tiny::IRBlock>> blocks;
+
+        /*!
+         * \brief Adds an empty block at the end of the function
+         * \return The block, owned by the function
+         */
+        tiny::IRBlock *addBlock();
+
+        /*!
+         * \brief Numbers the blocks and values in the order they're printed
+         *
+         * Numbers the blocks and values in the order they're printed. Passes that add or remove blocks or instructions
+         * leave gaps behind, which this closes.
+         */
+        void renumber();
+
+        /*!
+         * \brief Replaces every use of a value by another one
+         * \param value The value being replaced
+         * \param replacement Its replacement
+         * \return How many operands were replaced
+         */
+        std::size_t replaceUses(const tiny::IRInstruction *value, tiny::IRInstruction *replacement);
+
+        /*!
+         * \brief Gets the immediate dominator of every block
+         * \return The immediate dominators, by the index of their block. The entry and unreachable blocks get nullptr
+         */
+        [[nodiscard]] std::vector<tiny::IRBlock *> dominators() const;
+
+        /*!
+         * \brief Dumps the function as text
+         * \return The dump, such as "func f(i64 %0) -> i64 {...}", with a line per block label and instruction
+         */
+        [[nodiscard]] std::string toString() const;
+    };
+
+    //! The IR of a program: every function of its ASTs
+    struct IRModule {
+        std::vector<tiny::IRFunction> functions;
+
+        /*!
+         * \brief Finds a function by its qualified name
+         * \param name The name, such as "main.main"
+         * \return The function, or nullptr if there's none with that name
+         */
+        [[nodiscard]] const tiny::IRFunction *find(const std::string &name) const;
+
+        /*!
+         * \brief Checks that every function is well formed
+         * \return A description of every problem found, or nothing if the module is valid
+         *
+         * Checks that every function is well formed: every block ends with its only terminator, phis come first and
+         * have an operand per predecessor, predecessors match the terminators that jump to each block, operands have
+         * the types their operation expects, every value is defined in its function and dominates its uses, and calls
+         * and returns match the signatures of the functions. Integers must have the exact width and signedness their
+         * operation expects, so a narrower integer is an error unless it's cast first.
+         */
+        [[nodiscard]] std::vector<std::string> verify() const;
+
+        /*!
+         * \brief Dumps every function as text
+         * \return The dumps, separated by empty lines
+         */
+        [[nodiscard]] std::string toString() const;
+    };
+}
+
+#endif //TINY_IR_H
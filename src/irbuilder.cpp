@@ -0,0 +1,826 @@
+#include "irbuilder.h"
+
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "errors.h"
+#include "resolver.h"
+
+namespace {
+    //! The parameters and results of a function. The results are unknown until a return of the function is lowered
+    struct Signature {
+        std::vector<tiny::IRType> params;
+        std::optional<std::vector<tiny::IRType>> results;
+    };
+
+    using Signatures = std::unordered_map<std::string, Signature>;
+
+    //! A variable of the function being lowered
+    struct Variable {
+        tiny::IRType type;
+        //! The slot of a variable whose address is taken. nullptr for variables that live in SSA values
+        tiny::IRInstruction *address = nullptr;
+    };
+
+    //! Gets the type of a Type node, or of a node whose value is a type name such as an argument declaration
+    tiny::IRType typeOf(const tiny::ASTNode &node) {
+        auto type = tiny::IRType::fromName(node.getStringVal().toString(),
+                                           node.hasParam(tiny::ParameterType::Pointer) ? 1 : 0);
+        if (type.isVoid() || node.hasParam(tiny::ParameterType::Dereference)) {
+            throw tiny::IRError("Type '" + node.getStringVal().toString() + "' can't be lowered to IR", node.meta);
+        }
+
+        return type;
+    }
+
+    //! Collects the names of the variables whose address is taken
+    void collectAddressed(const tiny::ASTNode &node, std::unordered_set<std::string> &names) {
+        if (node.type == tiny::ASTNodeType::Identifier && node.hasParam(tiny::ParameterType::Dereference)) {
+            names.insert(node.getStringVal().toString());
+        }
+
+        for (auto const &c: node.children) {
+            collectAddressed(*c, names);
+        }
+    }
+
+    //! Lowers the body of a single function
+    class FunctionBuilder {
+    public:
+        FunctionBuilder(const tiny::FunctionResolver &resolver, const Signatures &signatures,
+                        const tiny::ASTFile &file, tiny::IRFunction &fn)
+                : resolver(resolver), signatures(signatures), file(file), fn(fn) {}
+
+        void build(const tiny::ASTNode &node) {
+            fn.params = signatures.at(fn.name).params;
+            collectAddressed(node, addressed);
+
+            entry = fn.addBlock();
+            current = entry;
+            seal(entry);
+            scopes.emplace_back();
+
+            auto const &args = node.getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children;
+            for (std::size_t i = 0; i < args.size(); i++) {
+                auto arg = entry->append(tiny::IROp::Arg, fn.params[i]);
+                arg->constant = tiny::RuntimeValue::fromInt(std::int64_t(i));
+                declare(args[i]->getParam(tiny::ParameterType::Name).getStringVal(args[i]->meta).toString(), arg);
+            }
+
+            block(*node.getChild(tiny::ASTNodeType::FunctionBody)->getFirstChild());
+
+            // Functions that end without a return give no values
+            if (!dead()) {
+                if (results && !results->empty()) {
+                    throw tiny::IRError("Function '" + fn.name + "' can end without returning a value", node.meta);
+                }
+
+                current->append(tiny::IROp::Return, {});
+            }
+
+            fn.results = results.value_or(std::vector<tiny::IRType>());
+
+            // Drop the blocks nothing jumps to, which were left after returns
+            std::vector<std::unique_ptr<tiny::IRBlock>> reachable;
+            for (auto &b: fn.blocks) {
+                if (b.get() == entry || !b->predecessors.empty()) {
+                    reachable.push_back(std::move(b));
+                }
+            }
+
+            fn.blocks = std::move(reachable);
+            fn.renumber();
+        }
+
+    private:
+        // SSA construction
+
+        void write(std::uint32_t variable, tiny::IRBlock *block, tiny::IRInstruction *value) {
+            definitions[variable][block] = value;
+        }
+
+        tiny::IRInstruction *read(std::uint32_t variable, tiny::IRBlock *block) {
+            auto &defs = definitions[variable];
+            if (auto it = defs.find(block); it != defs.end()) {
+                return it->second;
+            }
+
+            tiny::IRInstruction *value;
+            if (sealed.count(block) == 0) {
+                // More predecessors may come, so complete the phi once they're known
+                value = block->prepend(tiny::IROp::Phi, variables[variable].type);
+                incomplete[block].emplace_back(variable, value);
+            } else if (block->predecessors.size() == 1) {
+                value = read(variable, block->predecessors.front());
+            } else if (block->predecessors.empty()) {
+                throw tiny::IRError("Variable read before being written in '" + fn.name + "'", tiny::Metadata());
+            } else {
+                // Written first, so loops through this block find the phi instead of coming back here
+                value = block->prepend(tiny::IROp::Phi, variables[variable].type);
+                write(variable, block, value);
+                addPhiOperands(variable, value);
+            }
+
+            write(variable, block, value);
+            return value;
+        }
+
+        void addPhiOperands(std::uint32_t variable, tiny::IRInstruction *phi) {
+            for (auto *pred: phi->block->predecessors) {
+                auto *value = read(variable, pred);
+                phi->operands.push_back(value);
+                phi->targets.push_back(pred);
+            }
+        }
+
+        //! Marks a block as having all its predecessors
+        void seal(tiny::IRBlock *block) {
+            auto pending = std::move(incomplete[block]);
+            incomplete.erase(block);
+            sealed.insert(block);
+
+            for (auto const &[variable, phi]: pending) {
+                addPhiOperands(variable, phi);
+            }
+        }
+
+        //! Whether the current block can't be reached, because it comes after a return
+        bool dead() {
+            return current != entry && sealed.count(current) > 0 && current->predecessors.empty();
+        }
+
+        // Control flow
+
+        void jump(tiny::IRBlock *target) {
+            auto ins = current->append(tiny::IROp::Jump, {});
+            ins->targets = {target};
+            target->predecessors.push_back(current);
+        }
+
+        void branch(tiny::IRInstruction *condition, tiny::IRBlock *ifTrue, tiny::IRBlock *ifFalse) {
+            auto ins = current->append(tiny::IROp::Branch, {}, {condition});
+            ins->targets = {ifTrue, ifFalse};
+            ifTrue->predecessors.push_back(current);
+            ifFalse->predecessors.push_back(current);
+        }
+
+        // Variables
+
+        void declare(const std::string &name, tiny::IRInstruction *value) {
+            auto variable = std::uint32_t(variables.size());
+            variables.push_back({value->type});
+
+            if (addressed.count(name) > 0) {
+                variables.back().address = entry->prepend(tiny::IROp::Alloca, value->type.pointer());
+                current->append(tiny::IROp::Store, {}, {variables.back().address, value});
+            } else {
+                write(variable, current, value);
+            }
+
+            scopes.back()[name] = variable;
+        }
+
+        std::uint32_t lookup(const tiny::ASTNode &id) {
+            auto name = id.getStringVal().toString();
+            for (auto scope = scopes.rbegin(); scope != scopes.rend(); scope++) {
+                if (auto it = scope->find(name); it != scope->end()) {
+                    return it->second;
+                }
+            }
+
+            throw tiny::IRError("Undefined variable '" + name + "'", id.meta);
+        }
+
+        tiny::IRInstruction *load(std::uint32_t variable) {
+            if (auto *address = variables[variable].address) {
+                return current->append(tiny::IROp::Load, variables[variable].type, {address});
+            }
+
+            return read(variable, current);
+        }
+
+        void store(std::uint32_t variable, tiny::IRInstruction *value, const tiny::Metadata &meta) {
+            value = convert(value, variables[variable].type, meta);
+            if (auto *address = variables[variable].address) {
+                current->append(tiny::IROp::Store, {}, {address, value});
+            } else {
+                write(variable, current, value);
+            }
+        }
+
+        //! Converts a value to a type, which must be its own, another integer for an integer, or a decimal
+        tiny::IRInstruction *convert(tiny::IRInstruction *value, tiny::IRType type, const tiny::Metadata &meta) {
+            if (value->type == type) {
+                return value;
+            }
+
+            if (value->type.isInteger() && type.isInteger()) {
+                // Narrowing back what was only widened gives the original value
+                auto const *original = value->op == tiny::IROp::IntCast ? value->operands.front() : nullptr;
+                if (original != nullptr && original->type == type && value->type.bits >= type.bits) {
+                    return value->operands.front();
+                }
+
+                return current->append(tiny::IROp::IntCast, type, {value});
+            }
+
+            if (value->type.isInteger() && type == tiny::IRType{tiny::IRTypeKind::Float}) {
+                value = convert(value, {tiny::IRTypeKind::Int}, meta);
+                return current->append(tiny::IROp::IntToFloat, type, {value});
+            }
+
+            throw tiny::IRError("Expected a value of type '" + type.toString() + "', but got '"
+                                + value->type.toString() + "'", meta);
+        }
+
+        tiny::IRInstruction *constant(tiny::IRType type, const tiny::RuntimeValue &value) {
+            auto ins = current->append(tiny::IROp::Const, type);
+            ins->constant = value;
+            return ins;
+        }
+
+        // Statements
+
+        void block(const tiny::ASTNode &node) {
+            scopes.emplace_back();
+
+            for (auto const &c: node.children) {
+                // Statements after a return can't run
+                if (dead()) {
+                    break;
+                }
+
+                statement(*c);
+            }
+
+            scopes.pop_back();
+        }
+
+        void statement(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::ExpressionStatement:
+                expressionStatement(*node.getFirstChild());
+                break;
+            case tiny::ASTNodeType::BlockStatement:
+                block(node);
+                break;
+            case tiny::ASTNodeType::IfStatement:
+                ifStatement(node);
+                break;
+            case tiny::ASTNodeType::ForStatement:
+                forStatement(node);
+                break;
+            case tiny::ASTNodeType::FunctionReturn:
+                returnStatement(node);
+                break;
+            default:
+                unsupported(node);
+            }
+        }
+
+        void expressionStatement(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::Initialization: {
+                // The value is computed before the name is declared, so it can use a variable it shadows
+                auto const &lhs = *node.getFirstChild();
+                auto value = this->value(*node.getSecondChild());
+                if (lhs.type == tiny::ASTNodeType::TypedExpression) {
+                    value = convert(value, typeOf(*lhs.getChild(tiny::ASTNodeType::Type)), node.meta);
+                }
+
+                declare(lhs.getStringVal().toString(), value);
+                return;
+            }
+            case tiny::ASTNodeType::VarDeclaration: {
+                auto const &typeNode = *node.getFirstChild();
+                auto type = typeOf(typeNode);
+                auto zero = type.isPointer() ? tiny::RuntimeValue()
+                                             : tiny::RuntimeValue::zero(typeNode.getStringVal().toString());
+                declare(node.getStringVal().toString(), constant(type, zero));
+                return;
+            }
+            case tiny::ASTNodeType::Assignment:
+                assign(*node.getFirstChild(), value(*node.getSecondChild()), node.meta);
+                return;
+            case tiny::ASTNodeType::AssignmentSum:
+                compoundAssignment(node, tiny::IROp::Add);
+                return;
+            case tiny::ASTNodeType::AssignmentSub:
+                compoundAssignment(node, tiny::IROp::Sub);
+                return;
+            case tiny::ASTNodeType::AssignmentMulti:
+                compoundAssignment(node, tiny::IROp::Mul);
+                return;
+            case tiny::ASTNodeType::AssignmentDiv:
+                compoundAssignment(node, tiny::IROp::Div);
+                return;
+            default:
+                // Evaluated for its side effects, such as a call
+                expression(node);
+            }
+        }
+
+        //! Writes to a variable, or through a pointer with '$'
+        void assign(const tiny::ASTNode &lhs, tiny::IRInstruction *value, const tiny::Metadata &meta) {
+            if (lhs.type != tiny::ASTNodeType::Identifier) {
+                unsupported(lhs);
+            }
+
+            if (lhs.params.empty()) {
+                store(lookup(lhs), value, meta);
+            } else if (lhs.hasParam(tiny::ParameterType::ValueAt)) {
+                auto pointer = pointerOf(lhs);
+                current->append(tiny::IROp::Store, {}, {pointer, convert(value, pointer->type.pointee(), meta)});
+            } else {
+                unsupported(lhs);
+            }
+        }
+
+        void compoundAssignment(const tiny::ASTNode &node, tiny::IROp op) {
+            auto const &lhs = *node.getFirstChild();
+            auto rhs = value(*node.getSecondChild());
+            assign(lhs, arithmetic(op, value(lhs), rhs, node.meta), node.meta);
+        }
+
+        void ifStatement(const tiny::ASTNode &node) {
+            auto cond = condition(*node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild());
+            auto hasAlternative = node.children.size() >= 3;
+
+            auto consequent = fn.addBlock();
+            auto alternative = hasAlternative ? fn.addBlock() : nullptr;
+            auto end = fn.addBlock();
+
+            branch(cond, consequent, hasAlternative ? alternative : end);
+            seal(consequent);
+
+            current = consequent;
+            block(*node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild());
+            if (!dead()) {
+                jump(end);
+            }
+
+            if (hasAlternative) {
+                seal(alternative);
+                current = alternative;
+                block(*node.getChild(tiny::ASTNodeType::BranchAlternative)->getFirstChild());
+                if (!dead()) {
+                    jump(end);
+                }
+            }
+
+            seal(end);
+            current = end;
+        }
+
+        void forStatement(const tiny::ASTNode &node) {
+            auto const &cond = *node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild();
+            auto const &body = *node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild();
+
+            if (cond.type == tiny::ASTNodeType::RangeExpression) {
+                rangeLoop(cond, body);
+                return;
+            }
+
+            if (cond.type == tiny::ASTNodeType::ForEachExpression) {
+                unsupported(cond);
+            }
+
+            // A while loop: the header checks the condition before every iteration, and gets sealed once the body
+            // jumps back to it
+            auto header = fn.addBlock();
+            jump(header);
+            current = header;
+            auto check = condition(cond);
+
+            auto loop = fn.addBlock();
+            auto exit = fn.addBlock();
+            branch(check, loop, exit);
+            seal(loop);
+
+            current = loop;
+            block(body);
+            if (!dead()) {
+                jump(header);
+            }
+
+            seal(header);
+            seal(exit);
+            current = exit;
+        }
+
+        void rangeLoop(const tiny::ASTNode &range, const tiny::ASTNode &body) {
+            auto integer = [&](const tiny::ASTNode &node) {
+                auto ins = value(node);
+                if (ins->type != tiny::IRType{tiny::IRTypeKind::Int}) {
+                    throw tiny::IRError("Ranges must be over integers", node.meta);
+                }
+
+                return ins;
+            };
+
+            auto from = integer(*range.getChild(tiny::ASTNodeType::RangeFromExpression)->getFirstChild());
+
+            auto const &to = *range.getChild(tiny::ASTNodeType::RangeToExpression);
+            auto limit = to.children.empty() ? nullptr : integer(*to.getFirstChild()); // Open range if there's none
+
+            auto const &stepNode = *range.getChild(tiny::ASTNodeType::RangeStepExpression);
+            auto step = stepNode.children.empty() ? constant({tiny::IRTypeKind::Int}, tiny::RuntimeValue::fromInt(1))
+                                                  : integer(*stepNode.getFirstChild());
+            if (step->op == tiny::IROp::Const && step->constant.i == 0) {
+                throw tiny::IRError("The step of a range can't be zero", range.meta);
+            }
+
+            // The counter is a variable with no name, so its value flows through phis like any other
+            auto counter = std::uint32_t(variables.size());
+            variables.push_back({from->type});
+            write(counter, current, from);
+
+            auto header = fn.addBlock();
+            jump(header);
+            current = header;
+            auto index = read(counter, header);
+
+            auto loop = fn.addBlock();
+            auto exit = fn.addBlock();
+            if (limit == nullptr) {
+                jump(loop);
+            } else if (step->op == tiny::IROp::Const) {
+                auto op = step->constant.i > 0 ? tiny::IROp::Lt : tiny::IROp::Gt;
+                branch(current->append(op, {tiny::IRTypeKind::Bool}, {index, limit}), loop, exit);
+            } else {
+                // The sign of the step picks the comparison
+                auto zero = constant({tiny::IRTypeKind::Int}, tiny::RuntimeValue::fromInt(0));
+                auto up = fn.addBlock();
+                auto down = fn.addBlock();
+                branch(current->append(tiny::IROp::Gt, {tiny::IRTypeKind::Bool}, {step, zero}), up, down);
+                seal(up);
+                seal(down);
+
+                current = up;
+                branch(current->append(tiny::IROp::Lt, {tiny::IRTypeKind::Bool}, {index, limit}), loop, exit);
+                current = down;
+                branch(current->append(tiny::IROp::Gt, {tiny::IRTypeKind::Bool}, {index, limit}), loop, exit);
+            }
+
+            seal(loop);
+            current = loop;
+
+            scopes.emplace_back();
+            declare(range.getParam(tiny::ParameterType::RangeIdentifier).getStringVal(range.meta).toString(), index);
+            block(body);
+            scopes.pop_back();
+
+            if (!dead()) {
+                auto next = current->append(tiny::IROp::Add, from->type, {read(counter, current), step});
+                write(counter, current, next);
+                jump(header);
+            }
+
+            seal(header);
+            seal(exit);
+            current = exit;
+        }
+
+        void returnStatement(const tiny::ASTNode &node) {
+            std::vector<tiny::IRInstruction *> values;
+            for (auto const &c: node.children) {
+                values.push_back(value(*c));
+            }
+
+            // The first return gives the results of the function, and the others must match it
+            if (!results) {
+                results.emplace();
+                for (auto const *v: values) {
+                    results->push_back(v->type);
+                }
+            } else if (results->size() != values.size()) {
+                throw tiny::IRError("Function '" + fn.name + "' returns " + std::to_string(results->size())
+                                    + " values, but this return has " + std::to_string(values.size()), node.meta);
+            } else {
+                for (std::size_t i = 0; i < values.size(); i++) {
+                    values[i] = convert(values[i], (*results)[i], node.children[i]->meta);
+                }
+            }
+
+            current->append(tiny::IROp::Return, {}, values);
+
+            // Anything that follows can't be reached
+            current = fn.addBlock();
+            seal(current);
+        }
+
+        // Expressions
+
+        //! Lowers an expression that must give a value. Narrower integers are widened, since they compute as i64
+        tiny::IRInstruction *value(const tiny::ASTNode &node) {
+            auto ins = expression(node);
+            if (ins->type.isVoid()) {
+                throw tiny::IRError("'" + node.toString() + "' doesn't give a value", node.meta);
+            }
+
+            return ins->type.isInteger() ? convert(ins, {tiny::IRTypeKind::Int}, node.meta) : ins;
+        }
+
+        //! Lowers an expression that must give a boolean
+        tiny::IRInstruction *condition(const tiny::ASTNode &node) {
+            auto ins = value(node);
+            if (ins->type != tiny::IRType{tiny::IRTypeKind::Bool}) {
+                throw tiny::IRError("Conditions must be booleans, but got '" + ins->type.toString() + "'", node.meta);
+            }
+
+            return ins;
+        }
+
+        //! Lowers an expression
+        tiny::IRInstruction *expression(const tiny::ASTNode &node) {
+            switch (node.type) {
+            case tiny::ASTNodeType::LiteralInt:
+                return constant({tiny::IRTypeKind::Int}, tiny::RuntimeValue::fromInt(std::get<std::int64_t>(node.val)));
+            case tiny::ASTNodeType::LiteralDecimal:
+                return constant({tiny::IRTypeKind::Float},
+                                tiny::RuntimeValue::fromFloat(double(std::get<long double>(node.val))));
+            case tiny::ASTNodeType::LiteralBool:
+                return constant({tiny::IRTypeKind::Bool}, tiny::RuntimeValue::fromBool(std::get<bool>(node.val)));
+
+            case tiny::ASTNodeType::Identifier:
+                return identifier(node);
+
+            case tiny::ASTNodeType::OpAddition:
+                return binary(node, tiny::IROp::Add);
+            case tiny::ASTNodeType::OpSubtraction:
+                return binary(node, tiny::IROp::Sub);
+            case tiny::ASTNodeType::OpMultiplication:
+                return binary(node, tiny::IROp::Mul);
+            case tiny::ASTNodeType::OpDivision:
+                return binary(node, tiny::IROp::Div);
+            case tiny::ASTNodeType::OpExponentiate:
+                return binary(node, tiny::IROp::Pow);
+            case tiny::ASTNodeType::CompareEq:
+                return comparison(node, tiny::IROp::Eq);
+            case tiny::ASTNodeType::CompareNeq:
+                return comparison(node, tiny::IROp::Neq);
+            case tiny::ASTNodeType::CompareLt:
+                return comparison(node, tiny::IROp::Lt);
+            case tiny::ASTNodeType::CompareLteq:
+                return comparison(node, tiny::IROp::Lteq);
+            case tiny::ASTNodeType::CompareGt:
+                return comparison(node, tiny::IROp::Gt);
+            case tiny::ASTNodeType::CompareGteq:
+                return comparison(node, tiny::IROp::Gteq);
+
+            case tiny::ASTNodeType::UnaryNegative: {
+                auto x = value(*node.getFirstChild());
+                if (!x->type.isNumber()) {
+                    throw tiny::IRError("Can't negate a value of type '" + x->type.toString() + "'", node.meta);
+                }
+
+                return current->append(tiny::IROp::Neg, x->type, {x});
+            }
+            case tiny::ASTNodeType::UnaryNot:
+                return current->append(tiny::IROp::Not, {tiny::IRTypeKind::Bool}, {condition(*node.getFirstChild())});
+
+            case tiny::ASTNodeType::LogicalAnd:
+                return logical(node, true);
+            case tiny::ASTNodeType::LogicalOr:
+                return logical(node, false);
+
+            case tiny::ASTNodeType::FunctionCall:
+                return call(node);
+
+            default:
+                unsupported(node);
+            }
+        }
+
+        tiny::IRInstruction *identifier(const tiny::ASTNode &node) {
+            if (node.params.empty()) {
+                return load(lookup(node));
+            }
+
+            if (node.hasParam(tiny::ParameterType::ValueAt)) {
+                auto pointer = pointerOf(node);
+                return current->append(tiny::IROp::Load, pointer->type.pointee(), {pointer});
+            }
+
+            if (node.hasParam(tiny::ParameterType::Dereference)) {
+                return variables[lookup(node)].address; // Every variable whose address is taken has a slot
+            }
+
+            unsupported(node);
+        }
+
+        //! Gets the pointer held by the variable of a '$' expression
+        tiny::IRInstruction *pointerOf(const tiny::ASTNode &node) {
+            auto pointer = load(lookup(node));
+            if (!pointer->type.isPointer()) {
+                throw tiny::IRError("'" + node.getStringVal().toString() + "' isn't a pointer", node.meta);
+            }
+
+            return pointer;
+        }
+
+        tiny::IRInstruction *binary(const tiny::ASTNode &node, tiny::IROp op) {
+            auto x = value(*node.getFirstChild());
+            auto y = value(*node.getSecondChild());
+            return arithmetic(op, x, y, node.meta);
+        }
+
+        tiny::IRInstruction *arithmetic(tiny::IROp op, tiny::IRInstruction *x, tiny::IRInstruction *y,
+                                        const tiny::Metadata &meta) {
+            if (!x->type.isNumber() || !y->type.isNumber()) {
+                throw tiny::IRError("Invalid operands for '" + tiny::toString(op) + "' ('" + x->type.toString()
+                                    + "' and '" + y->type.toString() + "')", meta);
+            }
+
+            auto type = x->type.kind == tiny::IRTypeKind::Float || y->type.kind == tiny::IRTypeKind::Float
+                        ? tiny::IRType{tiny::IRTypeKind::Float} : tiny::IRType{tiny::IRTypeKind::Int};
+
+            // Negative powers of integers are decimals, so only constant exponents can keep them integers
+            if (op == tiny::IROp::Pow && type.kind == tiny::IRTypeKind::Int
+                && (y->op != tiny::IROp::Const || y->constant.i < 0)) {
+                type = {tiny::IRTypeKind::Float};
+            }
+
+            return current->append(op, type, {convert(x, type, meta), convert(y, type, meta)});
+        }
+
+        tiny::IRInstruction *comparison(const tiny::ASTNode &node, tiny::IROp op) {
+            auto x = value(*node.getFirstChild());
+            auto y = value(*node.getSecondChild());
+
+            if (x->type.isNumber() && y->type.isNumber()) {
+                if (x->type != y->type) {
+                    x = convert(x, {tiny::IRTypeKind::Float}, node.meta);
+                    y = convert(y, {tiny::IRTypeKind::Float}, node.meta);
+                }
+            } else if (x->type != y->type || (op != tiny::IROp::Eq && op != tiny::IROp::Neq)) {
+                throw tiny::IRError("Invalid operands for '" + tiny::toString(op) + "' ('" + x->type.toString()
+                                    + "' and '" + y->type.toString() + "')", node.meta);
+            }
+
+            return current->append(op, {tiny::IRTypeKind::Bool}, {x, y});
+        }
+
+        //! Short-circuits 'and' and 'or': the right-hand side only runs if the left-hand side doesn't decide
+        tiny::IRInstruction *logical(const tiny::ASTNode &node, bool isAnd) {
+            auto lhs = condition(*node.getFirstChild());
+            auto from = current;
+
+            auto rhsBlock = fn.addBlock();
+            auto end = fn.addBlock();
+            branch(lhs, isAnd ? rhsBlock : end, isAnd ? end : rhsBlock);
+            seal(rhsBlock);
+
+            current = rhsBlock;
+            auto rhs = condition(*node.getSecondChild());
+            auto rhsEnd = current;
+            jump(end);
+            seal(end);
+
+            current = end;
+            auto phi = end->prepend(tiny::IROp::Phi, {tiny::IRTypeKind::Bool});
+            phi->operands = {lhs, rhs};
+            phi->targets = {from, rhsEnd};
+            return phi;
+        }
+
+        tiny::IRInstruction *call(const tiny::ASTNode &node) {
+            auto const &callee = *node.getFirstChild();
+            if (callee.type == tiny::ASTNodeType::Identifier && !callee.params.empty()) {
+                unsupported(callee);
+            }
+
+            auto name = resolver.resolve<tiny::IRError>(file, callee);
+            auto const &signature = signatures.at(name);
+            auto const &args = node.getSecondChild()->children;
+            if (args.size() != signature.params.size()) {
+                throw tiny::IRError("Function '" + name + "' takes " + std::to_string(signature.params.size())
+                                    + " arguments, but got " + std::to_string(args.size()), node.meta);
+            }
+
+            std::vector<tiny::IRInstruction *> operands;
+            for (std::size_t i = 0; i < args.size(); i++) {
+                operands.push_back(convert(value(*args[i]), signature.params[i], args[i]->meta));
+            }
+
+            // Until a return of the function is lowered, guess that it gives an integer
+            tiny::IRType type{tiny::IRTypeKind::Int};
+            if (signature.results) {
+                type = signature.results->empty() ? tiny::IRType() : signature.results->front();
+            }
+
+            auto ins = current->append(tiny::IROp::Call, type, operands);
+            ins->callee = name;
+            return ins;
+        }
+
+        [[noreturn]] void unsupported(const tiny::ASTNode &node) {
+            throw tiny::IRError("'" + node.toString() + "' can't be lowered to IR", node.meta);
+        }
+
+        const tiny::FunctionResolver &resolver;
+        const Signatures &signatures;
+        const tiny::ASTFile &file;
+        tiny::IRFunction &fn;
+
+        tiny::IRBlock *entry = nullptr;
+        tiny::IRBlock *current = nullptr;
+        //! The types of the values returned so far. Unknown until the first return
+        std::optional<std::vector<tiny::IRType>> results;
+
+        std::vector<Variable> variables;
+        //! Variables by name, from the outermost to the innermost block
+        std::vector<std::unordered_map<std::string, std::uint32_t>> scopes;
+        //! The names of the variables whose address is taken
+        std::unordered_set<std::string> addressed;
+
+        //! The value of every variable at the end of the blocks it was read or written in
+        std::unordered_map<std::uint32_t, std::unordered_map<tiny::IRBlock *, tiny::IRInstruction *>> definitions;
+        //! The blocks whose predecessors are all known
+        std::unordered_set<tiny::IRBlock *> sealed;
+        //! Phis of blocks that weren't sealed yet, to complete once they are
+        std::unordered_map<tiny::IRBlock *, std::vector<std::pair<std::uint32_t, tiny::IRInstruction *>>> incomplete;
+    };
+}
+
+tiny::IRModule tiny::IRBuilder::build(const std::vector<tiny::ASTFile> &files) {
+    tiny::FunctionResolver resolver;
+    Signatures signatures;
+    std::vector<std::pair<const tiny::ASTFile *, const tiny::ASTNode *>> declarations;
+
+    // Gather every function first, so calls can go to functions declared later or in other files
+    for (auto const &file: files) {
+        for (auto const &node: file.statements) {
+            switch (node.type) {
+            case tiny::ASTNodeType::StructDeclaration:
+            case tiny::ASTNodeType::TraitDeclaration:
+                continue; // Types don't generate code
+            case tiny::ASTNodeType::FunctionDeclaration:
+                break;
+            default:
+                throw tiny::IRError("'" + node.toString() + "' can't be lowered to IR", node.meta);
+            }
+
+            auto name = node.getParam(tiny::ParameterType::Name).getStringVal(node.meta).toString();
+            if (!resolver.declare(file.mod.toString(), name)) {
+                throw tiny::IRError("Function '" + name + "' is defined more than once in module '"
+                                    + file.mod.toString() + "'", node.meta);
+            }
+
+            auto &signature = signatures[tiny::FunctionResolver::qualify(file.mod.toString(), name)];
+            for (auto const &arg: node.getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children) {
+                signature.params.push_back(typeOf(*arg));
+            }
+
+            declarations.emplace_back(&file, &node);
+        }
+    }
+
+    // Calls to functions whose results aren't known yet are guessed, so lower everything again until no results
+    // change. Errors only count once they do, since they may come from a wrong guess
+    for (std::size_t round = 0;; round++) {
+        tiny::IRModule module;
+        std::optional<tiny::IRError> error;
+        auto changed = false;
+
+        for (auto const &[file, node]: declarations) {
+            tiny::IRFunction fn;
+            fn.name = tiny::FunctionResolver::qualify(file->mod.toString(),
+                                                      node->getParam(tiny::ParameterType::Name)
+                                                              .getStringVal(node->meta).toString());
+
+            try {
+                FunctionBuilder builder(resolver, signatures, *file, fn);
+                builder.build(*node);
+            } catch (const tiny::IRError &e) {
+                if (!error) {
+                    error = e;
+                }
+
+                continue;
+            }
+
+            auto &results = signatures[fn.name].results;
+            if (results != fn.results) {
+                results = fn.results;
+                changed = true;
+            }
+
+            module.functions.push_back(std::move(fn));
+        }
+
+        if (!changed) {
+            if (error) {
+                throw *error;
+            }
+
+            return module;
+        }
+
+        if (round > declarations.size()) {
+            throw tiny::IRError("The results of the functions can't be inferred", tiny::Metadata());
+        }
+    }
+}
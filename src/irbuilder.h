@@ -0,0 +1,46 @@
+#ifndef TINY_IRBUILDER_H
+#define TINY_IRBUILDER_H
+
+#include <vector>
+
+#include "ast.h"
+#include "ir.h"
+
+namespace tiny {
+    /*!
+     * \brief Lowers ASTs into the SSA form of the IR
+     *
+     * Lowers the function declarations of a set of ASTs, as they come out of the Compiler, into IR. Variables become
+     * SSA values as they're lowered, following "Simple and Efficient Construction of Static Single Assignment Form"
+     * (Braun et al.): reading a variable looks for its definition in the current block and its predecessors, and only
+     * adds phis where definitions meet. Variables whose address is taken with '&' live in an Alloca instead, and are
+     * read and written with explicit loads and stores, as are values reached through '$'.
+     *
+     * Nothing gives expressions a type before this, so the builder infers them: literals and declarations give the
+     * types of variables, decimals of every width become f64, mixing integers and decimals converts the integers, and a
+     * power of integers is only an integer if its exponent is a non-negative constant. A variable keeps the type of its
+     * declaration. Integers keep the width they're declared with in arguments, typed variables and memory, but compute
+     * as i64 like in the VM: they're widened when read, and narrowed when written. The results of a function are the
+     * types of its returns, found by lowering every function again until the results of calls stop changing.
+     *
+     * Functions are named by their module ("main.f"), and calls are resolved like the BytecodeCompiler does.
+     *
+     * It accepts the same subset of the language as the BytecodeCompiler, plus pointers, but not None. Unlike in the
+     * VM, ranges don't stop early when their counter would wrap around.
+     */
+    class IRBuilder {
+    public:
+        /*!
+         * \brief Lowers the functions of a set of ASTs
+         * \param files The ASTs. Functions can call the functions of their module and of the modules it imports
+         * \return The module, with a function per function declaration, in the order they're declared
+         *
+         * Lowers the functions of a set of ASTs. Throws IRError if a node can't be lowered, if a name is undefined or
+         * redefined, or if types don't match, for example in a condition that isn't a boolean or in returns of
+         * different types.
+         */
+        static tiny::IRModule build(const std::vector<tiny::ASTFile> &files);
+    };
+}
+
+#endif //TINY_IRBUILDER_H
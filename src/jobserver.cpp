@@ -0,0 +1,180 @@
+#include "jobserver.h"
+
+#include <cstdlib>
+
+#include "logger.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+std::optional<std::string> tiny::JobServer::findAuth(std::string_view makeflags) {
+    std::optional<std::string> auth;
+
+    std::size_t pos = 0;
+    while (pos < makeflags.size()) {
+        auto end = makeflags.find(' ', pos);
+        if (end == std::string_view::npos) {
+            end = makeflags.size();
+        }
+
+        auto word = makeflags.substr(pos, end - pos);
+        for (std::string_view prefix: {"--jobserver-auth=", "--jobserver-fds="}) {
+            if (word.substr(0, prefix.size()) == prefix) {
+                auth = std::string(word.substr(prefix.size()));
+            }
+        }
+
+        pos = end + 1;
+    }
+
+    return auth;
+}
+
+std::unique_ptr<tiny::JobServer> tiny::JobServer::connect(const std::string &auth) {
+    if (auth.rfind("fifo:", 0) == 0) {
+        auto path = auth.substr(5);
+
+        int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        return std::unique_ptr<tiny::JobServer>(new tiny::JobServer(fd, fd, {fd}));
+    }
+
+    auto comma = auth.find(',');
+    if (comma == std::string::npos) {
+        return nullptr;
+    }
+
+    int readFd = -1;
+    int writeFd = -1;
+    try {
+        readFd = std::stoi(auth.substr(0, comma));
+        writeFd = std::stoi(auth.substr(comma + 1));
+    } catch (const std::exception &) {
+        return nullptr;
+    }
+
+    // make only passes the pipe to recipes marked as recursive; for the rest the descriptors are closed
+    if (readFd < 0 || writeFd < 0 || fcntl(readFd, F_GETFD) < 0 || fcntl(writeFd, F_GETFD) < 0) {
+        return nullptr;
+    }
+
+#if defined(__linux__)
+    // Reopening the pipe gets a private non-blocking read end without changing the flags of the one shared with make
+    auto procPath = "/proc/self/fd/" + std::to_string(readFd);
+    if (int fd = open(procPath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC); fd >= 0) {
+        return std::unique_ptr<tiny::JobServer>(new tiny::JobServer(fd, writeFd, {fd}));
+    }
+#endif
+
+    /*
+     * Without /proc the pipe can't be reopened, and a blocking read would hang if another process takes the token
+     * between poll() and read(). Make the pipe non-blocking instead. The flag also applies to the read end of make and
+     * the other jobs, which is why reopening the pipe is preferred
+     */
+    int fd = fcntl(readFd, F_DUPFD_CLOEXEC, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    if (int flags = fcntl(fd, F_GETFL); flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    return std::unique_ptr<tiny::JobServer>(new tiny::JobServer(fd, writeFd, {fd}));
+}
+
+tiny::JobServer::~JobServer() {
+    while (getHeld() > 0) {
+        release();
+    }
+
+    for (auto fd: owned) {
+        close(fd);
+    }
+}
+
+bool tiny::JobServer::acquire(std::chrono::milliseconds timeout) {
+    pollfd pfd{readFd, POLLIN, 0};
+    if (poll(&pfd, 1, std::int32_t(timeout.count())) <= 0) {
+        return false;
+    }
+
+    // Another process might have taken the token between poll() and read()
+    char token;
+    if (read(readFd, &token, 1) != 1) {
+        return false;
+    }
+
+    std::lock_guard lock(mtx);
+    held.push_back(token);
+
+    return true;
+}
+
+void tiny::JobServer::release() {
+    char token;
+    {
+        std::lock_guard lock(mtx);
+        if (held.empty()) {
+            return;
+        }
+
+        token = held.back();
+        held.pop_back();
+    }
+
+    while (write(writeFd, &token, 1) < 0 && errno == EINTR) {}
+}
+
+#else
+
+std::optional<std::string> tiny::JobServer::findAuth(std::string_view) {
+    return std::nullopt;
+}
+
+std::unique_ptr<tiny::JobServer> tiny::JobServer::connect(const std::string &) {
+    return nullptr;
+}
+
+tiny::JobServer::~JobServer() = default;
+
+bool tiny::JobServer::acquire(std::chrono::milliseconds) {
+    return false;
+}
+
+void tiny::JobServer::release() {}
+
+#endif
+
+std::unique_ptr<tiny::JobServer> tiny::JobServer::fromEnvironment() {
+    const char *makeflags = std::getenv("MAKEFLAGS");
+    if (makeflags == nullptr) {
+        return nullptr;
+    }
+
+    auto auth = findAuth(makeflags);
+    if (!auth) {
+        return nullptr;
+    }
+
+    auto client = connect(*auth);
+    if (!client) {
+        tiny::warn("Unable to use the make jobserver ('" + *auth + "'). Mark the rule running tiny with '+' to share it");
+    }
+
+    return client;
+}
+
+std::size_t tiny::JobServer::getHeld() {
+    std::lock_guard lock(mtx);
+    return held.size();
+}
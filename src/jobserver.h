@@ -0,0 +1,88 @@
+#ifndef TINY_JOBSERVER_H
+#define TINY_JOBSERVER_H
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tiny {
+    /*!
+     * \brief A client for the GNU make jobserver
+     *
+     * A client for the GNU make jobserver. When make runs with -j it hands its children a pipe (or a named fifo) holding
+     * one token per job slot, advertised through MAKEFLAGS. A child always owns one implicit slot, and has to take a
+     * token from the jobserver for every other job it runs at the same time, giving it back when done. This keeps the
+     * total parallelism of the build within the limit given to make.
+     *
+     * Only available on POSIX systems. On other platforms no jobserver is ever found.
+     */
+    class JobServer {
+    public:
+        /*!
+         * \brief Finds the jobserver description inside the contents of MAKEFLAGS
+         * \param makeflags The contents of MAKEFLAGS
+         * \return The value of the last --jobserver-auth (or --jobserver-fds) option, if any
+         */
+        static std::optional<std::string> findAuth(std::string_view makeflags);
+
+        /*!
+         * \brief Connects to a jobserver
+         * \param auth The jobserver description, either "R,W" (the file descriptors of a pipe) or "fifo:PATH"
+         * \return The client, or null if the jobserver can't be used
+         */
+        static std::unique_ptr<tiny::JobServer> connect(const std::string &auth);
+
+        /*!
+         * \brief Connects to the jobserver advertised through the MAKEFLAGS environment variable, if any
+         * \return The client, or null if there's no usable jobserver
+         */
+        static std::unique_ptr<tiny::JobServer> fromEnvironment();
+
+        //! Returns the tokens still held and closes the descriptors opened by the client
+        ~JobServer();
+
+        JobServer(JobServer const &) = delete;
+        void operator=(JobServer const &) = delete;
+
+        /*!
+         * \brief Takes a token from the jobserver
+         * \param timeout How long to wait for a token to become available
+         * \return True if a token was taken, false if the timeout expired
+         */
+        bool acquire(std::chrono::milliseconds timeout);
+
+        //! Gives a token back to the jobserver
+        void release();
+
+        //! Gets the number of tokens currently held
+        [[nodiscard]] std::size_t getHeld();
+
+    private:
+        /*!
+         * \brief Builds a client over the provided descriptors
+         * \param readFd The descriptor tokens are read from
+         * \param writeFd The descriptor tokens are written back to
+         * \param owned Which descriptors were opened by the client (and must be closed by it)
+         */
+        JobServer(int readFd, int writeFd, std::vector<int> owned) : readFd(readFd), writeFd(writeFd),
+                                                                   owned(std::move(owned)) {};
+
+        //! The descriptor tokens are read from
+        int readFd;
+        //! The descriptor tokens are written back to
+        int writeFd;
+        //! Descriptors opened by the client
+        std::vector<int> owned;
+
+        //! The tokens held. make expects the same bytes back
+        std::vector<char> held;
+        //! Guards held
+        std::mutex mtx;
+    };
+}
+
+#endif //TINY_JOBSERVER_H
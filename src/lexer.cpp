@@ -2,6 +2,7 @@
 
 #include <utility>
 #include "errors.h"
+#include "stats.h"
 
 std::vector<tiny::Lexeme> tiny::Lexer::lexAll()
 {
@@ -12,6 +13,7 @@ std::vector<tiny::Lexeme> tiny::Lexer::lexAll()
             continue;
         }
 
+        tiny::Statistics::get().addLexeme(lexeme.token);
         lexemes.push_back(lexeme);
     }
 
@@ -66,7 +68,7 @@ tiny::Lexeme tiny::Lexer::lex()
         while (true) {
             if (!s) {
                 meta.end = s.getIndex();
-                throw tiny::LexError("Unclosed multiline comment", getMetadata());
+                throw tiny::LexError(tiny::DiagnosticId::UnclosedComment, {}, getMetadata());
             }
 
             std::uint32_t got = s.get();
@@ -108,7 +110,7 @@ tiny::Lexeme tiny::Lexer::lex()
     }
 
     meta.end = s.getIndex();
-    throw tiny::LexError("Unknown symbol '"+tiny::String(input).toString()+"'", meta);
+    throw tiny::LexError(tiny::DiagnosticId::UnknownSymbol, {tiny::String(input).toString()}, meta);
 }
 
 tiny::Lexeme tiny::Lexer::lexId()
@@ -118,7 +120,7 @@ tiny::Lexeme tiny::Lexer::lexId()
     std::uint32_t input = s.get();
     if (input==StreamTerminator) {
         meta.end = s.getIndex();
-        throw tiny::LexError("End-of-file while parsing ID", meta);
+        throw tiny::LexError(tiny::DiagnosticId::EndOfFileInIdentifier, {}, meta);
     }
 
     tiny::String id(input);
@@ -144,7 +146,7 @@ tiny::Lexeme tiny::Lexer::lexNumericLiteral()
 
     if (input==StreamTerminator) {
         meta.end = s.getIndex();
-        throw tiny::LexError("End-of-file while parsing numeric literal", meta);
+        throw tiny::LexError(tiny::DiagnosticId::EndOfFileInNumber, {}, meta);
     }
 
     tiny::String number(input);
@@ -154,7 +156,7 @@ tiny::Lexeme tiny::Lexer::lexNumericLiteral()
         if (isdigit(char(s.peek()))) {
             // Disallow literals like 00.1 or 001 but allow 0.1 or 0
             meta.end = s.getIndex();
-            throw tiny::LexError("Numeric literals can't have a leading zero", meta);
+            throw tiny::LexError(tiny::DiagnosticId::LeadingZero, {}, meta);
         }
 
         if (s.peek()=='x') {
@@ -187,7 +189,7 @@ tiny::Lexeme tiny::Lexer::lexNumericLiteral()
     // Make sure we reject malformed decimal numbers like 3.12.14
     if (std::count(number.codepoints.begin(), number.codepoints.end(), '.')>1) {
         meta.end = s.getIndex();
-        throw tiny::LexError("Numeric literal has two decimal points", meta);
+        throw tiny::LexError(tiny::DiagnosticId::TwoDecimalPoints, {}, meta);
     }
 
     return Lexeme(tiny::Token::LiteralNum, number, meta);
@@ -199,7 +201,7 @@ tiny::Lexeme tiny::Lexer::lexStrLiteral()
 
     if (!s) {
         meta.end = s.getIndex();
-        throw tiny::LexError("End-of-file while parsing string literal", meta);
+        throw tiny::LexError(tiny::DiagnosticId::EndOfFileInString, {}, meta);
     }
 
     s.skip(); // step-over the first "
@@ -208,7 +210,7 @@ tiny::Lexeme tiny::Lexer::lexStrLiteral()
     for (std::uint32_t peek = s.peek(); peek!='"'; peek = s.peek()) {
         if (peek==StreamTerminator) {
             meta.end = s.getIndex();
-            throw tiny::LexError("End-of-file while parsing string literal", meta);
+            throw tiny::LexError(tiny::DiagnosticId::EndOfFileInString, {}, meta);
         }
 
         str += s.get();
@@ -225,7 +227,7 @@ tiny::Lexeme tiny::Lexer::lexCharLiteral()
 
     if (!s) {
         meta.end = s.getIndex();
-        throw tiny::LexError("End-of-file while parsing char literal", meta);
+        throw tiny::LexError(tiny::DiagnosticId::EndOfFileInChar, {}, meta);
     }
 
     s.skip(); // step-over the first '
@@ -233,7 +235,7 @@ tiny::Lexeme tiny::Lexer::lexCharLiteral()
     std::uint32_t next = s.get();
     if (s.get()!='\'') {
         meta.end = s.getIndex();
-        throw tiny::LexError("Invalid char definition", meta);
+        throw tiny::LexError(tiny::DiagnosticId::InvalidChar, {}, meta);
     }
 
     return Lexeme(tiny::Token::LiteralChar, tiny::String(next), meta);
@@ -439,6 +441,10 @@ tiny::String tiny::getTypeName(tiny::Token t)
         return "fixed32";
     case tiny::Token::TypeFixed64:
         return "fixed64";
+    case tiny::Token::TypeUFixed32:
+        return "ufixed32";
+    case tiny::Token::TypeUFixed64:
+        return "ufixed64";
 
         // Fixed-point
     case tiny::Token::TypeInt8:
@@ -449,6 +455,14 @@ tiny::String tiny::getTypeName(tiny::Token t)
         return "int32";
     case tiny::Token::TypeInt64:
         return "int64";
+    case tiny::Token::TypeUInt8:
+        return "uint8";
+    case tiny::Token::TypeUInt16:
+        return "uint16";
+    case tiny::Token::TypeUInt32:
+        return "uint32";
+    case tiny::Token::TypeUInt64:
+        return "uint64";
 
         // Floating-point
     case tiny::Token::TypeFloat32:
@@ -472,3 +486,164 @@ tiny::String tiny::getTypeName(tiny::Token t)
         return "";
     }
 }
+
+std::string tiny::toString(tiny::Token t)
+{
+    switch (t) {
+    case tiny::Token::None:
+        return "None";
+    case tiny::Token::Id:
+        return "Id";
+    case tiny::Token::KwConst:
+        return "KwConst";
+    case tiny::Token::KwImport:
+        return "KwImport";
+    case tiny::Token::KwModule:
+        return "KwModule";
+    case tiny::Token::KwStruct:
+        return "KwStruct";
+    case tiny::Token::KwTrait:
+        return "KwTrait";
+    case tiny::Token::KwFunc:
+        return "KwFunc";
+    case tiny::Token::KwAs:
+        return "KwAs";
+    case tiny::Token::KwIn:
+        return "KwIn";
+    case tiny::Token::KwIf:
+        return "KwIf";
+    case tiny::Token::KwElse:
+        return "KwElse";
+    case tiny::Token::KwFor:
+        return "KwFor";
+    case tiny::Token::KwReturn:
+        return "KwReturn";
+    case tiny::Token::KwAnd:
+        return "KwAnd";
+    case tiny::Token::KwOr:
+        return "KwOr";
+    case tiny::Token::TypeInt8:
+        return "TypeInt8";
+    case tiny::Token::TypeInt16:
+        return "TypeInt16";
+    case tiny::Token::TypeInt32:
+        return "TypeInt32";
+    case tiny::Token::TypeInt64:
+        return "TypeInt64";
+    case tiny::Token::TypeUInt8:
+        return "TypeUInt8";
+    case tiny::Token::TypeUInt16:
+        return "TypeUInt16";
+    case tiny::Token::TypeUInt32:
+        return "TypeUInt32";
+    case tiny::Token::TypeUInt64:
+        return "TypeUInt64";
+    case tiny::Token::TypeFixed32:
+        return "TypeFixed32";
+    case tiny::Token::TypeFixed64:
+        return "TypeFixed64";
+    case tiny::Token::TypeUFixed32:
+        return "TypeUFixed32";
+    case tiny::Token::TypeUFixed64:
+        return "TypeUFixed64";
+    case tiny::Token::TypeFloat32:
+        return "TypeFloat32";
+    case tiny::Token::TypeFloat64:
+        return "TypeFloat64";
+    case tiny::Token::TypeBool:
+        return "TypeBool";
+    case tiny::Token::TypeChar:
+        return "TypeChar";
+    case tiny::Token::TypeString:
+        return "TypeString";
+    case tiny::Token::TypeList:
+        return "TypeList";
+    case tiny::Token::TypeDict:
+        return "TypeDict";
+    case tiny::Token::TypeAny:
+        return "TypeAny";
+    case tiny::Token::Sum:
+        return "Sum";
+    case tiny::Token::Sub:
+        return "Sub";
+    case tiny::Token::Multi:
+        return "Multi";
+    case tiny::Token::Div:
+        return "Div";
+    case tiny::Token::Exp:
+        return "Exp";
+    case tiny::Token::Range:
+        return "Range";
+    case tiny::Token::Step:
+        return "Step";
+    case tiny::Token::Eq:
+        return "Eq";
+    case tiny::Token::Neq:
+        return "Neq";
+    case tiny::Token::Gt:
+        return "Gt";
+    case tiny::Token::Gteq:
+        return "Gteq";
+    case tiny::Token::Lt:
+        return "Lt";
+    case tiny::Token::Lteq:
+        return "Lteq";
+    case tiny::Token::Assign:
+        return "Assign";
+    case tiny::Token::AssignSum:
+        return "AssignSum";
+    case tiny::Token::AssignSub:
+        return "AssignSub";
+    case tiny::Token::AssignDiv:
+        return "AssignDiv";
+    case tiny::Token::AssignMulti:
+        return "AssignMulti";
+    case tiny::Token::Comma:
+        return "Comma";
+    case tiny::Token::NewLine:
+        return "NewLine";
+    case tiny::Token::Init:
+        return "Init";
+    case tiny::Token::Negation:
+        return "Negation";
+    case tiny::Token::MemberAccess:
+        return "MemberAccess";
+    case tiny::Token::Doublebang:
+        return "Doublebang";
+    case tiny::Token::Dereference:
+        return "Dereference";
+    case tiny::Token::ValueAt:
+        return "ValueAt";
+    case tiny::Token::OParenthesis:
+        return "OParenthesis";
+    case tiny::Token::CParenthesis:
+        return "CParenthesis";
+    case tiny::Token::OBraces:
+        return "OBraces";
+    case tiny::Token::CBraces:
+        return "CBraces";
+    case tiny::Token::OBrackets:
+        return "OBrackets";
+    case tiny::Token::CBrackets:
+        return "CBrackets";
+    case tiny::Token::LiteralNone:
+        return "LiteralNone";
+    case tiny::Token::LiteralTrue:
+        return "LiteralTrue";
+    case tiny::Token::LiteralFalse:
+        return "LiteralFalse";
+    case tiny::Token::LiteralNum:
+        return "LiteralNum";
+    case tiny::Token::LiteralStr:
+        return "LiteralStr";
+    case tiny::Token::LiteralChar:
+        return "LiteralChar";
+    case tiny::Token::SinglelineComment:
+        return "SinglelineComment";
+    case tiny::Token::MultilineComment:
+        return "MultilineComment";
+
+    default:
+        return "Unknown";
+    }
+}
@@ -141,6 +141,13 @@ namespace tiny {
      */
     [[nodiscard]] tiny::String getTypeName(tiny::Token t);
 
+    /*!
+     * \brief Returns the name of the Token
+     * \param t Token to stringify
+     * \return The name of the Token as it's declared (for example Token::KwFunc will become "KwFunc")
+     */
+    [[nodiscard]] std::string toString(tiny::Token t);
+
     //! A Lexeme is the product of the Lexer. It defines a token and optionally it's associated data.
     struct Lexeme {
         explicit Lexeme() = default;
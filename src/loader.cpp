@@ -0,0 +1,547 @@
+#include "loader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "errors.h"
+#include "alloctrack.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TINY_HAS_PREAD
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define TINY_HAS_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+std::vector<char> tiny::BufferPool::acquire(std::size_t size) {
+    std::vector<char> buffer;
+
+    {
+        std::lock_guard lock(mtx);
+
+        // Prefer a buffer that is big enough already, so it doesn't have to grow
+        auto it = std::find_if(buffers.begin(), buffers.end(), [&](const std::vector<char> &b) {
+            return b.capacity() >= size;
+        });
+
+        if (it == buffers.end() && !buffers.empty()) {
+            it = buffers.end() - 1;
+        }
+
+        if (it != buffers.end()) {
+            buffer = std::move(*it);
+            buffers.erase(it);
+        }
+    }
+
+    buffer.resize(size);
+    return buffer;
+}
+
+void tiny::BufferPool::release(std::vector<char> buffer) {
+    std::lock_guard lock(mtx);
+    if (buffers.size() < MAX_BUFFERS) {
+        buffers.push_back(std::move(buffer));
+    }
+}
+
+std::size_t tiny::BufferPool::size() {
+    std::lock_guard lock(mtx);
+    return buffers.size();
+}
+
+void tiny::BufferPool::clear() {
+    std::lock_guard lock(mtx);
+    buffers.clear();
+}
+
+#if defined(TINY_HAS_IO_URING)
+
+//! An io_uring instance, set up with raw system calls
+struct tiny::FileLoader::Ring {
+    //! Number of submission queue entries
+    static constexpr unsigned ENTRIES = 64;
+
+    int fd = -1;
+
+    void *sqMap = MAP_FAILED;
+    std::size_t sqMapSize = 0;
+    void *cqMap = MAP_FAILED;
+    std::size_t cqMapSize = 0;
+    io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    std::size_t sqesSize = 0;
+
+    unsigned *sqHead = nullptr;
+    unsigned *sqTail = nullptr;
+    unsigned *sqMask = nullptr;
+    unsigned *sqArray = nullptr;
+    unsigned sqEntries = 0;
+
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned *cqMask = nullptr;
+    io_uring_cqe *cqes = nullptr;
+
+    //! Entries queued since the last submission
+    unsigned toSubmit = 0;
+
+    //! Sets up the ring. Throws FileError if the kernel doesn't support it
+    Ring() {
+        io_uring_params params{};
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, ENTRIES, &params));
+        if (fd < 0) {
+            throw tiny::FileError("io_uring_setup failed: " + std::string(std::strerror(errno)));
+        }
+
+        sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap) {
+            sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+        }
+
+        sqMap = mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqMap == MAP_FAILED) {
+            throw tiny::FileError("Unable to map the io_uring submission queue");
+        }
+
+        if (singleMap) {
+            cqMap = sqMap;
+        } else {
+            cqMap = mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                         IORING_OFF_CQ_RING);
+            if (cqMap == MAP_FAILED) {
+                throw tiny::FileError("Unable to map the io_uring completion queue");
+            }
+        }
+
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                                fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            throw tiny::FileError("Unable to map the io_uring submission entries");
+        }
+
+        auto *sq = static_cast<char *>(sqMap);
+        sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        sqEntries = params.sq_entries;
+
+        auto *cq = static_cast<char *>(cqMap);
+        cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    ~Ring() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqesSize);
+        }
+
+        if (cqMap != MAP_FAILED && cqMap != sqMap) {
+            munmap(cqMap, cqMapSize);
+        }
+
+        if (sqMap != MAP_FAILED) {
+            munmap(sqMap, sqMapSize);
+        }
+
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    //! Queues a read. The ring must have room for it
+    void queueRead(int file, void *buffer, unsigned length, std::uint64_t offset, std::uint64_t userData) {
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+
+        auto &sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = file;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+        sqe.len = length;
+        sqe.off = offset;
+        sqe.user_data = userData;
+
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        toSubmit++;
+    }
+
+    //! Submits the queued entries and, if asked to, waits for at least one completion
+    void enter(bool waitForCompletion) {
+        unsigned flags = waitForCompletion ? IORING_ENTER_GETEVENTS : 0;
+        while (toSubmit > 0 || waitForCompletion) {
+            auto submitted = syscall(__NR_io_uring_enter, fd, toSubmit, waitForCompletion ? 1 : 0, flags, nullptr, 0);
+            if (submitted < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                throw tiny::FileError("io_uring_enter failed: " + std::string(std::strerror(errno)));
+            }
+
+            toSubmit -= std::min<unsigned>(toSubmit, static_cast<unsigned>(submitted));
+            waitForCompletion = false;
+            flags = 0;
+        }
+    }
+};
+
+#else
+
+//! Without io_uring support the ring is never built
+struct tiny::FileLoader::Ring {
+    static constexpr unsigned ENTRIES = 0;
+};
+
+#endif
+
+bool tiny::FileLoader::isIoUringAvailable() {
+#if defined(TINY_HAS_IO_URING)
+    static const bool available = []() {
+        try {
+            Ring ring;
+            return true;
+        } catch (const tiny::FileError &) {
+            return false; // Old kernels, or blocked by seccomp in containers
+        }
+    }();
+
+    return available;
+#else
+    return false;
+#endif
+}
+
+tiny::FileLoader::FileLoader(const std::vector<std::filesystem::path> &paths, tiny::LoadBackend requested)
+        : backend(requested) {
+    entries.resize(paths.size());
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        entries[i].path = paths[i];
+    }
+
+#if defined(TINY_HAS_IO_URING)
+    if (backend != tiny::LoadBackend::ThreadPool) {
+        try {
+            ring = std::make_unique<Ring>();
+        } catch (const tiny::FileError &) {
+            // Fall back to the thread pool
+        }
+    }
+
+    if (ring) {
+        backend = tiny::LoadBackend::IoUring;
+
+        try {
+            std::lock_guard lock(mtx);
+            submitReads();
+        } catch (const tiny::FileError &) {
+            // The destructor doesn't run when the constructor throws, so close the files opened so far here
+            release();
+            throw;
+        }
+
+        return;
+    }
+#endif
+
+    backend = tiny::LoadBackend::ThreadPool;
+
+    // The tasks run on other threads, which count their allocations like the thread that built the loader
+    auto *allocations = tiny::AllocationTracker::getCounters();
+    auto phase = tiny::AllocationTracker::getPhase();
+
+    auto &scheduler = tiny::Scheduler::get();
+    tasks.reserve(entries.size());
+    for (auto &entry: entries) {
+        tasks.push_back(scheduler.submit([&entry, allocations, phase]() {
+            tiny::AllocationScope allocationScope(allocations);
+            tiny::PhaseScope phaseScope(phase);
+            readFile(entry);
+        }));
+    }
+}
+
+tiny::FileLoader::~FileLoader() {
+    release();
+}
+
+void tiny::FileLoader::release() {
+    if (ring) {
+#if defined(TINY_HAS_IO_URING)
+        // The kernel writes into the buffers until the reads complete
+        std::lock_guard lock(mtx);
+        nextSubmit = entries.size();
+
+        while (inFlight > 0) {
+            try {
+                ring->enter(true);
+                reapCompletions();
+            } catch (const tiny::FileError &) {
+                break;
+            }
+        }
+#endif
+    } else {
+        for (auto const &task: tasks) {
+            try {
+                tiny::Scheduler::get().wait(task);
+            } catch (...) {
+                // Read errors were already reported by wait(index), or nobody asked for the file
+            }
+        }
+    }
+
+    auto &pool = tiny::BufferPool::get();
+    for (auto &entry: entries) {
+#if defined(TINY_HAS_PREAD)
+        if (entry.fd >= 0) {
+            close(entry.fd);
+        }
+#endif
+
+        pool.release(std::move(entry.buffer));
+    }
+}
+
+tiny::LoadBackend tiny::FileLoader::getBackend() const {
+    return backend;
+}
+
+std::string_view tiny::FileLoader::wait(std::size_t index) {
+    auto &entry = entries.at(index);
+
+    if (!ring) {
+        tiny::Scheduler::get().wait(tasks[index]);
+        return {entry.buffer.data(), entry.filled};
+    }
+
+#if defined(TINY_HAS_IO_URING)
+    std::unique_lock lock(mtx);
+    while (!entry.done) {
+        if (reaping) {
+            cv.wait(lock);
+            continue;
+        }
+
+        // Become the thread that waits for completions, and let the others sleep
+        reaping = true;
+        lock.unlock();
+
+        std::string error;
+        try {
+            ring->enter(true);
+        } catch (const tiny::FileError &e) {
+            error = e.msg;
+        }
+
+        lock.lock();
+        reaping = false;
+
+        if (error.empty()) {
+            try {
+                reapCompletions();
+                submitReads();
+            } catch (const tiny::FileError &e) {
+                error = e.msg;
+            }
+        }
+
+        // Wake the other waiters even on errors, or they would sleep forever with nobody reaping
+        cv.notify_all();
+
+        if (!error.empty()) {
+            throw tiny::FileError(error);
+        }
+    }
+#endif
+
+    if (!entry.error.empty()) {
+        throw tiny::FileError(entry.error);
+    }
+
+    return {entry.buffer.data(), entry.filled};
+}
+
+void tiny::FileLoader::submitReads() {
+#if defined(TINY_HAS_IO_URING)
+    while (nextSubmit < entries.size() && inFlight < ring->sqEntries) {
+        auto index = nextSubmit++;
+        auto &entry = entries[index];
+
+        entry.fd = open(entry.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (entry.fd < 0) {
+            finish(index, "Unable to open '" + entry.path.string() + "': " + std::strerror(errno));
+            continue;
+        }
+
+        struct stat st{};
+        if (fstat(entry.fd, &st) != 0) {
+            finish(index, "Unable to read '" + entry.path.string() + "': " + std::strerror(errno));
+            continue;
+        }
+
+        entry.buffer = tiny::BufferPool::get().acquire(static_cast<std::size_t>(st.st_size));
+        if (entry.buffer.empty()) {
+            finish(index);
+            continue;
+        }
+
+        submitRead(index);
+    }
+
+    ring->enter(false);
+#endif
+}
+
+void tiny::FileLoader::submitRead([[maybe_unused]] std::size_t index) {
+#if defined(TINY_HAS_IO_URING)
+    auto &entry = entries[index];
+    auto remaining = entry.buffer.size() - entry.filled;
+    ring->queueRead(entry.fd, entry.buffer.data() + entry.filled,
+                    static_cast<unsigned>(std::min<std::size_t>(remaining, 1u << 30)), entry.filled, index);
+    inFlight++;
+#endif
+}
+
+void tiny::FileLoader::reapCompletions() {
+#if defined(TINY_HAS_IO_URING)
+    unsigned head = *ring->cqHead;
+    unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; head++) {
+        auto const &cqe = ring->cqes[head & *ring->cqMask];
+        auto index = static_cast<std::size_t>(cqe.user_data);
+        auto result = cqe.res;
+        inFlight--;
+
+        auto &entry = entries[index];
+        if (result == -EINVAL || result == -EOPNOTSUPP) {
+            // Kernels before 5.6 don't have IORING_OP_READ, read this one synchronously. readFile gets its own buffer
+            tiny::BufferPool::get().release(std::move(entry.buffer));
+            entry.buffer.clear();
+            entry.filled = 0;
+            close(entry.fd);
+            entry.fd = -1;
+
+            try {
+                readFile(entry);
+            } catch (const tiny::FileError &) {
+                // Kept in the entry, thrown by wait()
+            }
+
+            finish(index, entry.error);
+        } else if (result < 0) {
+            finish(index, "Unable to read '" + entry.path.string() + "': " + std::strerror(-result));
+        } else {
+            entry.filled += static_cast<std::size_t>(result);
+
+            // Files can shrink while being read, or reads can come back short
+            if (result == 0 || entry.filled == entry.buffer.size()) {
+                finish(index);
+            } else {
+                submitRead(index);
+            }
+        }
+    }
+
+    __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    ring->enter(false);
+#endif
+}
+
+void tiny::FileLoader::finish(std::size_t index, std::string error) {
+    auto &entry = entries[index];
+#if defined(TINY_HAS_PREAD)
+    if (entry.fd >= 0) {
+        close(entry.fd);
+        entry.fd = -1;
+    }
+#endif
+
+    entry.error = std::move(error);
+    entry.done = true;
+}
+
+void tiny::FileLoader::readFile(Entry &entry) {
+#if defined(TINY_HAS_PREAD)
+    int fd = open(entry.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        entry.error = "Unable to open '" + entry.path.string() + "': " + std::strerror(errno);
+        throw tiny::FileError(entry.error);
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        entry.error = "Unable to read '" + entry.path.string() + "': " + std::strerror(errno);
+        throw tiny::FileError(entry.error);
+    }
+
+    entry.buffer = tiny::BufferPool::get().acquire(static_cast<std::size_t>(st.st_size));
+    while (entry.filled < entry.buffer.size()) {
+        auto result = pread(fd, entry.buffer.data() + entry.filled, entry.buffer.size() - entry.filled,
+                            static_cast<off_t>(entry.filled));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (result < 0) {
+            close(fd);
+            entry.error = "Unable to read '" + entry.path.string() + "': " + std::strerror(errno);
+            throw tiny::FileError(entry.error);
+        }
+
+        if (result == 0) {
+            break;
+        }
+
+        entry.filled += static_cast<std::size_t>(result);
+    }
+
+    close(fd);
+#else
+    std::ifstream in(entry.path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        entry.error = "Unable to open '" + entry.path.string() + "'";
+        throw tiny::FileError(entry.error);
+    }
+
+    auto size = static_cast<std::size_t>(in.tellg());
+    in.seekg(0);
+
+    entry.buffer = tiny::BufferPool::get().acquire(size);
+    in.read(entry.buffer.data(), static_cast<std::streamsize>(size));
+    if (in.bad()) {
+        entry.error = "Unable to read '" + entry.path.string() + "'";
+        throw tiny::FileError(entry.error);
+    }
+
+    // Files can shrink while being read
+    entry.filled = static_cast<std::size_t>(in.gcount());
+#endif
+
+    entry.done = true;
+}
@@ -0,0 +1,161 @@
+#ifndef TINY_LOADER_H
+#define TINY_LOADER_H
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "scheduler.h"
+
+namespace tiny {
+    /*!
+     * \brief A pool of read buffers, reused across compilations
+     *
+     * A pool of read buffers, reused across compilations so the watch mode and the compile server don't allocate the
+     * source buffers again on every build. Thread-safe.
+     */
+    class BufferPool {
+    public:
+        BufferPool(BufferPool const &) = delete;       // Meyers' singleton pattern. Don't Implement
+        void operator=(BufferPool const &) = delete;   // Ibidem
+
+        //! Get the singleton instance
+        static BufferPool &get() {
+            static BufferPool instance;
+            return instance;
+        }
+
+        /*!
+         * \brief Takes a buffer out of the pool, or allocates one if the pool is empty
+         * \param size Size of the buffer
+         * \return A buffer of the given size
+         */
+        std::vector<char> acquire(std::size_t size);
+
+        /*!
+         * \brief Gives a buffer back to the pool
+         * \param buffer The buffer
+         */
+        void release(std::vector<char> buffer);
+
+        //! Gets the number of buffers in the pool
+        std::size_t size();
+
+        //! Frees the buffers in the pool
+        void clear();
+
+    private:
+        //! Default constructor
+        BufferPool() = default;
+
+        //! Buffers beyond this number are freed instead of pooled
+        static constexpr std::size_t MAX_BUFFERS = 256;
+
+        std::mutex mtx;
+        //! Buffers ready to be reused
+        std::vector<std::vector<char>> buffers;
+    };
+
+    //! The mechanisms a FileLoader can read files with
+    enum class LoadBackend {
+        //! io_uring if the kernel supports it, ThreadPool otherwise
+        Auto,
+        //! Batched reads submitted to an io_uring instance
+        IoUring,
+        //! A pread per file (or a std::ifstream off POSIX systems), as Scheduler tasks
+        ThreadPool,
+    };
+
+    /*!
+     * \brief Reads a set of files ahead of their use
+     *
+     * Reads a set of files ahead of their use, so a file gets loaded while the previous ones are being lexed. Every
+     * read starts when the loader is built, and wait() blocks until one file is loaded. With io_uring the reads are
+     * submitted in batches and a single thread reaps the completions at a time. Otherwise each file is read with pread
+     * (or a std::ifstream off POSIX systems) on a Scheduler task. The contents live in buffers from the BufferPool,
+     * given back when the loader is destroyed.
+     */
+    class FileLoader {
+    public:
+        /*!
+         * \brief Starts loading files
+         * \param paths Paths of the files
+         * \param backend The mechanism to read the files with
+         */
+        explicit FileLoader(const std::vector<std::filesystem::path> &paths,
+                            tiny::LoadBackend backend = tiny::LoadBackend::Auto);
+
+        //! Waits for the reads in flight and gives the buffers back to the pool
+        ~FileLoader();
+
+        FileLoader(const FileLoader &) = delete;
+        FileLoader &operator=(const FileLoader &) = delete;
+
+        /*!
+         * \brief Waits for a file to be loaded
+         * \param index Index of the file, in the order given to the constructor
+         * \return The contents of the file. Valid for the lifetime of the loader
+         *
+         * Waits for a file to be loaded. Throws FileError if the file couldn't be read.
+         */
+        std::string_view wait(std::size_t index);
+
+        //! Gets the mechanism the files are read with. Never Auto
+        [[nodiscard]] tiny::LoadBackend getBackend() const;
+
+        //! Whether the kernel supports io_uring
+        static bool isIoUringAvailable();
+
+    private:
+        //! A file being loaded
+        struct Entry {
+            std::filesystem::path path;
+            std::vector<char> buffer;
+            //! Bytes read so far
+            std::size_t filled = 0;
+            //! Open file, while reading it with io_uring
+            int fd = -1;
+            bool done = false;
+            //! Why the read failed. Empty if it didn't
+            std::string error;
+        };
+
+        struct Ring;
+
+        //! Opens the next files and submits their reads, as long as the ring has room. Called with the lock held
+        void submitReads();
+        //! Submits the read of the rest of a file. Called with the lock held
+        void submitRead(std::size_t index);
+        //! Handles the completions in the ring. Called with the lock held
+        void reapCompletions();
+        //! Marks a file as loaded, or failed if an error is given. Called with the lock held
+        void finish(std::size_t index, std::string error = "");
+        //! Reads a whole file with pread
+        static void readFile(Entry &entry);
+        //! Waits for the reads in flight, closes the files and gives the buffers back to the pool
+        void release();
+
+        tiny::LoadBackend backend;
+        std::vector<Entry> entries;
+
+        //! The io_uring instance. Null with the ThreadPool backend
+        std::unique_ptr<Ring> ring;
+        //! Index of the next file to submit
+        std::size_t nextSubmit = 0;
+        //! Reads submitted and not completed
+        std::size_t inFlight = 0;
+        //! Whether a thread is waiting for completions
+        bool reaping = false;
+        std::mutex mtx;
+        std::condition_variable cv;
+
+        //! The read tasks of the ThreadPool backend
+        std::vector<tiny::TaskHandle> tasks;
+    };
+}
+
+#endif //TINY_LOADER_H
@@ -1,6 +1,341 @@
 #include "logger.h"
 
 #include <filesystem>
+#include <map>
+
+#if !defined(_WIN32)
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <unistd.h>
+
+//! A message formatted into a ring slot. Longer messages spill into a heap string
+struct LogSlot {
+    //! Number of bytes kept inline
+    static constexpr std::size_t INLINE_SIZE = 232;
+
+    //! Order in which the message was logged
+    std::uint64_t sequence = 0;
+    //! Length of the formatted message
+    std::uint32_t length = 0;
+    //! The message, if it didn't fit inline. Owned by the slot until the writer takes it
+    std::string *overflow = nullptr;
+    //! The message, if it fit
+    char text[INLINE_SIZE] = {};
+};
+
+//! A single-producer, single-consumer ring of messages. Each logging thread owns one
+struct LogRing {
+    static constexpr std::size_t SIZE = 256;
+
+    std::array<LogSlot, SIZE> slots;
+
+    //! Next slot to read. Only written by the writer thread
+    alignas(64) std::atomic<std::uint64_t> head{0};
+    //! Next slot to write. Only written by the owning thread
+    alignas(64) std::atomic<std::uint64_t> tail{0};
+    //! Set once the owning thread exits, so the writer can drop the ring once it's empty
+    std::atomic<bool> closed{false};
+};
+
+struct tiny::Logger::Backend {
+    //! Messages get numbered from here on
+    std::atomic<std::uint64_t> nextSequence{0};
+    //! Every message numbered below this one was written
+    std::atomic<std::uint64_t> writtenSequence{0};
+
+    //! File descriptor the messages are written to
+    std::atomic<int> output{STDOUT_FILENO};
+
+    //! The rings of the threads that logged. Locked only to register a ring and to list them
+    std::mutex ringsMutex;
+    std::vector<std::shared_ptr<LogRing>> rings;
+
+    std::thread writer;
+    std::once_flag started;
+    std::atomic<bool> stopping{false};
+
+    //! Wakes the writer when new messages arrive
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> work{false};
+
+    //! Signals the threads waiting in flush()
+    std::mutex flushMutex;
+    std::condition_variable flushed;
+
+    ~Backend() {
+        if (writer.joinable()) {
+            stopping = true;
+            notify();
+            writer.join();
+        }
+    }
+
+    //! Gets the ring of the calling thread, registering it the first time
+    LogRing &getRing() {
+        struct Handle {
+            std::shared_ptr<LogRing> ring;
+
+            ~Handle() {
+                if (ring) {
+                    ring->closed.store(true, std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local Handle handle;
+        if (!handle.ring) {
+            handle.ring = std::make_shared<LogRing>();
+
+            std::lock_guard lock(ringsMutex);
+            rings.push_back(handle.ring);
+        }
+
+        return *handle.ring;
+    }
+
+    //! Wakes the writer if it's waiting for messages
+    void notify() {
+        work.store(true, std::memory_order_release);
+        if (sleeping.load(std::memory_order_acquire)) {
+            wake.notify_one();
+        }
+    }
+
+    //! Formats a message into the ring of the calling thread
+    void push(tiny::LogLevel lv, std::string_view content) {
+        std::call_once(started, [this]() {
+            writer = std::thread([this]() { run(); });
+        });
+
+        static constexpr std::string_view names[] = {"FATAL", "ERROR", "WARNING", "INFO", "DEBUG"};
+        static constexpr std::string_view colours[] = {"31", "31", "33", "34", "37"};
+        auto index = std::size_t(lv) < 5 ? std::size_t(lv) : 0;
+
+        // [<colour>LEVEL<reset>] content
+        std::string_view parts[] = {"[\u001b[", colours[index], ";1m", names[index], "\u001b[0m] ", content, "\n"};
+
+        std::size_t length = 0;
+        for (auto const &part: parts) {
+            length += part.size();
+        }
+
+        auto &ring = getRing();
+        auto sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+
+        // Wait for the writer to make room. The writer drains every ring, so this can't deadlock
+        auto tail = ring.tail.load(std::memory_order_relaxed);
+        while (tail - ring.head.load(std::memory_order_acquire) >= LogRing::SIZE) {
+            notify();
+            std::this_thread::yield();
+        }
+
+        auto &slot = ring.slots[tail % LogRing::SIZE];
+        slot.sequence = sequence;
+        slot.length = static_cast<std::uint32_t>(length);
+
+        char *out = slot.text;
+        if (length > LogSlot::INLINE_SIZE) {
+            slot.overflow = new std::string(length, '\0');
+            out = slot.overflow->data();
+        }
+
+        for (auto const &part: parts) {
+            std::memcpy(out, part.data(), part.size());
+            out += part.size();
+        }
+
+        ring.tail.store(tail + 1, std::memory_order_release);
+        notify();
+    }
+
+    //! Writes a whole buffer, retrying on partial writes
+    void writeAll(const std::string &buffer) {
+        std::size_t written = 0;
+        while (written < buffer.size()) {
+            auto result = ::write(output.load(), buffer.data() + written, buffer.size() - written);
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (result <= 0) {
+                return; // Nowhere to write to. Drop the batch rather than blocking the loggers
+            }
+
+            written += static_cast<std::size_t>(result);
+        }
+    }
+
+    //! The writer thread. Drains the rings and writes the messages in the order they were logged
+    void run() {
+        std::uint64_t next = 0;
+        std::map<std::uint64_t, std::string> pending; // Messages logged after one that isn't drained yet
+        std::vector<std::shared_ptr<LogRing>> snapshot;
+        std::string batch;
+
+        while (true) {
+            work.store(false, std::memory_order_relaxed);
+
+            {
+                std::lock_guard lock(ringsMutex);
+                snapshot = rings;
+            }
+
+            bool drained = false;
+            for (auto const &ring: snapshot) {
+                auto head = ring->head.load(std::memory_order_relaxed);
+                auto tail = ring->tail.load(std::memory_order_acquire);
+
+                for (; head != tail; head++) {
+                    auto &slot = ring->slots[head % LogRing::SIZE];
+                    std::string_view text = slot.overflow != nullptr ? std::string_view(*slot.overflow)
+                                                                     : std::string_view(slot.text, slot.length);
+
+                    if (slot.sequence == next && pending.empty()) {
+                        batch += text;
+                        next++;
+                    } else {
+                        pending.emplace(slot.sequence, text);
+                    }
+
+                    delete slot.overflow;
+                    slot.overflow = nullptr;
+                    drained = true;
+                }
+
+                ring->head.store(head, std::memory_order_release);
+            }
+
+            for (auto it = pending.begin(); it != pending.end() && it->first == next; it = pending.erase(it)) {
+                batch += it->second;
+                next++;
+            }
+
+            if (!batch.empty()) {
+                writeAll(batch);
+                batch.clear();
+
+                {
+                    std::lock_guard lock(flushMutex);
+                    writtenSequence.store(next, std::memory_order_release);
+                }
+
+                flushed.notify_all();
+            }
+
+            // Drop the rings of the threads that exited, once they're empty
+            {
+                std::lock_guard lock(ringsMutex);
+                rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::shared_ptr<LogRing> &r) {
+                    return r->closed.load(std::memory_order_acquire) &&
+                           r->head.load(std::memory_order_relaxed) == r->tail.load(std::memory_order_acquire);
+                }), rings.end());
+            }
+
+            if (drained) {
+                continue;
+            }
+
+            if (stopping && next == nextSequence.load()) {
+                return;
+            }
+
+            // Sleep until a message arrives. The timeout covers a wake up sent right before sleeping
+            sleeping.store(true, std::memory_order_release);
+            {
+                std::unique_lock lock(wakeMutex);
+                wake.wait_for(lock, std::chrono::milliseconds(5), [this]() {
+                    return work.load(std::memory_order_acquire) || stopping.load();
+                });
+            }
+            sleeping.store(false, std::memory_order_release);
+        }
+    }
+
+    //! Waits until every message logged so far is written
+    void flush() {
+        if (!writer.joinable() || std::this_thread::get_id() == writer.get_id()) {
+            return;
+        }
+
+        auto target = nextSequence.load();
+        notify();
+
+        std::unique_lock lock(flushMutex);
+        while (writtenSequence.load(std::memory_order_acquire) < target) {
+            flushed.wait_for(lock, std::chrono::milliseconds(5));
+        }
+    }
+};
+
+namespace {
+    //! The terminate handler that was installed before the Logger's
+    std::terminate_handler previousTerminate = nullptr;
+
+    //! Writes the queued messages before the process ends on an uncaught exception or std::terminate
+    void flushOnTerminate() {
+        tiny::Logger::get().flush();
+
+        if (previousTerminate != nullptr) {
+            previousTerminate();
+        }
+
+        std::abort();
+    }
+}
+
+#else
+
+//! Windows writes synchronously, since the colours are set through the console API
+struct tiny::Logger::Backend {};
+
+#endif
+
+tiny::Logger::Logger() {
+#if !defined(_WIN32)
+    backend = std::make_unique<Backend>();
+    previousTerminate = std::set_terminate(flushOnTerminate);
+#endif
+}
+
+tiny::Logger::~Logger() {
+#if !defined(_WIN32)
+    std::set_terminate(previousTerminate);
+#endif
+}
+
+std::optional<tiny::LogLevel> tiny::toLogLevel(std::string_view name) {
+    static const std::map<std::string_view, tiny::LogLevel> levelTable {
+            {"debug", tiny::LogLevel::Debug},
+            {"info", tiny::LogLevel::Info},
+            {"warn", tiny::LogLevel::Warning},
+            {"warning", tiny::LogLevel::Warning},
+            {"warnings", tiny::LogLevel::Warning},
+            {"error", tiny::LogLevel::Error},
+            {"errors", tiny::LogLevel::Error},
+            {"fatal", tiny::LogLevel::Fatal},
+            {"disable", tiny::LogLevel::Disable},
+            {"disabled", tiny::LogLevel::Disable},
+    };
+
+    auto it = levelTable.find(name);
+    if (it == levelTable.end()) {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
 
 void tiny::Logger::setLevel(tiny::LogLevel lv) {
     level = lv;
@@ -20,11 +355,10 @@ void tiny::Logger::log(const tiny::LogMsg &msg) {
         return;
     }
 
+#if defined(_WIN32)
     const std::lock_guard<std::mutex> lock(mutex);
 
     std::string lv = tiny::LogMsg::levelToString(msg.level);
-
-#if defined(_WIN32)
     HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
 
     // Get the current console state so we can restore it
@@ -40,8 +374,26 @@ void tiny::Logger::log(const tiny::LogMsg &msg) {
     SetConsoleTextAttribute(console, consoleAttr); // Reset the console
     stream << "] " + msg.content + "\n";
 #else
-    stream << "[" << "\u001b[" << tiny::LogMsg::levelColour(msg.level) << ";1m" << lv;
-    stream << "\u001b[0m] " + msg.content + "\n";
+    backend->push(msg.level, msg.content);
+
+    if (msg.level == LogLevel::Fatal) {
+        backend->flush();
+    }
+#endif
+}
+
+void tiny::Logger::flush() {
+#if defined(_WIN32)
+    stream.flush();
+#else
+    backend->flush();
+#endif
+}
+
+void tiny::Logger::setOutput(int fd) {
+#if !defined(_WIN32)
+    backend->flush();
+    backend->output = fd;
 #endif
 }
 
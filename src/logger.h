@@ -2,7 +2,10 @@
 #define TINY_LOGGER_H
 
 #include <string>
+#include <string_view>
+#include <optional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 
 #if defined(_WIN32)
@@ -25,12 +28,24 @@ namespace tiny {
         Disable = -1,
     };
 
+    /*!
+     * \brief Parses the name of a logging level, as used by '--log' and tiny.toml
+     * \param name The name, like "debug" or "warn"
+     * \return The level, or nothing if the name is unknown
+     */
+    std::optional<tiny::LogLevel> toLogLevel(std::string_view name);
+
     /*!
      * \brief The Logger class handles formatted and pretty logging
      *
      * The Logger class handles formatted and pretty logging. It can be configured to any of several logging
-     * levels. By default the logger prints its output to std-io for non-error
-     * messages, and to std-err for error messages.
+     * levels. By default the logger prints its output to std-io.
+     *
+     * Outside of Windows, logging doesn't block on the output. Each thread formats its messages into its own lock-free
+     * ring buffer, and a background thread drains the rings and writes the messages in batches with write(2). Messages
+     * are numbered when logged and written in that order, so the messages about a file keep their order even when its
+     * steps run on different threads. Fatal messages are flushed before log() returns, and the pending ones before the
+     * process ends through std::terminate.
      */
     class Logger {
     public:
@@ -109,8 +124,22 @@ namespace tiny {
         */
         void fatal(const std::string &msg);
 
+        //! Waits until every message logged so far is written
+        void flush();
+
+        /*!
+         * \brief Sets the file descriptor the messages are written to. Flushes the pending messages first
+         * \param fd The file descriptor. Defaults to the standard output
+         */
+        void setOutput(int fd);
+
     private:
-        Logger() = default;
+        Logger();
+        ~Logger();
+
+        //! The asynchronous writer, outside of Windows
+        struct Backend;
+        std::unique_ptr<Backend> backend;
 
         //! Stream on which to log
         std::ostream& stream = std::cout;
@@ -1,16 +1,99 @@
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <memory>
+#include <optional>
 #include <string>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
 #include "logger.h"
 #include "compiler.h"
 #include "config.h"
 #include "errors.h"
+#include "profiler.h"
+#include "stats.h"
+#include "server.h"
+#include "watcher.h"
+#include "scheduler.h"
+#include "batch.h"
+#include "project.h"
+#include "diagstream.h"
+#include "corpus.h"
+#include "bytecode.h"
+#include "vm.h"
+#include "interpreter.h"
+#include "irbuilder.h"
+#include "passes.h"
+#include "cgen.h"
+
+namespace {
+    //! Writes the queued log messages when main() returns, before the program's output or exit status is seen
+    struct LogFlusher {
+        ~LogFlusher() {
+            tiny::Logger::get().flush();
+        }
+    };
+
+    //! Reports the statistics and the profile when main() returns, whichever command ran
+    struct ReportWriter {
+        //! Whether to log the statistics
+        bool stats = false;
+        //! Whether to log the profile summary
+        bool profile = false;
+        //! Where to write the trace, if anywhere
+        std::optional<std::string> traceOut;
+
+        ~ReportWriter() {
+            if (stats) {
+                tiny::Statistics::get().logSummary();
+                tiny::Scheduler::get().logSummary();
+            }
+
+            if (profile) {
+                tiny::Profiler::get().logSummary();
+            }
+
+            if (traceOut) {
+                try {
+                    tiny::Profiler::get().dumpTrace(*traceOut);
+                    tiny::info("Trace written to '" + *traceOut + "'");
+                } catch (const tiny::FileError &e) {
+                    tiny::error(e.msg);
+                }
+            }
+        }
+    };
+
+    //! Compiles the project in the current directory, keeping its ASTs. Returns nullopt if it doesn't compile
+    std::optional<std::vector<tiny::ASTFile>> compileProject(const std::optional<tiny::ProjectSettings> &project) {
+        tiny::Compiler compiler;
+        compiler.setProject(project);
+        compiler.setKeepASTs(true);
+
+        auto result = compiler.compile();
+        if (result.status != tiny::CompilationStatus::Ok) {
+            return std::nullopt;
+        }
+
+        auto files = std::move(result.files);
+        std::sort(files.begin(), files.end(), [](const tiny::ASTFile &a, const tiny::ASTFile &b) {
+            return a.file.path < b.file.path;
+        });
+
+        return files;
+    }
+}
 
 /*
  * Important: This is the WIP main, and it's here just for testing.
  */
 
 int main(int argc, char *argv[]) {
+    LogFlusher flusher;
+
     try {
         tiny::Configuration::get().parseArguments(argc, argv);
     } catch(const tiny::CLIError &e) {
@@ -18,9 +101,26 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    // Project settings apply unless they were given on the command line. Kept, so compiling doesn't read them again
+    std::optional<tiny::ProjectSettings> project;
+    if (auto projectFile = std::filesystem::current_path() / "tiny.toml"; std::filesystem::exists(projectFile)) {
+        try {
+            project = tiny::ProjectSettings::load(projectFile);
+            tiny::Configuration::get().applyProject(*project);
+        } catch (const tiny::TomlError &e) {
+            tiny::fatal("tiny.toml:" + std::to_string(e.line) + ":" + std::to_string(e.column) + ": " + e.msg);
+            return 1;
+        } catch (const tiny::FileError &e) {
+            tiny::fatal(e.what());
+            return 1;
+        }
+    }
+
+    // From here on the settings are only read
+    tiny::Configuration::get().freeze();
+
     // Set the logging level
-    auto lv = tiny::LogLevel(std::get<std::int32_t>(tiny::getSetting(tiny::Option::Log).param));
-    tiny::Logger::get().setLevel(lv);
+    tiny::Logger::get().setLevel(tiny::getSetting<tiny::Option::Log>());
 
     try {
         std::locale::global(std::locale("en_US.UTF8"));
@@ -29,12 +129,288 @@ int main(int argc, char *argv[]) {
         tiny::warn("Non-ASCII characters might be unrecognized.");
     }
 
-    if (tiny::getSetting(tiny::Option::PrintVersion).isEnabled) {
+    if (tiny::getSetting<tiny::Option::PrintVersion>()) {
+        tiny::Logger::get().flush();
         std::cout << TINY_NAME << " " << TINY_VERSION << " (" << TINY_VERSION_NICKNAME << "). "
                   << TINY_COPYRIGHT << " " << TINY_LICENCE << std::endl;
         return 0;
     }
 
+    auto const &traceOut = tiny::getSetting<tiny::Option::TraceOut>();
+    auto profile = tiny::getSetting<tiny::Option::Profile>();
+    if (traceOut || profile) {
+        tiny::Profiler::get().enable();
+    }
+
+    auto stats = tiny::getSetting<tiny::Option::Stats>();
+    if (stats) {
+        tiny::Statistics::get().enable();
+    }
+
+    ReportWriter report{stats, profile, traceOut};
+
+    // Under make -j share its job slots. Otherwise use as many as requested, or one per hardware thread
+    if (auto jobServer = tiny::JobServer::fromEnvironment()) {
+        tiny::debug("Using the make jobserver");
+        tiny::Scheduler::get().setJobServer(std::move(jobServer));
+    }
+
+    if (auto jobs = tiny::getSetting<tiny::Option::Jobs>(); jobs > 0) {
+        tiny::Scheduler::get().setJobs(jobs);
+    }
+
+    // Orchestrators can ask for the diagnostics as binary records on a descriptor they opened for us
+    std::unique_ptr<tiny::DiagnosticWriter> diagnostics;
+    if (auto fd = tiny::getSetting<tiny::Option::DiagnosticsFd>()) {
+        diagnostics = std::make_unique<tiny::DiagnosticWriter>(*fd);
+    }
+
+    // Generate a synthetic project to benchmark with, instead of compiling one
+    if (auto const &corpusRoot = tiny::getSetting<tiny::Option::Corpus>()) {
+        tiny::CorpusOptions options;
+        if (auto files = tiny::getSetting<tiny::Option::CorpusFiles>()) {
+            options.files = std::uint32_t(*files);
+        }
+
+        if (auto fileSize = tiny::getSetting<tiny::Option::CorpusFileSize>()) {
+            options.fileSize = std::uint64_t(*fileSize);
+        }
+
+        if (auto depth = tiny::getSetting<tiny::Option::CorpusDepth>()) {
+            options.depth = std::uint32_t(*depth);
+        }
+
+        if (auto seed = tiny::getSetting<tiny::Option::CorpusSeed>()) {
+            options.seed = std::uint64_t(*seed);
+        }
+
+        try {
+            auto bytes = tiny::CorpusGenerator(options).write(*corpusRoot);
+            tiny::info("Generated " + std::to_string(options.files) + " files (" + std::to_string(bytes)
+                       + " bytes) in '" + *corpusRoot + "'");
+        } catch (const tiny::FileError &e) {
+            tiny::fatal(e.what());
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (tiny::getSetting<tiny::Option::Serve>()) {
+        auto const &socket = tiny::getSetting<tiny::Option::Socket>();
+        if (!socket) {
+            tiny::fatal("The 'serve' mode requires a socket path ('--socket <path>')");
+            return 1;
+        }
+
+        try {
+            tiny::Server server(*socket);
+            server.run();
+        } catch (const tiny::ServerError &e) {
+            tiny::fatal(e.what());
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (auto const &server = tiny::getSetting<tiny::Option::Server>()) {
+        try {
+            tiny::Client client(*server);
+            auto result = client.build(std::filesystem::current_path());
+            if (diagnostics) {
+                diagnostics->write(result);
+            }
+
+            return result.status == tiny::CompilationStatus::Ok ? 0 : 1;
+        } catch (const tiny::ServerError &e) {
+            tiny::fatal(e.what());
+            return 1;
+        }
+    }
+
+    auto buildMany = tiny::getSetting(tiny::Option::BuildMany).isEnabled;
+    auto const &manifest = tiny::getSetting<tiny::Option::Manifest>();
+    if (buildMany || manifest) {
+        auto const &listedRoots = tiny::getSetting<tiny::Option::BuildMany>();
+        std::vector<std::filesystem::path> roots(listedRoots.begin(), listedRoots.end());
+
+        if (manifest) {
+            try {
+                auto listed = tiny::readManifest(*manifest);
+                roots.insert(roots.end(), listed.begin(), listed.end());
+            } catch (const tiny::FileError &e) {
+                tiny::fatal(e.what());
+                return 1;
+            }
+        }
+
+        if (roots.empty()) {
+            tiny::fatal("No projects to compile. List their directories after 'build-many' or in a '--manifest'");
+            return 1;
+        }
+
+        tiny::ASTCache cache;
+        auto results = tiny::compileProjects(roots, &cache);
+        tiny::logBatchSummary(results);
+
+        if (diagnostics) {
+            for (auto const &r: results) {
+                diagnostics->write(r.result, r.root);
+            }
+        }
+
+        for (auto const &r: results) {
+            if (r.result.status != tiny::CompilationStatus::Ok) {
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+    if (tiny::getSetting<tiny::Option::Watch>()) {
+        try {
+            tiny::Watcher watcher(std::filesystem::current_path());
+            if (diagnostics) {
+                watcher.setOnBuild([&diagnostics](const tiny::WatchBuild &build) {
+                    diagnostics->write(build.result);
+                });
+            }
+
+            watcher.run();
+        } catch (const tiny::WatchError &e) {
+            tiny::fatal(e.what());
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (tiny::getSetting<tiny::Option::EmitIR>()) {
+        auto files = compileProject(project);
+        if (!files) {
+            return 1;
+        }
+
+        try {
+            auto module = tiny::IRBuilder::build(*files);
+            tiny::PassManager::standard().run(module);
+
+            // The logger writes to the same descriptor from its own thread
+            tiny::Logger::get().flush();
+            std::cout << module.toString() << std::flush;
+        } catch (const tiny::CompilerError &e) {
+            tiny::fatal(e.meta.file.getRelativePath().string() + ": " + e.getMessage());
+            return 1;
+        }
+
+        return 0;
+    }
+
+    auto const &emitC = tiny::getSetting<tiny::Option::EmitC>();
+    auto const &native = tiny::getSetting<tiny::Option::Native>();
+    if (emitC || native) {
+        auto files = compileProject(project);
+        if (!files) {
+            return 1;
+        }
+
+        std::string source;
+        try {
+            source = tiny::CGenerator::generate(*files);
+        } catch (const tiny::CompilerError &e) {
+            tiny::fatal(e.meta.file.getRelativePath().string() + ": " + e.getMessage());
+            return 1;
+        }
+
+        // The C compiler needs a file, so without --emit-c the source only lives until it's compiled
+#if defined(__unix__) || defined(__APPLE__)
+        auto unique = std::to_string(::getpid());
+#else
+        auto unique = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        std::filesystem::path cFile = emitC ? std::filesystem::path(*emitC)
+                                            : std::filesystem::temp_directory_path() / ("tiny-" + unique + ".c");
+        {
+            std::ofstream out(cFile);
+            out << source;
+            if (!out) {
+                tiny::fatal("Unable to write the C source to '" + cFile.string() + "'");
+                return 1;
+            }
+        }
+
+        auto built = true;
+        if (native) {
+            try {
+                tiny::CGenerator::compileNative(cFile, *native);
+                tiny::info("Executable written to '" + *native + "'");
+            } catch (const tiny::NativeCompileError &e) {
+                tiny::fatal(e.what());
+                built = false;
+            }
+
+            if (!emitC) {
+                std::filesystem::remove(cFile);
+            }
+        }
+
+        return built ? 0 : 1;
+    }
+
+    if (tiny::getSetting(tiny::Option::Run).isEnabled) {
+        // The function to run (main by default) and its arguments
+        auto const &call = tiny::getSetting<tiny::Option::Run>();
+        auto function = call.empty() ? std::string("main") : call.front();
+
+        std::vector<tiny::RuntimeValue> args;
+        for (std::size_t i = 1; i < call.size(); i++) {
+            auto value = tiny::RuntimeValue::parse(call[i]);
+            if (!value) {
+                tiny::fatal("Invalid argument ('" + call[i] + "') for '" + function + "'");
+                return 1;
+            }
+
+            args.push_back(*value);
+        }
+
+        auto files = compileProject(project);
+        if (!files) {
+            return 1;
+        }
+
+        try {
+            // Closures start faster, bytecode runs faster
+            std::vector<tiny::RuntimeValue> results;
+            if (tiny::getSetting<tiny::Option::Tier>() == "closure") {
+                results = tiny::ClosureCompiler::compile(*files).call(function, args);
+            } else {
+                auto program = tiny::BytecodeCompiler::compile(*files);
+                results = tiny::VM(program).call(function, args);
+            }
+
+            // The logger writes to the same descriptor from its own thread
+            tiny::Logger::get().flush();
+            for (auto const &value: results) {
+                std::cout << value.toString() << std::endl;
+            }
+        } catch (const tiny::CompilerError &e) {
+            tiny::fatal(e.meta.file.getRelativePath().string() + ": " + e.getMessage());
+            return 1;
+        } catch (const tiny::ExecutionError &e) {
+            tiny::fatal(e.what());
+            return 1;
+        }
+
+        return 0;
+    }
+
     tiny::Compiler compiler;
-    compiler.compile();
+    compiler.setProject(project);
+    auto result = compiler.compile();
+
+    if (diagnostics) {
+        diagnostics->write(result);
+    }
 }
\ No newline at end of file
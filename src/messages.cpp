@@ -0,0 +1,79 @@
+#include "messages.h"
+
+std::string_view tiny::getMessageFormat(tiny::DiagnosticId id) {
+    switch (id) {
+    case DiagnosticId::Generic:
+        return "{0}";
+
+    case DiagnosticId::UnclosedComment:
+        return "Unclosed multiline comment";
+    case DiagnosticId::UnknownSymbol:
+        return "Unknown symbol '{0}'";
+    case DiagnosticId::EndOfFileInIdentifier:
+        return "End-of-file while parsing ID";
+    case DiagnosticId::EndOfFileInNumber:
+        return "End-of-file while parsing numeric literal";
+    case DiagnosticId::LeadingZero:
+        return "Numeric literals can't have a leading zero";
+    case DiagnosticId::TwoDecimalPoints:
+        return "Numeric literal has two decimal points";
+    case DiagnosticId::EndOfFileInString:
+        return "End-of-file while parsing string literal";
+    case DiagnosticId::EndOfFileInChar:
+        return "End-of-file while parsing char literal";
+    case DiagnosticId::InvalidChar:
+        return "Invalid char definition";
+
+    case DiagnosticId::UnexpectedEndOfFile:
+        return "Unexpected end-of-file";
+    case DiagnosticId::UnexpectedToken:
+        return "Unexpected token: expected {0} but got {1}";
+    case DiagnosticId::MissingModuleName:
+        return "No module name defined";
+    case DiagnosticId::ModuleNameRedefined:
+        return "The module name can only be defined once at the start of the file";
+    case DiagnosticId::MisplacedImport:
+        return "Import statements can only be placed immediately after the module name";
+    case DiagnosticId::ConstantInStruct:
+        return "Constant types are not allowed inside structs";
+    case DiagnosticId::ConstantInTrait:
+        return "Constant types are not allowed inside traits";
+    case DiagnosticId::MultipleStatements:
+        return "Invalid expression. Multiple statements";
+    case DiagnosticId::InitializeNonIdentifier:
+        return "Can only initialize identifiers";
+    case DiagnosticId::AssignNonIdentifier:
+        return "Invalid assignment. Can only assign a value to an identifier";
+    case DiagnosticId::InvalidLiteral:
+        return "Invalid literal";
+    case DiagnosticId::InvalidBooleanLiteral:
+        return "Invalid boolean literal";
+    }
+
+    return "{0}";
+}
+
+std::string tiny::renderMessage(tiny::DiagnosticId id, const std::vector<std::string> &args) {
+    auto format = getMessageFormat(id);
+
+    std::string result;
+    result.reserve(format.size());
+
+    for (std::size_t i = 0; i < format.size(); i++) {
+        // Placeholders are a single digit between braces
+        if (format[i] == '{' && i + 2 < format.size() && format[i + 2] == '}' && format[i + 1] >= '0' &&
+            format[i + 1] <= '9') {
+            auto arg = std::size_t(format[i + 1] - '0');
+            if (arg < args.size()) {
+                result += args[arg];
+            }
+
+            i += 2;
+            continue;
+        }
+
+        result += format[i];
+    }
+
+    return result;
+}
@@ -0,0 +1,70 @@
+#ifndef TINY_MESSAGES_H
+#define TINY_MESSAGES_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tiny {
+    //! How serious a diagnostic is
+    enum class Severity : std::uint8_t {
+        Error,
+        Warning,
+        Note,
+    };
+
+    /*!
+     * \brief Identifies the message of a diagnostic
+     *
+     * Identifies the message of a diagnostic. Diagnostics carry an id and the arguments of its message instead of the
+     * rendered text, so tools can match them without parsing text. The values are part of the binary diagnostics
+     * format: new ids go at the end, and existing ones never change.
+     */
+    enum class DiagnosticId : std::uint16_t {
+        //! A message without an id. The only argument is the whole message
+        Generic,
+
+        // Lexer
+        UnclosedComment,
+        UnknownSymbol,
+        EndOfFileInIdentifier,
+        EndOfFileInNumber,
+        LeadingZero,
+        TwoDecimalPoints,
+        EndOfFileInString,
+        EndOfFileInChar,
+        InvalidChar,
+
+        // Parser
+        UnexpectedEndOfFile,
+        UnexpectedToken,
+        MissingModuleName,
+        ModuleNameRedefined,
+        MisplacedImport,
+        ConstantInStruct,
+        ConstantInTrait,
+        MultipleStatements,
+        InitializeNonIdentifier,
+        AssignNonIdentifier,
+        InvalidLiteral,
+        InvalidBooleanLiteral,
+    };
+
+    /*!
+     * \brief Gets the format of a message, with its arguments as {0}, {1}...
+     * \param id The message
+     * \return The format
+     */
+    std::string_view getMessageFormat(tiny::DiagnosticId id);
+
+    /*!
+     * \brief Renders a message by replacing the placeholders of its format with the arguments
+     * \param id The message
+     * \param args The arguments
+     * \return The message. Missing arguments render as empty strings
+     */
+    std::string renderMessage(tiny::DiagnosticId id, const std::vector<std::string> &args);
+}
+
+#endif //TINY_MESSAGES_H
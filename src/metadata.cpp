@@ -1,4 +1,7 @@
 #include "metadata.h"
+
+#include <algorithm>
+
 #include "stringutil.h"
 
 std::pair<std::uint64_t, std::uint64_t> tiny::Metadata::getPosition(tiny::Stream<std::uint32_t> &s) const {
@@ -19,6 +22,31 @@ std::pair<std::uint64_t, std::uint64_t> tiny::Metadata::getPosition(tiny::Stream
     return {line, col};
 }
 
+std::pair<std::uint64_t, std::uint64_t> tiny::Metadata::getByteRange(tiny::Stream<std::uint32_t> &s) const {
+    auto prevState = s.getIndex(); // Save the index to restore it latter
+    auto last = std::max(end, start + 1);
+
+    std::uint64_t begin = 0;
+    std::uint64_t bytes = 0;
+
+    s.seek(0);
+    while (s && s.getIndex() < last) {
+        if (s.getIndex() == start) {
+            begin = bytes;
+        }
+
+        auto c = s.get();
+        bytes += c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+    }
+
+    if (start >= s.getIndex()) {
+        begin = bytes; // Points past the end of the stream
+    }
+
+    s.seek(prevState);
+    return {begin, bytes};
+}
+
 std::pair<std::string, std::int32_t>
 tiny::Metadata::getContext(tiny::Stream<std::uint32_t> &s, std::int32_t range) const {
     unsigned long prevState = s.getIndex(); // Save the index to restore it latter
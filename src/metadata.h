@@ -37,6 +37,13 @@ namespace tiny {
          */
         [[nodiscard]] std::pair<std::uint64_t, std::uint64_t> getPosition(tiny::Stream<std::uint32_t> &s) const;
 
+        /*!
+         * \brief Returns the byte offsets of the start and end positions in the UTF-8 encoding of the stream
+         * \param s Stream in which the range is calculated
+         * \return A [begin, end) byte offset pair. If the end is not set the range spans the start codepoint
+         */
+        [[nodiscard]] std::pair<std::uint64_t, std::uint64_t> getByteRange(tiny::Stream<std::uint32_t> &s) const;
+
         /*!
          * \brief Returns the context around the error and the position of the error in the context
          * \param s Stream in which the error was generated
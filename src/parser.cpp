@@ -8,13 +8,12 @@ tiny::Lexeme tiny::Parser::consume(const tiny::Token &token) {
 
     if (s.isTerminator(got)) {
         // Use the metadata of the last token
-        throw tiny::ParseError("Unexpected end-of-file", getMetadata());
+        throw tiny::ParseError(tiny::DiagnosticId::UnexpectedEndOfFile, {}, getMetadata());
     }
 
     if (token != got.token) {
-        throw tiny::ParseError(
-                "Unexpected token: expected " + tiny::Lexeme(token).string() + " but got " + got.string(),
-                got.metadata);
+        throw tiny::ParseError(tiny::DiagnosticId::UnexpectedToken, {tiny::Lexeme(token).string(), got.string()},
+                               got.metadata);
     }
 
     return got;
@@ -75,7 +74,7 @@ tiny::String tiny::Parser::moduleStatement(bool optional) {
             return "";
         }
 
-        throw tiny::ParseError("No module name defined", getMetadata());
+        throw tiny::ParseError(tiny::DiagnosticId::MissingModuleName, {}, getMetadata());
     }
 
     return consume(tiny::Token::Id).value;
@@ -161,10 +160,9 @@ tiny::ASTNode tiny::Parser::statement(std::vector<tiny::Token> terminators) {
         case tiny::Token::KwTrait:
             return traitStatement();
         case tiny::Token::KwModule:
-            throw tiny::ParseError("The module name can only be defined once at the start of the file", getMetadata());
+            throw tiny::ParseError(tiny::DiagnosticId::ModuleNameRedefined, {}, getMetadata());
         case tiny::Token::KwImport:
-            throw tiny::ParseError("Import statements can only be placed immediately after the module name",
-                                   getMetadata());
+            throw tiny::ParseError(tiny::DiagnosticId::MisplacedImport, {}, getMetadata());
         default:
             return expressionStatement(std::move(terminators));
     }
@@ -585,7 +583,7 @@ tiny::ASTNode tiny::Parser::structFieldList() {
 
         if (field.hasParam(tiny::ParameterType::Const)) {
             s.backup();
-            throw tiny::ParseError("Constant types are not allowed inside structs", s.get().metadata);
+            throw tiny::ParseError(tiny::DiagnosticId::ConstantInStruct, {}, s.get().metadata);
         }
 
         node.addChildren(field);
@@ -630,7 +628,7 @@ tiny::ASTNode tiny::Parser::traitFieldList() {
         auto field = typedExpression();
         if (field.hasParam(tiny::ParameterType::Const)) {
             s.backup();
-            throw tiny::ParseError("Constant types are not allowed inside traits", s.get().metadata);
+            throw tiny::ParseError(tiny::DiagnosticId::ConstantInTrait, {}, s.get().metadata);
         }
 
         node.addChildren(field);
@@ -661,7 +659,7 @@ tiny::ASTNode tiny::Parser::expressionStatement(std::vector<tiny::Token> termina
 
     // Check if the next token is a terminator
     if (std::find(terminators.begin(), terminators.end(), s.peek().token) == terminators.end()) {
-        throw ParseError("Invalid expression. Multiple statements", s.peek().metadata);
+        throw ParseError(tiny::DiagnosticId::MultipleStatements, {}, s.peek().metadata);
     }
 
     return exp;
@@ -719,7 +717,7 @@ tiny::ASTNode tiny::Parser::assignmentExpression() {
         case tiny::Token::Init: {
             op = tiny::ASTNodeType::Initialization;
             if (lhs.type != tiny::ASTNodeType::TypedExpression && lhs.type != tiny::ASTNodeType::Identifier) {
-                throw tiny::ParseError("Can only initialize identifiers", s.get().metadata);
+                throw tiny::ParseError(tiny::DiagnosticId::InitializeNonIdentifier, {}, s.get().metadata);
             }
 
             break;
@@ -755,7 +753,7 @@ tiny::ASTNode tiny::Parser::assignmentExpression() {
 
     if (lhs.type != tiny::ASTNodeType::TypedExpression && lhs.type != tiny::ASTNodeType::Identifier
         && lhs.type != tiny::ASTNodeType::MemberAccess && lhs.type != tiny::ASTNodeType::IndexedAccess) {
-        throw tiny::ParseError("Invalid assignment. Can only assign a value to an identifier", s.get().metadata);
+        throw tiny::ParseError(tiny::DiagnosticId::AssignNonIdentifier, {}, s.get().metadata);
     }
 
     auto exp = logicalExpression();
@@ -1130,7 +1128,7 @@ tiny::ASTNode tiny::Parser::literal() {
         case tiny::Token::LiteralNone:
             return literalNone();
         default:
-            throw ParseError("Invalid literal", s.peek().metadata);
+            throw ParseError(tiny::DiagnosticId::InvalidLiteral, {}, s.peek().metadata);
     }
 }
 
@@ -1195,7 +1193,7 @@ tiny::ASTNode tiny::Parser::literalBool() {
             node.val = false;
             return node;
         default:
-            throw tiny::ParseError("Invalid boolean literal", got.metadata);
+            throw tiny::ParseError(tiny::DiagnosticId::InvalidBooleanLiteral, {}, got.metadata);
     }
 }
 
@@ -0,0 +1,152 @@
+#include "passes.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "errors.h"
+
+namespace {
+    //! Checks a module, and throws IRError with its first problem if it's invalid
+    void check(const tiny::IRModule &module, const std::string &when) {
+        auto problems = module.verify();
+        if (!problems.empty()) {
+            throw tiny::IRError("Invalid IR " + when + ": " + problems.front(), tiny::Metadata());
+        }
+    }
+
+    //! Removes the given instructions from their blocks
+    void erase(tiny::IRFunction &fn, const std::unordered_set<const tiny::IRInstruction *> &removed) {
+        for (auto &block: fn.blocks) {
+            auto &instructions = block->instructions;
+            instructions.erase(std::remove_if(instructions.begin(), instructions.end(), [&](const auto &ins) {
+                return removed.count(ins.get()) > 0;
+            }), instructions.end());
+        }
+    }
+}
+
+tiny::PassManager tiny::PassManager::standard() {
+    tiny::PassManager manager;
+    manager.add(tiny::simplifyPhisPass());
+    manager.add(tiny::deadCodePass());
+    return manager;
+}
+
+void tiny::PassManager::add(tiny::IRPass pass) {
+    passes.push_back(std::move(pass));
+}
+
+std::size_t tiny::PassManager::run(tiny::IRModule &module) const {
+    if (verify) {
+        check(module, "before the passes");
+    }
+
+    std::size_t changes = 0;
+    for (auto const &pass: passes) {
+        std::size_t changed = 0;
+        for (auto &fn: module.functions) {
+            if (pass.run(fn)) {
+                changed++;
+            }
+        }
+
+        if (verify && changed > 0) {
+            check(module, "after pass '" + pass.name + "'");
+        }
+
+        changes += changed;
+    }
+
+    for (auto &fn: module.functions) {
+        fn.renumber();
+    }
+
+    return changes;
+}
+
+tiny::IRPass tiny::simplifyPhisPass() {
+    return {"simplify-phis", [](tiny::IRFunction &fn) {
+        // Removing a phi can make the phis that use it trivial, so repeat until none is left
+        auto changed = false;
+        for (auto progress = true; progress;) {
+            progress = false;
+            std::unordered_set<const tiny::IRInstruction *> removed;
+
+            for (auto &block: fn.blocks) {
+                for (auto &ins: block->instructions) {
+                    if (ins->op != tiny::IROp::Phi) {
+                        break;
+                    }
+
+                    tiny::IRInstruction *same = nullptr;
+                    auto trivial = true;
+                    for (auto *operand: ins->operands) {
+                        if (operand == same || operand == ins.get() || removed.count(operand) > 0) {
+                            continue;
+                        }
+
+                        if (same != nullptr) {
+                            trivial = false;
+                            break;
+                        }
+
+                        same = operand;
+                    }
+
+                    // A phi that only uses itself can't be reached, and is left to the dead code elimination
+                    if (trivial && same != nullptr) {
+                        fn.replaceUses(ins.get(), same);
+                        removed.insert(ins.get());
+                    }
+                }
+            }
+
+            if (!removed.empty()) {
+                erase(fn, removed);
+                progress = true;
+                changed = true;
+            }
+        }
+
+        return changed;
+    }};
+}
+
+tiny::IRPass tiny::deadCodePass() {
+    return {"dce", [](tiny::IRFunction &fn) {
+        // Everything instructions with side effects use, directly or not, is live
+        std::unordered_set<const tiny::IRInstruction *> live;
+        std::vector<const tiny::IRInstruction *> pending;
+        for (auto const &block: fn.blocks) {
+            for (auto const &ins: block->instructions) {
+                if (ins->hasSideEffects() || ins->op == tiny::IROp::Arg) {
+                    live.insert(ins.get());
+                    pending.push_back(ins.get());
+                }
+            }
+        }
+
+        while (!pending.empty()) {
+            auto const *ins = pending.back();
+            pending.pop_back();
+
+            for (auto const *operand: ins->operands) {
+                if (live.insert(operand).second) {
+                    pending.push_back(operand);
+                }
+            }
+        }
+
+        std::unordered_set<const tiny::IRInstruction *> removed;
+        for (auto const &block: fn.blocks) {
+            for (auto const &ins: block->instructions) {
+                if (live.count(ins.get()) == 0) {
+                    removed.insert(ins.get());
+                }
+            }
+        }
+
+        erase(fn, removed);
+        return !removed.empty();
+    }};
+}
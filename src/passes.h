@@ -0,0 +1,81 @@
+#ifndef TINY_PASSES_H
+#define TINY_PASSES_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ir.h"
+
+namespace tiny {
+    //! A transformation over the IR of a function
+    struct IRPass {
+        //! Identifies the pass in errors
+        std::string name;
+        //! Transforms a function in place, and returns whether it changed it
+        std::function<bool(tiny::IRFunction &)> run;
+    };
+
+    /*!
+     * \brief Runs passes over every function of a module, in the order they were added
+     *
+     * Runs passes over every function of a module, in the order they were added. Unless disabled, the module is
+     * verified before the first pass and after every pass that changed it, so a pass that breaks the IR is caught
+     * right away instead of by the passes that follow it.
+     */
+    class PassManager {
+    public:
+        /*!
+         * \brief Creates a PassManager with no passes
+         * \param verify Whether to verify the module between passes
+         */
+        explicit PassManager(bool verify = true) : verify(verify) {}
+
+        /*!
+         * \brief Creates a PassManager with the built-in passes
+         * \return The PassManager, which removes trivial phis and then dead code
+         */
+        static tiny::PassManager standard();
+
+        //! Adds a pass after every other pass
+        void add(tiny::IRPass pass);
+
+        //! Gets the passes, in the order they run
+        [[nodiscard]] const std::vector<tiny::IRPass> &getPasses() const { return passes; }
+
+        /*!
+         * \brief Runs every pass over every function of a module, and numbers the functions again
+         * \param module The module
+         * \return How many times a pass changed a function
+         *
+         * Runs every pass over every function of a module, and numbers the functions again. Throws IRError if the
+         * module is invalid before the passes or after any of them.
+         */
+        std::size_t run(tiny::IRModule &module) const;
+
+    private:
+        std::vector<tiny::IRPass> passes;
+        bool verify;
+    };
+
+    /*!
+     * \brief Gets the pass that removes trivial phis
+     * \return The pass, named "simplify-phis"
+     *
+     * Gets the pass that removes trivial phis. A phi is trivial if every operand is the same value or the phi itself,
+     * in which case its uses can use that value directly. Building SSA form leaves many of those behind, for example
+     * in the header of every loop for every variable read in the loop.
+     */
+    [[nodiscard]] tiny::IRPass simplifyPhisPass();
+
+    /*!
+     * \brief Gets the pass that removes dead code
+     * \return The pass, named "dce"
+     *
+     * Gets the pass that removes the instructions whose result isn't used, directly or through other instructions, by
+     * any instruction with side effects, such as a store, a call or a terminator. Arguments are always kept.
+     */
+    [[nodiscard]] tiny::IRPass deadCodePass();
+}
+
+#endif //TINY_PASSES_H
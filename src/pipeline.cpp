@@ -3,9 +3,9 @@
 #include "pipeline.h"
 #include "errors.h"
 #include "parser.h"
+#include "profiler.h"
 
-template<typename Output>
-std::string tiny::PipelineStage<Output>::getStepName() const {
+std::string_view tiny::toString(tiny::CompilationStep step) {
     switch (step) {
         case tiny::CompilationStep::FileSelection:
             return "FileSelection";
@@ -13,6 +13,10 @@ std::string tiny::PipelineStage<Output>::getStepName() const {
             return "Lexer";
         case tiny::CompilationStep::Parser:
             return "Parser";
+        case tiny::CompilationStep::SymbolTable:
+            return "SymbolTable";
+        case tiny::CompilationStep::Serialization:
+            return "Serialization";
 
         case tiny::CompilationStep::None:
         default:
@@ -20,16 +24,52 @@ std::string tiny::PipelineStage<Output>::getStepName() const {
     }
 }
 
+template<typename Output>
+std::string tiny::PipelineStage<Output>::getStepName() const {
+    return std::string(tiny::toString(step));
+}
+
+namespace {
+    //! The output type that flows through the pipe
+    template<typename Output>
+    /*!
+     * \brief Moves the value through each of the stages, and replaces it with the output of the last one
+     * \param stages The stages of the pipe
+     * \param value The value to move through the stages
+     */
+    void runPipe(const std::vector<tiny::PipelineStage<Output>> &stages, Output &value) {
+        for (const auto &s: stages) {
+            tiny::ProfileScope scope(s.name, "stage");
+            auto res = s.task(std::move(value));
+
+            switch (res.action) {
+                case tiny::StageAction::Continue:
+                    value = std::move(res.output);
+                    break;
+
+                case tiny::StageAction::Reject:
+                    throw tiny::PipelineRejectError(s.name, s.getStepName(), res.msg);
+
+                default:
+                    throw tiny::PipelineError(s.name, s.getStepName(), "Invalid action value");
+            }
+        }
+    }
+}
+
 void tiny::Pipeline::addFileSelectionStage(const tiny::PipelineStage<std::vector<tiny::File>> &s) {
     fileSelectionStages.push_back(s);
+    fileSelectionStages.back().step = tiny::CompilationStep::FileSelection;
 }
 
 void tiny::Pipeline::addLexStage(const tiny::PipelineStage<std::vector<tiny::Lexeme>> &s) {
     lexStages.push_back(s);
+    lexStages.back().step = tiny::CompilationStep::Lexer;
 }
 
 void tiny::Pipeline::addParseStage(const tiny::PipelineStage<tiny::ASTFile> &s) {
     parseStages.push_back(s);
+    parseStages.back().step = tiny::CompilationStep::Parser;
 }
 
 std::uint64_t tiny::Pipeline::getPipeLength(tiny::CompilationStep step) const {
@@ -47,63 +87,14 @@ std::uint64_t tiny::Pipeline::getPipeLength(tiny::CompilationStep step) const {
     }
 }
 
-
-std::vector<tiny::File> tiny::Pipeline::runFileSelectionPipe(std::vector<tiny::File> &files) const {
-    for (const auto &s: fileSelectionStages) {
-        auto res = s.task(files);
-        files = res.output;
-
-        switch (res.action) {
-            case tiny::StageAction::Continue:
-                break;
-
-            case tiny::StageAction::Reject:
-                throw tiny::PipelineRejectError(s.name, s.getStepName(), res.msg);
-
-            default:
-                throw tiny::PipelineError(s.name, s.getStepName(), "Invalid action value");
-        }
-    }
-
-    return files;
+void tiny::Pipeline::runFileSelectionPipe(std::vector<tiny::File> &files) const {
+    runPipe(fileSelectionStages, files);
 }
 
-std::vector<tiny::Lexeme> tiny::Pipeline::runLexPipe(std::vector<tiny::Lexeme> &lexemes) const {
-    for (const auto &s: lexStages) {
-        auto res = s.task(lexemes);
-        lexemes = res.output;
-
-        switch (res.action) {
-            case tiny::StageAction::Continue:
-                break;
-
-            case tiny::StageAction::Reject:
-                throw tiny::PipelineRejectError(s.name, s.getStepName(), res.msg);
-
-            default:
-                throw tiny::PipelineError(s.name, s.getStepName(), "Invalid action value");
-        }
-    }
-
-    return lexemes;
+void tiny::Pipeline::runLexPipe(std::vector<tiny::Lexeme> &lexemes) const {
+    runPipe(lexStages, lexemes);
 }
 
-tiny::ASTFile tiny::Pipeline::runParsePipe(tiny::ASTFile &files) const {
-    for (const auto &s: parseStages) {
-        auto res = s.task(files);
-        files = res.output;
-
-        switch (res.action) {
-            case tiny::StageAction::Continue:
-                break;
-
-            case tiny::StageAction::Reject:
-                throw tiny::PipelineRejectError(s.name, s.getStepName(), res.msg);
-
-            default:
-                throw tiny::PipelineError(s.name, s.getStepName(), "Invalid action value");
-        }
-    }
-
-    return files;
+void tiny::Pipeline::runParsePipe(tiny::ASTFile &file) const {
+    runPipe(parseStages, file);
 }
@@ -2,6 +2,7 @@
 #define TINY_PIPELINE_H
 
 #include <vector>
+#include <string_view>
 #include <fstream>
 #include <functional>
 
@@ -16,8 +17,17 @@ namespace tiny {
         FileSelection,
         Lexer,
         Parser,
+        SymbolTable,
+        Serialization,
     };
 
+    /*!
+     * \brief Gets the name of a compilation step
+     * \param step The step
+     * \return A view of the name of the step (for example "Lexer"). The name lives for the whole program
+     */
+    [[nodiscard]] std::string_view toString(tiny::CompilationStep step);
+
     //! The action taken by a stage. The stage can either Reject the code or Continue the pipeline
     enum class StageAction {
         None,
@@ -33,16 +43,16 @@ namespace tiny {
         explicit StageResult(tiny::StageAction a) : action(a) {};
 
         //! Constructs a result with only the output and defaults the action to Continue
-        explicit StageResult(Output o) : output(o) {};
+        explicit StageResult(Output o) : output(std::move(o)) {};
 
         //! Constructs a result without output
         StageResult(tiny::StageAction a, std::string_view msg) : action(a), msg(msg) {};
 
         //! Constructs a result without detail message
-        StageResult(tiny::StageAction a, Output o) : action(a), output(o) {};
+        StageResult(tiny::StageAction a, Output o) : action(a), output(std::move(o)) {};
 
         //! Full constructor for the result
-        StageResult(tiny::StageAction a, Output o, std::string_view msg) : action(a), output(o), msg(msg) {};
+        StageResult(tiny::StageAction a, Output o, std::string_view msg) : action(a), output(std::move(o)), msg(msg) {};
 
         //! The action which the stage decided to take
         tiny::StageAction action = tiny::StageAction::Continue;
@@ -61,11 +71,17 @@ namespace tiny {
      * A stage is a script that gets injected inside the compilation Pipeline. It is essentially a function that runs
      * after a step in the compiler, and receives as input the steps' or other stage's output and can modify the values
      * that get passed to the next step of compilation.
+     *
+     * The task takes ownership of its input and hands it back through the StageResult, so the pipeline moves the
+     * output from stage to stage without copying it. A stage that only inspects or edits the input in-place should
+     * move the same object into its result (e.g. `return tiny::StageResult(std::move(in));`).
      */
     struct PipelineStage {
+        //! The signature of the task. The input is owned by the task until it's handed back inside the result
+        using Task = std::function<StageResult<Output>(Output)>;
+
         //! Full constructor
-        PipelineStage(std::string_view name, std::function<StageResult<Output>(Output)> task) : name(name),
-                                                                                                task(task) {};
+        PipelineStage(std::string_view name, Task task) : name(name), task(std::move(task)) {};
 
         //! Arbitrary name for this stage
         std::string name;
@@ -73,7 +89,7 @@ namespace tiny {
         tiny::CompilationStep step = tiny::CompilationStep::None;
 
         //! The task (function) that this stages executes
-        std::function<StageResult<Output>(Output)> task;
+        Task task;
 
         /*!
          * \brief Gets a string with the name of the step
@@ -89,6 +105,10 @@ namespace tiny {
      * The pipeline simplifies the execution of scripts (stages) between steps in the compilation process. It holds
      * all the loaded stages and runs them back-to-back for a given stage until a final output is reached. This output
      * is then run through the next compilation step.
+     *
+     * The file selection pipe runs once per compilation, but the lexer and parser pipes run once per file, and files
+     * are compiled concurrently on the threads of the Scheduler. The stages of those pipes run back-to-back for each
+     * file, yet different files can be inside the same stage at once, so their tasks must be thread-safe.
      */
     class Pipeline {
         //! The stages to run after file selection
@@ -110,36 +130,42 @@ namespace tiny {
 
         /*!
          * \brief Adds a stage to the lexer pipe
-         * \param s A stage
+         * \param s A stage. Its task is called concurrently for different files, so it must be thread-safe
          */
         void addLexStage(const tiny::PipelineStage<std::vector<tiny::Lexeme>> &s);
 
         /*!
          * \brief Adds a stage to the parser pipe
-         * \param s A stage
+         * \param s A stage. Its task is called concurrently for different files, so it must be thread-safe
          */
         void addParseStage(const tiny::PipelineStage<tiny::ASTFile> &s);
 
         /*!
          * \brief Runs back-to-back all the stages inside the file selection pipe
-         * \param files The output of the file selector
-         * \return The output of the last stage, or the unmodified input if no stages are set
+         * \param files The output of the file selector. Replaced in-place by the output of the last stage
+         *
+         * The files are moved through the stages, so no copies are made. If a stage rejects the input or fails
+         * PipelineRejectError or PipelineError are thrown, and the contents of files are unspecified.
          */
-        std::vector<tiny::File> runFileSelectionPipe(std::vector<tiny::File> &files) const;
+        void runFileSelectionPipe(std::vector<tiny::File> &files) const;
 
         /*!
          * \brief Runs back-to-back all the stages inside the lexer pipe
-         * \param lexemes The output of the lexer
-         * \return The output of the last stage, or the unmodified input if no stages are set
+         * \param lexemes The output of the lexer. Replaced in-place by the output of the last stage
+         *
+         * The lexemes are moved through the stages, so no copies are made. If a stage rejects the input or fails
+         * PipelineRejectError or PipelineError are thrown, and the contents of lexemes are unspecified.
          */
-        std::vector<tiny::Lexeme> runLexPipe(std::vector<tiny::Lexeme> &lexemes) const;
+        void runLexPipe(std::vector<tiny::Lexeme> &lexemes) const;
 
         /*!
          * \brief Runs back-to-back all the stages inside the parser pipe
-         * \param files The output of the parser
-         * \return The output of the last stage, or the unmodified input if no stages are set
+         * \param file The output of the parser. Replaced in-place by the output of the last stage
+         *
+         * The AST is moved through the stages, so no copies are made. If a stage rejects the input or fails
+         * PipelineRejectError or PipelineError are thrown, and the contents of file are unspecified.
          */
-        tiny::ASTFile runParsePipe(tiny::ASTFile &file) const;
+        void runParsePipe(tiny::ASTFile &file) const;
 
         /*!
          * \brief Gets the length of a pipeline
@@ -0,0 +1,163 @@
+#include "profiler.h"
+
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+#include "logger.h"
+#include "errors.h"
+
+void tiny::Profiler::enable() {
+    epoch.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void tiny::Profiler::disable() {
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+std::uint64_t tiny::Profiler::now() const {
+    auto origin = std::chrono::steady_clock::duration(epoch.load(std::memory_order_relaxed));
+    auto elapsed = std::chrono::steady_clock::now().time_since_epoch() - origin;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void tiny::Profiler::record(tiny::ProfileEvent ev) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    events.push_back(std::move(ev));
+}
+
+std::vector<tiny::ProfileEvent> tiny::Profiler::getEvents() {
+    const std::lock_guard<std::mutex> lock(mutex);
+    return events;
+}
+
+void tiny::Profiler::clear() {
+    const std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+}
+
+nlohmann::json tiny::Profiler::toTraceJson() {
+    auto evs = getEvents();
+
+    std::vector<nlohmann::json> traceEvents;
+    traceEvents.reserve(evs.size() + 1);
+
+    traceEvents.push_back(nlohmann::json{
+            {"name", "process_name"},
+            {"ph",   "M"},
+            {"pid",  1},
+            {"args", {{"name", "tiny"}}},
+    });
+
+    std::vector<std::uint32_t> threads;
+    for (auto const &ev: evs) {
+        if (std::find(threads.begin(), threads.end(), ev.tid) == threads.end()) {
+            threads.push_back(ev.tid);
+        }
+
+        // Complete events ("X") carry both the start and the duration, in microseconds
+        traceEvents.push_back(nlohmann::json{
+                {"name", ev.name},
+                {"cat",  ev.category},
+                {"ph",   "X"},
+                {"ts",   ev.start},
+                {"dur",  ev.duration},
+                {"pid",  1},
+                {"tid",  ev.tid},
+        });
+    }
+
+    for (auto tid: threads) {
+        traceEvents.push_back(nlohmann::json{
+                {"name", "thread_name"},
+                {"ph",   "M"},
+                {"pid",  1},
+                {"tid",  tid},
+                {"args", {{"name", tid == 1 ? "main" : "worker " + std::to_string(tid - 1)}}},
+        });
+    }
+
+    return nlohmann::json{
+            {"traceEvents",     traceEvents},
+            {"displayTimeUnit", "ms"},
+    };
+}
+
+void tiny::Profiler::dumpTrace(const std::filesystem::path &path) {
+    std::ofstream traceOut;
+    traceOut.open(path);
+    traceOut << toTraceJson().dump();
+    traceOut.close();
+
+    if (!traceOut) {
+        throw tiny::FileError("Unable to write the trace to '" + path.string() + "'");
+    }
+}
+
+void tiny::Profiler::logSummary() {
+    struct Total {
+        std::string category;
+        std::string name;
+        std::uint64_t count = 0;
+        std::uint64_t duration = 0;
+    };
+
+    std::map<std::pair<std::string, std::string>, Total> totals;
+    for (auto const &ev: getEvents()) {
+        auto &total = totals[{ev.category, ev.name}];
+        total.category = ev.category;
+        total.name = ev.name;
+        total.count++;
+        total.duration += ev.duration;
+    }
+
+    std::vector<Total> sorted;
+    sorted.reserve(totals.size());
+    for (auto const &[_, total]: totals) {
+        sorted.push_back(total);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const Total &a, const Total &b) {
+        return a.duration > b.duration;
+    });
+
+    tiny::info("Profile (category, name, count, total time):");
+    for (auto const &total: sorted) {
+        std::ostringstream ms;
+        ms << std::fixed << std::setprecision(3) << double(total.duration) / 1000.0;
+        tiny::info("  [" + total.category + "] " + total.name + " x" + std::to_string(total.count) + ": " + ms.str() + "ms");
+    }
+}
+
+std::uint32_t tiny::Profiler::getThreadId() {
+    static std::atomic<std::uint32_t> nextId = 1;
+    thread_local std::uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+
+    return id;
+}
+
+tiny::ProfileScope::ProfileScope(std::string_view name, std::string_view category) {
+    auto &profiler = tiny::Profiler::get();
+    if (!profiler.isEnabled()) {
+        return;
+    }
+
+    active = true;
+    event.name = name;
+    event.category = category;
+    event.tid = tiny::Profiler::getThreadId();
+    event.start = profiler.now();
+}
+
+tiny::ProfileScope::~ProfileScope() {
+    if (!active) {
+        return;
+    }
+
+    auto &profiler = tiny::Profiler::get();
+    event.duration = profiler.now() - event.start;
+    profiler.record(std::move(event));
+}
@@ -0,0 +1,162 @@
+#ifndef TINY_PROFILER_H
+#define TINY_PROFILER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+
+#include "nlohmann/json.hpp"
+
+namespace tiny {
+    //! A timed event recorded by the Profiler
+    struct ProfileEvent {
+        //! Name of the event, such as the name of a step, a file or a pipeline stage
+        std::string name;
+        //! Category of the event. Used to group the events of the same kind
+        std::string category;
+        //! Start of the event, in microseconds since the Profiler was enabled
+        std::uint64_t start = 0;
+        //! Duration of the event, in microseconds
+        std::uint64_t duration = 0;
+        //! Identifier of the thread that recorded the event
+        std::uint32_t tid = 0;
+    };
+
+    /*!
+     * \brief The Profiler collects timed events of the compilation process
+     *
+     * The Profiler collects timed events of the compilation process, such as the time spent on each compilation
+     * step, on each file and on each pipeline stage. The events can be dumped as a Chrome Trace Event file (that can be
+     * opened with Perfetto or chrome://tracing) or summarized into the log. The Profiler is disabled by default, and
+     * while disabled recording events costs a single check.
+     */
+    class Profiler {
+    public:
+        Profiler(Profiler const &) = delete;            // Meyers' singleton pattern. Don't Implement
+        void operator=(Profiler const &) = delete;      // Ibidem
+
+        /*!
+         * \brief Fetches the Profiler's singleton instance
+         * \return The Profiler's singleton instance
+         */
+        static Profiler &get() {
+            static Profiler instance;
+            return instance;
+        }
+
+        /*!
+         * \brief Enables the recording of events, and sets the time origin of the events to now
+         */
+        void enable();
+
+        /*!
+         * \brief Stops the recording of events. Already recorded events are kept
+         */
+        void disable();
+
+        /*!
+         * \brief Returns whether the Profiler is recording events
+         * \return True if the Profiler is enabled
+         */
+        [[nodiscard]] bool isEnabled() const {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        /*!
+         * \brief Gets the current time, in microseconds since the Profiler was enabled
+         * \return The time in microseconds
+         */
+        [[nodiscard]] std::uint64_t now() const;
+
+        /*!
+         * \brief Records an event. Safe to call from multiple threads
+         * \param ev The event to record
+         */
+        void record(tiny::ProfileEvent ev);
+
+        /*!
+         * \brief Gets a copy of the recorded events
+         * \return A vector with the recorded events, in the order they finished
+         */
+        [[nodiscard]] std::vector<tiny::ProfileEvent> getEvents();
+
+        /*!
+         * \brief Discards all the recorded events
+         */
+        void clear();
+
+        /*!
+         * \brief Serializes the recorded events as a Chrome Trace Event JSON object
+         * \return A nlohmann::json with the trace
+         */
+        [[nodiscard]] nlohmann::json toTraceJson();
+
+        /*!
+         * \brief Writes the recorded events as a Chrome Trace Event file
+         * \param path Where to create the file
+         * \throws FileError if the file can't be written
+         */
+        void dumpTrace(const std::filesystem::path &path);
+
+        /*!
+         * \brief Logs the total time and number of events grouped by category and name, slowest first
+         */
+        void logSummary();
+
+        /*!
+         * \brief Gets a small, stable identifier for the calling thread
+         * \return The identifier of the thread. The first thread that asks gets 1
+         */
+        static std::uint32_t getThreadId();
+
+    private:
+        Profiler() = default;
+
+        //! Whether events are being recorded
+        std::atomic<bool> enabled = false;
+
+        //! Time origin of the events, in ticks of the steady clock. Atomic since now() reads it without the lock
+        std::atomic<std::chrono::steady_clock::rep> epoch = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        //! Lock over the events
+        std::mutex mutex;
+
+        //! The recorded events
+        std::vector<tiny::ProfileEvent> events;
+    };
+
+    /*!
+     * \brief Times the scope in which it lives, and records it in the Profiler when the scope ends
+     *
+     * Times the scope in which it lives, and records it in the Profiler when the scope ends. Nested scopes show up as
+     * nested events in the trace. If the Profiler is disabled when the scope begins nothing is recorded.
+     */
+    class ProfileScope {
+    public:
+        /*!
+         * \brief Starts timing a scope
+         * \param name Name of the event. Only copied if the Profiler is enabled
+         * \param category Category of the event. Only copied if the Profiler is enabled
+         */
+        ProfileScope(std::string_view name, std::string_view category);
+
+        //! Stops timing the scope and records the event
+        ~ProfileScope();
+
+        ProfileScope(ProfileScope const &) = delete;
+        void operator=(ProfileScope const &) = delete;
+
+    private:
+        //! Whether the Profiler was enabled when the scope began
+        bool active = false;
+
+        //! The event being timed
+        tiny::ProfileEvent event;
+    };
+}
+
+#endif //TINY_PROFILER_H
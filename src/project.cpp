@@ -0,0 +1,120 @@
+#include "project.h"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include "toml.h"
+#include "errors.h"
+#include "glob.h"
+
+namespace {
+    //! Throws a TomlError pointing at a value
+    [[noreturn]] void invalid(const tiny::TomlValue &v, const std::string &msg) {
+        throw tiny::TomlError(msg, v.line, v.column);
+    }
+
+    //! Reads an array of strings
+    std::vector<std::string> toStrings(const tiny::TomlValue &v, const std::string &key) {
+        if (!v.is<tiny::TomlValue::Array>()) {
+            invalid(v, "'" + key + "' must be an array of strings, not a " + v.getTypeName());
+        }
+
+        std::vector<std::string> result;
+        for (auto const &item: v.as<tiny::TomlValue::Array>()) {
+            if (!item.is<std::string>()) {
+                invalid(item, "'" + key + "' must be an array of strings, not of " + item.getTypeName() + "s");
+            }
+
+            result.push_back(item.as<std::string>());
+        }
+
+        return result;
+    }
+
+    //! Reads an array of glob patterns, compiling each one so a malformed pattern points at its value
+    std::vector<std::string> toGlobs(const tiny::TomlValue &v, const std::string &key) {
+        auto patterns = toStrings(v, key);
+        auto const &items = v.as<tiny::TomlValue::Array>();
+
+        for (std::size_t i = 0; i < patterns.size(); i++) {
+            try {
+                tiny::Glob glob(patterns[i]);
+            } catch (const tiny::GlobError &e) {
+                invalid(items[i], e.msg);
+            }
+        }
+
+        return patterns;
+    }
+}
+
+tiny::ProjectSettings tiny::ProjectSettings::parse(std::string_view content) {
+    auto root = tiny::parseToml(content);
+    tiny::ProjectSettings settings;
+
+    auto const *build = root.find("build");
+    if (build == nullptr) {
+        return settings;
+    }
+
+    if (!build->is<tiny::TomlValue::Table>()) {
+        invalid(*build, "'build' must be a table");
+    }
+
+    for (auto const &[key, value]: build->as<tiny::TomlValue::Table>()) {
+        if (key == "jobs") {
+            if (!value.is<std::int64_t>() || value.as<std::int64_t>() < 1 || value.as<std::int64_t>() > 4096) {
+                invalid(value, "'jobs' must be an integer between 1 and 4096");
+            }
+
+            settings.jobs = std::int32_t(value.as<std::int64_t>());
+        } else if (key == "log") {
+            auto level = value.is<std::string>() ? tiny::toLogLevel(value.as<std::string>()) : std::nullopt;
+            if (!level) {
+                invalid(value, "'log' must be one of \"debug\", \"info\", \"warn\", \"error\", \"fatal\" or \"disable\"");
+            }
+
+            settings.log = level;
+        } else if (key == "max-errors") {
+            if (!value.is<std::int64_t>() || value.as<std::int64_t>() < 0 ||
+                value.as<std::int64_t>() > std::numeric_limits<std::int32_t>::max()) {
+                invalid(value, "'max-errors' must be a non-negative integer");
+            }
+
+            settings.maxErrors = std::int32_t(value.as<std::int64_t>());
+        } else if (key == "include") {
+            settings.include = toGlobs(value, key);
+        } else if (key == "exclude") {
+            settings.exclude = toGlobs(value, key);
+        } else if (key == "output") {
+            auto names = toStrings(value, key);
+            auto const &outputs = value.as<tiny::TomlValue::Array>();
+
+            for (std::size_t i = 0; i < names.size(); i++) {
+                if (names[i] != "ast-json") {
+                    invalid(outputs[i], "Unknown output '" + names[i] + "'");
+                }
+
+                settings.outputASTJSON = true;
+            }
+        } else {
+            tiny::warn("Unknown setting 'build." + key + "' in tiny.toml (" + std::to_string(value.line) + ":" +
+                       std::to_string(value.column) + ")");
+        }
+    }
+
+    return settings;
+}
+
+tiny::ProjectSettings tiny::ProjectSettings::load(const std::filesystem::path &file) {
+    std::ifstream input(file, std::ios::binary);
+    if (!input) {
+        throw tiny::FileError("Unable to read the project file '" + file.string() + "'");
+    }
+
+    std::ostringstream content;
+    content << input.rdbuf();
+
+    return parse(content.str());
+}
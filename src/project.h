@@ -0,0 +1,66 @@
+#ifndef TINY_PROJECT_H
+#define TINY_PROJECT_H
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "logger.h"
+
+namespace tiny {
+    /*!
+     * \brief The settings of a project, read from its tiny.toml
+     *
+     * The settings of a project, read from the [build] table of its tiny.toml, so every developer and CI job builds it
+     * the same way:
+     *
+     *     [build]
+     *     jobs = 8                       # Worker threads, like '--jobs'
+     *     log = "warn"                   # Log level, like '--log'
+     *     max-errors = 50                # Diagnostics shown per build, like '--max-errors'. 0 shows them all
+     *     include = ["*.ty", "!old.ty"]  # Globs of the sources to compile, '!' drops earlier matches. Defaults to the
+     *                                    # *.ty files in the root
+     *     exclude = ["gen/", "build/"]   # Globs of the paths to skip. Excluded directories are never read
+     *     output = ["ast-json"]          # Extra outputs, like '--ast-json'
+     *
+     * Settings given on the command line take precedence over the ones in the file (see Configuration::applyProject).
+     */
+    struct ProjectSettings {
+        //! Number of jobs, if set
+        std::optional<std::int32_t> jobs;
+        //! Log level, if set
+        std::optional<tiny::LogLevel> log;
+        //! Maximum number of diagnostics shown, if set
+        std::optional<std::int32_t> maxErrors;
+        //! Globs of the source files. Empty for the default selection
+        std::vector<std::string> include;
+        //! Globs of the files and directories to skip
+        std::vector<std::string> exclude;
+        //! Whether to dump the AST of each file as JSON
+        bool outputASTJSON = false;
+
+        /*!
+         * \brief Parses the settings out of a tiny.toml document
+         * \param content The document
+         * \return The settings
+         *
+         * Parses the settings out of a tiny.toml document. Throws TomlError if the document is malformed, or if a
+         * setting has the wrong type or value, such as an include or exclude glob that doesn't compile. Unknown settings
+         * only get a warning, so newer project files still build.
+         */
+        static tiny::ProjectSettings parse(std::string_view content);
+
+        /*!
+         * \brief Reads the settings of a tiny.toml file. See parse()
+         * \param file Path of the file
+         * \return The settings
+         *
+         * Reads the settings of a tiny.toml file. Throws FileError if the file can't be read.
+         */
+        static tiny::ProjectSettings load(const std::filesystem::path &file);
+    };
+}
+
+#endif //TINY_PROJECT_H
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "compiler.h"
+#include "errors.h"
+#include "lexer.h"
+#include "logger.h"
+#include "tables.h"
+
+/*
+ * The tiny Python module
+ *
+ * Exposes the lexer, the parser and the in-memory compiler. Tokens and AST nodes are returned as tables of parallel
+ * columns that implement the buffer protocol, so numpy.asarray() and memoryview() read them in place instead of
+ * creating a Python object per element. The GIL is released while compiling.
+ */
+
+namespace py = pybind11;
+
+namespace {
+    //! A read-only view over a column of a table. Keeps the table alive
+    template<typename T>
+    struct Column {
+        std::shared_ptr<const void> owner;
+        const std::vector<T> *values;
+    };
+
+    //! The lexemes of a source
+    struct Tokens {
+        tiny::TokenTable table;
+    };
+
+    //! The AST of a source
+    struct Tree {
+        tiny::ASTFile file;
+        tiny::NodeTable table;
+    };
+
+    template<typename T, typename Owner>
+    Column<T> column(const std::shared_ptr<Owner> &owner, const std::vector<T> &values) {
+        return {owner, &values};
+    }
+
+    template<typename T>
+    void bindColumn(py::module_ &m, const char *name) {
+        py::class_<Column<T>>(m, name, py::buffer_protocol())
+                .def_buffer([](Column<T> &c) {
+                    return py::buffer_info(const_cast<T *>(c.values->data()), sizeof(T),
+                                           py::format_descriptor<T>::format(), 1,
+                                           {py::ssize_t(c.values->size())}, {py::ssize_t(sizeof(T))}, true);
+                })
+                .def("__len__", [](const Column<T> &c) { return c.values->size(); })
+                .def("__getitem__", [](const Column<T> &c, py::ssize_t i) {
+                    auto size = py::ssize_t(c.values->size());
+                    if (i < 0) {
+                        i += size;
+                    }
+
+                    if (i < 0 || i >= size) {
+                        throw py::index_error("Column index out of range");
+                    }
+
+                    return (*c.values)[std::size_t(i)];
+                });
+    }
+
+    std::shared_ptr<Tokens> lex(const std::string &source, const std::string &name) {
+        auto tokens = std::make_shared<Tokens>();
+
+        {
+            py::gil_scoped_release release;
+
+            tiny::Stream<std::uint32_t> charStream(tiny::String(source).data());
+            tiny::Lexer lexer(charStream);
+            lexer.setMetadataFile(tiny::File{tiny::FileType::Source, name});
+
+            tokens->table = tiny::TokenTable::build(lexer.lexAll());
+        }
+
+        return tokens;
+    }
+
+    //! The result of compiling a set of sources
+    struct Compilation {
+        bool ok = true;
+        std::vector<std::shared_ptr<Tree>> files;
+        std::vector<tiny::Diagnostic> diagnostics;
+    };
+
+    Compilation compile(const std::vector<std::pair<std::string, std::string>> &named) {
+        std::vector<tiny::Source> sources;
+        sources.reserve(named.size());
+        for (auto const &[name, content]: named) {
+            sources.push_back({name, content});
+        }
+
+        Compilation compilation;
+
+        {
+            py::gil_scoped_release release;
+
+            tiny::Compiler compiler;
+            auto result = compiler.compile(sources);
+
+            compilation.ok = result.status == tiny::CompilationStatus::Ok;
+            compilation.diagnostics = std::move(result.diagnostics);
+
+            for (auto &file: result.files) {
+                auto tree = std::make_shared<Tree>();
+                tree->table = tiny::NodeTable::build(file);
+                tree->file = std::move(file);
+                compilation.files.push_back(std::move(tree));
+            }
+        }
+
+        return compilation;
+    }
+}
+
+PYBIND11_MODULE(tiny, m) {
+    m.doc() = "Lexer, parser and compiler of the tiny language";
+
+    // Only the results matter to scripts, so the compiler stays quiet unless asked otherwise
+    tiny::Logger::get().setLevel(tiny::LogLevel::Disable);
+
+    m.def("set_log_level", [](const std::string &level) {
+        auto parsed = tiny::toLogLevel(level);
+        if (!parsed) {
+            throw py::value_error("Unknown log level '" + level + "'");
+        }
+
+        tiny::Logger::get().setLevel(*parsed);
+    }, py::arg("level"), "Sets the level of the compiler's log: debug, info, warn, error, fatal or disable");
+
+    static py::exception<tiny::CompilerError> compileError(m, "CompileError");
+    static auto raiseCompileError = [](const std::string &msg, tiny::DiagnosticId id,
+                                       const std::vector<std::string> &args, std::uint64_t start,
+                                       std::uint64_t end) {
+        // Carry the id and codepoint range of the error, so scripts don't need to parse the message
+        auto error = py::handle(compileError.ptr())(msg);
+        error.attr("id") = std::int32_t(id);
+        error.attr("arguments") = args;
+        error.attr("start") = start;
+        error.attr("end") = std::max(start, end);
+        PyErr_SetObject(compileError.ptr(), error.ptr());
+    };
+
+    py::register_exception_translator([](std::exception_ptr p) {
+        try {
+            if (p) {
+                std::rethrow_exception(p);
+            }
+        } catch (const tiny::CompilerError &e) {
+            raiseCompileError(e.what(), e.id, e.args, e.meta.start, e.meta.end);
+        }
+    });
+
+    bindColumn<std::uint16_t>(m, "UInt16Column");
+    bindColumn<std::uint32_t>(m, "UInt32Column");
+    bindColumn<std::int32_t>(m, "Int32Column");
+
+    m.attr("TOKEN_NAMES") = tiny::getTokenNames();
+    m.attr("NODE_NAMES") = tiny::getNodeTypeNames();
+
+    py::class_<Tokens, std::shared_ptr<Tokens>>(m, "Tokens", "The lexemes of a source, as columns")
+            .def("__len__", [](const Tokens &t) { return t.table.size(); })
+            .def_property_readonly("kinds", [](const std::shared_ptr<Tokens> &t) {
+                return column(t, t->table.kinds);
+            }, "Index of the token of every lexeme in TOKEN_NAMES")
+            .def_property_readonly("starts", [](const std::shared_ptr<Tokens> &t) {
+                return column(t, t->table.starts);
+            }, "Index of the first character of every lexeme in the source")
+            .def_property_readonly("ends", [](const std::shared_ptr<Tokens> &t) {
+                return column(t, t->table.ends);
+            }, "Index past the last character of every lexeme in the source");
+
+    py::class_<Tree, std::shared_ptr<Tree>>(m, "Tree", "The AST of a source, as columns in depth-first pre-order")
+            .def("__len__", [](const Tree &t) { return t.table.size(); })
+            .def_property_readonly("name", [](const Tree &t) { return t.file.file.path.string(); })
+            .def_property_readonly("module", [](const Tree &t) { return t.file.mod.toString(); })
+            .def_property_readonly("imports", [](const Tree &t) {
+                std::vector<std::pair<std::string, std::string>> imports;
+                for (auto const &i: t.file.imports) {
+                    imports.emplace_back(i.mod.toString(), i.alias.toString());
+                }
+
+                return imports;
+            }, "The imported modules, as (module, alias) pairs")
+            .def_property_readonly("kinds", [](const std::shared_ptr<Tree> &t) {
+                return column(t, t->table.kinds);
+            }, "Index of the type of every node in NODE_NAMES")
+            .def_property_readonly("parents", [](const std::shared_ptr<Tree> &t) {
+                return column(t, t->table.parents);
+            }, "Index of the parent of every node. -1 for the top-level statements")
+            .def_property_readonly("sizes", [](const std::shared_ptr<Tree> &t) {
+                return column(t, t->table.sizes);
+            }, "Number of nodes in the subtree of every node, itself included")
+            .def_property_readonly("starts", [](const std::shared_ptr<Tree> &t) {
+                return column(t, t->table.starts);
+            }, "Index of the first character of every node in the source")
+            .def_property_readonly("ends", [](const std::shared_ptr<Tree> &t) {
+                return column(t, t->table.ends);
+            }, "Index past the last character of every node in the source")
+            .def("json", [](const Tree &t) { return t.file.toJson().dump(); }, "The AST serialized as JSON");
+
+    py::class_<tiny::Diagnostic>(m, "Diagnostic")
+            .def_readonly("file", &tiny::Diagnostic::file)
+            .def_readonly("line", &tiny::Diagnostic::line)
+            .def_readonly("column", &tiny::Diagnostic::column)
+            .def_readonly("begin", &tiny::Diagnostic::begin, "Byte offset of the start of the problem")
+            .def_readonly("end", &tiny::Diagnostic::end, "Byte offset past the end of the problem")
+            .def_readonly("message", &tiny::Diagnostic::msg)
+            .def_readonly("args", &tiny::Diagnostic::args)
+            .def_property_readonly("id", [](const tiny::Diagnostic &d) { return std::int32_t(d.id); })
+            .def_property_readonly("step", [](const tiny::Diagnostic &d) {
+                return std::string(tiny::toString(d.step));
+            })
+            .def("__repr__", [](const tiny::Diagnostic &d) { return "<Diagnostic " + d.toString() + ">"; });
+
+    py::class_<Compilation>(m, "Compilation")
+            .def_readonly("ok", &Compilation::ok)
+            .def_readonly("files", &Compilation::files, "The ASTs of the sources before the first one with errors")
+            .def_readonly("diagnostics", &Compilation::diagnostics);
+
+    m.def("lex", &lex, py::arg("source"), py::arg("name") = "<source>",
+          "Splits a source into lexemes. Raises CompileError if the source can't be lexed");
+
+    m.def("compile", &compile, py::arg("sources"),
+          "Compiles a list of (name, source) pairs in parallel, returning their ASTs and diagnostics");
+
+    m.def("parse", [](const std::string &source, const std::string &name) {
+        auto compilation = compile({{name, source}});
+        if (!compilation.ok) {
+            // Diagnostics locate problems in bytes, but CompileError does it in codepoints, like lex()
+            auto const &d = compilation.diagnostics.front();
+            auto codepoints = [&source](std::uint64_t bytes) {
+                auto end = source.begin() + std::ptrdiff_t(std::min<std::uint64_t>(bytes, source.size()));
+                return std::uint64_t(std::count_if(source.begin(), end, [](char c) {
+                    return (static_cast<unsigned char>(c) & 0xC0u) != 0x80u;
+                }));
+            };
+
+            raiseCompileError(d.toString(), d.id, d.args, codepoints(d.begin), codepoints(d.end));
+            throw py::error_already_set();
+        }
+
+        return compilation.files.front();
+    }, py::arg("source"), py::arg("name") = "<source>",
+          "Parses a single source into its Tree. Raises CompileError with the first diagnostic if it has errors");
+}
@@ -0,0 +1,99 @@
+#include "resolver.h"
+
+#include <algorithm>
+
+bool tiny::FunctionResolver::declare(const std::string &mod, const std::string &name) {
+    if (!functions.insert(qualify(mod, name)).second) {
+        return false;
+    }
+
+    modules[name].push_back(mod);
+    return true;
+}
+
+std::optional<std::string> tiny::FunctionResolver::find(const std::string &name) const {
+    if (functions.count(name) > 0) {
+        return name;
+    }
+
+    auto it = modules.find(name);
+    if (it == modules.end() || it->second.size() != 1) {
+        return std::nullopt;
+    }
+
+    return qualify(it->second.front(), name);
+}
+
+std::string tiny::FunctionResolver::qualify(const std::string &mod, const std::string &name) {
+    return mod + "." + name;
+}
+
+std::optional<std::string> tiny::FunctionResolver::resolve(const tiny::ASTFile &caller, const tiny::ASTNode &callee,
+                                                           std::string &error) const {
+    auto own = caller.mod.toString();
+
+    // m.f(), where m is the caller's module or one it imports
+    if (callee.type == tiny::ASTNodeType::MemberAccess
+        && callee.getFirstChild()->type == tiny::ASTNodeType::Identifier
+        && callee.getSecondChild()->type == tiny::ASTNodeType::Identifier) {
+        auto qualifier = callee.getFirstChild()->getStringVal().toString();
+        auto name = callee.getSecondChild()->getStringVal().toString();
+
+        std::optional<std::string> mod;
+        if (qualifier == own) {
+            mod = own;
+        }
+
+        for (auto const &i: caller.imports) {
+            auto alias = i.alias.toString();
+            if ((alias.empty() ? i.mod.toString() : alias) == qualifier) {
+                mod = i.mod.toString();
+            }
+        }
+
+        if (!mod) {
+            error = "Module '" + qualifier + "' isn't imported";
+            return std::nullopt;
+        }
+
+        if (functions.count(qualify(*mod, name)) == 0) {
+            error = "Undefined function '" + qualify(*mod, name) + "'";
+            return std::nullopt;
+        }
+
+        return qualify(*mod, name);
+    }
+
+    if (callee.type != tiny::ASTNodeType::Identifier) {
+        error = "'" + callee.toString() + "' isn't a function";
+        return std::nullopt;
+    }
+
+    // f(), declared by the caller's module or else by a single imported one
+    auto name = callee.getStringVal().toString();
+    if (functions.count(qualify(own, name)) > 0) {
+        return qualify(own, name);
+    }
+
+    std::vector<std::string> candidates;
+    for (auto const &i: caller.imports) {
+        auto qualified = qualify(i.mod.toString(), name);
+        if (functions.count(qualified) > 0 && std::find(candidates.begin(), candidates.end(), qualified)
+                                              == candidates.end()) {
+            candidates.push_back(qualified);
+        }
+    }
+
+    if (candidates.empty()) {
+        error = "Undefined function '" + name + "'";
+        return std::nullopt;
+    }
+
+    if (candidates.size() > 1) {
+        error = "Function '" + name + "' is declared by more than one imported module ('" + candidates[0] + "' and '"
+                + candidates[1] + "'). Call it through its module";
+        return std::nullopt;
+    }
+
+    return candidates.front();
+}
@@ -0,0 +1,80 @@
+#ifndef TINY_RESOLVER_H
+#define TINY_RESOLVER_H
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ast.h"
+
+namespace tiny {
+    /*!
+     * \brief Resolves the functions called in a set of ASTs to the module that declares them
+     *
+     * Resolves the functions called in a set of ASTs to the module that declares them. Functions are identified by
+     * their module and their name, so different modules can declare functions with the same name. They are referred to
+     * by their qualified name, "module.name".
+     *
+     * A call by a bare name ('f(x)') goes to the function of the caller's module, or else to the function of the only
+     * imported module that declares one with that name. A qualified call ('m.f(x)') goes to the function of the
+     * module named by 'm': an import alias, an imported module that isn't aliased, or the caller's own module.
+     */
+    class FunctionResolver {
+    public:
+        /*!
+         * \brief Declares a function
+         * \param mod The module that declares it
+         * \param name The name of the function
+         * \return False if the module already declares a function with that name
+         */
+        bool declare(const std::string &mod, const std::string &name);
+
+        /*!
+         * \brief Resolves the callee of a call
+         * \tparam Error The CompilerError to throw
+         * \param caller The AST of the calling code
+         * \param callee The first child of the call
+         * \return The qualified name of the function
+         *
+         * Resolves the callee of a call. Throws Error if it doesn't name a single declared function.
+         */
+        template<typename Error>
+        [[nodiscard]] std::string resolve(const tiny::ASTFile &caller, const tiny::ASTNode &callee) const {
+            std::string error;
+            auto qualified = resolve(caller, callee, error);
+            if (!qualified) {
+                throw Error(error, callee.meta);
+            }
+
+            return *qualified;
+        }
+
+        /*!
+         * \brief Finds a function to be called from outside the program
+         * \param name Its qualified name, or its bare name if no other module declares a function with that name
+         * \return The qualified name, or nullopt if it names no function, or more than one
+         */
+        [[nodiscard]] std::optional<std::string> find(const std::string &name) const;
+
+        /*!
+         * \brief Gets the qualified name of a function
+         * \param mod The module that declares it
+         * \param name The name of the function
+         * \return The name in the form "module.name"
+         */
+        [[nodiscard]] static std::string qualify(const std::string &mod, const std::string &name);
+
+    private:
+        std::optional<std::string> resolve(const tiny::ASTFile &caller, const tiny::ASTNode &callee,
+                                           std::string &error) const;
+
+        //! The qualified names of every function
+        std::unordered_set<std::string> functions;
+        //! The modules declaring every name
+        std::unordered_map<std::string, std::vector<std::string>> modules;
+    };
+}
+
+#endif //TINY_RESOLVER_H
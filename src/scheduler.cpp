@@ -0,0 +1,311 @@
+#include "scheduler.h"
+
+#include <random>
+#include <sstream>
+#include <iomanip>
+
+#include "logger.h"
+
+namespace {
+    //! Index of the worker run by the thread. Threads outside of the pool use slot 0
+    thread_local std::size_t currentWorker = 0;
+}
+
+tiny::Scheduler::Scheduler() {
+    start(0);
+}
+
+tiny::Scheduler::~Scheduler() {
+    shutdown();
+}
+
+void tiny::Scheduler::setJobs(std::size_t jobs) {
+    shutdown();
+    start(jobs);
+}
+
+void tiny::Scheduler::setJobServer(std::unique_ptr<tiny::JobServer> js) {
+    auto jobs = workers.size();
+
+    shutdown();
+    jobServer = std::move(js);
+    start(jobs);
+}
+
+std::size_t tiny::Scheduler::getJobs() const {
+    return workers.size();
+}
+
+void tiny::Scheduler::start(std::size_t jobs) {
+    if (jobs == 0) {
+        jobs = (std::max)(1u, std::thread::hardware_concurrency());
+    }
+
+    // Keep whatever was queued in slot 0
+    std::deque<tiny::TaskHandle> leftover;
+    for (auto &w: workers) {
+        leftover.insert(leftover.end(), w->tasks.begin(), w->tasks.end());
+    }
+
+    workers.clear();
+    for (std::size_t i = 0; i < jobs; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    workers[0]->tasks = std::move(leftover);
+
+    stopping = false;
+    for (std::size_t i = 1; i < jobs; i++) {
+        threads.emplace_back(&tiny::Scheduler::run, this, i);
+    }
+
+    resetStats();
+}
+
+void tiny::Scheduler::shutdown() {
+    {
+        std::lock_guard lock(sleepMtx);
+        stopping = true;
+    }
+    sleepCv.notify_all();
+
+    for (auto &t: threads) {
+        t.join();
+    }
+
+    threads.clear();
+}
+
+void tiny::Scheduler::run(std::size_t index) {
+    currentWorker = index;
+    bool hasToken = false;
+
+    while (true) {
+        // Get a token before looking for work, and only while there's some
+        if (jobServer && !hasToken && queued.load() > 0) {
+            hasToken = jobServer->acquire(std::chrono::milliseconds(10));
+            if (!hasToken) {
+                if (stopping) {
+                    return;
+                }
+
+                continue;
+            }
+        }
+
+        if (!jobServer || hasToken) {
+            if (auto task = take(index)) {
+                execute(task, index);
+                continue;
+            }
+        }
+
+        // Out of work, let other processes use the token
+        if (hasToken) {
+            jobServer->release();
+            hasToken = false;
+        }
+
+        std::unique_lock lock(sleepMtx);
+        sleepCv.wait(lock, [this]() { return stopping || queued.load() > 0; });
+
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+tiny::TaskHandle tiny::Scheduler::submit(std::function<void()> fn, const std::vector<tiny::TaskHandle> &dependencies) {
+    auto task = std::make_shared<tiny::Task>(std::move(fn));
+
+    for (auto const &dep: dependencies) {
+        std::lock_guard lock(dep->mtx);
+        if (!dep->done) {
+            task->pending++;
+            dep->dependents.push_back(task);
+        }
+    }
+
+    // Drop the submission guard. If every dependency is done the task is ready
+    if (--task->pending == 0) {
+        schedule(task);
+    }
+
+    return task;
+}
+
+void tiny::Scheduler::schedule(tiny::TaskHandle task) {
+    auto index = currentWorker < workers.size() ? currentWorker : 0;
+
+    {
+        std::lock_guard lock(workers[index]->mtx);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+
+    // Bump the counter under the lock so a thread about to sleep can't miss it
+    {
+        std::lock_guard lock(sleepMtx);
+        queued++;
+    }
+    sleepCv.notify_one();
+
+    {
+        std::lock_guard lock(doneMtx);
+    }
+    doneCv.notify_all();
+}
+
+tiny::TaskHandle tiny::Scheduler::take(std::size_t index) {
+    // Own queue first, newest task first
+    {
+        auto &own = *workers[index];
+        std::lock_guard lock(own.mtx);
+        if (!own.tasks.empty()) {
+            auto task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued--;
+
+            return task;
+        }
+    }
+
+    // Then steal the oldest task from the others, starting at a random queue
+    thread_local std::minstd_rand rng(std::random_device{}());
+    auto count = workers.size();
+    auto start = rng() % count;
+
+    for (std::size_t i = 0; i < count; i++) {
+        auto victim = (start + i) % count;
+        if (victim == index) {
+            continue;
+        }
+
+        auto &w = *workers[victim];
+        std::lock_guard lock(w.mtx);
+        if (!w.tasks.empty()) {
+            auto task = std::move(w.tasks.front());
+            w.tasks.pop_front();
+            queued--;
+            workers[index]->steals.fetch_add(1, std::memory_order_relaxed);
+
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+void tiny::Scheduler::execute(const tiny::TaskHandle &task, std::size_t index) {
+    auto begin = std::chrono::steady_clock::now();
+
+    try {
+        task->fn();
+    } catch (...) {
+        task->exception = std::current_exception();
+    }
+
+    auto &w = *workers[index];
+    w.executed.fetch_add(1, std::memory_order_relaxed);
+    w.busy.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count(), std::memory_order_relaxed);
+
+    std::vector<tiny::TaskHandle> dependents;
+    {
+        std::lock_guard lock(task->mtx);
+        task->done = true;
+        task->finished.store(true, std::memory_order_release);
+        dependents.swap(task->dependents);
+    }
+
+    task->fn = nullptr; // Release whatever the work captured
+
+    for (auto &dep: dependents) {
+        if (--dep->pending == 0) {
+            schedule(std::move(dep));
+        }
+    }
+
+    {
+        std::lock_guard lock(doneMtx);
+    }
+    doneCv.notify_all();
+}
+
+void tiny::Scheduler::wait(const tiny::TaskHandle &task) {
+    help(task);
+
+    if (task->exception) {
+        std::rethrow_exception(task->exception);
+    }
+}
+
+void tiny::Scheduler::wait(const std::vector<tiny::TaskHandle> &tasks) {
+    for (auto const &t: tasks) {
+        help(t);
+    }
+
+    for (auto const &t: tasks) {
+        if (t->exception) {
+            std::rethrow_exception(t->exception);
+        }
+    }
+}
+
+void tiny::Scheduler::help(const tiny::TaskHandle &task) {
+    auto index = currentWorker < workers.size() ? currentWorker : 0;
+
+    while (!task->isDone()) {
+        if (auto other = take(index)) {
+            execute(other, index);
+            continue;
+        }
+
+        std::unique_lock lock(doneMtx);
+        doneCv.wait_for(lock, std::chrono::milliseconds(1), [this, &task]() {
+            return task->isDone() || queued.load() > 0;
+        });
+    }
+}
+
+std::vector<tiny::WorkerStats> tiny::Scheduler::getStats() const {
+    auto elapsed = std::chrono::steady_clock::now() - statsSince;
+
+    std::vector<tiny::WorkerStats> stats;
+    for (auto const &w: workers) {
+        tiny::WorkerStats s;
+        s.tasks = w->executed.load(std::memory_order_relaxed);
+        s.steals = w->steals.load(std::memory_order_relaxed);
+        s.busy = std::chrono::nanoseconds(w->busy.load(std::memory_order_relaxed));
+        s.utilization = elapsed.count() > 0 ? double(s.busy.count()) /
+                                              double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+                                            : 0;
+
+        stats.push_back(s);
+    }
+
+    return stats;
+}
+
+void tiny::Scheduler::resetStats() {
+    for (auto &w: workers) {
+        w->executed.store(0, std::memory_order_relaxed);
+        w->steals.store(0, std::memory_order_relaxed);
+        w->busy.store(0, std::memory_order_relaxed);
+    }
+
+    statsSince = std::chrono::steady_clock::now();
+}
+
+void tiny::Scheduler::logSummary() const {
+    auto stats = getStats();
+
+    tiny::info("Workers (" + std::to_string(stats.size()) + " jobs):");
+    for (std::size_t i = 0; i < stats.size(); i++) {
+        std::ostringstream line;
+        line << "  " << (i == 0 ? std::string("main") : "#" + std::to_string(i)) << ": " << stats[i].tasks
+             << " tasks, " << stats[i].steals << " steals, " << std::fixed << std::setprecision(1)
+             << stats[i].utilization * 100 << "% busy";
+
+        tiny::info(line.str());
+    }
+}
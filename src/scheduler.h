@@ -0,0 +1,203 @@
+#ifndef TINY_SCHEDULER_H
+#define TINY_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "jobserver.h"
+
+namespace tiny {
+    /*!
+     * \brief A unit of work run by the Scheduler
+     *
+     * A unit of work run by the Scheduler. Tasks are handled through shared pointers (TaskHandle), so they can be
+     * waited on and depended upon for as long as needed.
+     */
+    class Task {
+    public:
+        /*!
+         * \brief Creates a task
+         * \param fn The work to do
+         */
+        explicit Task(std::function<void()> fn) : fn(std::move(fn)) {};
+
+        //! Whether the task has finished running
+        [[nodiscard]] bool isDone() const {
+            return finished.load(std::memory_order_acquire);
+        }
+
+    private:
+        friend class Scheduler;
+
+        //! The work to do
+        std::function<void()> fn;
+        //! Dependencies not yet finished, plus one while the task is being submitted
+        std::atomic<std::int32_t> pending{1};
+        //! Set once the task finished running
+        std::atomic<bool> finished{false};
+        //! Guards done and dependents
+        std::mutex mtx;
+        //! Whether the task finished. Unlike finished, only read and written under mtx
+        bool done = false;
+        //! Tasks waiting for this one to finish
+        std::vector<std::shared_ptr<tiny::Task>> dependents;
+        //! The exception thrown by the task, if any
+        std::exception_ptr exception;
+    };
+
+    //! A shared handle to a Task
+    using TaskHandle = std::shared_ptr<tiny::Task>;
+
+    //! Statistics of a Scheduler worker
+    struct WorkerStats {
+        //! Tasks run by the worker
+        std::uint64_t tasks = 0;
+        //! Tasks the worker took from another worker's queue
+        std::uint64_t steals = 0;
+        //! Time spent running tasks
+        std::chrono::nanoseconds busy{0};
+        //! Fraction of the time since the stats were reset spent running tasks, from 0 to 1
+        double utilization = 0;
+    };
+
+    /*!
+     * \brief A work-stealing thread pool shared by all the compilation steps
+     *
+     * A work-stealing thread pool shared by all the compilation steps. Every worker owns a queue: tasks submitted from
+     * a worker go to its own queue, where it picks them newest-first, and idle workers steal the oldest tasks from a
+     * randomly picked queue. Tasks can depend on other tasks, and only get scheduled once all their dependencies
+     * finished (whether they threw or not).
+     *
+     * Slot 0 belongs to the threads outside of the pool: they submit to its queue, and run tasks while waiting in
+     * wait(). With N jobs the pool has N - 1 threads, so with a single job every task runs inline in wait().
+     *
+     * If a JobServer is set, slot 0 uses the implicit job slot of the process and every pool thread has to hold a
+     * token from the jobserver while it runs tasks, so the parallelism stays within the limit of the outer build.
+     */
+    class Scheduler {
+    public:
+        Scheduler(Scheduler const &) = delete;         // Meyers' singleton pattern. Don't Implement
+        void operator=(Scheduler const &) = delete;    // Ibidem
+
+        //! Get the singleton instance
+        static Scheduler &get() {
+            static Scheduler instance;
+            return instance;
+        }
+
+        //! Stops the worker threads
+        ~Scheduler();
+
+        /*!
+         * \brief Sets the number of tasks that can run at once. Must be called while no tasks are running
+         * \param jobs The number of jobs. 0 uses the number of hardware threads
+         */
+        void setJobs(std::size_t jobs);
+
+        //! Gets the number of tasks that can run at once
+        [[nodiscard]] std::size_t getJobs() const;
+
+        /*!
+         * \brief Makes the pool threads take a token from a jobserver before running tasks. Must be called while no
+         * tasks are running
+         * \param js The jobserver client. Null to stop using a jobserver
+         */
+        void setJobServer(std::unique_ptr<tiny::JobServer> js);
+
+        /*!
+         * \brief Submits a task
+         * \param fn The work to do
+         * \param dependencies Tasks that must finish before this one runs
+         * \return A handle to the task
+         */
+        tiny::TaskHandle submit(std::function<void()> fn, const std::vector<tiny::TaskHandle> &dependencies = {});
+
+        /*!
+         * \brief Waits for a task to finish, running other tasks in the meantime. Rethrows the task's exception
+         * \param task The task
+         */
+        void wait(const tiny::TaskHandle &task);
+
+        /*!
+         * \brief Waits for several tasks to finish. Rethrows the first exception, in the order of the tasks
+         * \param tasks The tasks
+         */
+        void wait(const std::vector<tiny::TaskHandle> &tasks);
+
+        //! Gets the statistics of every worker, starting with slot 0 (the threads outside of the pool)
+        [[nodiscard]] std::vector<tiny::WorkerStats> getStats() const;
+
+        //! Sets the statistics of every worker back to zero
+        void resetStats();
+
+        //! Logs the statistics of every worker
+        void logSummary() const;
+
+    private:
+        //! Starts with as many jobs as hardware threads
+        Scheduler();
+
+        //! A task queue plus the statistics of its owner
+        struct Worker {
+            std::mutex mtx;
+            std::deque<tiny::TaskHandle> tasks;
+
+            std::atomic<std::uint64_t> executed{0};
+            std::atomic<std::uint64_t> steals{0};
+            std::atomic<std::int64_t> busy{0};
+        };
+
+        //! Starts the pool threads
+        void start(std::size_t jobs);
+
+        //! Stops and joins the pool threads
+        void shutdown();
+
+        //! Body of the pool threads
+        void run(std::size_t index);
+
+        //! Adds a task with no pending dependencies to the queue of the calling thread
+        void schedule(tiny::TaskHandle task);
+
+        //! Takes a task from the queue of the worker, or steals one. Null if there's none
+        tiny::TaskHandle take(std::size_t index);
+
+        //! Runs a task and schedules the dependents it unblocks
+        void execute(const tiny::TaskHandle &task, std::size_t index);
+
+        //! Runs other tasks until the provided one finishes
+        void help(const tiny::TaskHandle &task);
+
+        //! The workers. Index 0 is shared by the threads outside of the pool
+        std::vector<std::unique_ptr<Worker>> workers;
+        //! The pool threads. Thread i runs worker i + 1
+        std::vector<std::thread> threads;
+
+        //! Tasks waiting in any queue. Signed, since a task can be taken before the counter gets bumped
+        std::atomic<std::int64_t> queued{0};
+        //! Set to stop the pool threads
+        std::atomic<bool> stopping{false};
+        //! Idle pool threads sleep on this until a task is queued
+        std::condition_variable sleepCv;
+        std::mutex sleepMtx;
+        //! Threads in wait() sleep on this until a task finishes or is queued
+        std::condition_variable doneCv;
+        std::mutex doneMtx;
+
+        //! The jobserver limiting the pool threads. Null if there's none
+        std::unique_ptr<tiny::JobServer> jobServer;
+
+        //! When the statistics were last reset
+        std::chrono::steady_clock::time_point statsSince = std::chrono::steady_clock::now();
+    };
+}
+
+#endif //TINY_SCHEDULER_H
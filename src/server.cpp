@@ -0,0 +1,365 @@
+#include "server.h"
+
+#include "errors.h"
+#include "logger.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "nlohmann/json.hpp"
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+    //! Set by the signal handler to stop the accept loop
+    std::atomic<bool> interrupted{false};
+
+    void onSignal(int) {
+        interrupted = true;
+    }
+
+    //! Stops the accept loop on SIGINT and SIGTERM while it lives, then restores the previous handlers
+    class SignalScope {
+    public:
+        SignalScope() {
+            // No SA_RESTART, so a signal interrupts the blocking accept()
+            struct sigaction action{};
+            action.sa_handler = onSignal;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGINT, &action, &previousInt);
+            sigaction(SIGTERM, &action, &previousTerm);
+            interrupted = false;
+        }
+
+        ~SignalScope() {
+            sigaction(SIGINT, &previousInt, nullptr);
+            sigaction(SIGTERM, &previousTerm, nullptr);
+        }
+
+        SignalScope(const SignalScope &) = delete;
+        SignalScope &operator=(const SignalScope &) = delete;
+
+    private:
+        struct sigaction previousInt{};
+        struct sigaction previousTerm{};
+    };
+
+    //! Builds the address of a Unix domain socket, throwing ServerError if the path doesn't fit
+    sockaddr_un makeAddress(const std::filesystem::path &path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+
+        auto str = path.string();
+        if (str.size() >= sizeof(addr.sun_path)) {
+            throw tiny::ServerError("The socket path '" + str + "' is too long");
+        }
+
+        std::memcpy(addr.sun_path, str.c_str(), str.size() + 1);
+        return addr;
+    }
+
+    //! Sends a JSON object followed by a newline. Returns false if the peer went away
+    bool sendLine(int fd, const nlohmann::json &json) {
+        auto line = json.dump() + "\n";
+
+        std::size_t sent = 0;
+        while (sent < line.size()) {
+            auto n = ::send(fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (n <= 0) {
+                return false;
+            }
+
+            sent += std::size_t(n);
+        }
+
+        return true;
+    }
+
+    //! Buffers the bytes read from a connection and splits them in lines
+    class LineReader {
+    public:
+        explicit LineReader(int fd) : fd(fd) {};
+
+        //! Reads the next line, without the newline. Returns false if the connection was closed
+        bool next(std::string &line) {
+            while (true) {
+                if (auto nl = buffer.find('\n'); nl != std::string::npos) {
+                    line = buffer.substr(0, nl);
+                    buffer.erase(0, nl + 1);
+                    return true;
+                }
+
+                char chunk[4096];
+                auto n = ::read(fd, chunk, sizeof(chunk));
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+
+                if (n <= 0) {
+                    return false;
+                }
+
+                buffer.append(chunk, std::size_t(n));
+            }
+        }
+
+    private:
+        int fd;
+        std::string buffer;
+    };
+
+    //! Opens a connection to a server, throwing ServerError if it isn't reachable
+    int connectTo(const std::filesystem::path &path) {
+        auto addr = makeAddress(path);
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw tiny::ServerError(std::string("Unable to create a socket: ") + std::strerror(errno));
+        }
+
+        if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+            auto err = errno;
+            ::close(fd);
+            throw tiny::ServerError("Unable to connect to the server at '" + path.string() + "': " +
+                                    std::strerror(err));
+        }
+
+        return fd;
+    }
+}
+
+tiny::Server::~Server() {
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        std::error_code ec;
+        std::filesystem::remove(socketPath, ec);
+    }
+}
+
+tiny::ASTCache &tiny::Server::getCache() {
+    return cache;
+}
+
+void tiny::Server::run() {
+    auto addr = makeAddress(socketPath);
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        throw tiny::ServerError(std::string("Unable to create a socket: ") + std::strerror(errno));
+    }
+
+    // A socket file left behind by a server that didn't exit cleanly would make bind() fail
+    std::error_code ec;
+    std::filesystem::remove(socketPath, ec);
+
+    if (::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || ::listen(listenFd, 8) < 0) {
+        auto err = errno;
+        ::close(listenFd);
+        listenFd = -1;
+        throw tiny::ServerError("Unable to listen on '" + socketPath.string() + "': " + std::strerror(err));
+    }
+
+    SignalScope signals;
+
+    tiny::info("Listening on '" + socketPath.string() + "'");
+
+    bool running = true;
+    while (running && !interrupted) {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno != EINTR) {
+                tiny::error(std::string("Unable to accept a connection: ") + std::strerror(errno));
+            }
+
+            continue;
+        }
+
+        running = serve(fd);
+        ::close(fd);
+    }
+
+    ::close(listenFd);
+    listenFd = -1;
+    std::filesystem::remove(socketPath, ec);
+
+    tiny::info("Server stopped");
+}
+
+bool tiny::Server::serve(int fd) {
+    LineReader reader(fd);
+    std::string line;
+
+    while (reader.next(line)) {
+        auto request = nlohmann::json::parse(line, nullptr, false);
+        if (request.is_discarded() || !request.is_object()) {
+            sendLine(fd, {{"status", "error"}, {"msg", "Invalid request"}});
+            continue;
+        }
+
+        // value() throws on fields of another type, and a bad request mustn't take the server down
+        auto isString = [&](const char *key) { return !request.contains(key) || request[key].is_string(); };
+        if (!isString("command") || !isString("path")) {
+            sendLine(fd, {{"status", "error"}, {"msg", "Invalid request"}});
+            continue;
+        }
+
+        auto command = request.value("command", "");
+        if (command == "build") {
+            build(fd, request.value("path", ""));
+        } else if (command == "stop") {
+            sendLine(fd, {{"status", "ok"}});
+            return false;
+        } else {
+            sendLine(fd, {{"status", "error"}, {"msg", "Unknown command '" + command + "'"}});
+        }
+    }
+
+    return true;
+}
+
+void tiny::Server::build(int fd, const std::filesystem::path &root) {
+    tiny::info("Building '" + root.string() + "'");
+
+    if (root.empty() || !std::filesystem::is_directory(root)) {
+        sendLine(fd, {{"status", "error"}, {"msg", "Invalid project path '" + root.string() + "'"}});
+        return;
+    }
+
+    tiny::Compiler compiler(root);
+    compiler.setCache(&cache);
+    cache.resetCounters();
+
+    auto result = compiler.compile();
+
+    for (auto &d: result.diagnostics) {
+        // The client doesn't share the working directory of the server
+        if (!d.file.empty()) {
+            d.file = std::filesystem::absolute(d.file).lexically_normal().string();
+        }
+
+        if (!sendLine(fd, {{"diagnostic", d.toJson()}})) {
+            return;
+        }
+    }
+
+    sendLine(fd, {
+            {"status",   result.status == tiny::CompilationStatus::Ok ? "ok" : "error"},
+            {"compiled", cache.getMisses()},
+            {"reused",   cache.getHits()},
+    });
+}
+
+tiny::CompilationResult tiny::Client::build(const std::filesystem::path &root) const {
+    int fd = connectTo(socketPath);
+
+    if (!sendLine(fd, {{"command", "build"}, {"path", std::filesystem::absolute(root).string()}})) {
+        ::close(fd);
+        throw tiny::ServerError("The server closed the connection");
+    }
+
+    tiny::CompilationResult result;
+    LineReader reader(fd);
+    std::string line;
+
+    while (reader.next(line)) {
+        auto response = nlohmann::json::parse(line, nullptr, false);
+        if (response.is_discarded() || !response.is_object()) {
+            continue;
+        }
+
+        if (response.contains("diagnostic")) {
+            auto d = tiny::Diagnostic::fromJson(response["diagnostic"]);
+
+            auto shown = d;
+            if (!shown.file.empty()) {
+                shown.file = tiny::File{tiny::FileType::Source, d.file}.getRelativePath().string();
+            }
+
+            tiny::error(shown.toString());
+            if (!d.context.empty()) {
+                tiny::error("\t" + d.context);
+            }
+
+            result.diagnostics.push_back(std::move(d));
+            continue;
+        }
+
+        ::close(fd);
+
+        if (response.value("status", "") != "ok") {
+            result.status = tiny::CompilationStatus::Error;
+            if (!result.diagnostics.empty()) {
+                result.error = {result.diagnostics.front().step, result.diagnostics.front().msg};
+            } else {
+                result.error = {tiny::CompilationStep::None, response.value("msg", "")};
+                tiny::fatal(result.error.msg);
+            }
+
+            return result;
+        }
+
+        tiny::info("Done (" + std::to_string(response.value("compiled", 0)) + " compiled, " +
+                   std::to_string(response.value("reused", 0)) + " reused)");
+        return result;
+    }
+
+    ::close(fd);
+    throw tiny::ServerError("The server closed the connection before the build finished");
+}
+
+void tiny::Client::stop() const {
+    int fd = connectTo(socketPath);
+
+    if (!sendLine(fd, {{"command", "stop"}})) {
+        ::close(fd);
+        throw tiny::ServerError("The server closed the connection");
+    }
+
+    LineReader reader(fd);
+    std::string line;
+    reader.next(line);
+
+    ::close(fd);
+}
+
+#else
+
+tiny::Server::~Server() = default;
+
+tiny::ASTCache &tiny::Server::getCache() {
+    return cache;
+}
+
+void tiny::Server::run() {
+    throw tiny::ServerError("The compile server is only available on POSIX systems");
+}
+
+bool tiny::Server::serve(int) {
+    return false;
+}
+
+void tiny::Server::build(int, const std::filesystem::path &) {}
+
+tiny::CompilationResult tiny::Client::build(const std::filesystem::path &) const {
+    throw tiny::ServerError("The compile server is only available on POSIX systems");
+}
+
+void tiny::Client::stop() const {
+    throw tiny::ServerError("The compile server is only available on POSIX systems");
+}
+
+#endif
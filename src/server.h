@@ -0,0 +1,98 @@
+#ifndef TINY_SERVER_H
+#define TINY_SERVER_H
+
+#include <filesystem>
+#include <string>
+
+#include "compiler.h"
+#include "cache.h"
+
+namespace tiny {
+    /*!
+     * \brief A long-lived compile server that keeps the ASTs of unchanged files in memory between builds
+     *
+     * A long-lived compile server that keeps the ASTs of unchanged files in memory between builds. It listens on a
+     * Unix domain socket and serves one client at a time. Clients and server exchange JSON objects, one per line:
+     *
+     *  - {"command": "build", "path": "<project directory>"} compiles the project. The server answers with one
+     *    {"diagnostic": {...}} line per diagnostic, followed by {"status": "ok"|"error", "compiled": n, "reused": n}
+     *  - {"command": "stop"} makes the server exit after answering {"status": "ok"}
+     *
+     * Only available on POSIX systems. On other platforms run() throws ServerError.
+     */
+    class Server {
+    public:
+        /*!
+         * \brief Builds a server that will listen on the provided socket path
+         * \param socketPath Where to create the socket. A stale socket file in that path gets replaced
+         */
+        explicit Server(std::filesystem::path socketPath) : socketPath(std::move(socketPath)) {};
+
+        //! Closes and removes the socket, if still open
+        ~Server();
+
+        Server(Server const &) = delete;
+        void operator=(Server const &) = delete;
+
+        /*!
+         * \brief Serves requests until a stop request is received or the process is interrupted (SIGINT or SIGTERM)
+         *
+         * Serves requests until a stop request is received or the process is interrupted (SIGINT or SIGTERM). Throws
+         * ServerError if the socket can't be created.
+         */
+        void run();
+
+        //! Gets the cache shared by all the builds
+        tiny::ASTCache &getCache();
+
+    private:
+        /*!
+         * \brief Serves every request sent through a connection
+         * \param fd The connection
+         * \return False if a stop request was received, true otherwise
+         */
+        bool serve(int fd);
+
+        /*!
+         * \brief Compiles a project and sends the result through a connection
+         * \param fd The connection
+         * \param root The directory of the project
+         */
+        void build(int fd, const std::filesystem::path &root);
+
+        //! Path of the socket
+        std::filesystem::path socketPath;
+        //! The listening socket. -1 if not listening
+        int listenFd = -1;
+        //! The ASTs kept between builds
+        tiny::ASTCache cache;
+    };
+
+    //! A client for the compile Server
+    class Client {
+    public:
+        /*!
+         * \brief Builds a client for the server listening on the provided socket path
+         * \param socketPath Path of the server's socket
+         */
+        explicit Client(std::filesystem::path socketPath) : socketPath(std::move(socketPath)) {};
+
+        /*!
+         * \brief Asks the server to compile a project, and logs the diagnostics it streams back
+         * \param root The directory of the project
+         * \return The result of the compilation, as reported by the server
+         *
+         * Throws ServerError if the server can't be reached or the connection drops before the build ends.
+         */
+        tiny::CompilationResult build(const std::filesystem::path &root) const;
+
+        //! Asks the server to stop. Throws ServerError if the server can't be reached
+        void stop() const;
+
+    private:
+        //! Path of the server's socket
+        std::filesystem::path socketPath;
+    };
+}
+
+#endif //TINY_SERVER_H
@@ -0,0 +1,188 @@
+#include "stats.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#include <Psapi.h>
+#pragma comment(lib, "psapi")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "logger.h"
+
+namespace {
+    //! The size of the array
+    template<std::size_t N>
+    /*!
+     * \brief Adds the values of a shard's array into a snapshot's array
+     * \param into The snapshot's array
+     * \param from The shard's array
+     */
+    void merge(std::array<std::uint64_t, N> &into, const std::array<std::atomic<std::uint64_t>, N> &from) {
+        for (std::size_t i = 0; i < N; i++) {
+            into[i] += from[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    //! The size of the array
+    template<std::size_t N>
+    /*!
+     * \brief Sets all the values of a shard's array to zero
+     * \param arr The shard's array
+     */
+    void zero(std::array<std::atomic<std::uint64_t>, N> &arr) {
+        for (auto &v: arr) {
+            v.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::string tiny::toString(tiny::Counter c) {
+    switch (c) {
+        case tiny::Counter::BytesRead:
+            return "BytesRead";
+        case tiny::Counter::CodepointsDecoded:
+            return "CodepointsDecoded";
+        case tiny::Counter::FilesCompiled:
+            return "FilesCompiled";
+        case tiny::Counter::NodesFolded:
+            return "NodesFolded";
+        case tiny::Counter::HeapAllocations:
+            return "HeapAllocations";
+        case tiny::Counter::HeapBytes:
+            return "HeapBytes";
+
+        default:
+            return "Unknown";
+    }
+}
+
+tiny::Statistics::Shard &tiny::Statistics::local() {
+    thread_local Shard *shard = nullptr;
+
+    if (shard == nullptr) {
+        const std::lock_guard<std::mutex> lock(mutex);
+
+        shards.push_back(std::make_unique<Shard>());
+        shard = shards.back().get();
+    }
+
+    return *shard;
+}
+
+void tiny::Statistics::addAST(const tiny::ASTFile &file) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    auto &shard = local();
+
+    std::vector<const tiny::ASTNode *> pending;
+    for (auto const &stmt: file.statements) {
+        pending.push_back(&stmt);
+    }
+
+    while (!pending.empty()) {
+        auto node = pending.back();
+        pending.pop_back();
+
+        bump(shard.astNodes[std::size_t(node->type)], 1);
+
+        for (auto const &c: node->children) {
+            pending.push_back(c.get());
+        }
+    }
+}
+
+tiny::StatsSnapshot tiny::Statistics::snapshot() {
+    tiny::StatsSnapshot snap;
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+
+        for (auto const &shard: shards) {
+            merge(snap.counters, shard->counters);
+            merge(snap.lexemes, shard->lexemes);
+            merge(snap.astNodes, shard->astNodes);
+            merge(snap.promises, shard->promises);
+            merge(snap.fulfillments, shard->fulfillments);
+        }
+    }
+
+    snap.peakRSS = getPeakRSS();
+
+    return snap;
+}
+
+void tiny::Statistics::reset() {
+    // The shards are zeroed instead of dropped, since the threads keep a pointer to theirs
+    const std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto &shard: shards) {
+        zero(shard->counters);
+        zero(shard->lexemes);
+        zero(shard->astNodes);
+        zero(shard->promises);
+        zero(shard->fulfillments);
+    }
+}
+
+void tiny::Statistics::logSummary() {
+    auto snap = snapshot();
+
+    tiny::info("Statistics:");
+    for (std::size_t i = 0; i < tiny::COUNTER_COUNT; i++) {
+        if (snap.counters[i] > 0) {
+            tiny::info("  " + tiny::toString(tiny::Counter(i)) + ": " + std::to_string(snap.counters[i]));
+        }
+    }
+
+    if (snap.peakRSS > 0) {
+        tiny::info("  PeakRSS: " + std::to_string(snap.peakRSS / 1024) + " KiB");
+    }
+
+    tiny::info("Lexemes per token:");
+    for (std::size_t i = 0; i < tiny::TOKEN_COUNT; i++) {
+        if (snap.lexemes[i] > 0) {
+            tiny::info("  " + tiny::toString(tiny::Token(i)) + ": " + std::to_string(snap.lexemes[i]));
+        }
+    }
+
+    tiny::info("AST nodes per type:");
+    for (std::size_t i = 0; i < tiny::AST_NODE_TYPE_COUNT; i++) {
+        if (snap.astNodes[i] > 0) {
+            auto name = tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType(i)).toString();
+            tiny::info("  " + name + ": " + std::to_string(snap.astNodes[i]));
+        }
+    }
+
+    tiny::info("Promises / fulfillments per assertion:");
+    for (std::size_t i = 0; i < tiny::ASSERTION_COUNT; i++) {
+        if (snap.promises[i] > 0 || snap.fulfillments[i] > 0) {
+            tiny::info("  " + tiny::toString(tiny::Assertion(i)) + ": " + std::to_string(snap.promises[i]) + " / " +
+                       std::to_string(snap.fulfillments[i]));
+        }
+    }
+}
+
+std::uint64_t tiny::Statistics::getPeakRSS() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+
+#if defined(__APPLE__)
+    return std::uint64_t(usage.ru_maxrss); // Already in bytes
+#else
+    return std::uint64_t(usage.ru_maxrss) * 1024; // In kilobytes
+#endif
+#endif
+}
@@ -0,0 +1,221 @@
+#ifndef TINY_STATS_H
+#define TINY_STATS_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lexer.h"
+#include "ast.h"
+#include "symtab.h"
+
+namespace tiny {
+    //! The scalar counters kept by the Statistics registry
+    enum class Counter {
+        //! Bytes of source code read
+        BytesRead,
+        //! Unicode codepoints decoded from the source code
+        CodepointsDecoded,
+        //! Source files compiled
+        FilesCompiled,
+        //! Operations folded into a literal or dropped by the ConstantFolder
+        NodesFolded,
+        //! Heap allocations (only counted when the allocation tracker is built in)
+        HeapAllocations,
+        //! Bytes allocated in the heap (only counted when the allocation tracker is built in)
+        HeapBytes,
+    };
+
+    //! Number of Counter values
+    constexpr std::size_t COUNTER_COUNT = std::size_t(tiny::Counter::HeapBytes) + 1;
+    //! Number of Token values. Must be kept in sync with the last Token
+    constexpr std::size_t TOKEN_COUNT = std::size_t(tiny::Token::MultilineComment) + 1;
+    //! Number of ASTNodeType values. Must be kept in sync with the last ASTNodeType
+    constexpr std::size_t AST_NODE_TYPE_COUNT = std::size_t(tiny::ASTNodeType::Composition) + 1;
+    //! Number of Assertion values. Must be kept in sync with the last Assertion
+    constexpr std::size_t ASSERTION_COUNT = std::size_t(tiny::Assertion::IsOfType) + 1;
+
+    /*!
+     * \brief Returns the name of a Counter
+     * \param c The Counter
+     * \return The name of the Counter as it's declared (for example Counter::BytesRead will become "BytesRead")
+     */
+    [[nodiscard]] std::string toString(tiny::Counter c);
+
+    //! A merged, point-in-time copy of all the statistics
+    struct StatsSnapshot {
+        //! Scalar counters, indexed by Counter
+        std::array<std::uint64_t, tiny::COUNTER_COUNT> counters{};
+        //! Lexemes produced, indexed by Token
+        std::array<std::uint64_t, tiny::TOKEN_COUNT> lexemes{};
+        //! AST nodes produced, indexed by ASTNodeType
+        std::array<std::uint64_t, tiny::AST_NODE_TYPE_COUNT> astNodes{};
+        //! Promises added to the symbol tables, indexed by Assertion
+        std::array<std::uint64_t, tiny::ASSERTION_COUNT> promises{};
+        //! Fulfillments added to the symbol tables, indexed by Assertion
+        std::array<std::uint64_t, tiny::ASSERTION_COUNT> fulfillments{};
+        //! Peak resident set size of the process, in bytes. 0 if unknown
+        std::uint64_t peakRSS = 0;
+
+        /*!
+         * \brief Gets the value of a scalar counter
+         * \param c The Counter
+         * \return The value of the counter
+         */
+        [[nodiscard]] std::uint64_t get(tiny::Counter c) const {
+            return counters[std::size_t(c)];
+        }
+    };
+
+    /*!
+     * \brief A thread-safe registry of counters over the compilation process
+     *
+     * A thread-safe registry of counters over the compilation process, such as the bytes read, the lexemes produced per
+     * Token or the promises made per Assertion. Each thread writes to its own shard, so counting never contends on a
+     * lock or a shared cache line. The shards are merged when a snapshot is taken. The registry is disabled by default,
+     * and while disabled counting costs a single check.
+     */
+    class Statistics {
+    public:
+        Statistics(Statistics const &) = delete;        // Meyers' singleton pattern. Don't Implement
+        void operator=(Statistics const &) = delete;    // Ibidem
+
+        /*!
+         * \brief Fetches the Statistics' singleton instance
+         * \return The Statistics' singleton instance
+         */
+        static Statistics &get() {
+            static Statistics instance;
+            return instance;
+        }
+
+        //! Starts counting
+        void enable() {
+            enabled.store(true, std::memory_order_relaxed);
+        }
+
+        //! Stops counting. The counted values are kept
+        void disable() {
+            enabled.store(false, std::memory_order_relaxed);
+        }
+
+        /*!
+         * \brief Returns whether the registry is counting
+         * \return True if the registry is enabled
+         */
+        [[nodiscard]] bool isEnabled() const {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        /*!
+         * \brief Adds to a scalar counter
+         * \param c The Counter
+         * \param n The amount to add
+         */
+        void add(tiny::Counter c, std::uint64_t n = 1) {
+            if (isEnabled()) {
+                bump(local().counters[std::size_t(c)], n);
+            }
+        }
+
+        /*!
+         * \brief Counts a lexeme
+         * \param t The Token of the lexeme
+         */
+        void addLexeme(tiny::Token t) {
+            if (isEnabled()) {
+                bump(local().lexemes[std::size_t(t)], 1);
+            }
+        }
+
+        /*!
+         * \brief Counts the nodes of an AST, recursively
+         * \param file The AST
+         */
+        void addAST(const tiny::ASTFile &file);
+
+        /*!
+         * \brief Counts a promise added to a symbol table
+         * \param a The Assertion of the promise
+         */
+        void addPromise(tiny::Assertion a) {
+            if (isEnabled()) {
+                bump(local().promises[std::size_t(a)], 1);
+            }
+        }
+
+        /*!
+         * \brief Counts a fulfillment added to a symbol table
+         * \param a The Assertion of the fulfillment
+         */
+        void addFulfillment(tiny::Assertion a) {
+            if (isEnabled()) {
+                bump(local().fulfillments[std::size_t(a)], 1);
+            }
+        }
+
+        /*!
+         * \brief Merges the shards of all the threads into a snapshot
+         * \return The merged statistics
+         *
+         * Merges the shards of all the threads into a snapshot. Threads might still be counting while the snapshot is
+         * taken, in which case their latest increments might be missing.
+         */
+        [[nodiscard]] tiny::StatsSnapshot snapshot();
+
+        //! Sets every counter back to zero
+        void reset();
+
+        //! Logs the non-zero statistics
+        void logSummary();
+
+        /*!
+         * \brief Gets the peak resident set size of the process
+         * \return The peak RSS in bytes, or 0 if the platform doesn't provide it
+         */
+        static std::uint64_t getPeakRSS();
+
+    private:
+        Statistics() = default;
+
+        //! The counters owned by a single thread
+        struct Shard {
+            std::array<std::atomic<std::uint64_t>, tiny::COUNTER_COUNT> counters{};
+            std::array<std::atomic<std::uint64_t>, tiny::TOKEN_COUNT> lexemes{};
+            std::array<std::atomic<std::uint64_t>, tiny::AST_NODE_TYPE_COUNT> astNodes{};
+            std::array<std::atomic<std::uint64_t>, tiny::ASSERTION_COUNT> promises{};
+            std::array<std::atomic<std::uint64_t>, tiny::ASSERTION_COUNT> fulfillments{};
+        };
+
+        /*!
+         * \brief Increments a counter of the calling thread's shard
+         * \param counter The counter
+         * \param n The amount to add
+         *
+         * Only the owning thread writes to its shard, so a plain load and store is enough (no locked instruction).
+         * The atomics only guarantee that concurrent snapshots read whole values.
+         */
+        static void bump(std::atomic<std::uint64_t> &counter, std::uint64_t n) {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        /*!
+         * \brief Gets the calling thread's shard, and creates it on the first call
+         * \return The shard of the calling thread
+         */
+        Shard &local();
+
+        //! Whether counting is enabled
+        std::atomic<bool> enabled = false;
+
+        //! Lock over the list of shards
+        std::mutex mutex;
+
+        //! A shard for each thread that has counted something. Shards outlive their threads so they can be merged
+        std::vector<std::unique_ptr<Shard>> shards;
+    };
+}
+
+#endif //TINY_STATS_H
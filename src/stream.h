@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <vector>
 #include <iterator>
+#include <utility>
 
 #include "unicode.h"
 
@@ -30,7 +31,7 @@ namespace tiny {
          * \param col A vector of items to add to the stream
          * \param terminator An optional terminator to return if the stream's length is exceeded
          */
-        explicit Stream(std::vector<T> col) : collection(col) {};
+        explicit Stream(std::vector<T> col) : collection(std::move(col)) {};
 
         /*!
          * \brief Use a std::stream for the creation of the underlying vector
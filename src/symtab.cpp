@@ -1,5 +1,6 @@
 #include "symtab.h"
 #include "logger.h"
+#include "stats.h"
 
 void tiny::SymbolTable::build() {
     for (const auto &node: ast.statements) {
@@ -207,6 +208,7 @@ void tiny::Scope::addPromise(tiny::Promise promise) {
     tiny::debug(promise.meta.file,
             "<- (" + (!name.codepoints.empty() ? name.toString() : "?") + ") " + promise.toString().toString());
 
+    tiny::Statistics::get().addPromise(promise.assertion);
     promises.push_back(std::move(promise));
 }
 
@@ -214,6 +216,7 @@ void tiny::Scope::addFulfilment(tiny::Promise fulfilment) {
     tiny::debug(fulfilment.meta.file,
             "-> (" + (!name.codepoints.empty() ? name.toString() : "?") + ") " + fulfilment.toString().toString());
 
+    tiny::Statistics::get().addFulfillment(fulfilment.assertion);
     fulfillments.push_back(std::move(fulfilment));
 }
 
@@ -248,3 +251,35 @@ tiny::String tiny::Promise::toString() const
         return "Invalid promise";
     }
 }
+
+std::string tiny::toString(tiny::Assertion a)
+{
+    switch (a) {
+    case tiny::Assertion::None:
+        return "None";
+    case tiny::Assertion::IsDefined:
+        return "IsDefined";
+    case tiny::Assertion::HasMember:
+        return "HasMember";
+    case tiny::Assertion::IsIndexable:
+        return "IsIndexable";
+    case tiny::Assertion::IsStruct:
+        return "IsStruct";
+    case tiny::Assertion::IsCallable:
+        return "IsCallable";
+    case tiny::Assertion::CallReturns:
+        return "CallReturns";
+    case tiny::Assertion::CallReturnCount:
+        return "CallReturnCount";
+    case tiny::Assertion::CallRequires:
+        return "CallRequires";
+    case tiny::Assertion::IsNumeric:
+        return "IsNumeric";
+    case tiny::Assertion::IsText:
+        return "IsText";
+    case tiny::Assertion::IsOfType:
+        return "IsOfType";
+    default:
+        return "Unknown";
+    }
+}
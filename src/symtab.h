@@ -24,6 +24,13 @@ namespace tiny {
         IsOfType
     };
 
+    /*!
+     * \brief Returns the name of the Assertion
+     * \param a Assertion to stringify
+     * \return The name of the Assertion as it's declared (for example Assertion::IsDefined will become "IsDefined")
+     */
+    [[nodiscard]] std::string toString(tiny::Assertion a);
+
     struct Promise {
     public:
         Promise(tiny::String identifier, tiny::Assertion assertion, tiny::Metadata meta):
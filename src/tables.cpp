@@ -0,0 +1,76 @@
+#include "tables.h"
+
+#include <algorithm>
+
+tiny::TokenTable tiny::TokenTable::build(const std::vector<tiny::Lexeme> &lexemes) {
+    tiny::TokenTable table;
+    table.kinds.reserve(lexemes.size());
+    table.starts.reserve(lexemes.size());
+    table.ends.reserve(lexemes.size());
+
+    for (auto const &l: lexemes) {
+        table.kinds.push_back(std::uint16_t(l.token));
+        table.starts.push_back(std::uint32_t(l.metadata.start));
+        table.ends.push_back(std::uint32_t(std::max(l.metadata.start, l.metadata.end)));
+    }
+
+    return table;
+}
+
+std::size_t tiny::TokenTable::size() const {
+    return kinds.size();
+}
+
+namespace {
+    //! Appends a node and its descendants, returning the size of its subtree
+    std::uint32_t append(tiny::NodeTable &table, const tiny::ASTNode &node, std::int32_t parent) {
+        auto index = table.kinds.size();
+
+        table.kinds.push_back(std::uint16_t(node.type));
+        table.parents.push_back(parent);
+        table.sizes.push_back(1);
+        table.starts.push_back(std::uint32_t(node.meta.start));
+        table.ends.push_back(std::uint32_t(std::max(node.meta.start, node.meta.end)));
+
+        std::uint32_t size = 1;
+        for (auto const &child: node.children) {
+            if (child) {
+                size += append(table, *child, std::int32_t(index));
+            }
+        }
+
+        table.sizes[index] = size;
+        return size;
+    }
+}
+
+tiny::NodeTable tiny::NodeTable::build(const tiny::ASTFile &file) {
+    tiny::NodeTable table;
+    for (auto const &statement: file.statements) {
+        append(table, statement, -1);
+    }
+
+    return table;
+}
+
+std::size_t tiny::NodeTable::size() const {
+    return kinds.size();
+}
+
+std::vector<std::string> tiny::getTokenNames() {
+    std::vector<std::string> names;
+    for (auto t = std::size_t(tiny::Token::None); t <= std::size_t(tiny::Token::MultilineComment); t++) {
+        names.push_back(tiny::toString(tiny::Token(t)));
+    }
+
+    return names;
+}
+
+std::vector<std::string> tiny::getNodeTypeNames() {
+    std::vector<std::string> names;
+    for (auto t = std::size_t(tiny::ASTNodeType::None); t <= std::size_t(tiny::ASTNodeType::Composition); t++) {
+        names.push_back(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType(t)).toString());
+    }
+
+    return names;
+}
@@ -0,0 +1,74 @@
+#ifndef TINY_TABLES_H
+#define TINY_TABLES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lexer.h"
+#include "ast.h"
+
+namespace tiny {
+    /*!
+     * \brief The lexemes of a file as parallel arrays, one entry per lexeme
+     *
+     * The lexemes of a file as parallel arrays, one entry per lexeme. Offsets are codepoint indices into the source,
+     * so they can slice the decoded text directly. Meant to be handed out without copies, such as through the buffer
+     * protocol of the Python module.
+     */
+    struct TokenTable {
+        //! The Token of every lexeme
+        std::vector<std::uint16_t> kinds;
+        //! Index of the first codepoint of every lexeme
+        std::vector<std::uint32_t> starts;
+        //! Index past the last codepoint of every lexeme
+        std::vector<std::uint32_t> ends;
+
+        /*!
+         * \brief Builds the table out of the lexemes of a file
+         * \param lexemes The lexemes
+         * \return The table
+         */
+        static tiny::TokenTable build(const std::vector<tiny::Lexeme> &lexemes);
+
+        //! Number of lexemes
+        [[nodiscard]] std::size_t size() const;
+    };
+
+    /*!
+     * \brief The nodes of an AST as parallel arrays, in depth-first pre-order
+     *
+     * The nodes of an AST as parallel arrays, in depth-first pre-order: every node comes before its children, and its
+     * descendants are the sizes[i] - 1 entries right after it. The top-level statements have no parent (-1).
+     */
+    struct NodeTable {
+        //! The ASTNodeType of every node
+        std::vector<std::uint16_t> kinds;
+        //! Index of the parent of every node. -1 for the top-level statements
+        std::vector<std::int32_t> parents;
+        //! Number of nodes in the subtree of every node, itself included
+        std::vector<std::uint32_t> sizes;
+        //! Index of the first codepoint of every node
+        std::vector<std::uint32_t> starts;
+        //! Index past the last codepoint of every node. Equal to the start if unknown
+        std::vector<std::uint32_t> ends;
+
+        /*!
+         * \brief Builds the table out of the AST of a file
+         * \param file The AST
+         * \return The table
+         */
+        static tiny::NodeTable build(const tiny::ASTFile &file);
+
+        //! Number of nodes
+        [[nodiscard]] std::size_t size() const;
+    };
+
+    //! Gets the names of every Token, indexed by their value
+    std::vector<std::string> getTokenNames();
+
+    //! Gets the names of every ASTNodeType, indexed by their value
+    std::vector<std::string> getNodeTypeNames();
+}
+
+#endif //TINY_TABLES_H
@@ -0,0 +1,667 @@
+#include "toml.h"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <set>
+
+#include "errors.h"
+
+namespace {
+    //! Whether a character can be part of a bare key
+    bool isBareKeyChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+    }
+
+    //! Appends a codepoint to a string as UTF-8
+    void appendUtf8(std::string &out, std::uint32_t cp) {
+        if (cp < 0x80) {
+            out += char(cp);
+        } else if (cp < 0x800) {
+            out += char(0xC0 | (cp >> 6));
+            out += char(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += char(0xE0 | (cp >> 12));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        } else {
+            out += char(0xF0 | (cp >> 18));
+            out += char(0x80 | ((cp >> 12) & 0x3F));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        }
+    }
+
+    //! A single-pass parser over the text of a document
+    class TomlParser {
+    public:
+        explicit TomlParser(std::string_view content) : content(content) {};
+
+        tiny::TomlValue parse() {
+            tiny::TomlValue root{tiny::TomlValue::Table{}, 1, 1};
+            auto *current = &root;
+            std::string currentPath;
+
+            while (true) {
+                skipBlank();
+                if (atEnd()) {
+                    break;
+                }
+
+                if (peek() == '[') {
+                    current = &header(root, currentPath);
+                } else {
+                    keyValue(*current, currentPath);
+                }
+
+                endOfLine();
+            }
+
+            return root;
+        }
+
+    private:
+        using Table = tiny::TomlValue::Table;
+        using Array = tiny::TomlValue::Array;
+
+        [[nodiscard]] bool atEnd() const {
+            return pos >= content.size();
+        }
+
+        [[nodiscard]] char peek(std::size_t offset = 0) const {
+            return pos + offset < content.size() ? content[pos + offset] : '\0';
+        }
+
+        [[nodiscard]] bool startsWith(std::string_view s) const {
+            return content.substr(pos, s.size()) == s;
+        }
+
+        char advance() {
+            char c = content[pos++];
+            if (c == '\n') {
+                line++;
+                column = 1;
+            } else {
+                column++;
+            }
+
+            return c;
+        }
+
+        void expect(char c, const std::string &what) {
+            if (peek() != c || atEnd()) {
+                fail("Expected " + what);
+            }
+
+            advance();
+        }
+
+        [[noreturn]] void fail(const std::string &msg) const {
+            throw tiny::TomlError(msg, line, column);
+        }
+
+        //! Skips spaces and tabs
+        void skipSpaces() {
+            while (peek() == ' ' || peek() == '\t') {
+                advance();
+            }
+        }
+
+        //! Skips a comment, if there's one
+        void skipComment() {
+            if (peek() == '#') {
+                while (!atEnd() && peek() != '\n') {
+                    advance();
+                }
+            }
+        }
+
+        //! Skips whitespace, comments and newlines
+        void skipBlank() {
+            while (true) {
+                skipSpaces();
+                skipComment();
+                if (peek() == '\r' && peek(1) == '\n') {
+                    advance();
+                }
+
+                if (atEnd() || peek() != '\n') {
+                    return;
+                }
+
+                advance();
+            }
+        }
+
+        //! Requires the rest of the line to be blank
+        void endOfLine() {
+            skipSpaces();
+            skipComment();
+            if (peek() == '\r' && peek(1) == '\n') {
+                advance();
+            }
+
+            if (!atEnd() && peek() != '\n') {
+                fail("Expected the end of the line");
+            }
+        }
+
+        //! Parses a dotted key
+        std::vector<std::string> key() {
+            std::vector<std::string> parts;
+
+            while (true) {
+                skipSpaces();
+
+                if (peek() == '"') {
+                    parts.push_back(basicString());
+                } else if (peek() == '\'') {
+                    parts.push_back(literalString());
+                } else {
+                    auto start = pos;
+                    while (!atEnd() && isBareKeyChar(peek())) {
+                        advance();
+                    }
+
+                    if (start == pos) {
+                        fail("Expected a key");
+                    }
+
+                    parts.emplace_back(content.substr(start, pos - start));
+                }
+
+                skipSpaces();
+                if (peek() != '.') {
+                    return parts;
+                }
+
+                advance();
+            }
+        }
+
+        //! Gets the entry of a key in a table, or null
+        static tiny::TomlValue *lookup(Table &table, std::string_view k) {
+            for (auto &[name, value]: table) {
+                if (name == k) {
+                    return &value;
+                }
+            }
+
+            return nullptr;
+        }
+
+        /*!
+         * \brief Walks into the table under a key, creating it if needed
+         * \param table The parent table
+         * \param k The key
+         * \param path Path of the parent. Gets updated to the path of the child
+         */
+        tiny::TomlValue &descend(tiny::TomlValue &table, const std::string &k, std::string &path) {
+            auto &entries = std::get<Table>(table.data);
+            path += '\x1f' + k;
+
+            auto *child = lookup(entries, k);
+            if (child == nullptr) {
+                entries.emplace_back(k, tiny::TomlValue{Table{}, line, column});
+                return entries.back().second;
+            }
+
+            if (frozen.count(path) > 0) {
+                fail("Can't extend the inline value of '" + k + "'");
+            }
+
+            if (child->is<Array>() && !child->as<Array>().empty() && child->as<Array>().back().is<Table>()) {
+                // Arrays of tables extend their last table
+                auto &array = std::get<Array>(child->data);
+                path += '#' + std::to_string(array.size() - 1);
+                return array.back();
+            }
+
+            if (!child->is<Table>()) {
+                fail("'" + k + "' is already defined as a " + child->getTypeName());
+            }
+
+            return *child;
+        }
+
+        //! Parses a table or array of tables header, returning the table to add the next keys to
+        tiny::TomlValue &header(tiny::TomlValue &root, std::string &path) {
+            advance();
+            bool isArray = peek() == '[';
+            if (isArray) {
+                advance();
+            }
+
+            auto parts = key();
+            expect(']', "']' to close the table header");
+            if (isArray) {
+                expect(']', "']]' to close the array of tables header");
+            }
+
+            path.clear();
+            auto *table = &root;
+            for (std::size_t i = 0; i + 1 < parts.size(); i++) {
+                table = &descend(*table, parts[i], path);
+            }
+
+            auto const &last = parts.back();
+            auto &entries = std::get<Table>(table->data);
+            auto *existing = lookup(entries, last);
+            path += '\x1f' + last;
+
+            if (isArray) {
+                if (existing == nullptr) {
+                    entries.emplace_back(last, tiny::TomlValue{Array{}, line, column});
+                    existing = &entries.back().second;
+                } else if (!existing->is<Array>() || frozen.count(path) > 0) {
+                    fail("'" + last + "' is not an array of tables");
+                }
+
+                auto &array = std::get<Array>(existing->data);
+                array.push_back(tiny::TomlValue{Table{}, line, column});
+                path += '#' + std::to_string(array.size() - 1);
+                defined.insert(path);
+
+                return array.back();
+            }
+
+            if (!defined.insert(path).second) {
+                fail("Table '" + last + "' is defined more than once");
+            }
+
+            if (existing == nullptr) {
+                entries.emplace_back(last, tiny::TomlValue{Table{}, line, column});
+                return entries.back().second;
+            }
+
+            if (!existing->is<Table>() || frozen.count(path) > 0) {
+                fail("'" + last + "' is already defined as a " + existing->getTypeName());
+            }
+
+            return *existing;
+        }
+
+        //! Parses a key/value pair into a table
+        void keyValue(tiny::TomlValue &table, const std::string &tablePath) {
+            auto parts = key();
+            auto path = tablePath;
+
+            auto *target = &table;
+            for (std::size_t i = 0; i + 1 < parts.size(); i++) {
+                target = &descend(*target, parts[i], path);
+                defined.insert(path);
+            }
+
+            skipSpaces();
+            expect('=', "'=' after the key");
+            skipSpaces();
+
+            auto const &last = parts.back();
+            auto &entries = std::get<Table>(target->data);
+            if (lookup(entries, last) != nullptr) {
+                fail("Key '" + last + "' is defined more than once");
+            }
+
+            path += '\x1f' + last;
+            auto v = value(path);
+            entries.emplace_back(last, std::move(v));
+        }
+
+        //! Parses a value. Inline tables and arrays get frozen under their path
+        tiny::TomlValue value(const std::string &path) {
+            tiny::TomlValue v{false, line, column};
+            char c = peek();
+
+            if (c == '"') {
+                v.data = startsWith("\"\"\"") ? multilineBasicString() : basicString();
+            } else if (c == '\'') {
+                v.data = startsWith("'''") ? multilineLiteralString() : literalString();
+            } else if (startsWith("true")) {
+                pos += 4;
+                column += 4;
+                v.data = true;
+            } else if (startsWith("false")) {
+                pos += 5;
+                column += 5;
+                v.data = false;
+            } else if (c == '[') {
+                v.data = array(path);
+                frozen.insert(path);
+            } else if (c == '{') {
+                v.data = inlineTable(path);
+                frozen.insert(path);
+            } else {
+                v.data = number();
+            }
+
+            return v;
+        }
+
+        Array array(const std::string &path) {
+            advance();
+            Array result;
+
+            while (true) {
+                skipBlank();
+                if (peek() == ']') {
+                    advance();
+                    return result;
+                }
+
+                if (atEnd()) {
+                    fail("Unterminated array");
+                }
+
+                result.push_back(value(path + '#' + std::to_string(result.size())));
+
+                skipBlank();
+                if (peek() == ',') {
+                    advance();
+                } else if (peek() != ']') {
+                    fail("Expected ',' or ']' in the array");
+                }
+            }
+        }
+
+        Table inlineTable(const std::string &path) {
+            advance();
+            tiny::TomlValue table{Table{}, line, column};
+
+            skipSpaces();
+            if (peek() == '}') {
+                advance();
+                return table.as<Table>();
+            }
+
+            while (true) {
+                keyValue(table, path);
+                skipSpaces();
+
+                if (peek() == '}') {
+                    advance();
+                    return std::get<Table>(table.data);
+                }
+
+                expect(',', "',' or '}' in the inline table");
+            }
+        }
+
+        std::variant<bool, std::int64_t, double, std::string, Array, Table> number() {
+            auto startLine = line;
+            auto startColumn = column;
+
+            std::string digits;
+            if (peek() == '+' || peek() == '-') {
+                digits += advance();
+            }
+
+            if (startsWith("inf") || startsWith("nan")) {
+                bool negative = !digits.empty() && digits[0] == '-';
+                bool inf = startsWith("inf");
+                pos += 3;
+                column += 3;
+
+                if (inf) {
+                    return negative ? -std::numeric_limits<double>::infinity()
+                                    : std::numeric_limits<double>::infinity();
+                }
+
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+
+            int base = 10;
+            if (digits.empty() && peek() == '0' && (peek(1) == 'x' || peek(1) == 'o' || peek(1) == 'b')) {
+                base = peek(1) == 'x' ? 16 : (peek(1) == 'o' ? 8 : 2);
+                advance();
+                advance();
+            }
+
+            auto isDigit = [base](char c) {
+                return (c >= '0' && c <= '9') || (base == 16 && ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')));
+            };
+
+            bool isFloat = false;
+            char previous = '\0';
+            while (!atEnd()) {
+                char c = peek();
+
+                if (c == '_') {
+                    // Underscores must sit between digits
+                    if (!isDigit(previous) || !isDigit(peek(1))) {
+                        fail("Misplaced '_' in number");
+                    }
+                } else if (isDigit(c)) {
+                    digits += c;
+                } else if (base == 10 && (c == '.' || c == 'e' || c == 'E' ||
+                                          ((c == '+' || c == '-') && (previous == 'e' || previous == 'E')))) {
+                    isFloat = true;
+                    digits += c;
+                } else if (base == 10 && (c == '-' || c == ':')) {
+                    fail("Dates and times are not supported");
+                } else {
+                    break;
+                }
+
+                previous = c;
+                advance();
+            }
+
+            auto body = std::string_view(digits);
+            if (!body.empty() && (body[0] == '+' || body[0] == '-')) {
+                body.remove_prefix(1);
+            }
+
+            if (body.empty()) {
+                throw tiny::TomlError("Invalid value", startLine, startColumn);
+            }
+
+            if (isFloat) {
+                char *end = nullptr;
+                double result = std::strtod(digits.c_str(), &end);
+                if (end != digits.c_str() + digits.size() || body[0] == '.' || body.back() == '.') {
+                    throw tiny::TomlError("Invalid float '" + digits + "'", startLine, startColumn);
+                }
+
+                return result;
+            }
+
+            if (base == 10 && body.size() > 1 && body[0] == '0') {
+                throw tiny::TomlError("Leading zeros are not allowed in '" + digits + "'", startLine, startColumn);
+            }
+
+            std::int64_t result = 0;
+            auto begin = digits.data() + (digits[0] == '+' ? 1 : 0);
+            auto [end, ec] = std::from_chars(begin, digits.data() + digits.size(), result, base);
+            if (ec != std::errc() || end != digits.data() + digits.size()) {
+                throw tiny::TomlError("Invalid integer '" + digits + "'", startLine, startColumn);
+            }
+
+            return result;
+        }
+
+        //! Parses an escape sequence of a basic string, after the backslash
+        void escape(std::string &out) {
+            char c = advance();
+            switch (c) {
+            case 'b': out += '\b'; return;
+            case 't': out += '\t'; return;
+            case 'n': out += '\n'; return;
+            case 'f': out += '\f'; return;
+            case 'r': out += '\r'; return;
+            case 'e': out += '\x1b'; return;
+            case '"': out += '"'; return;
+            case '\\': out += '\\'; return;
+            case 'u':
+            case 'U': {
+                std::size_t length = c == 'u' ? 4 : 8;
+                std::uint32_t cp = 0;
+                auto hex = content.substr(pos, length);
+                auto [end, ec] = std::from_chars(hex.data(), hex.data() + hex.size(), cp, 16);
+                if (hex.size() != length || ec != std::errc() || end != hex.data() + hex.size() ||
+                    cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+                    fail("Invalid unicode escape");
+                }
+
+                pos += length;
+                column += length;
+                appendUtf8(out, cp);
+                return;
+            }
+            default:
+                fail(std::string("Invalid escape sequence '\\") + c + "'");
+            }
+        }
+
+        std::string basicString() {
+            advance();
+            std::string out;
+
+            while (true) {
+                if (atEnd() || peek() == '\n') {
+                    fail("Unterminated string");
+                }
+
+                char c = advance();
+                if (c == '"') {
+                    return out;
+                }
+
+                if (c == '\\') {
+                    escape(out);
+                } else {
+                    out += c;
+                }
+            }
+        }
+
+        std::string literalString() {
+            advance();
+            auto start = pos;
+
+            while (peek() != '\'') {
+                if (atEnd() || peek() == '\n') {
+                    fail("Unterminated string");
+                }
+
+                advance();
+            }
+
+            advance();
+            return std::string(content.substr(start, pos - start - 1));
+        }
+
+        //! Skips the newline right after the opening delimiter of a multi-line string
+        void skipFirstNewline() {
+            if (peek() == '\r' && peek(1) == '\n') {
+                advance();
+            }
+
+            if (peek() == '\n') {
+                advance();
+            }
+        }
+
+        std::string multilineBasicString() {
+            pos += 3;
+            column += 3;
+            skipFirstNewline();
+
+            std::string out;
+            while (true) {
+                if (atEnd()) {
+                    fail("Unterminated multi-line string");
+                }
+
+                // Up to two quotes can be right before the closing delimiter
+                if (startsWith("\"\"\"") && !startsWith("\"\"\"\"\"\"")) {
+                    while (startsWith("\"\"\"\"")) {
+                        out += advance();
+                    }
+
+                    pos += 3;
+                    column += 3;
+                    return out;
+                }
+
+                char c = advance();
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+
+                // A backslash at the end of a line trims the whitespace up to the next non-blank character
+                auto save = pos;
+                skipSpaces();
+                if (peek() == '\n' || (peek() == '\r' && peek(1) == '\n')) {
+                    while (peek() == ' ' || peek() == '\t' || peek() == '\n' || peek() == '\r') {
+                        advance();
+                    }
+                    continue;
+                }
+
+                column -= pos - save;
+                pos = save;
+                escape(out);
+            }
+        }
+
+        std::string multilineLiteralString() {
+            pos += 3;
+            column += 3;
+            skipFirstNewline();
+
+            auto start = pos;
+            while (true) {
+                if (atEnd()) {
+                    fail("Unterminated multi-line string");
+                }
+
+                if (startsWith("'''") && !startsWith("''''''")) {
+                    while (startsWith("''''")) {
+                        advance();
+                    }
+
+                    auto result = std::string(content.substr(start, pos - start));
+                    pos += 3;
+                    column += 3;
+                    return result;
+                }
+
+                advance();
+            }
+        }
+
+        std::string_view content;
+        std::size_t pos = 0;
+        std::size_t line = 1;
+        std::size_t column = 1;
+
+        //! Paths of the tables defined by a header or by dotted keys
+        std::set<std::string> defined;
+        //! Paths of the inline tables and arrays, which can't be extended
+        std::set<std::string> frozen;
+    };
+}
+
+const tiny::TomlValue *tiny::TomlValue::find(std::string_view key) const {
+    if (!is<Table>()) {
+        return nullptr;
+    }
+
+    for (auto const &[name, value]: as<Table>()) {
+        if (name == key) {
+            return &value;
+        }
+    }
+
+    return nullptr;
+}
+
+std::string tiny::TomlValue::getTypeName() const {
+    static const char *names[] = {"boolean", "integer", "float", "string", "array", "table"};
+    return names[data.index()];
+}
+
+tiny::TomlValue tiny::parseToml(std::string_view content) {
+    return TomlParser(content).parse();
+}
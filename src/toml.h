@@ -0,0 +1,65 @@
+#ifndef TINY_TOML_H
+#define TINY_TOML_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace tiny {
+    /*!
+     * \brief A value of a TOML document
+     *
+     * A value of a TOML document: a boolean, an integer, a float, a string, an array or a table. Tables keep their keys
+     * in the order they were defined. Every value knows the line and column it was defined at, so the settings built
+     * on top of it can point at the offending value.
+     */
+    struct TomlValue {
+        using Array = std::vector<tiny::TomlValue>;
+        using Table = std::vector<std::pair<std::string, tiny::TomlValue>>;
+
+        //! The value
+        std::variant<bool, std::int64_t, double, std::string, Array, Table> data = Table{};
+
+        //! Line the value was defined at, starting at 1
+        std::size_t line = 0;
+        //! Column the value was defined at, starting at 1
+        std::size_t column = 0;
+
+        //! Whether the value holds a T
+        template<typename T>
+        [[nodiscard]] bool is() const {
+            return std::holds_alternative<T>(data);
+        }
+
+        //! Gets the value as a T. Throws std::bad_variant_access if it's of another type
+        template<typename T>
+        [[nodiscard]] const T &as() const {
+            return std::get<T>(data);
+        }
+
+        /*!
+         * \brief Looks for a key in a table
+         * \param key The key. Not dotted
+         * \return The value, or null if the key is not in the table or this is not a table
+         */
+        [[nodiscard]] const tiny::TomlValue *find(std::string_view key) const;
+
+        //! Gets the name of the type of the value, as used in error messages
+        [[nodiscard]] std::string getTypeName() const;
+    };
+
+    /*!
+     * \brief Parses a TOML document
+     * \param content The document
+     * \return The root table
+     *
+     * Parses a TOML document in a single pass, without regular expressions. Supports the whole of TOML 1.0 except
+     * dates and times. Throws TomlError, with the position of the error, if the document is malformed.
+     */
+    tiny::TomlValue parseToml(std::string_view content);
+}
+
+#endif //TINY_TOML_H
@@ -0,0 +1,268 @@
+#include "value.h"
+
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "errors.h"
+
+namespace {
+    bool isNumeric(const tiny::RuntimeValue &v) {
+        return v.kind == tiny::ValueKind::Int || v.kind == tiny::ValueKind::Float;
+    }
+
+    double toFloat(const tiny::RuntimeValue &v) {
+        return v.kind == tiny::ValueKind::Int ? double(v.i) : v.f;
+    }
+
+    [[noreturn]] void invalidOperands(tiny::Operator op, const tiny::RuntimeValue &x, const tiny::RuntimeValue &y) {
+        throw tiny::ExecutionError("Invalid operands for '" + tiny::toString(op) + "' (" + x.toString() + " and "
+                                   + y.toString() + ")");
+    }
+
+    //! Integer exponentiation by squaring. Wraps around on overflow
+    std::int64_t power(std::int64_t base, std::int64_t exponent) {
+        std::uint64_t result = 1;
+        auto b = std::uint64_t(base);
+
+        while (exponent > 0) {
+            if (exponent & 1) {
+                result *= b;
+            }
+
+            b *= b;
+            exponent >>= 1;
+        }
+
+        return std::int64_t(result);
+    }
+}
+
+tiny::RuntimeValue tiny::RuntimeValue::zero(const std::string &type) {
+    if (type.rfind("float", 0) == 0) {
+        return fromFloat(0);
+    }
+
+    if (type == "bool") {
+        return fromBool(false);
+    }
+
+    if (type.rfind("int", 0) == 0 || type.rfind("uint", 0) == 0) {
+        return fromInt(0);
+    }
+
+    return {};
+}
+
+bool tiny::RuntimeValue::operator==(const tiny::RuntimeValue &other) const {
+    if (kind != other.kind) {
+        return false;
+    }
+
+    switch (kind) {
+    case tiny::ValueKind::Int:
+        return i == other.i;
+    case tiny::ValueKind::Float:
+        return f == other.f;
+    case tiny::ValueKind::Bool:
+        return b == other.b;
+    default:
+        return true;
+    }
+}
+
+std::string tiny::RuntimeValue::toString() const {
+    switch (kind) {
+    case tiny::ValueKind::Int:
+        return std::to_string(i);
+    case tiny::ValueKind::Float: {
+        std::ostringstream out;
+        out << std::setprecision(17) << f;
+        return out.str();
+    }
+    case tiny::ValueKind::Bool:
+        return b ? "True" : "False";
+    default:
+        return "None";
+    }
+}
+
+std::optional<tiny::RuntimeValue> tiny::RuntimeValue::parse(const std::string &str) {
+    if (str == "True" || str == "False") {
+        return fromBool(str == "True");
+    }
+
+    if (str == "None") {
+        return tiny::RuntimeValue();
+    }
+
+    try {
+        std::size_t end = 0;
+        if (str.find('.') == std::string::npos) {
+            auto value = std::stoll(str, &end, 0);
+            if (end == str.size()) {
+                return fromInt(value);
+            }
+        } else {
+            auto value = std::stod(str, &end);
+            if (end == str.size()) {
+                return fromFloat(value);
+            }
+        }
+    } catch (const std::exception &) {}
+
+    return std::nullopt;
+}
+
+std::string tiny::toString(tiny::Operator op) {
+    switch (op) {
+    case tiny::Operator::Add:
+        return "+";
+    case tiny::Operator::Sub:
+        return "-";
+    case tiny::Operator::Mul:
+        return "*";
+    case tiny::Operator::Div:
+        return "/";
+    case tiny::Operator::Pow:
+        return "**";
+    case tiny::Operator::Eq:
+        return "==";
+    case tiny::Operator::Neq:
+        return "!=";
+    case tiny::Operator::Lt:
+        return "<";
+    case tiny::Operator::Lteq:
+        return "<=";
+    case tiny::Operator::Gt:
+        return ">";
+    case tiny::Operator::Gteq:
+        return ">=";
+    default:
+        return "?";
+    }
+}
+
+tiny::RuntimeValue tiny::applyArithmetic(tiny::Operator op, const tiny::RuntimeValue &x, const tiny::RuntimeValue &y) {
+    if (!isNumeric(x) || !isNumeric(y)) {
+        invalidOperands(op, x, y);
+    }
+
+    if (x.kind == tiny::ValueKind::Int && y.kind == tiny::ValueKind::Int) {
+        // Unsigned arithmetic, so overflows wrap around instead of being undefined
+        auto a = std::uint64_t(x.i);
+        auto b = std::uint64_t(y.i);
+
+        switch (op) {
+        case tiny::Operator::Add:
+            return tiny::RuntimeValue::fromInt(std::int64_t(a + b));
+        case tiny::Operator::Sub:
+            return tiny::RuntimeValue::fromInt(std::int64_t(a - b));
+        case tiny::Operator::Mul:
+            return tiny::RuntimeValue::fromInt(std::int64_t(a * b));
+        case tiny::Operator::Div:
+            if (y.i == 0) {
+                throw tiny::ExecutionError("Division by zero");
+            }
+
+            if (x.i == std::numeric_limits<std::int64_t>::min() && y.i == -1) {
+                return x; // Wraps around
+            }
+
+            return tiny::RuntimeValue::fromInt(x.i / y.i);
+        case tiny::Operator::Pow:
+            if (y.i < 0) {
+                return tiny::RuntimeValue::fromFloat(std::pow(double(x.i), double(y.i)));
+            }
+
+            return tiny::RuntimeValue::fromInt(power(x.i, y.i));
+        default:
+            invalidOperands(op, x, y);
+        }
+    }
+
+    auto a = toFloat(x);
+    auto b = toFloat(y);
+
+    switch (op) {
+    case tiny::Operator::Add:
+        return tiny::RuntimeValue::fromFloat(a + b);
+    case tiny::Operator::Sub:
+        return tiny::RuntimeValue::fromFloat(a - b);
+    case tiny::Operator::Mul:
+        return tiny::RuntimeValue::fromFloat(a * b);
+    case tiny::Operator::Div:
+        return tiny::RuntimeValue::fromFloat(a / b);
+    case tiny::Operator::Pow:
+        return tiny::RuntimeValue::fromFloat(std::pow(a, b));
+    default:
+        invalidOperands(op, x, y);
+    }
+}
+
+bool tiny::applyComparison(tiny::Operator op, const tiny::RuntimeValue &x, const tiny::RuntimeValue &y) {
+    if (isNumeric(x) && isNumeric(y)) {
+        if (x.kind == tiny::ValueKind::Int && y.kind == tiny::ValueKind::Int) {
+            switch (op) {
+            case tiny::Operator::Eq:
+                return x.i == y.i;
+            case tiny::Operator::Neq:
+                return x.i != y.i;
+            case tiny::Operator::Lt:
+                return x.i < y.i;
+            case tiny::Operator::Lteq:
+                return x.i <= y.i;
+            case tiny::Operator::Gt:
+                return x.i > y.i;
+            default:
+                return x.i >= y.i;
+            }
+        }
+
+        auto a = toFloat(x);
+        auto b = toFloat(y);
+
+        switch (op) {
+        case tiny::Operator::Eq:
+            return a == b;
+        case tiny::Operator::Neq:
+            return a != b;
+        case tiny::Operator::Lt:
+            return a < b;
+        case tiny::Operator::Lteq:
+            return a <= b;
+        case tiny::Operator::Gt:
+            return a > b;
+        default:
+            return a >= b;
+        }
+    }
+
+    // Booleans and None can only be told apart
+    if (op == tiny::Operator::Eq) {
+        return x == y;
+    }
+
+    if (op == tiny::Operator::Neq) {
+        return x != y;
+    }
+
+    invalidOperands(op, x, y);
+}
+
+tiny::RuntimeValue tiny::applyNegation(const tiny::RuntimeValue &x) {
+    if (x.kind == tiny::ValueKind::Int) {
+        return tiny::RuntimeValue::fromInt(std::int64_t(-std::uint64_t(x.i)));
+    }
+
+    if (x.kind == tiny::ValueKind::Float) {
+        return tiny::RuntimeValue::fromFloat(-x.f);
+    }
+
+    throw tiny::ExecutionError("Invalid operand for '-' (" + x.toString() + ")");
+}
+
+void tiny::invalidCondition(const tiny::RuntimeValue &x) {
+    throw tiny::ExecutionError("Expected a boolean but got " + x.toString());
+}
@@ -0,0 +1,132 @@
+#ifndef TINY_VALUE_H
+#define TINY_VALUE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace tiny {
+    //! The kind of value held by a RuntimeValue
+    enum class ValueKind : std::uint8_t {
+        None,
+        Int,
+        Float,
+        Bool,
+    };
+
+    //! A value of a running program. Every integer type is held as an int64, and every floating-point type as a double
+    struct RuntimeValue {
+        //! Kind of the value
+        tiny::ValueKind kind = tiny::ValueKind::None;
+
+        union {
+            std::int64_t i = 0;
+            double f;
+            bool b;
+        };
+
+        //! Builds an integer value
+        static RuntimeValue fromInt(std::int64_t v) { RuntimeValue r; r.kind = ValueKind::Int; r.i = v; return r; }
+        //! Builds a floating-point value
+        static RuntimeValue fromFloat(double v) { RuntimeValue r; r.kind = ValueKind::Float; r.f = v; return r; }
+        //! Builds a boolean value
+        static RuntimeValue fromBool(bool v) { RuntimeValue r; r.kind = ValueKind::Bool; r.b = v; return r; }
+
+        /*!
+         * \brief Gets the value of a declared but not initialized variable
+         * \param type Name of the type of the variable
+         * \return 0 for the integer and floating-point types, False for bool, and None for any other type
+         */
+        [[nodiscard]] static RuntimeValue zero(const std::string &type);
+
+        //! Whether both values are of the same kind and hold the same value
+        bool operator==(const RuntimeValue &other) const;
+        bool operator!=(const RuntimeValue &other) const { return !(*this == other); }
+
+        /*!
+         * \brief Serializes the value as a std::string
+         * \return The number, "True" or "False" for booleans, or "None"
+         */
+        [[nodiscard]] std::string toString() const;
+
+        /*!
+         * \brief Parses a value written as a Tiny literal, such as a command-line argument
+         * \param str An integer, a decimal number, "True", "False" or "None"
+         * \return The value, or nullopt if the string isn't a literal
+         */
+        [[nodiscard]] static std::optional<RuntimeValue> parse(const std::string &str);
+    };
+
+    //! The binary operators over runtime values
+    enum class Operator : std::uint8_t {
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Pow,
+        Eq,
+        Neq,
+        Lt,
+        Lteq,
+        Gt,
+        Gteq,
+    };
+
+    /*!
+     * \brief Gets the symbol of an operator
+     * \param op The operator
+     * \return The symbol, as written in Tiny (for example Operator::Add will become "+")
+     */
+    [[nodiscard]] std::string toString(tiny::Operator op);
+
+    /*!
+     * \brief Applies an arithmetic operator (Add, Sub, Mul, Div or Pow)
+     * \param op The operator
+     * \param x Left operand
+     * \param y Right operand
+     * \return The result
+     *
+     * Applies an arithmetic operator. Integers wrap around on overflow, and integer division truncates. If either
+     * operand is floating-point the operation is done in floating-point, as is raising an integer to a negative power.
+     * Throws ExecutionError for a non-numeric operand or an integer division by zero.
+     */
+    [[nodiscard]] tiny::RuntimeValue applyArithmetic(tiny::Operator op, const tiny::RuntimeValue &x,
+                                                     const tiny::RuntimeValue &y);
+
+    /*!
+     * \brief Applies a comparison operator (Eq, Neq, Lt, Lteq, Gt or Gteq)
+     * \param op The operator
+     * \param x Left operand
+     * \param y Right operand
+     * \return The result
+     *
+     * Applies a comparison operator. Numbers compare by value whatever their kind. Booleans and None can only be
+     * compared for equality, and throw ExecutionError otherwise.
+     */
+    [[nodiscard]] bool applyComparison(tiny::Operator op, const tiny::RuntimeValue &x, const tiny::RuntimeValue &y);
+
+    /*!
+     * \brief Negates a number. Throws ExecutionError if it isn't one
+     * \param x The number
+     * \return The negated number. Integers wrap around
+     */
+    [[nodiscard]] tiny::RuntimeValue applyNegation(const tiny::RuntimeValue &x);
+
+    //! Throws the ExecutionError of a condition that isn't a boolean
+    [[noreturn]] void invalidCondition(const tiny::RuntimeValue &x);
+
+    /*!
+     * \brief Gets the value of a boolean, as used by a condition. Throws ExecutionError if it isn't a boolean
+     * \param x The boolean
+     * \return Its value
+     */
+    inline bool toCondition(const tiny::RuntimeValue &x) {
+        if (x.kind != tiny::ValueKind::Bool) {
+            tiny::invalidCondition(x);
+        }
+
+        return x.b;
+    }
+}
+
+#endif //TINY_VALUE_H
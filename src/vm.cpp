@@ -0,0 +1,300 @@
+#include "vm.h"
+
+#include <algorithm>
+
+#include "errors.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(TINY_VM_SWITCH_DISPATCH)
+#define TINY_VM_THREADED
+#endif
+
+bool tiny::VM::isThreaded() {
+#ifdef TINY_VM_THREADED
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<tiny::RuntimeValue> tiny::VM::call(const std::string &name, const std::vector<tiny::RuntimeValue> &args) {
+    auto index = program.find(name);
+    if (index < 0) {
+        throw tiny::ExecutionError("Undefined function '" + name + "'. Qualify it as 'module." + name
+                                   + "' if more than one module declares it");
+    }
+
+    return call(std::uint32_t(index), args);
+}
+
+std::vector<tiny::RuntimeValue> tiny::VM::call(std::uint32_t function, const std::vector<tiny::RuntimeValue> &args) {
+    if (function >= program.functions.size()) {
+        throw tiny::ExecutionError("Undefined function #" + std::to_string(function));
+    }
+
+    auto const &fn = program.functions[function];
+    if (args.size() != fn.arity) {
+        throw tiny::ExecutionError("Function '" + fn.name + "' takes " + std::to_string(fn.arity)
+                                   + " arguments, but got " + std::to_string(args.size()));
+    }
+
+    reserve(std::max<std::size_t>(fn.registers, 1));
+    std::copy(args.begin(), args.end(), stack.begin());
+
+    frames.clear();
+    frames.push_back({&fn, fn.code.data(), 0});
+
+    return execute();
+}
+
+void tiny::VM::reserve(std::size_t size) {
+    if (size <= stack.size()) {
+        return;
+    }
+
+    if (size > MAX_STACK) {
+        throw tiny::ExecutionError("Stack overflow");
+    }
+
+    stack.resize(std::min(MAX_STACK, std::max(size, stack.size() * 2)));
+}
+
+std::vector<tiny::RuntimeValue> tiny::VM::execute() {
+    // The state of the running function is kept in locals, and only saved in its frame when it calls another one
+    const tiny::BytecodeFunction *fn = frames.back().fn;
+    const tiny::Instruction *ip = frames.back().ip;
+    const tiny::RuntimeValue *k = fn->constants.data();
+    tiny::RuntimeValue *r = stack.data() + frames.back().base;
+
+#ifdef TINY_VM_THREADED
+    // In the order of OpCode
+    static const void *dispatch[] = {
+            &&op_LoadConst, &&op_LoadInt, &&op_Move,
+            &&op_Add, &&op_Sub, &&op_Mul, &&op_Div, &&op_Pow, &&op_Neg, &&op_Not,
+            &&op_Eq, &&op_Neq, &&op_Lt, &&op_Lteq, &&op_Gt, &&op_Gteq,
+            &&op_Jump, &&op_JumpIfFalse, &&op_JumpIfTrue, &&op_ForPrep, &&op_ForLoop,
+            &&op_Call, &&op_Return,
+    };
+
+    static_assert(sizeof(dispatch) / sizeof(dispatch[0]) == tiny::OPCODE_COUNT, "Every operation needs a label");
+
+#define VM_CASE(name) op_##name:
+#define VM_NEXT() goto *dispatch[std::size_t(ip->op)]
+#else
+#define VM_CASE(name) case tiny::OpCode::name:
+#define VM_NEXT() continue
+#endif
+
+#define VM_ARITHMETIC(name, op)                                                                                       \
+    VM_CASE(name) {                                                                                                   \
+        auto const &x = r[ip->b];                                                                                     \
+        auto const &y = r[ip->c];                                                                                     \
+        if (x.kind == tiny::ValueKind::Int && y.kind == tiny::ValueKind::Int) {                                       \
+            r[ip->a] = tiny::RuntimeValue::fromInt(std::int64_t(std::uint64_t(x.i) op std::uint64_t(y.i)));           \
+        } else {                                                                                                      \
+            r[ip->a] = tiny::applyArithmetic(tiny::Operator::name, x, y);                                             \
+        }                                                                                                             \
+        ip++;                                                                                                         \
+        VM_NEXT();                                                                                                    \
+    }
+
+#define VM_COMPARISON(name, op)                                                                                       \
+    VM_CASE(name) {                                                                                                   \
+        auto const &x = r[ip->b];                                                                                     \
+        auto const &y = r[ip->c];                                                                                     \
+        if (x.kind == tiny::ValueKind::Int && y.kind == tiny::ValueKind::Int) {                                       \
+            r[ip->a] = tiny::RuntimeValue::fromBool(x.i op y.i);                                                      \
+        } else {                                                                                                      \
+            auto result = tiny::applyComparison(tiny::Operator::name, x, y);                                          \
+            r[ip->a] = tiny::RuntimeValue::fromBool(result);                                                          \
+        }                                                                                                             \
+        ip++;                                                                                                         \
+        VM_NEXT();                                                                                                    \
+    }
+
+    try {
+#ifdef TINY_VM_THREADED
+        VM_NEXT();
+#else
+        for (;;) switch (ip->op) {
+#endif
+
+        VM_CASE(LoadConst) {
+            r[ip->a] = k[ip->bx()];
+            ip++;
+            VM_NEXT();
+        }
+
+        VM_CASE(LoadInt) {
+            r[ip->a] = tiny::RuntimeValue::fromInt(ip->sbx());
+            ip++;
+            VM_NEXT();
+        }
+
+        VM_CASE(Move) {
+            r[ip->a] = r[ip->b];
+            ip++;
+            VM_NEXT();
+        }
+
+        VM_ARITHMETIC(Add, +)
+        VM_ARITHMETIC(Sub, -)
+        VM_ARITHMETIC(Mul, *)
+
+        VM_CASE(Div) {
+            r[ip->a] = tiny::applyArithmetic(tiny::Operator::Div, r[ip->b], r[ip->c]);
+            ip++;
+            VM_NEXT();
+        }
+
+        VM_CASE(Pow) {
+            r[ip->a] = tiny::applyArithmetic(tiny::Operator::Pow, r[ip->b], r[ip->c]);
+            ip++;
+            VM_NEXT();
+        }
+
+        VM_CASE(Neg) {
+            auto const &x = r[ip->b];
+            if (x.kind == tiny::ValueKind::Int) {
+                r[ip->a] = tiny::RuntimeValue::fromInt(std::int64_t(-std::uint64_t(x.i)));
+            } else {
+                r[ip->a] = tiny::applyNegation(x);
+            }
+
+            ip++;
+            VM_NEXT();
+        }
+
+        VM_CASE(Not) {
+            auto const &x = r[ip->b];
+            if (x.kind != tiny::ValueKind::Bool) {
+                tiny::invalidCondition(x);
+            }
+
+            r[ip->a] = tiny::RuntimeValue::fromBool(!x.b);
+            ip++;
+            VM_NEXT();
+        }
+
+        VM_COMPARISON(Eq, ==)
+        VM_COMPARISON(Neq, !=)
+        VM_COMPARISON(Lt, <)
+        VM_COMPARISON(Lteq, <=)
+        VM_COMPARISON(Gt, >)
+        VM_COMPARISON(Gteq, >=)
+
+        VM_CASE(Jump) {
+            ip += 1 + ip->sbx();
+            VM_NEXT();
+        }
+
+        VM_CASE(JumpIfFalse) {
+            auto const &x = r[ip->a];
+            if (x.kind != tiny::ValueKind::Bool) {
+                tiny::invalidCondition(x);
+            }
+
+            ip += x.b ? 1 : 1 + ip->sbx();
+            VM_NEXT();
+        }
+
+        VM_CASE(JumpIfTrue) {
+            auto const &x = r[ip->a];
+            if (x.kind != tiny::ValueKind::Bool) {
+                tiny::invalidCondition(x);
+            }
+
+            ip += x.b ? 1 + ip->sbx() : 1;
+            VM_NEXT();
+        }
+
+        VM_CASE(ForPrep) {
+            auto const &counter = r[ip->a];
+            auto const &limit = r[ip->a + 1];
+            auto const &step = r[ip->a + 2];
+
+            if (counter.kind != tiny::ValueKind::Int || step.kind != tiny::ValueKind::Int
+                || (limit.kind != tiny::ValueKind::Int && limit.kind != tiny::ValueKind::None)) {
+                throw tiny::ExecutionError("Ranges must be over integers");
+            }
+
+            if (step.i == 0) {
+                throw tiny::ExecutionError("The step of a range can't be zero");
+            }
+
+            if (limit.kind == tiny::ValueKind::None || (step.i > 0 ? counter.i < limit.i : counter.i > limit.i)) {
+                r[ip->a + 3] = counter;
+                ip++;
+            } else {
+                ip += 1 + ip->sbx();
+            }
+
+            VM_NEXT();
+        }
+
+        VM_CASE(ForLoop) {
+            auto &counter = r[ip->a];
+            auto const &limit = r[ip->a + 1];
+            auto step = r[ip->a + 2].i;
+
+            // Stop instead of wrapping around
+            auto next = std::int64_t(std::uint64_t(counter.i) + std::uint64_t(step));
+            auto wrapped = step > 0 ? next < counter.i : next > counter.i;
+
+            if (!wrapped && (limit.kind == tiny::ValueKind::None || (step > 0 ? next < limit.i : next > limit.i))) {
+                counter.i = next;
+                r[ip->a + 3] = counter;
+                ip += 1 + ip->sbx();
+            } else {
+                ip++;
+            }
+
+            VM_NEXT();
+        }
+
+        VM_CASE(Call) {
+            auto const &callee = program.functions[ip->bx()];
+            auto base = std::size_t(r - stack.data()) + ip->a;
+
+            frames.back().ip = ip + 1;
+            reserve(base + std::max<std::size_t>(callee.registers, 1));
+            frames.push_back({&callee, callee.code.data(), base});
+
+            fn = &callee;
+            ip = callee.code.data();
+            k = callee.constants.data();
+            r = stack.data() + base;
+            VM_NEXT();
+        }
+
+        VM_CASE(Return) {
+            if (frames.size() == 1) {
+                return {r + ip->a, r + ip->a + ip->b};
+            }
+
+            // The first value, if any, replaces the arguments in the registers of the caller
+            auto result = ip->b > 0 ? r[ip->a] : tiny::RuntimeValue();
+            *r = result;
+
+            frames.pop_back();
+            auto const &caller = frames.back();
+            fn = caller.fn;
+            ip = caller.ip;
+            k = fn->constants.data();
+            r = stack.data() + caller.base;
+            VM_NEXT();
+        }
+
+#ifndef TINY_VM_THREADED
+        }
+#endif
+    } catch (const tiny::ExecutionError &e) {
+        throw tiny::ExecutionError("In '" + fn->name + "': " + e.msg);
+    }
+
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_ARITHMETIC
+#undef VM_COMPARISON
+
+    return {};
+}
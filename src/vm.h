@@ -0,0 +1,80 @@
+#ifndef TINY_VM_H
+#define TINY_VM_H
+
+#include <string>
+#include <vector>
+
+#include "bytecode.h"
+
+namespace tiny {
+    /*!
+     * \brief Runs the bytecode of a BytecodeProgram
+     *
+     * Runs the bytecode of a BytecodeProgram. Every call gets a window of registers on a shared stack, starting at the
+     * arguments the caller put on top of its own registers, so arguments are never copied. The VM dispatches with
+     * computed gotos (threaded code) when built with GCC or Clang, and with a switch otherwise, or if
+     * TINY_VM_SWITCH_DISPATCH is defined.
+     *
+     * Integers wrap around on overflow, integer division truncates, and operations mixing integers and floating-point
+     * numbers are done in floating-point. Errors such as a division by zero or a non-boolean condition throw
+     * ExecutionError.
+     */
+    class VM {
+    public:
+        /*!
+         * \brief Builds a VM for a program
+         * \param program The program. Must outlive the VM
+         */
+        explicit VM(const tiny::BytecodeProgram &program) : program(program) {};
+
+        /*!
+         * \brief Runs a function
+         * \param name Name of the function. See BytecodeProgram::find()
+         * \param args The arguments
+         * \return The values returned by the function
+         *
+         * Runs a function. Throws ExecutionError if the name doesn't pick a single function, the number of arguments
+         * doesn't match, or the program fails while running.
+         */
+        std::vector<tiny::RuntimeValue> call(const std::string &name, const std::vector<tiny::RuntimeValue> &args);
+
+        /*!
+         * \brief Runs a function by its index in the program. See call(const std::string &, ...)
+         * \param function Index of the function
+         * \param args The arguments
+         * \return The values returned by the function
+         */
+        std::vector<tiny::RuntimeValue> call(std::uint32_t function, const std::vector<tiny::RuntimeValue> &args);
+
+        //! Whether the VM was built with computed-goto dispatch
+        [[nodiscard]] static bool isThreaded();
+
+        //! Maximum number of registers in the stack, across all the active calls
+        static constexpr std::size_t MAX_STACK = 1 << 20;
+
+    private:
+        //! The state of a caller, restored when its callee returns
+        struct Frame {
+            //! The function being run
+            const tiny::BytecodeFunction *fn;
+            //! Next instruction to run
+            const tiny::Instruction *ip;
+            //! Index of the first register of the function in the stack
+            std::size_t base;
+        };
+
+        //! Runs the bytecode from the frame on top of the frames until it returns
+        std::vector<tiny::RuntimeValue> execute();
+
+        //! Grows the stack to hold at least size registers. Throws ExecutionError past MAX_STACK
+        void reserve(std::size_t size);
+
+        const tiny::BytecodeProgram &program;
+        //! The registers of all the active calls
+        std::vector<tiny::RuntimeValue> stack;
+        //! The active calls. The last one is the running one
+        std::vector<Frame> frames;
+    };
+}
+
+#endif //TINY_VM_H
@@ -0,0 +1,299 @@
+#include "watcher.h"
+
+#include <sstream>
+#include <iomanip>
+
+#include "errors.h"
+#include "logger.h"
+#include "project.h"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    //! Set by the signal handler to stop the watch loop
+    std::atomic<bool> interrupted{false};
+
+    void onSignal(int) {
+        interrupted = true;
+    }
+
+    //! Stops the watch loop on SIGINT and SIGTERM while it lives, then restores the previous handlers
+    class SignalScope {
+    public:
+        SignalScope() {
+            // No SA_RESTART, so a signal interrupts the blocking poll()
+            struct sigaction action{};
+            action.sa_handler = onSignal;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGINT, &action, &previousInt);
+            sigaction(SIGTERM, &action, &previousTerm);
+            interrupted = false;
+        }
+
+        ~SignalScope() {
+            sigaction(SIGINT, &previousInt, nullptr);
+            sigaction(SIGTERM, &previousTerm, nullptr);
+        }
+
+        SignalScope(const SignalScope &) = delete;
+        SignalScope &operator=(const SignalScope &) = delete;
+
+    private:
+        struct sigaction previousInt{};
+        struct sigaction previousTerm{};
+    };
+
+    //! Whether a change to a file with the given name can affect the compilation
+    bool isRelevant(const std::filesystem::path &name) {
+        return name.extension() == ".ty" || name.filename() == "tiny.toml";
+    }
+}
+
+void tiny::Watcher::run() {
+    compiler.setCache(&cache);
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        throw tiny::WatchError("Unable to initialize inotify");
+    }
+
+    // Watch descriptors to the directory they watch
+    std::map<int, std::filesystem::path> watches;
+    tiny::File projectFile{tiny::FileType::Meta, root / "tiny.toml"};
+    auto watchAll = [&]() {
+        tiny::FileSelector selector(root);
+        try {
+            auto project = tiny::ProjectSettings::load(projectFile.path);
+            selector.setPatterns(project.include, project.exclude);
+        } catch (const tiny::TomlError &e) {
+            // Watch with the default patterns until it's fixed
+            tiny::error(projectFile.getRelativePath().string() + ":" + std::to_string(e.line) + ":" +
+                        std::to_string(e.column) + ": " + e.msg);
+        } catch (const tiny::FileError &) {
+            // A missing project file is reported by the compilation
+        }
+
+        // The compilation reports the directories it can't read too, so watch at least the root
+        std::vector<std::filesystem::path> directories{root};
+        bool listed = true;
+        try {
+            directories = selector.getDirectories();
+        } catch (const std::filesystem::filesystem_error &e) {
+            tiny::error(e.what());
+            listed = false;
+        }
+
+        std::set<int> wanted;
+        for (auto const &dir: directories) {
+            int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE |
+                                                        IN_DELETE | IN_DELETE_SELF);
+            if (wd >= 0) {
+                watches[wd] = dir; // Watching an already watched directory returns the same descriptor
+                wanted.insert(wd);
+            }
+        }
+
+        // Stop watching the directories the project no longer selects, such as newly excluded ones
+        for (auto it = watches.begin(); it != watches.end();) {
+            if (listed && wanted.count(it->first) == 0) {
+                inotify_rm_watch(fd, it->first);
+                it = watches.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+
+    SignalScope signals;
+
+    watchAll();
+    tiny::info("Watching '" + root.string() + "'");
+
+    build({}, std::chrono::steady_clock::now());
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    std::set<std::filesystem::path> changed;
+    std::chrono::steady_clock::time_point since;
+    bool rescan = false;
+
+    while (!stopping && !interrupted) {
+        // Wait for the first change for a while, then only for the debounce window to coalesce bursts
+        auto timeout = changed.empty() && !rescan ? 100 : std::int32_t(debounce.count());
+
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue; // Interrupted
+            }
+
+            auto reason = std::string(std::strerror(errno));
+            close(fd);
+            throw tiny::WatchError("Unable to wait for changes: " + reason);
+        }
+
+        if (ready == 0) {
+            if (changed.empty() && !rescan) {
+                continue;
+            }
+
+            if (rescan) {
+                watchAll();
+                rescan = false;
+            }
+
+            build(changed, since);
+            changed.clear();
+            continue;
+        }
+
+        while (true) {
+            auto len = read(fd, buffer, sizeof(buffer));
+            if (len <= 0) {
+                break;
+            }
+
+            for (char *ptr = buffer; ptr < buffer + len;) {
+                auto *event = reinterpret_cast<inotify_event *>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                if (changed.empty() && !rescan) {
+                    since = std::chrono::steady_clock::now();
+                }
+
+                if (event->mask & (IN_IGNORED | IN_DELETE_SELF)) {
+                    watches.erase(event->wd);
+                    continue;
+                }
+
+                if (event->mask & IN_ISDIR) {
+                    rescan = true; // New or removed directories might hold sources
+                    continue;
+                }
+
+                auto dir = watches.find(event->wd);
+                if (dir == watches.end() || event->len == 0) {
+                    continue;
+                }
+
+                auto path = dir->second / event->name;
+                if (path == projectFile.path) {
+                    rescan = true; // The include and exclude globs might select other directories
+                }
+
+                if (isRelevant(path)) {
+                    changed.insert(path);
+                }
+            }
+        }
+    }
+
+    close(fd);
+    tiny::info("Stopped watching '" + root.string() + "'");
+}
+
+#else
+
+void tiny::Watcher::run() {
+    throw tiny::WatchError("The watch mode is only available on Linux");
+}
+
+#endif
+
+void tiny::Watcher::stop() {
+    stopping = true;
+}
+
+void tiny::Watcher::setOnBuild(std::function<void(const tiny::WatchBuild &)> fn) {
+    onBuild = std::move(fn);
+}
+
+void tiny::Watcher::build(const std::set<std::filesystem::path> &changed,
+                          std::chrono::steady_clock::time_point since) {
+    tiny::WatchBuild watchBuild;
+
+    auto affected = changed;
+    addDependents(affected);
+    for (auto const &path: affected) {
+        cache.invalidate(path);
+    }
+
+    auto getCached = [this]() {
+        std::set<std::filesystem::path> cached;
+        cache.forEach([&cached](const std::filesystem::path &path, const tiny::ASTFile &) {
+            cached.insert(path);
+        });
+
+        return cached;
+    };
+
+    auto before = getCached();
+
+    cache.resetCounters();
+    watchBuild.result = compiler.compile();
+
+    // Whatever got into the cache during the build was compiled, plus the affected files that failed to compile
+    for (auto const &path: getCached()) {
+        if (before.count(path) == 0) {
+            watchBuild.recompiled.insert(path);
+        }
+    }
+
+    for (auto const &path: affected) {
+        if (std::filesystem::exists(path)) {
+            watchBuild.recompiled.insert(path);
+        }
+    }
+
+    watchBuild.latency = std::chrono::steady_clock::now() - since;
+
+    std::ostringstream latency;
+    latency << std::fixed << std::setprecision(1)
+            << std::chrono::duration<double, std::milli>(watchBuild.latency).count();
+    tiny::info("Rebuilt " + std::to_string(cache.getMisses()) + " files, reused " + std::to_string(cache.getHits()) +
+               " (" + latency.str() + "ms)");
+
+    if (onBuild) {
+        onBuild(watchBuild);
+    }
+}
+
+void tiny::Watcher::addDependents(std::set<std::filesystem::path> &files) {
+    // Module of every file, and the files importing every module
+    std::map<std::filesystem::path, std::string> modules;
+    std::map<std::string, std::vector<std::filesystem::path>> importers;
+
+    cache.forEach([&](const std::filesystem::path &path, const tiny::ASTFile &ast) {
+        modules[path] = ast.mod.toString();
+        for (auto const &imprt: ast.imports) {
+            importers[imprt.mod.toString()].push_back(path);
+        }
+    });
+
+    std::vector<std::filesystem::path> pending(files.begin(), files.end());
+    std::set<std::string> visited;
+
+    while (!pending.empty()) {
+        auto path = pending.back();
+        pending.pop_back();
+
+        auto mod = modules.find(path);
+        if (mod == modules.end() || !visited.insert(mod->second).second) {
+            continue;
+        }
+
+        for (auto const &importer: importers[mod->second]) {
+            if (files.insert(importer).second) {
+                pending.push_back(importer);
+            }
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef TINY_WATCHER_H
+#define TINY_WATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "compiler.h"
+#include "cache.h"
+
+namespace tiny {
+    //! The outcome of one of the builds of a Watcher
+    struct WatchBuild {
+        //! The result of the compilation
+        tiny::CompilationResult result;
+        //! The files that had to be compiled again (changed files plus the files importing them)
+        std::set<std::filesystem::path> recompiled;
+        //! Time between the last change being noticed and the end of the build
+        std::chrono::steady_clock::duration latency{};
+    };
+
+    /*!
+     * \brief Watches a project and recompiles it incrementally whenever its files change
+     *
+     * Watches a project and recompiles it incrementally whenever its files change. Bursts of filesystem events (such as
+     * an editor saving several files) are coalesced into a single build. Each build only compiles the changed files
+     * and the files that import their modules (transitively); every other file reuses its AST from memory.
+     *
+     * Uses inotify, so it's only available on Linux. On other platforms run() throws WatchError.
+     */
+    class Watcher {
+    public:
+        /*!
+         * \brief Builds a watcher for the project in the provided directory
+         * \param root The directory of the project
+         * \param debounce How long to wait for more events after a change before building
+         */
+        explicit Watcher(std::filesystem::path root,
+                         std::chrono::milliseconds debounce = std::chrono::milliseconds(10)) : root(std::move(root)),
+                                                                                              debounce(debounce),
+                                                                                              compiler(this->root) {};
+
+        Watcher(Watcher const &) = delete;
+        void operator=(Watcher const &) = delete;
+
+        /*!
+         * \brief Builds the project, then rebuilds it on every change until stop() is called or the process is
+         * interrupted (SIGINT or SIGTERM)
+         */
+        void run();
+
+        //! Makes run() return. Can be called from any thread
+        void stop();
+
+        /*!
+         * \brief Sets a function to be called after every build, including the first one
+         * \param fn The function
+         */
+        void setOnBuild(std::function<void(const tiny::WatchBuild &)> fn);
+
+    private:
+        /*!
+         * \brief Compiles the changed files, their dependents and every file missing from the cache
+         * \param changed The files that changed since the last build
+         * \param since When the first of the changes was noticed
+         */
+        void build(const std::set<std::filesystem::path> &changed, std::chrono::steady_clock::time_point since);
+
+        /*!
+         * \brief Adds the files that import the modules of the provided files, transitively
+         * \param files The files. Gets extended with their dependents
+         */
+        void addDependents(std::set<std::filesystem::path> &files);
+
+        //! Directory of the project
+        std::filesystem::path root;
+        //! How long to wait for more events after a change
+        std::chrono::milliseconds debounce;
+        //! The ASTs of the unchanged files
+        tiny::ASTCache cache;
+        //! The compiler used for every build
+        tiny::Compiler compiler;
+        //! Called after every build
+        std::function<void(const tiny::WatchBuild &)> onBuild;
+        //! Set to make run() return
+        std::atomic<bool> stopping{false};
+    };
+}
+
+#endif //TINY_WATCHER_H
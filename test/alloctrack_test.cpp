@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+
+#include "alloctrack.h"
+
+TEST(AllocationTracker, PhaseScopesNest) {
+    ASSERT_EQ(tiny::AllocationTracker::getPhase(), tiny::CompilationStep::None);
+
+    {
+        tiny::PhaseScope lexer(tiny::CompilationStep::Lexer);
+        ASSERT_EQ(tiny::AllocationTracker::getPhase(), tiny::CompilationStep::Lexer);
+
+        {
+            tiny::PhaseScope parser(tiny::CompilationStep::Parser);
+            ASSERT_EQ(tiny::AllocationTracker::getPhase(), tiny::CompilationStep::Parser);
+        }
+
+        ASSERT_EQ(tiny::AllocationTracker::getPhase(), tiny::CompilationStep::Lexer);
+    }
+
+    ASSERT_EQ(tiny::AllocationTracker::getPhase(), tiny::CompilationStep::None);
+}
+
+TEST(AllocationTracker, AttributesToPhase) {
+    tiny::AllocationTracker::reset();
+
+    {
+        tiny::PhaseScope scope(tiny::CompilationStep::Serialization);
+        auto buffer = std::make_unique<char[]>(1000);
+        buffer[0] = 'a';
+    }
+
+    auto stats = tiny::AllocationTracker::getStats(tiny::CompilationStep::Serialization);
+    if (!tiny::AllocationTracker::isBuiltIn()) {
+        ASSERT_EQ(stats.allocations, 0);
+        return;
+    }
+
+    ASSERT_EQ(stats.allocations, 1);
+    ASSERT_EQ(stats.deallocations, 1);
+    ASSERT_GE(stats.bytes, 1000);
+    ASSERT_EQ(tiny::AllocationTracker::getStats(tiny::CompilationStep::Parser).allocations, 0);
+}
+
+TEST(AllocationTracker, CountersOfACompilation) {
+    tiny::AllocationCounters mine;
+    tiny::AllocationCounters other;
+
+    {
+        tiny::AllocationScope scope(&mine);
+        ASSERT_EQ(tiny::AllocationTracker::getCounters(), &mine);
+
+        tiny::PhaseScope phase(tiny::CompilationStep::Lexer);
+        auto buffer = std::make_unique<char[]>(100);
+        buffer[0] = 'a';
+    }
+
+    ASSERT_EQ(tiny::AllocationTracker::getCounters(), nullptr);
+    ASSERT_EQ(other.getStats(tiny::CompilationStep::Lexer).allocations, 0);
+
+    if (!tiny::AllocationTracker::isBuiltIn()) {
+        ASSERT_EQ(mine.getStats(tiny::CompilationStep::Lexer).allocations, 0);
+        return;
+    }
+
+    // Also counted in the totals of the process
+    ASSERT_EQ(mine.getStats(tiny::CompilationStep::Lexer).allocations, 1);
+    ASSERT_EQ(mine.getStats(tiny::CompilationStep::Lexer).deallocations, 1);
+    ASSERT_GE(tiny::AllocationTracker::getStats(tiny::CompilationStep::Lexer).allocations, 1);
+}
@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+#include "batch.h"
+#include "errors.h"
+
+TEST(Batch, ReadsManifest) {
+    auto root = std::filesystem::temp_directory_path() / "tiny_manifest_test";
+    std::filesystem::create_directories(root);
+
+    std::ofstream(root / "projects.txt") << "# Packages\n\npkg/a\n  pkg/b  \n/abs/c\n";
+
+    auto roots = tiny::readManifest(root / "projects.txt");
+    std::vector<std::filesystem::path> expect{root / "pkg" / "a", root / "pkg" / "b", "/abs/c"};
+    ASSERT_EQ(roots, expect);
+
+    ASSERT_THROW(tiny::readManifest(root / "missing.txt"), tiny::FileError);
+    std::filesystem::remove_all(root);
+}
+
+TEST(Batch, CompilesProjects) {
+    auto root = std::filesystem::temp_directory_path() / "tiny_batch_test";
+    std::filesystem::remove_all(root);
+
+    for (auto name: {"a", "b", "broken"}) {
+        std::filesystem::create_directories(root / name);
+        std::ofstream(root / name / "tiny.toml") << "";
+    }
+
+    std::ofstream(root / "a" / "main.ty") << "module a\n";
+    std::ofstream(root / "b" / "main.ty") << "module b\n\nfunc f() {\n}\n";
+    std::ofstream(root / "broken" / "main.ty") << "module broken\n\nfunc ( {\n";
+
+    auto results = tiny::compileProjects({root / "a", root / "missing", root / "b", root / "broken"});
+
+    ASSERT_EQ(results.size(), 4);
+    ASSERT_EQ(results[0].result.status, tiny::CompilationStatus::Ok);
+    ASSERT_EQ(results[1].result.status, tiny::CompilationStatus::Error);
+    ASSERT_EQ(results[2].result.status, tiny::CompilationStatus::Ok);
+    ASSERT_EQ(results[3].result.status, tiny::CompilationStatus::Error);
+    ASSERT_EQ(results[3].result.error.step, tiny::CompilationStep::Parser);
+    ASSERT_EQ(results[2].root, root / "b");
+
+    std::filesystem::remove_all(root);
+}
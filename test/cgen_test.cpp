@@ -0,0 +1,234 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <optional>
+
+#include "compiler.h"
+#include "errors.h"
+#include "cgen.h"
+#include "bytecode.h"
+#include "vm.h"
+#include "interpreter.h"
+
+namespace {
+    //! Compiles a program and translates it into C
+    std::string generate(const std::string &source) {
+        tiny::Compiler compiler;
+        auto result = compiler.compile({{"main.ty", "module main\n\n" + source}});
+        EXPECT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+        return tiny::CGenerator::generate(result.files);
+    }
+
+    bool contains(const std::string &code, const std::string &fragment) {
+        return code.find(fragment) != std::string::npos;
+    }
+
+    //! Runs a command and gets its output, or nullopt if it fails
+    std::optional<std::string> output(const std::string &command) {
+        auto *pipe = ::popen(command.c_str(), "r");
+        if (!pipe) {
+            return std::nullopt;
+        }
+
+        std::string out;
+        char buffer[256];
+        while (auto n = std::fread(buffer, 1, sizeof(buffer), pipe)) {
+            out.append(buffer, n);
+        }
+
+        return ::pclose(pipe) == 0 ? std::optional(out) : std::nullopt;
+    }
+}
+
+TEST(CGen, Types) {
+    auto code = generate("struct Point {\n"
+                         "    int32 x,\n"
+                         "    float64 y\n"
+                         "}\n"
+                         "\n"
+                         "struct Labeled {\n"
+                         "    Point,\n"
+                         "    uint8 tag\n"
+                         "}\n"
+                         "\n"
+                         "func move(*Labeled l, int64 dx) {\n"
+                         "    l.x += dx\n"
+                         "    l.y = l.y * 0.5\n"
+                         "}\n");
+
+    // Builtin types come from <stdint.h>, and structs are declared before the structs composed of them
+    ASSERT_TRUE(contains(code, "#include <stdint.h>"));
+    ASSERT_TRUE(contains(code, "struct tiny_Point {\n    int32_t x;\n    double y;\n};"));
+    ASSERT_TRUE(contains(code, "struct tiny_Labeled {\n    tiny_Point Point;\n    uint8_t tag;\n};"));
+    ASSERT_LT(code.find("struct tiny_Point {"), code.find("struct tiny_Labeled {"));
+
+    // Fields of compositions are reached through them
+    ASSERT_TRUE(contains(code, "static void tiny_main_move(tiny_Labeled *l, int64_t dx) {"));
+    ASSERT_TRUE(contains(code, "l->Point.x += dx;"));
+    ASSERT_TRUE(contains(code, "l->Point.y = l->Point.y * 0.5;"));
+
+    // No main, no entry point
+    ASSERT_FALSE(contains(code, "int main("));
+}
+
+TEST(CGen, Loops) {
+    auto code = generate("func sum(int n) {\n"
+                         "    s := 0\n"
+                         "    for i := 0..n {\n"
+                         "        s += i\n"
+                         "    }\n"
+                         "    for i := n..0 -> -2 {\n"
+                         "        s -= i\n"
+                         "    }\n"
+                         "    k := 3\n"
+                         "    for j := 0..n -> k {\n"
+                         "        s += j\n"
+                         "    }\n"
+                         "    for s > 100 {\n"
+                         "        s = s / 2\n"
+                         "    }\n"
+                         "    return s\n"
+                         "}\n");
+
+    // Ranges compute their bounds once, and only check the sign of steps that aren't constant
+    ASSERT_TRUE(contains(code, "for (int64_t i = 0, i_end = n; i < i_end; i++) {"));
+    ASSERT_TRUE(contains(code, "for (int64_t i_1 = n; i_1 > 0; i_1 -= 2) {"));
+    ASSERT_TRUE(contains(code, "for (int64_t j = 0, j_end = n, j_step = k; "
+                               "j_step > 0 ? j < j_end : j > j_end; j += j_step) {"));
+    ASSERT_TRUE(contains(code, "while (s > 100) {"));
+    ASSERT_TRUE(contains(code, "static int64_t tiny_main_sum(int32_t n) {"));
+}
+
+TEST(CGen, Errors) {
+    EXPECT_THROW(generate("func main(int x) {\n    y := 1\n    y = 2.5\n    return y\n}\n"), tiny::CodegenError);
+    EXPECT_THROW(generate("func main(int x) {\n    if x {\n        return 1\n    }\n    return 0\n}\n"),
+                 tiny::CodegenError);
+
+    try {
+        generate("func main(int x) {\n    if x > 1 {\n        return 1\n    }\n}\n");
+        FAIL();
+    } catch (const tiny::CodegenError &e) {
+        ASSERT_TRUE(contains(e.msg, "can end without returning a value"));
+    }
+
+    try {
+        generate("struct A {\n    B,\n    int32 x\n}\n\nstruct B {\n    A,\n    int32 y\n}\n");
+        FAIL();
+    } catch (const tiny::CodegenError &e) {
+        ASSERT_TRUE(contains(e.msg, "contains itself"));
+    }
+}
+
+TEST(CGen, Native) {
+    if (!output("cc --version > /dev/null 2>&1")) {
+        GTEST_SKIP() << "No C compiler";
+    }
+
+    std::string source = "func collatz(int64 n) {\n"
+                         "    steps := 0\n"
+                         "    for n != 1 {\n"
+                         "        if n / 2 * 2 == n {\n"
+                         "            n = n / 2\n"
+                         "        } else {\n"
+                         "            n = 3 * n + 1\n"
+                         "        }\n"
+                         "        steps += 1\n"
+                         "    }\n"
+                         "    return steps\n"
+                         "}\n"
+                         "\n"
+                         "func main(int limit) {\n"
+                         "    total := 0\n"
+                         "    for i := 1..limit {\n"
+                         "        total += collatz(i)\n"
+                         "    }\n"
+                         "    return total + 2 ** 3\n"
+                         "}\n";
+
+    auto root = std::filesystem::temp_directory_path() / "tiny_cgen_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    std::ofstream(root / "main.c") << generate(source);
+    tiny::CGenerator::compileNative(root / "main.c", root / "main");
+
+    auto native = output((root / "main").string() + " 1000");
+    ASSERT_TRUE(native);
+
+    // Same result as the VM
+    tiny::Compiler compiler;
+    auto result = compiler.compile({{"main.ty", "module main\n\n" + source}});
+    auto program = tiny::BytecodeCompiler::compile(result.files);
+    auto expected = tiny::VM(program).call("main", {tiny::RuntimeValue::fromInt(1000)});
+    ASSERT_EQ(*native, expected.front().toString() + "\n");
+
+    // Wrong arguments are reported, not run
+    ASSERT_FALSE(output((root / "main").string() + " abc 2> /dev/null"));
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(CGen, Widths) {
+    if (!output("cc --version > /dev/null 2>&1")) {
+        GTEST_SKIP() << "No C compiler";
+    }
+
+    auto root = std::filesystem::temp_directory_path() / "tiny_cgen_widths_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    // Narrower integers compute with 64 bits, and 64 bits wrap around, in the executable as in both tiers
+    auto same = [&](const std::string &source, std::int64_t arg) {
+        std::ofstream(root / "main.c") << generate(source);
+        tiny::CGenerator::compileNative(root / "main.c", root / "main");
+
+        auto native = output((root / "main").string() + " " + std::to_string(arg));
+        ASSERT_TRUE(native);
+
+        tiny::Compiler compiler;
+        auto result = compiler.compile({{"main.ty", "module main\n\n" + source}});
+        auto args = std::vector<tiny::RuntimeValue>{tiny::RuntimeValue::fromInt(arg)};
+
+        auto program = tiny::BytecodeCompiler::compile(result.files);
+        auto vm = tiny::VM(program).call("main", args);
+        auto closures = tiny::ClosureCompiler::compile(result.files).call("main", args);
+        ASSERT_EQ(vm, closures);
+        ASSERT_EQ(*native, vm.front().toString() + "\n") << source;
+    };
+
+    same("func main(int32 a) {\n    x := a * a\n    return x\n}\n", 100000);
+    same("func square(int16 a) {\n    return a * a\n}\n\nfunc main(int16 a) {\n    return square(a) - a * a\n}\n",
+         30000);
+    same("func main(int64 a) {\n    return a * a * a * a\n}\n", 100000);
+    same("func main(int32 a) {\n    uint32 b := 1\n    return a < b\n}\n", -1);
+
+    // The returns disagree, so the inferred result is wide enough for both
+    same("func f(int n) {\n    if n < 1 {\n        return n\n    }\n    return f(n - 1) + 3000000000\n}\n\n"
+         "func main(int n) {\n    return f(n)\n}\n", 1);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(CGen, Modules) {
+    tiny::Compiler compiler;
+    auto result = compiler.compile({{"main.ty", "module main\n\nimport (\n    a\n)\n\n"
+                                                "func main(int n) {\n    return helper(n) + a.helper(n)\n}\n\n"
+                                                "func helper(int n) {\n    return n\n}\n"},
+                                    {"a.ty", "module a\n\nfunc helper(int n) {\n    return n * 10\n}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+    // Functions are named by their module, so modules can declare the same names
+    auto code = tiny::CGenerator::generate(result.files);
+    ASSERT_TRUE(contains(code, "static int32_t tiny_main_helper(int32_t n) {"));
+    ASSERT_TRUE(contains(code, "static int64_t tiny_a_helper(int32_t n) {"));
+    ASSERT_TRUE(contains(code, "tiny_main_helper(n)) + tiny_a_helper(n);"));
+    ASSERT_TRUE(contains(code, "tiny_main_main(arg0)"));
+
+    // Only imported modules can be called
+    result = compiler.compile({{"main.ty", "module main\n\nfunc main(int n) {\n    return a.helper(n)\n}\n"},
+                               {"a.ty", "module a\n\nfunc helper(int n) {\n    return n\n}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_THROW(tiny::CGenerator::generate(result.files), tiny::CodegenError);
+}
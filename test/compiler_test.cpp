@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+#include "compiler.h"
+
+TEST(Compiler, CompilesInMemorySources) {
+    tiny::Compiler compiler;
+
+    std::vector<tiny::Source> sources{
+            {"math.ty", "module math\n\nfunc add(int a, int b) {\n    return a + b\n}\n"},
+            {"main.ty", "module main\n\nfunc main() {\n    x := 1 + 2\n    return x\n}\n"},
+    };
+
+    auto result = compiler.compile(sources);
+
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_TRUE(result.diagnostics.empty());
+    ASSERT_EQ(result.files.size(), 2);
+
+    ASSERT_EQ(result.files[0].mod.toString(), "math");
+    ASSERT_EQ(result.files[0].file.path, "math.ty");
+    ASSERT_EQ(result.files[0].statements.size(), 1);
+    ASSERT_EQ(result.files[1].mod.toString(), "main");
+}
+
+TEST(Compiler, ReportsDiagnostics) {
+    tiny::Compiler compiler;
+
+    std::vector<tiny::Source> sources{
+            {"ok.ty", "module ok\n"},
+            {"bad.ty", "module bad\n\nfunc main() {\n    x := (1 +\n}\n"},
+            {"never.ty", "module never\n"},
+    };
+
+    auto result = compiler.compile(sources);
+
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Error);
+    ASSERT_EQ(result.files.size(), 1);
+    ASSERT_EQ(result.diagnostics.size(), 1);
+
+    auto const &diagnostic = result.diagnostics[0];
+    ASSERT_EQ(diagnostic.step, tiny::CompilationStep::Parser);
+    ASSERT_EQ(diagnostic.file, "bad.ty");
+    ASSERT_GE(diagnostic.line, 4);
+    ASSERT_FALSE(diagnostic.msg.empty());
+}
+
+TEST(Compiler, UsesGivenProjectSettings) {
+    auto root = std::filesystem::temp_directory_path() / "tiny_project_settings_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    // Only read when no settings are given
+    std::ofstream(root / "tiny.toml") << "[build\n";
+    std::ofstream(root / "main.ty") << "module main\n";
+
+    tiny::Compiler compiler(root);
+    ASSERT_EQ(compiler.compile().status, tiny::CompilationStatus::Error);
+
+    compiler.setProject(tiny::ProjectSettings());
+    ASSERT_EQ(compiler.compile().status, tiny::CompilationStatus::Ok);
+
+    compiler.setProject(std::nullopt);
+    ASSERT_EQ(compiler.compile().status, tiny::CompilationStatus::Error);
+
+    // Given settings aren't checked by ProjectSettings::parse, so a bad glob is reported by the compilation
+    tiny::ProjectSettings badGlob;
+    badGlob.include = {"[z-a]"};
+    compiler.setProject(badGlob);
+
+    auto result = compiler.compile();
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Error);
+    ASSERT_EQ(result.diagnostics.size(), 1);
+    ASSERT_EQ(result.diagnostics[0].step, tiny::CompilationStep::FileSelection);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(Compiler, KeepsASTs) {
+    auto root = std::filesystem::temp_directory_path() / "tiny_keep_asts_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    std::ofstream(root / "tiny.toml") << "";
+    std::ofstream(root / "main.ty") << "module main\n\nfunc main() {\n    return 1\n}\n";
+
+    tiny::Compiler compiler(root);
+    compiler.setProject(tiny::ProjectSettings());
+
+    auto result = compiler.compile();
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_TRUE(result.files.empty());
+
+    compiler.setKeepASTs(true);
+
+    result = compiler.compile();
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_EQ(result.files.size(), 1);
+    ASSERT_EQ(result.files[0].mod.toString(), "main");
+    ASSERT_EQ(result.files[0].statements.size(), 1);
+
+    std::filesystem::remove_all(root);
+}
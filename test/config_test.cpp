@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 
 #include "config.h"
+#include "errors.h"
 
 TEST(Configuration, GetSetting) {
     auto config = tiny::getSetting(tiny::Option::PrintVersion);
@@ -21,3 +22,74 @@ TEST(Configuration, SetSetting) {
     ASSERT_EQ(config.isEnabled, true);
     ASSERT_EQ(std::get<std::int32_t>(config.param), std::int32_t(tiny::LogLevel::Debug));
 }
+
+TEST(Configuration, ProjectSettingsYieldToCommandLine) {
+    char arg0[] = "tiny";
+    char arg1[] = "--jobs";
+    char arg2[] = "2";
+    char *argv[] = {arg0, arg1, arg2};
+    tiny::Configuration::get().parseArguments(3, argv);
+
+    tiny::ProjectSettings project;
+    project.jobs = 8;
+    project.outputASTJSON = true;
+    tiny::Configuration::get().applyProject(project);
+
+    ASSERT_TRUE(tiny::Configuration::get().isSetByCommandLine(tiny::Option::Jobs));
+    ASSERT_EQ(std::get<std::int32_t>(tiny::getSetting(tiny::Option::Jobs).param), 2);
+    ASSERT_TRUE(tiny::getSetting(tiny::Option::OutputASTJSON).isEnabled);
+
+    tiny::Configuration::get().setSetting(tiny::Setting{tiny::Option::Jobs, false, std::int32_t(0)});
+    tiny::Configuration::get().setSetting(tiny::Setting{tiny::Option::OutputASTJSON, false});
+}
+
+TEST(Configuration, TypedValues) {
+    auto &config = tiny::Configuration::get();
+
+    // Defaults
+    ASSERT_FALSE(config.get<tiny::Option::Profile>());
+    ASSERT_FALSE(config.get<tiny::Option::TraceOut>());
+    ASSERT_EQ(config.get<tiny::Option::Jobs>(), 0);
+
+    config.setSetting(tiny::Setting{tiny::Option::TraceOut, true, "trace.json"});
+    config.setSetting(tiny::Setting{tiny::Option::Jobs, true, std::int32_t(6)});
+    config.setSetting(tiny::Setting{tiny::Option::Log, true, std::int32_t(tiny::LogLevel::Error)});
+    config.setSetting(tiny::Setting{tiny::Option::BuildMany, true, std::vector<tiny::String>{"a", "b"}});
+
+    static_assert(std::is_same_v<std::decay_t<decltype(tiny::getSetting<tiny::Option::Jobs>())>, std::int32_t>);
+    ASSERT_EQ(tiny::getSetting<tiny::Option::TraceOut>(), "trace.json");
+    ASSERT_EQ(tiny::getSetting<tiny::Option::Jobs>(), 6);
+    ASSERT_EQ(tiny::getSetting<tiny::Option::Log>(), tiny::LogLevel::Error);
+    ASSERT_EQ(tiny::getSetting<tiny::Option::BuildMany>(), (std::vector<std::string>{"a", "b"}));
+
+    config.setSetting(tiny::Setting{tiny::Option::TraceOut, false});
+    config.setSetting(tiny::Setting{tiny::Option::Jobs, false, std::int32_t(0)});
+    config.setSetting(tiny::Setting{tiny::Option::Log, true, std::int32_t(tiny::LogLevel::Info)});
+    config.setSetting(tiny::Setting{tiny::Option::BuildMany, false, std::vector<tiny::String>{}});
+
+    ASSERT_FALSE(tiny::getSetting<tiny::Option::TraceOut>());
+    ASSERT_EQ(tiny::getSetting<tiny::Option::Jobs>(), 0);
+    ASSERT_FALSE(config.isFrozen());
+}
+
+TEST(Configuration, SettingsAfterRun) {
+    char arg0[] = "tiny";
+    char arg1[] = "run";
+    char arg2[] = "--tier";
+    char arg3[] = "closure";
+    char arg4[] = "main";
+    char arg5[] = "100000";
+    char *argv[] = {arg0, arg1, arg2, arg3, arg4, arg5};
+    tiny::Configuration::get().parseArguments(6, argv);
+
+    // The function and its arguments can follow the settings
+    ASSERT_EQ(tiny::getSetting<tiny::Option::Tier>(), "closure");
+    ASSERT_EQ(tiny::getSetting<tiny::Option::Run>(), (std::vector<std::string>{"main", "100000"}));
+
+    tiny::Configuration::get().setSetting(tiny::Setting{tiny::Option::Run, false, std::vector<tiny::String>{}});
+    tiny::Configuration::get().setSetting(tiny::Setting{tiny::Option::Tier, false});
+
+    // Without 'run' they're still invalid
+    char *invalid[] = {arg0, arg4};
+    ASSERT_THROW(tiny::Configuration::get().parseArguments(2, invalid), tiny::CLIError);
+}
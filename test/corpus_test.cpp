@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+#include "corpus.h"
+#include "bytecode.h"
+
+TEST(Corpus, Deterministic) {
+    tiny::CorpusOptions options;
+    options.files = 4;
+    options.fileSize = 2048;
+
+    auto first = tiny::CorpusGenerator(options).generate();
+    auto second = tiny::CorpusGenerator(options).generate();
+
+    ASSERT_EQ(first.size(), 4);
+    for (std::size_t i = 0; i < first.size(); i++) {
+        ASSERT_EQ(first[i].name, second[i].name);
+        ASSERT_EQ(first[i].content, second[i].content);
+        ASSERT_GE(first[i].content.size(), options.fileSize);
+    }
+
+    // A bigger corpus starts with the same files
+    options.files = 8;
+    ASSERT_EQ(tiny::CorpusGenerator(options).generateFile(3), first[3].content);
+
+    options.seed = 2;
+    ASSERT_NE(tiny::CorpusGenerator(options).generateFile(3), first[3].content);
+}
+
+TEST(Corpus, Compiles) {
+    for (std::uint64_t seed = 1; seed <= 8; seed++) {
+        tiny::CorpusOptions options;
+        options.files = 8;
+        options.fileSize = 4096;
+        options.depth = std::uint32_t(seed % 5);
+        options.seed = seed;
+
+        tiny::Compiler compiler;
+        auto result = compiler.compile(tiny::CorpusGenerator(options).generate());
+
+        for (auto const &d: result.diagnostics) {
+            std::cout << d.toString() << std::endl;
+        }
+
+        ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+        ASSERT_EQ(result.files.size(), options.files);
+    }
+}
+
+TEST(Corpus, CompilesToBytecode) {
+    tiny::CorpusOptions options;
+    options.files = 8;
+    options.fileSize = 4096;
+
+    tiny::Compiler compiler;
+    auto result = compiler.compile(tiny::CorpusGenerator(options).generate());
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+    // Calls match the arity of their callee, and no two modules define the same function
+    ASSERT_NO_THROW(tiny::BytecodeCompiler::compile(result.files));
+
+    auto first = tiny::CorpusGenerator(options).generateFile(0);
+    auto second = tiny::CorpusGenerator(options).generateFile(1);
+    ASSERT_NE(first.find("func f0_"), std::string::npos);
+    ASSERT_EQ(second.find("func f0_"), std::string::npos);
+}
+
+TEST(Corpus, Write) {
+    auto root = std::filesystem::temp_directory_path() / "tiny_corpus_test";
+    std::filesystem::remove_all(root);
+
+    tiny::CorpusOptions options;
+    options.files = 6;
+    options.fileSize = 1024;
+    tiny::CorpusGenerator generator(options);
+
+    auto bytes = generator.write(root);
+
+    std::uint64_t expected = 0;
+    for (std::uint32_t i = 0; i < options.files; i++) {
+        ASSERT_EQ(std::filesystem::file_size(root / tiny::CorpusGenerator::getFileName(i)),
+                  generator.generateFile(i).size());
+        expected += generator.generateFile(i).size();
+    }
+
+    ASSERT_EQ(bytes, expected);
+    ASSERT_TRUE(std::filesystem::exists(root / "tiny.toml"));
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(Corpus, ScalingBenchmark) {
+    // Goes up to 512 KB of source by default. Set TINY_CORPUS_BYTES to go further (up to 1 GB)
+    std::uint64_t maxBytes = 512 * 1024;
+    if (auto const *env = std::getenv("TINY_CORPUS_BYTES")) {
+        maxBytes = std::strtoull(env, nullptr, 10);
+    }
+
+    for (std::uint64_t bytes = 1024; bytes <= maxBytes; bytes *= 8) {
+        // Files of up to 64 KB, as many as needed
+        tiny::CorpusOptions options;
+        options.fileSize = std::min<std::uint64_t>(bytes, 64 * 1024);
+        options.files = std::uint32_t(bytes / options.fileSize);
+
+        auto sources = tiny::CorpusGenerator(options).generate();
+
+        std::uint64_t total = 0;
+        for (auto const &s: sources) {
+            total += s.content.size();
+        }
+
+        tiny::Compiler compiler;
+        auto start = std::chrono::steady_clock::now();
+        auto result = compiler.compile(sources);
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+        std::cout << "Corpus benchmark -> Compiled " << options.files << " files (" << total << " bytes) in "
+                  << std::int64_t(elapsed * 1000) << "ms (" << std::int64_t(double(total) / elapsed / 1024)
+                  << " KB/second)" << std::endl;
+    }
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "diagnostics.h"
+#include "compiler.h"
+
+namespace {
+    //! An error at the provided codepoint range of a file
+    tiny::ParseError errorAt(const std::string &file, std::uint64_t start, std::uint64_t end) {
+        return tiny::ParseError(tiny::DiagnosticId::InvalidLiteral, {},
+                                tiny::Metadata(tiny::File{tiny::FileType::Source, file}, start, end));
+    }
+}
+
+TEST(DiagnosticEngine, Deduplicates) {
+    tiny::DiagnosticEngine engine;
+    std::string source = "module a\n\nx := 1\n";
+
+    for (int i = 0; i < 1000; i++) {
+        engine.report(tiny::CompilationStep::Parser, errorAt("a.ty", 15, 16), source);
+    }
+
+    engine.report({tiny::CompilationStep::Lexer, "a.ty", 0, 0, "Rejected by a pipe"});
+    engine.report({tiny::CompilationStep::Lexer, "a.ty", 0, 0, "Rejected by a pipe"});
+
+    ASSERT_EQ(engine.getCount(), 2);
+    ASSERT_EQ(engine.getSuppressed(), 1000);
+    ASSERT_EQ(engine.getDuplicates(), 1000);
+
+    auto diagnostics = engine.finish(false);
+    ASSERT_EQ(diagnostics.size(), 2);
+
+    // Rendered only now, with the position and context
+    auto const &rendered = diagnostics[1];
+    ASSERT_EQ(rendered.msg, "Invalid literal");
+    ASSERT_EQ(rendered.line, 3);
+    ASSERT_EQ(rendered.column, 6);
+    ASSERT_EQ(rendered.context, "x := 1");
+    ASSERT_EQ(rendered.begin, 15);
+    ASSERT_EQ(rendered.end, 16);
+}
+
+TEST(DiagnosticEngine, ErrorsRenderLazily) {
+    // Throwing only keeps the id and arguments
+    auto error = tiny::LexError(tiny::DiagnosticId::UnknownSymbol, {"$"}, tiny::Metadata());
+    ASSERT_TRUE(error.msg.empty());
+
+    ASSERT_EQ(error.getMessage(), "Unknown symbol '$'");
+    ASSERT_STREQ(error.what(), "Unknown symbol '$'");
+
+    // Errors made out of a message are already rendered
+    ASSERT_EQ(tiny::LexError("Rejected", tiny::Metadata()).msg, "Rejected");
+}
+
+TEST(DiagnosticEngine, Limits) {
+    std::string source(100, 'x');
+
+    tiny::DiagnosticEngine engine(7, 3);
+    for (std::uint64_t i = 0; i < 10; i++) {
+        engine.report(tiny::CompilationStep::Parser, errorAt("b.ty", i, i + 1), source);
+        engine.report(tiny::CompilationStep::Parser, errorAt("a.ty", i, i + 1), source);
+        engine.report(tiny::CompilationStep::Parser, errorAt("c.ty", i, i + 1), source);
+    }
+
+    // Three per file, and then only the first seven of them sorted by file and position
+    auto diagnostics = engine.finish(false);
+    ASSERT_EQ(diagnostics.size(), 7);
+    ASSERT_EQ(engine.getSuppressed(), 30 - 7);
+    ASSERT_EQ(engine.getDuplicates(), 0);
+    ASSERT_EQ(diagnostics[0].file, "a.ty");
+    ASSERT_EQ(diagnostics[2].file, "a.ty");
+    ASSERT_EQ(diagnostics[2].begin, 2);
+    ASSERT_EQ(diagnostics[6].file, "c.ty");
+
+    tiny::DiagnosticEngine unlimited(0);
+    for (std::uint64_t i = 0; i < 50; i++) {
+        unlimited.report(tiny::CompilationStep::Parser, errorAt("a.ty", i, i + 1), source);
+    }
+
+    ASSERT_EQ(unlimited.finish(false).size(), 50);
+}
+
+TEST(DiagnosticEngine, ReportsEveryFile) {
+    tiny::Compiler compiler;
+
+    std::vector<tiny::Source> sources{
+            {"a.ty", "module a\n\nx := 01\n"},
+            {"b.ty", "module b\n"},
+            {"c.ty", "module c\n\nx := 01\n"},
+    };
+
+    auto result = compiler.compile(sources);
+
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Error);
+    ASSERT_TRUE(result.files.empty());
+    ASSERT_EQ(result.diagnostics.size(), 2);
+    ASSERT_EQ(result.diagnostics[0].file, "a.ty");
+    ASSERT_EQ(result.diagnostics[1].file, "c.ty");
+    ASSERT_EQ(result.diagnostics[1].line, 3);
+}
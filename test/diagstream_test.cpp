@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include "diagstream.h"
+#include "errors.h"
+
+namespace {
+    //! Reads everything written to the read end of a pipe
+    std::string drain(int fd) {
+        std::string data;
+        char buffer[4096];
+        ssize_t n;
+        while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+            data.append(buffer, std::size_t(n));
+        }
+
+        return data;
+    }
+}
+
+TEST(DiagnosticStream, RendersMessages) {
+    ASSERT_EQ(tiny::renderMessage(tiny::DiagnosticId::UnexpectedToken, {"'('", "'{'"}),
+              "Unexpected token: expected '(' but got '{'");
+    ASSERT_EQ(tiny::renderMessage(tiny::DiagnosticId::UnknownSymbol, {"$"}), "Unknown symbol '$'");
+    ASSERT_EQ(tiny::renderMessage(tiny::DiagnosticId::Generic, {"Anything"}), "Anything");
+    ASSERT_EQ(tiny::renderMessage(tiny::DiagnosticId::UnknownSymbol, {}), "Unknown symbol ''");
+}
+
+TEST(DiagnosticStream, RoundTrip) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    tiny::CompilationResult first;
+    first.status = tiny::CompilationStatus::Error;
+    first.diagnostics.push_back({tiny::CompilationStep::Parser, "a.ty", 3, 7, "Invalid literal", "", tiny::Severity::Error,
+                                 tiny::DiagnosticId::InvalidLiteral, {}, 20, 24});
+    first.diagnostics.push_back({tiny::CompilationStep::Lexer, "a.ty", 1, 1, "Unknown symbol '$'", "",
+                                 tiny::Severity::Warning, tiny::DiagnosticId::UnknownSymbol, {"$"}, 0, 1});
+    first.diagnostics.push_back({tiny::CompilationStep::FileSelection, "", 0, 0, "No metadata file"});
+
+    tiny::CompilationResult second;
+
+    {
+        tiny::DiagnosticWriter writer(fds[1]);
+        writer.write(first);
+        writer.write(second, "other");
+    }
+
+    ::close(fds[1]);
+    auto data = drain(fds[0]);
+    ::close(fds[0]);
+
+    auto stream = tiny::readDiagnostics(data);
+    ASSERT_TRUE(stream.complete);
+    ASSERT_EQ(stream.builds.size(), 2);
+    ASSERT_EQ(stream.builds[0].status, tiny::CompilationStatus::Error);
+    ASSERT_EQ(stream.builds[1].status, tiny::CompilationStatus::Ok);
+    ASSERT_TRUE(stream.builds[1].diagnostics.empty());
+
+    auto const &diagnostics = stream.builds[0].diagnostics;
+    ASSERT_EQ(diagnostics.size(), 3);
+
+    ASSERT_EQ(diagnostics[0].step, tiny::CompilationStep::Parser);
+    ASSERT_EQ(diagnostics[0].file, "a.ty");
+    ASSERT_EQ(diagnostics[0].line, 3);
+    ASSERT_EQ(diagnostics[0].column, 7);
+    ASSERT_EQ(diagnostics[0].begin, 20);
+    ASSERT_EQ(diagnostics[0].end, 24);
+    ASSERT_EQ(diagnostics[0].id, tiny::DiagnosticId::InvalidLiteral);
+    ASSERT_EQ(diagnostics[0].msg, "Invalid literal");
+
+    ASSERT_EQ(diagnostics[1].severity, tiny::Severity::Warning);
+    ASSERT_EQ(diagnostics[1].args, std::vector<std::string>{"$"});
+    ASSERT_EQ(diagnostics[1].msg, "Unknown symbol '$'");
+
+    ASSERT_TRUE(diagnostics[2].file.empty());
+    ASSERT_EQ(diagnostics[2].id, tiny::DiagnosticId::Generic);
+    ASSERT_EQ(diagnostics[2].msg, "No metadata file");
+
+    // The file record is only sent once
+    ASSERT_EQ(data.find("a.ty"), data.rfind("a.ty"));
+
+    // A truncated record is left for later, but garbage is rejected
+    auto partial = tiny::readDiagnostics(data.substr(0, data.size() - 3));
+    ASSERT_FALSE(partial.complete);
+    ASSERT_THROW(tiny::readDiagnostics("not a stream"), tiny::DiagnosticStreamError);
+}
+
+TEST(DiagnosticStream, SurvivesClosedReader) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ::close(fds[0]);
+
+    // Writing to a pipe without a reader raises SIGPIPE, which must not end the process
+    tiny::CompilationResult result;
+    result.diagnostics.push_back({tiny::CompilationStep::Parser, "a.ty", 1, 1, "Invalid literal"});
+
+    tiny::DiagnosticWriter writer(fds[1]);
+    writer.write(result);
+    writer.write(result);
+
+    ::close(fds[1]);
+}
+
+TEST(DiagnosticStream, CompilerDiagnosticsCarryIds) {
+    tiny::Compiler compiler;
+
+    std::vector<tiny::Source> sources{
+            {"bad.ty", "module bad\n\n// \xC3\xA9\nx := 01\n"},
+    };
+
+    auto result = compiler.compile(sources);
+    ASSERT_EQ(result.diagnostics.size(), 1);
+
+    auto const &diagnostic = result.diagnostics[0];
+    ASSERT_EQ(diagnostic.id, tiny::DiagnosticId::LeadingZero);
+    ASSERT_EQ(diagnostic.msg, "Numeric literals can't have a leading zero");
+
+    // Byte offsets count the two bytes of the accented character
+    ASSERT_EQ(diagnostic.begin, std::string("module bad\n\n// \xC3\xA9\nx := ").size());
+    ASSERT_GT(diagnostic.end, diagnostic.begin);
+}
@@ -5,6 +5,10 @@
 #include <fstream>
 #include <unordered_set>
 
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
 const auto explorerSandboxPath = std::filesystem::current_path() / "sandbox"/ "explorer";
 const auto explorerInnerPath = explorerSandboxPath / "inner";
 
@@ -141,6 +145,130 @@ TEST(Explorer, SearchNonASCIIFilename) {
     ASSERT_EQ(got, expect);
 }
 
+TEST(Explorer, SearchDepthLimit) {
+    auto deepPath = explorerInnerPath / "deep";
+    std::filesystem::create_directory(deepPath);
+    std::ofstream(deepPath / "test_deep.txt");
+
+    tiny::Explorer explorer(explorerSandboxPath);
+    explorer.setSearchDepth(1);
+    ASSERT_TRUE(explorer.search("test_deep.txt").empty());
+
+    std::vector<std::filesystem::path> expectDirs{explorerSandboxPath, explorerInnerPath};
+    ASSERT_EQ(explorer.getDirectories(), expectDirs);
+
+    explorer.setSearchDepth(2);
+    auto found = explorer.search("test_deep.txt");
+    ASSERT_EQ(found.size(), 1);
+    ASSERT_EQ(found[0].path(), deepPath / "test_deep.txt");
+
+    std::filesystem::remove_all(deepPath);
+}
+
+TEST(Explorer, SearchGlob) {
+    tiny::Explorer explorer(explorerSandboxPath);
+    explorer.setSearchDepth(1);
+
+    std::unordered_set<std::string> got;
+    for (auto const &file: explorer.search("inner/test[12]_*.txt")) {
+        got.insert(file.path().filename().string());
+    }
+
+    std::unordered_set<std::string> expect{"test1_inner.txt", "test2_inner.txt"};
+
+    ASSERT_EQ(got, expect);
+}
+
+TEST(Explorer, SearchNegatedTerm) {
+    tiny::Explorer explorer(explorerSandboxPath);
+    explorer.setSearchDepth(1);
+
+    auto found = explorer.search(std::vector<std::string>{"test[12].txt", "!test2.txt"});
+    ASSERT_EQ(found.size(), 1);
+    ASSERT_EQ(found[0].path(), explorerSandboxPath / "test1.txt");
+
+    // A negated term alone matches nothing
+    ASSERT_TRUE(explorer.search("!test1.txt").empty());
+}
+
+TEST(Explorer, TinyIgnore) {
+    auto buildPath = explorerSandboxPath / "build";
+    std::filesystem::create_directory(buildPath);
+    std::ofstream(buildPath / "test_build.txt");
+
+    {
+        std::ofstream ignore(explorerSandboxPath / tiny::Explorer::IGNORE_FILE);
+        ignore << "build/\n"
+                  "test[23].txt\n";
+    }
+
+    tiny::Explorer explorer(explorerSandboxPath);
+    explorer.setSearchDepth(1);
+
+    std::unordered_set<std::string> got;
+    for (auto const &file: explorer.search("*.txt")) {
+        got.insert(file.path().filename().string());
+    }
+
+    std::unordered_set<std::string> expect{"test1.txt", "test1_inner.txt", "test2_inner.txt"};
+    ASSERT_EQ(got, expect);
+
+    // Ignored directories are never walked into
+    std::vector<std::filesystem::path> expectDirs{explorerSandboxPath, explorerInnerPath};
+    ASSERT_EQ(explorer.getDirectories(), expectDirs);
+
+    std::filesystem::remove(explorerSandboxPath / tiny::Explorer::IGNORE_FILE);
+    std::filesystem::remove_all(buildPath);
+}
+
+TEST(Explorer, WideTree) {
+    auto widePath = explorerSandboxPath / "wide";
+    for (std::int32_t i = 0; i < 300; i++) {
+        auto dir = widePath / ("dir" + std::to_string(i));
+        std::filesystem::create_directories(dir);
+        std::ofstream(dir / "file.txt");
+    }
+
+#if defined(__linux__)
+    // Far fewer descriptors than directories, which are only open while they're read
+    rlimit previous{};
+    getrlimit(RLIMIT_NOFILE, &previous);
+    rlimit limited = previous;
+    limited.rlim_cur = 64;
+    setrlimit(RLIMIT_NOFILE, &limited);
+#endif
+
+    tiny::Explorer explorer(widePath);
+    auto found = explorer.search("*.txt").size();
+
+#if defined(__linux__)
+    setrlimit(RLIMIT_NOFILE, &previous);
+#endif
+
+    ASSERT_EQ(found, 300);
+    std::filesystem::remove_all(widePath);
+
+    // Directories that can't be read aren't skipped silently
+    tiny::Explorer missing(explorerSandboxPath / "missing");
+    ASSERT_THROW(missing.search("*.txt"), std::filesystem::filesystem_error);
+}
+
+TEST(Explorer, Links) {
+    auto linkPath = explorerSandboxPath / "links";
+    std::filesystem::create_directories(linkPath);
+    std::filesystem::create_symlink(explorerSandboxPath / "test1.txt", linkPath / "file.txt");
+    std::filesystem::create_directory_symlink(explorerInnerPath, linkPath / "dir");
+
+    // Links to files are selected, links to directories aren't walked into
+    tiny::Explorer explorer(linkPath);
+    explorer.setSearchDepth(2);
+    auto found = explorer.search("*.txt");
+    ASSERT_EQ(found.size(), 1);
+    ASSERT_EQ(found[0].path(), linkPath / "file.txt");
+
+    std::filesystem::remove_all(linkPath);
+}
+
 TEST(Explorer, Cleanup) {
     std::filesystem::remove_all(explorerSandboxPath);
 }
\ No newline at end of file
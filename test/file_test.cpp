@@ -123,6 +123,19 @@ TEST(FileSelector, GetFiles) {
     }
 }
 
+TEST(FileSelector, GetLocalSourcesPatterns) {
+    tiny::FileSelector fs(fileSelectorSandboxPath);
+    fs.setPatterns({"inner/*.ty", "test1.ty"}, {"inner2.ty"});
+
+    std::vector<std::string> got;
+    for (auto const &f: fs.getLocalSourceFiles()) {
+        got.push_back(f.path.lexically_relative(fileSelectorSandboxPath).generic_string());
+    }
+
+    std::vector<std::string> expect{"inner/inner1.ty", "test1.ty"};
+    ASSERT_EQ(got, expect);
+}
+
 TEST(FileSelector, Cleanup) {
     std::filesystem::remove_all(fileSelectorSandboxPath);
 }
@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+
+#include "compiler.h"
+#include "folding.h"
+#include "bytecode.h"
+#include "vm.h"
+#include "errors.h"
+
+namespace {
+    //! Compiles a function returning an expression, and gets the folded expression
+    tiny::ASTNode foldReturn(const std::string &expression) {
+        tiny::Compiler compiler;
+        auto result = compiler.compile({{"main.ty", "module main\n\nfunc main(int x) {\n    return " + expression
+                                                    + "\n}\n"}});
+        EXPECT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+        auto const &body = *result.files.front().statements.front().getChild(tiny::ASTNodeType::FunctionBody);
+        return *body.getFirstChild()->getFirstChild()->getFirstChild();
+    }
+
+    std::int64_t integer(const tiny::ASTNode &node) {
+        EXPECT_EQ(node.type, tiny::ASTNodeType::LiteralInt);
+        return node.type == tiny::ASTNodeType::LiteralInt ? std::get<std::int64_t>(node.val) : 0;
+    }
+
+    tiny::ASTNode literal(std::int64_t value) {
+        return tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::LiteralInt, value);
+    }
+}
+
+TEST(ConstantFolder, Arithmetic) {
+    ASSERT_EQ(integer(foldReturn("2 + 3 * 4")), 14);
+    ASSERT_EQ(integer(foldReturn("(2 + 3) * 4")), 20);
+    ASSERT_EQ(integer(foldReturn("-7 / 2")), -3);
+    ASSERT_EQ(integer(foldReturn("2 ** 10")), 1024);
+
+    auto decimal = foldReturn("1 + 0.5");
+    ASSERT_EQ(decimal.type, tiny::ASTNodeType::LiteralDecimal);
+    ASSERT_EQ(std::get<long double>(decimal.val), 1.5);
+
+    // Only the literal part of an operation is folded
+    auto partial = foldReturn("x * (2 + 3)");
+    ASSERT_EQ(partial.type, tiny::ASTNodeType::OpMultiplication);
+    ASSERT_EQ(integer(*partial.getSecondChild()), 5);
+}
+
+TEST(ConstantFolder, IntegerSemantics) {
+    // Wraps around instead of overflowing
+    ASSERT_EQ(integer(foldReturn("9223372036854775807 + 1")), std::numeric_limits<std::int64_t>::min());
+
+    // The overflowing division wraps around too
+    auto min = std::numeric_limits<std::int64_t>::min();
+    tiny::ASTNode division(tiny::Metadata(), tiny::ASTNodeType::OpDivision, literal(min), literal(-1));
+    ASSERT_EQ(tiny::ConstantFolder::fold(division), 1);
+    ASSERT_EQ(integer(division), min);
+
+    // Divisions by zero are left for the run time
+    ASSERT_EQ(foldReturn("1 / 0").type, tiny::ASTNodeType::OpDivision);
+
+    // Negative powers of integers are decimals
+    ASSERT_EQ(foldReturn("2 ** -1").type, tiny::ASTNodeType::LiteralDecimal);
+}
+
+TEST(ConstantFolder, Logic) {
+    auto boolean = [](const tiny::ASTNode &node) {
+        EXPECT_EQ(node.type, tiny::ASTNodeType::LiteralBool);
+        return std::get<bool>(node.val);
+    };
+
+    ASSERT_TRUE(boolean(foldReturn("1 < 2")));
+    ASSERT_FALSE(boolean(foldReturn("1.5 >= 2")));
+    ASSERT_FALSE(boolean(foldReturn("3 == 3 and 2 != 2")));
+    ASSERT_TRUE(boolean(foldReturn("!(1 > 2)")));
+
+    // A literal left-hand side picks the result
+    ASSERT_EQ(foldReturn("True and x > 1").type, tiny::ASTNodeType::CompareGt);
+    ASSERT_FALSE(boolean(foldReturn("False and x > 1")));
+    ASSERT_TRUE(boolean(foldReturn("True or x > 1")));
+    ASSERT_EQ(foldReturn("x > 1 or True").type, tiny::ASTNodeType::LogicalOr);
+
+    // Only over a right-hand side that's sure to be a boolean
+    ASSERT_EQ(foldReturn("True and 5").type, tiny::ASTNodeType::LogicalAnd);
+    ASSERT_EQ(foldReturn("False or x").type, tiny::ASTNodeType::LogicalOr);
+    ASSERT_EQ(foldReturn("False and x").type, tiny::ASTNodeType::LogicalAnd);
+    ASSERT_EQ(foldReturn("True and !(x < 1 or x > 3)").type, tiny::ASTNodeType::UnaryNot);
+}
+
+TEST(ConstantFolder, Identities) {
+    ASSERT_EQ(foldReturn("(x - 3) * 1").type, tiny::ASTNodeType::OpSubtraction);
+    ASSERT_EQ(foldReturn("1 * (x - 3)").type, tiny::ASTNodeType::OpSubtraction);
+    ASSERT_EQ(foldReturn("-x + 0").type, tiny::ASTNodeType::UnaryNegative);
+    ASSERT_EQ(foldReturn("(x + 2) / 1").type, tiny::ASTNodeType::OpAddition);
+    ASSERT_EQ(foldReturn("(x * 2) ** 1").type, tiny::ASTNodeType::OpMultiplication);
+
+    // These would change the result, or turn an integer into a decimal
+    ASSERT_EQ(foldReturn("0 - x").type, tiny::ASTNodeType::OpSubtraction);
+    ASSERT_EQ(foldReturn("(x + 1) * 1.0").type, tiny::ASTNodeType::OpMultiplication);
+    ASSERT_EQ(foldReturn("(x + 1) * 0").type, tiny::ASTNodeType::OpMultiplication);
+
+    // Nothing says an identifier holds a number, and dropping the operation would hide its error
+    ASSERT_EQ(foldReturn("x * 1").type, tiny::ASTNodeType::OpMultiplication);
+    ASSERT_EQ(foldReturn("0 + x").type, tiny::ASTNodeType::OpAddition);
+}
+
+TEST(ConstantFolder, KeepsRuntimeErrors) {
+    tiny::Compiler compiler;
+    auto result = compiler.compile({{"main.ty", "module main\n\n"
+                                                "func main() {\n"
+                                                "    b := True\n"
+                                                "    return b * 1\n"
+                                                "}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+    auto program = tiny::BytecodeCompiler::compile(result.files);
+    tiny::VM vm(program);
+    ASSERT_THROW(vm.call("main", {}), tiny::ExecutionError);
+}
+
+TEST(ConstantFolder, KeepsResults) {
+    tiny::Compiler compiler;
+    auto result = compiler.compile({{"main.ty", "module main\n\n"
+                                                "func main(int x) {\n"
+                                                "    sum := 0\n"
+                                                "    for i := 0..x * 1 + 0 {\n"
+                                                "        if True and i * 2 > 3 - 1 {\n"
+                                                "            sum += i * (10 / 5)\n"
+                                                "        }\n"
+                                                "    }\n"
+                                                "    return sum + -(4 ** 0)\n"
+                                                "}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+    auto program = tiny::BytecodeCompiler::compile(result.files);
+    tiny::VM vm(program);
+    ASSERT_EQ(vm.call("main", {tiny::RuntimeValue::fromInt(10)}).front(), tiny::RuntimeValue::fromInt(87));
+}
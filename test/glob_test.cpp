@@ -0,0 +1,134 @@
+#include "gtest/gtest.h"
+
+#include "glob.h"
+#include "errors.h"
+
+#include <fstream>
+
+TEST(Glob, Literal) {
+    tiny::Glob glob("main.ty");
+
+    ASSERT_TRUE(glob.matches("main.ty"));
+    ASSERT_TRUE(glob.matches("src/nested/main.ty")); // No '/', so it matches at any depth
+    ASSERT_FALSE(glob.matches("main.tyx"));
+    ASSERT_FALSE(glob.matches("xmain.ty"));
+}
+
+TEST(Glob, Star) {
+    tiny::Glob glob("*.ty");
+
+    ASSERT_TRUE(glob.matches("main.ty"));
+    ASSERT_TRUE(glob.matches(".ty"));
+    ASSERT_TRUE(glob.matches("src/lib.ty"));
+    ASSERT_FALSE(glob.matches("main.txt"));
+
+    tiny::Glob anchored("src/*.ty");
+    ASSERT_TRUE(anchored.matches("src/lib.ty"));
+    ASSERT_FALSE(anchored.matches("src/nested/lib.ty")); // '*' doesn't cross directories
+    ASSERT_FALSE(anchored.matches("other/src/lib.ty"));
+}
+
+TEST(Glob, DoubleStar) {
+    tiny::Glob glob("src/**/*.ty");
+
+    ASSERT_TRUE(glob.matches("src/main.ty"));
+    ASSERT_TRUE(glob.matches("src/a/b/c/main.ty"));
+    ASSERT_FALSE(glob.matches("lib/main.ty"));
+    ASSERT_FALSE(glob.matches("src//main.ty"));
+
+    tiny::Glob trailing("build/**");
+    ASSERT_TRUE(trailing.matches("build/out/main.o"));
+    ASSERT_FALSE(trailing.matches("builder/main.o"));
+
+    tiny::Glob leading("**/gen");
+    ASSERT_TRUE(leading.matches("gen"));
+    ASSERT_TRUE(leading.matches("a/b/gen"));
+    ASSERT_FALSE(leading.matches("a/gen/b"));
+    ASSERT_FALSE(leading.matches("/gen"));
+}
+
+TEST(Glob, QuestionMark) {
+    tiny::Glob glob("test?.txt");
+
+    ASSERT_TRUE(glob.matches("test1.txt"));
+    ASSERT_FALSE(glob.matches("test.txt"));
+    ASSERT_FALSE(glob.matches("test12.txt"));
+    ASSERT_FALSE(tiny::Glob("a?b").matches("a/b"));
+}
+
+TEST(Glob, CharacterClass) {
+    tiny::Glob glob("test[1-3x].txt");
+
+    ASSERT_TRUE(glob.matches("test1.txt"));
+    ASSERT_TRUE(glob.matches("test3.txt"));
+    ASSERT_TRUE(glob.matches("testx.txt"));
+    ASSERT_FALSE(glob.matches("test4.txt"));
+
+    tiny::Glob negated("test[!1-3].txt");
+    ASSERT_FALSE(negated.matches("test1.txt"));
+    ASSERT_TRUE(negated.matches("test4.txt"));
+
+    tiny::Glob bracket("[]]");
+    ASSERT_TRUE(bracket.matches("]"));
+}
+
+TEST(Glob, Escape) {
+    tiny::Glob glob("\\*.ty");
+
+    ASSERT_TRUE(glob.matches("*.ty"));
+    ASSERT_FALSE(glob.matches("main.ty"));
+}
+
+TEST(Glob, DirectoryOnly) {
+    tiny::Glob glob("build/");
+
+    ASSERT_TRUE(glob.matches("build", true));
+    ASSERT_TRUE(glob.matches("sub/build", true));
+    ASSERT_FALSE(glob.matches("build", false));
+}
+
+TEST(Glob, Anchored) {
+    tiny::Glob glob("/build");
+
+    ASSERT_TRUE(glob.matches("build"));
+    ASSERT_FALSE(glob.matches("sub/build"));
+}
+
+TEST(Glob, Invalid) {
+    ASSERT_THROW(tiny::Glob("test[1-3.txt"), tiny::GlobError);
+    ASSERT_THROW(tiny::Glob("[z-a]"), tiny::GlobError);
+    ASSERT_THROW(tiny::Glob("abc\\"), tiny::GlobError);
+    ASSERT_THROW(tiny::Glob("!"), tiny::GlobError);
+}
+
+TEST(IgnoreList, LastMatchWins) {
+    tiny::IgnoreList ignore;
+    ignore.add("*.ty");
+    ignore.add("!keep.ty");
+
+    ASSERT_TRUE(ignore.isIgnored("main.ty", false));
+    ASSERT_FALSE(ignore.isIgnored("keep.ty", false));
+    ASSERT_FALSE(ignore.isIgnored("main.txt", false));
+}
+
+TEST(IgnoreList, Load) {
+    auto file = std::filesystem::temp_directory_path() / "tiny_ignore_test";
+    {
+        std::ofstream out(file);
+        out << "# Generated code\n"
+               "\n"
+               "build/\r\n"
+               "x[\n"
+               "*.o  \n";
+    }
+
+    // The malformed line is skipped, not the whole file
+    auto ignore = tiny::IgnoreList::load(file);
+    ASSERT_TRUE(ignore.isIgnored("build", true));
+    ASSERT_TRUE(ignore.isIgnored("src/main.o", false));
+    ASSERT_FALSE(ignore.isIgnored("src/main.ty", false));
+
+    std::filesystem::remove(file);
+
+    ASSERT_TRUE(tiny::IgnoreList::load(file).empty());
+}
@@ -0,0 +1,398 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+
+#include "compiler.h"
+#include "errors.h"
+#include "bytecode.h"
+#include "interpreter.h"
+#include "vm.h"
+
+namespace {
+    std::vector<tiny::ASTFile> parse(const std::string &code) {
+        tiny::Compiler compiler;
+        auto result = compiler.compile({{"main.ty", "module main\n\n" + code}});
+        EXPECT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+        return std::move(result.files);
+    }
+
+    tiny::ClosureProgram compileProgram(const std::string &code) {
+        return tiny::ClosureCompiler::compile(parse(code));
+    }
+
+    tiny::RuntimeValue run(const std::string &code, const std::vector<tiny::RuntimeValue> &args = {}) {
+        auto results = compileProgram(code).call("main", args);
+        EXPECT_EQ(results.size(), 1);
+
+        return results.empty() ? tiny::RuntimeValue() : results.front();
+    }
+
+    tiny::RuntimeValue integer(std::int64_t v) {
+        return tiny::RuntimeValue::fromInt(v);
+    }
+
+    /*!
+     * \brief A plain tree-walking interpreter, to measure the closures against
+     *
+     * A plain tree-walking interpreter, to measure the closures against. It switches over the type of every node each
+     * time it's reached, and keeps variables and functions by name. Only handles what the benchmark needs.
+     */
+    class TreeWalker {
+    public:
+        explicit TreeWalker(const std::vector<tiny::ASTFile> &files) {
+            for (auto const &file: files) {
+                for (auto const &node: file.statements) {
+                    functions[node.getParam(tiny::ParameterType::Name).getStringVal(node.meta).toString()] = &node;
+                }
+            }
+        }
+
+        tiny::RuntimeValue call(const std::string &name, const std::vector<tiny::RuntimeValue> &args) {
+            auto const &fn = *functions.at(name);
+            Scope scope;
+
+            auto const &decls = fn.getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children;
+            for (std::size_t i = 0; i < decls.size(); i++) {
+                scope[decls[i]->getParam(tiny::ParameterType::Name).getStringVal(decls[i]->meta).toString()] = args[i];
+            }
+
+            tiny::RuntimeValue result;
+            statement(*fn.getChild(tiny::ASTNodeType::FunctionBody)->getFirstChild(), scope, result);
+            return result;
+        }
+
+    private:
+        using Scope = std::unordered_map<std::string, tiny::RuntimeValue>;
+
+        bool statement(const tiny::ASTNode &node, Scope &scope, tiny::RuntimeValue &result) {
+            switch (node.type) {
+            case tiny::ASTNodeType::BlockStatement:
+                for (auto const &c: node.children) {
+                    if (statement(*c, scope, result)) {
+                        return true;
+                    }
+                }
+
+                return false;
+            case tiny::ASTNodeType::ExpressionStatement: {
+                auto const &e = *node.getFirstChild();
+                auto value = eval(*e.getSecondChild(), scope);
+                auto name = e.getFirstChild()->getStringVal().toString();
+
+                switch (e.type) {
+                case tiny::ASTNodeType::AssignmentSum:
+                    scope[name] = tiny::applyArithmetic(tiny::Operator::Add, scope[name], value);
+                    break;
+                case tiny::ASTNodeType::AssignmentSub:
+                    scope[name] = tiny::applyArithmetic(tiny::Operator::Sub, scope[name], value);
+                    break;
+                default:
+                    scope[name] = value;
+                }
+
+                return false;
+            }
+            case tiny::ASTNodeType::IfStatement: {
+                auto const &condition = *node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild();
+                if (tiny::toCondition(eval(condition, scope))) {
+                    return statement(*node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild(), scope,
+                                     result);
+                }
+
+                return node.children.size() > 2
+                       && statement(*node.getChild(tiny::ASTNodeType::BranchAlternative)->getFirstChild(), scope,
+                                    result);
+            }
+            case tiny::ASTNodeType::ForStatement: {
+                auto const &range = *node.getChild(tiny::ASTNodeType::BranchCondition)->getFirstChild();
+                auto name = range.getParam(tiny::ParameterType::RangeIdentifier).getStringVal(range.meta).toString();
+                auto from = eval(*range.getChild(tiny::ASTNodeType::RangeFromExpression)->getFirstChild(), scope);
+                auto to = eval(*range.getChild(tiny::ASTNodeType::RangeToExpression)->getFirstChild(), scope);
+
+                for (auto i = from.i; i < to.i; i++) {
+                    scope[name] = integer(i);
+                    if (statement(*node.getChild(tiny::ASTNodeType::BranchConsequent)->getFirstChild(), scope,
+                                  result)) {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+            default: // FunctionReturn
+                result = eval(*node.getFirstChild(), scope);
+                return true;
+            }
+        }
+
+        tiny::RuntimeValue eval(const tiny::ASTNode &node, Scope &scope) {
+            switch (node.type) {
+            case tiny::ASTNodeType::LiteralInt:
+                return integer(std::get<std::int64_t>(node.val));
+            case tiny::ASTNodeType::Identifier:
+                return scope.at(node.getStringVal().toString());
+            case tiny::ASTNodeType::OpAddition:
+                return tiny::applyArithmetic(tiny::Operator::Add, eval(*node.getFirstChild(), scope),
+                                             eval(*node.getSecondChild(), scope));
+            case tiny::ASTNodeType::OpSubtraction:
+                return tiny::applyArithmetic(tiny::Operator::Sub, eval(*node.getFirstChild(), scope),
+                                             eval(*node.getSecondChild(), scope));
+            case tiny::ASTNodeType::OpMultiplication:
+                return tiny::applyArithmetic(tiny::Operator::Mul, eval(*node.getFirstChild(), scope),
+                                             eval(*node.getSecondChild(), scope));
+            case tiny::ASTNodeType::CompareLt:
+                return tiny::RuntimeValue::fromBool(tiny::applyComparison(
+                        tiny::Operator::Lt, eval(*node.getFirstChild(), scope), eval(*node.getSecondChild(), scope)));
+            case tiny::ASTNodeType::CompareGt:
+                return tiny::RuntimeValue::fromBool(tiny::applyComparison(
+                        tiny::Operator::Gt, eval(*node.getFirstChild(), scope), eval(*node.getSecondChild(), scope)));
+            default: { // FunctionCall
+                std::vector<tiny::RuntimeValue> args;
+                for (auto const &arg: node.getSecondChild()->children) {
+                    args.push_back(eval(*arg, scope));
+                }
+
+                return call(node.getFirstChild()->getStringVal().toString(), args);
+            }
+            }
+        }
+
+        std::unordered_map<std::string, const tiny::ASTNode *> functions;
+    };
+
+    double seconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TEST(Interpreter, Arithmetic) {
+    ASSERT_EQ(run("func main() {\n    return 2 + 3 * 4\n}\n"), integer(14));
+    ASSERT_EQ(run("func main() {\n    return (2 + 3) * 4\n}\n"), integer(20));
+    ASSERT_EQ(run("func main() {\n    return 7 / 2\n}\n"), integer(3));
+    ASSERT_EQ(run("func main() {\n    return -7 / 2\n}\n"), integer(-3));
+    ASSERT_EQ(run("func main() {\n    return 2 ** 10\n}\n"), integer(1024));
+    ASSERT_EQ(run("func main() {\n    return 1 + 0.5\n}\n"), tiny::RuntimeValue::fromFloat(1.5));
+    ASSERT_EQ(run("func main(float a) {\n    return a * 2\n}\n", {tiny::RuntimeValue::fromFloat(1.25)}),
+              tiny::RuntimeValue::fromFloat(2.5));
+
+    // Integers wrap around
+    ASSERT_EQ(run("func main() {\n    return 9223372036854775807 + 1\n}\n"),
+              integer(std::numeric_limits<std::int64_t>::min()));
+}
+
+TEST(Interpreter, Comparisons) {
+    auto yes = tiny::RuntimeValue::fromBool(true);
+    auto no = tiny::RuntimeValue::fromBool(false);
+
+    ASSERT_EQ(run("func main() {\n    return 1 < 2\n}\n"), yes);
+    ASSERT_EQ(run("func main() {\n    return 2 <= 1\n}\n"), no);
+    ASSERT_EQ(run("func main() {\n    return 1.5 > 1\n}\n"), yes);
+    ASSERT_EQ(run("func main() {\n    return 3 == 3 and 2 != 2\n}\n"), no);
+    ASSERT_EQ(run("func main() {\n    return 3 == 4 or 2 >= 2\n}\n"), yes);
+    ASSERT_EQ(run("func main() {\n    return !(1 > 2)\n}\n"), yes);
+}
+
+TEST(Interpreter, Variables) {
+    ASSERT_EQ(run("func main(int a) {\n"
+                  "    x := a + 1\n"
+                  "    x = x * 2\n"
+                  "    x += 3\n"
+                  "    int64 y\n"
+                  "    y -= x\n"
+                  "    {\n"
+                  "        x := 100\n"
+                  "        y += x\n"
+                  "    }\n"
+                  "    return y\n"
+                  "}\n", {integer(4)}), integer(87));
+}
+
+TEST(Interpreter, Branches) {
+    auto program = compileProgram("func main(int a) {\n"
+                                  "    if a > 10 {\n"
+                                  "        return 1\n"
+                                  "    } else {\n"
+                                  "        if a > 5 and a != 7 {\n"
+                                  "            return 2\n"
+                                  "        }\n"
+                                  "    }\n"
+                                  "    return 3\n"
+                                  "}\n");
+
+    ASSERT_EQ(program.call("main", {integer(11)}).front(), integer(1));
+    ASSERT_EQ(program.call("main", {integer(6)}).front(), integer(2));
+    ASSERT_EQ(program.call("main", {integer(7)}).front(), integer(3));
+    ASSERT_EQ(program.call("main", {integer(5)}).front(), integer(3));
+}
+
+TEST(Interpreter, Loops) {
+    // Ranges exclude their upper bound
+    ASSERT_EQ(run("func main() {\n"
+                  "    sum := 0\n"
+                  "    for i := 0..10 {\n"
+                  "        sum += i\n"
+                  "    }\n"
+                  "    return sum\n"
+                  "}\n"), integer(45));
+
+    ASSERT_EQ(run("func main() {\n"
+                  "    sum := 0\n"
+                  "    for i := 10..0 -> -3 {\n"
+                  "        sum += i\n"
+                  "    }\n"
+                  "    return sum\n"
+                  "}\n"), integer(22));
+
+    ASSERT_EQ(run("func main() {\n"
+                  "    n := 1\n"
+                  "    for n < 1000 {\n"
+                  "        n *= 2\n"
+                  "    }\n"
+                  "    return n\n"
+                  "}\n"), integer(1024));
+
+    // Changing the variable doesn't change the iterations
+    ASSERT_EQ(run("func main() {\n"
+                  "    count := 0\n"
+                  "    for i := 0..5 {\n"
+                  "        i = 100\n"
+                  "        count += 1\n"
+                  "    }\n"
+                  "    return count\n"
+                  "}\n"), integer(5));
+}
+
+TEST(Interpreter, Calls) {
+    auto program = compileProgram("func main(int n) {\n"
+                                  "    return fib(n)\n"
+                                  "}\n\n"
+                                  "func fib(int n) {\n"
+                                  "    if n < 2 {\n"
+                                  "        return n\n"
+                                  "    }\n"
+                                  "    return fib(n - 1) + fib(n - 2)\n"
+                                  "}\n\n"
+                                  "func pair(int a, int b) {\n"
+                                  "    return b, a\n"
+                                  "}\n\n"
+                                  "func nothing() {\n"
+                                  "}\n");
+
+    ASSERT_EQ(program.call("main", {integer(20)}), std::vector<tiny::RuntimeValue>{integer(6765)});
+    ASSERT_EQ(program.call("pair", {integer(1), integer(2)}),
+              (std::vector<tiny::RuntimeValue>{integer(2), integer(1)}));
+    ASSERT_TRUE(program.call("nothing", {}).empty());
+    ASSERT_THROW(program.call("main", {}), tiny::ExecutionError);
+    ASSERT_THROW(program.call("nope", {}), tiny::ExecutionError);
+}
+
+TEST(Interpreter, Modules) {
+    tiny::Compiler compiler;
+    auto result = compiler.compile({{"main.ty", "module main\n\nimport (\n    a,\n    b as other\n)\n\n"
+                                                "func main(int n) {\n"
+                                                "    return helper(n) + a.helper(n) + other.helper(n) + twice(n)\n"
+                                                "}\n\n"
+                                                "func helper(int n) {\n    return n\n}\n"},
+                                    {"a.ty", "module a\n\nfunc helper(int n) {\n    return n * 10\n}\n\n"
+                                             "func twice(int n) {\n    return helper(n) * 2\n}\n"},
+                                    {"b.ty", "module b\n\nfunc helper(int n) {\n    return n * 100\n}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+    // Resolved like in bytecode
+    auto program = tiny::ClosureCompiler::compile(result.files);
+    auto expected = tiny::VM(tiny::BytecodeCompiler::compile(result.files)).call("main", {integer(1)});
+    ASSERT_EQ(program.call("main", {integer(1)}), expected);
+    ASSERT_EQ(program.call("b.helper", {integer(1)}), std::vector<tiny::RuntimeValue>{integer(100)});
+    ASSERT_THROW(program.call("helper", {integer(1)}), tiny::ExecutionError);
+
+    result = compiler.compile({{"main.ty", "module main\n\nfunc main(int n) {\n    return a.helper(n)\n}\n"},
+                               {"a.ty", "module a\n\nfunc helper(int n) {\n    return n\n}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_THROW(tiny::ClosureCompiler::compile(result.files), tiny::InterpreterError);
+}
+
+TEST(Interpreter, Errors) {
+    ASSERT_THROW(run("func main() {\n    x := 0\n    return 1 / x\n}\n"), tiny::ExecutionError);
+    ASSERT_THROW(run("func main() {\n    if 1 {\n        return 1\n    }\n}\n"), tiny::ExecutionError);
+
+    try {
+        run("func main() {\n    return main()\n}\n");
+        FAIL() << "Expected a stack overflow";
+    } catch (const tiny::ExecutionError &e) {
+        ASSERT_EQ(e.msg, "In 'main.main': Stack overflow");
+    }
+
+    ASSERT_THROW(compileProgram("func main() {\n    return x\n}\n"), tiny::InterpreterError);
+    ASSERT_THROW(compileProgram("func main() {\n    return f(1)\n}\n"), tiny::InterpreterError);
+    ASSERT_THROW(compileProgram("func main() {\n    return main(1)\n}\n"), tiny::InterpreterError);
+}
+
+TEST(Interpreter, Benchmark) {
+    auto files = parse("func fib(int n) {\n"
+                       "    if n < 2 {\n"
+                       "        return n\n"
+                       "    }\n"
+                       "    return fib(n - 1) + fib(n - 2)\n"
+                       "}\n\n"
+                       "func loop(int n) {\n"
+                       "    sum := 0\n"
+                       "    for i := 0..n {\n"
+                       "        if i * 3 > sum {\n"
+                       "            sum += i\n"
+                       "        } else {\n"
+                       "            sum -= 1\n"
+                       "        }\n"
+                       "    }\n"
+                       "    return sum\n"
+                       "}\n");
+
+    // Startup: compiling both tiers, many times over so the timer can see it
+    const int compilations = 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < compilations; i++) {
+        tiny::ClosureCompiler::compile(files);
+    }
+    auto closureStartup = seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < compilations; i++) {
+        tiny::BytecodeCompiler::compile(files);
+    }
+    auto bytecodeStartup = seconds(start);
+
+    std::cout << "Interpreter benchmark -> compiled in " << std::int64_t(closureStartup / compilations * 1e9)
+              << "ns (bytecode: " << std::int64_t(bytecodeStartup / compilations * 1e9) << "ns)" << std::endl;
+
+    // Throughput, against a plain tree walker
+    auto program = tiny::ClosureCompiler::compile(files);
+    TreeWalker walker(files);
+
+    start = std::chrono::steady_clock::now();
+    auto fib = program.call("fib", {integer(25)});
+    auto closures = seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    auto walked = walker.call("fib", {integer(25)});
+    auto tree = seconds(start);
+
+    ASSERT_EQ(fib.front(), integer(75025));
+    ASSERT_EQ(walked, integer(75025));
+    std::cout << "Interpreter benchmark -> fib(25) in " << std::int64_t(closures * 1000) << "ms (tree walker: "
+              << std::int64_t(tree * 1000) << "ms)" << std::endl;
+
+    const std::int64_t iterations = 2000000;
+    start = std::chrono::steady_clock::now();
+    auto sum = program.call("loop", {integer(iterations)});
+    closures = seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    walked = walker.call("loop", {integer(iterations)});
+    tree = seconds(start);
+
+    ASSERT_EQ(sum.front(), walked);
+    std::cout << "Interpreter benchmark -> " << iterations << " loop iterations in " << std::int64_t(closures * 1000)
+              << "ms (tree walker: " << std::int64_t(tree * 1000) << "ms)" << std::endl;
+}
@@ -0,0 +1,285 @@
+#include "gtest/gtest.h"
+
+#include "compiler.h"
+#include "errors.h"
+#include "irbuilder.h"
+#include "passes.h"
+
+namespace {
+    //! Compiles a program and lowers it into IR, without running any pass
+    tiny::IRModule build(const std::string &source) {
+        tiny::Compiler compiler;
+        auto result = compiler.compile({{"main.ty", "module main\n\n" + source}});
+        EXPECT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+        return tiny::IRBuilder::build(result.files);
+    }
+
+    //! Counts the instructions of a function with the given operation
+    std::size_t count(const tiny::IRFunction &fn, tiny::IROp op) {
+        std::size_t found = 0;
+        for (auto const &block: fn.blocks) {
+            for (auto const &ins: block->instructions) {
+                found += ins->op == op ? 1 : 0;
+            }
+        }
+
+        return found;
+    }
+
+    const tiny::IRType INT{tiny::IRTypeKind::Int};
+    const tiny::IRType FLOAT{tiny::IRTypeKind::Float};
+}
+
+TEST(IR, Dump) {
+    auto module = build("func main(int x) {\n"
+                        "    y := x * 2\n"
+                        "    if y > 10 {\n"
+                        "        y = 10\n"
+                        "    }\n"
+                        "    return y\n"
+                        "}\n");
+    ASSERT_TRUE(module.verify().empty());
+
+    tiny::PassManager::standard().run(module);
+    ASSERT_EQ(module.toString(), "func main.main(i32) -> i64 {\n"
+                                 "bb0:\n"
+                                 "    %0 = arg i32 0\n"
+                                 "    %1 = intcast i64 %0\n"
+                                 "    %2 = const i64 2\n"
+                                 "    %3 = mul i64 %1, %2\n"
+                                 "    %4 = const i64 10\n"
+                                 "    %5 = gt bool %3, %4\n"
+                                 "    br %5, bb1, bb2\n"
+                                 "bb1:\n"
+                                 "    %6 = const i64 10\n"
+                                 "    jmp bb2\n"
+                                 "bb2:\n"
+                                 "    %7 = phi i64 [%3, bb0], [%6, bb1]\n"
+                                 "    ret %7\n"
+                                 "}\n");
+}
+
+TEST(IR, Loops) {
+    auto module = build("func sum(int n) {\n"
+                        "    total := 0\n"
+                        "    for i := 0..n {\n"
+                        "        total += i\n"
+                        "    }\n"
+                        "    k := n\n"
+                        "    for k > 0 {\n"
+                        "        k -= 1\n"
+                        "    }\n"
+                        "    return total + k\n"
+                        "}\n");
+    ASSERT_TRUE(module.verify().empty());
+
+    auto &fn = module.functions.front();
+    ASSERT_EQ(fn.results, std::vector<tiny::IRType>{INT});
+
+    // Building leaves trivial phis for the variables each loop only reads, which the passes remove
+    auto before = count(fn, tiny::IROp::Phi);
+    ASSERT_GT(tiny::PassManager::standard().run(module), 0);
+    ASSERT_LT(count(fn, tiny::IROp::Phi), before);
+
+    // The counter and total of the range, and k in the while loop
+    ASSERT_EQ(count(fn, tiny::IROp::Phi), 3);
+    ASSERT_TRUE(module.verify().empty());
+}
+
+TEST(IR, LoadsAndStores) {
+    auto module = build("func swap(*int64 a, *int64 b) {\n"
+                        "    t := $a\n"
+                        "    $a = $b\n"
+                        "    $b = t\n"
+                        "}\n"
+                        "\n"
+                        "func main() {\n"
+                        "    x := 1\n"
+                        "    y := 2\n"
+                        "    swap(&x, &y)\n"
+                        "    return x - y\n"
+                        "}\n");
+    tiny::PassManager::standard().run(module);
+
+    auto const &swap = *module.find("main.swap");
+    ASSERT_EQ(swap.params, (std::vector<tiny::IRType>{INT.pointer(), INT.pointer()}));
+    ASSERT_TRUE(swap.results.empty());
+    ASSERT_EQ(count(swap, tiny::IROp::Load), 2);
+    ASSERT_EQ(count(swap, tiny::IROp::Store), 2);
+
+    // Variables whose address is taken live in memory
+    auto const &main = *module.find("main.main");
+    ASSERT_EQ(count(main, tiny::IROp::Alloca), 2);
+    ASSERT_EQ(count(main, tiny::IROp::Load), 2);
+    ASSERT_EQ(count(main, tiny::IROp::Phi), 0);
+    ASSERT_NE(main.toString().find("call @main.swap(%0, %1)"), std::string::npos);
+}
+
+TEST(IR, Types) {
+    auto module = build("func main(int x) {\n"
+                        "    return half(x) + 1\n"
+                        "}\n"
+                        "\n"
+                        "func half(int x) {\n"
+                        "    if x > 0 and x < 100 {\n"
+                        "        return x / 2.0\n"
+                        "    }\n"
+                        "    return 0\n"
+                        "}\n");
+    tiny::PassManager::standard().run(module);
+
+    // Results are inferred even for functions declared after their callers
+    ASSERT_EQ(module.find("main.half")->results, std::vector<tiny::IRType>{FLOAT});
+    ASSERT_EQ(module.find("main.main")->results, std::vector<tiny::IRType>{FLOAT});
+    ASSERT_EQ(count(*module.find("main.half"), tiny::IROp::IntToFloat), 2);
+
+    // The 'and' short-circuits through a phi
+    ASSERT_EQ(count(*module.find("main.half"), tiny::IROp::Phi), 1);
+
+    EXPECT_THROW(build("func main(int x) {\n    if x {\n        return 1\n    }\n}\n"), tiny::IRError);
+    EXPECT_THROW(build("func main(int x) {\n    y := 1\n    y = True\n}\n"), tiny::IRError);
+    EXPECT_THROW(build("func main(int x) {\n    if x > 1 {\n        return 1\n    }\n}\n"), tiny::IRError);
+}
+
+TEST(IR, Widths) {
+    auto module = build("func store(*int8 p, int64 v) {\n"
+                        "    $p = v\n"
+                        "}\n"
+                        "\n"
+                        "func main(uint16 a) {\n"
+                        "    x := a * a\n"
+                        "    int8 y := x\n"
+                        "    store(&y, x)\n"
+                        "    return x + y\n"
+                        "}\n");
+    ASSERT_TRUE(module.verify().empty());
+
+    // Arguments keep their declared types, and are widened to compute with
+    auto const &main = *module.find("main.main");
+    ASSERT_EQ(main.params, std::vector<tiny::IRType>{tiny::IRType::fromName("uint16")});
+    ASSERT_EQ(main.params.front().toString(), "u16");
+    ASSERT_EQ(main.results, std::vector<tiny::IRType>{INT});
+    ASSERT_NE(main.toString().find("intcast i64 %0"), std::string::npos);
+
+    // Writing to memory of a narrower type narrows the value
+    auto const &store = *module.find("main.store");
+    ASSERT_EQ(store.params.front().toString(), "*i8");
+    ASSERT_EQ(count(store, tiny::IROp::IntCast), 1);
+
+    // Pointers to different widths don't mix
+    EXPECT_THROW(build("func f(*int32 p) {\n}\n\nfunc main() {\n    x := 1\n    f(&x)\n}\n"), tiny::IRError);
+
+    // The verifier rejects arithmetic over narrower integers that weren't widened
+    tiny::IRModule manual;
+    manual.functions.emplace_back();
+    auto &fn = manual.functions.back();
+    auto narrow = tiny::IRType::fromName("int32");
+    fn.name = "main.f";
+    fn.params = {narrow};
+    fn.results = {narrow};
+
+    auto entry = fn.addBlock();
+    auto arg = entry->append(tiny::IROp::Arg, narrow);
+    arg->constant = tiny::RuntimeValue::fromInt(0);
+    auto sum = entry->append(tiny::IROp::Add, narrow, {arg, arg});
+    entry->append(tiny::IROp::Return, {}, {sum});
+    ASSERT_EQ(manual.verify().size(), 1);
+
+    entry->instructions.erase(entry->instructions.begin() + 1, entry->instructions.end());
+    auto wide = entry->append(tiny::IROp::IntCast, INT, {arg});
+    sum = entry->append(tiny::IROp::Add, INT, {wide, wide});
+    entry->append(tiny::IROp::Return, {}, {sum});
+    ASSERT_EQ(manual.verify().size(), 1); // Returns an i64 from a function that gives an i32
+
+    entry->instructions.pop_back();
+    entry->append(tiny::IROp::Return, {}, {entry->append(tiny::IROp::IntCast, narrow, {sum})});
+    ASSERT_TRUE(manual.verify().empty());
+}
+
+TEST(IR, Modules) {
+    tiny::Compiler compiler;
+    auto result = compiler.compile({{"main.ty", "module main\n\nimport (\n    a\n)\n\n"
+                                                "func main(int n) {\n    return helper(n) + a.helper(n)\n}\n\n"
+                                                "func helper(int n) {\n    return n\n}\n"},
+                                    {"a.ty", "module a\n\nfunc helper(int n) {\n    return n * 10\n}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+    // Functions with the same name in different modules are different functions
+    auto module = tiny::IRBuilder::build(result.files);
+    ASSERT_TRUE(module.verify().empty());
+    ASSERT_NE(module.find("main.helper"), nullptr);
+    ASSERT_NE(module.find("a.helper"), nullptr);
+    ASSERT_EQ(module.find("helper"), nullptr);
+
+    auto dump = module.find("main.main")->toString();
+    ASSERT_NE(dump.find("@main.helper("), std::string::npos);
+    ASSERT_NE(dump.find("@a.helper("), std::string::npos);
+
+    // Only imported modules can be called
+    result = compiler.compile({{"main.ty", "module main\n\nfunc main(int n) {\n    return a.helper(n)\n}\n"},
+                               {"a.ty", "module a\n\nfunc helper(int n) {\n    return n\n}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_THROW(tiny::IRBuilder::build(result.files), tiny::IRError);
+}
+
+TEST(IR, Verifier) {
+    tiny::IRModule module;
+    module.functions.emplace_back();
+    auto &fn = module.functions.back();
+    fn.name = "f";
+    fn.results = {INT};
+
+    auto entry = fn.addBlock();
+    auto next = fn.addBlock();
+    auto one = entry->append(tiny::IROp::Const, INT);
+    one->constant = tiny::RuntimeValue::fromInt(1);
+
+    // No terminator
+    ASSERT_FALSE(module.verify().empty());
+
+    auto jump = entry->append(tiny::IROp::Jump, {});
+    jump->targets = {next};
+    next->predecessors = {entry};
+    next->append(tiny::IROp::Return, {}, {one});
+    ASSERT_TRUE(module.verify().empty());
+
+    // A phi with no operand for its predecessor
+    auto phi = next->prepend(tiny::IROp::Phi, INT);
+    ASSERT_FALSE(module.verify().empty());
+    phi->operands = {one};
+    phi->targets = {entry};
+    ASSERT_TRUE(module.verify().empty());
+
+    // A value used before it's defined
+    auto two = next->append(tiny::IROp::Const, INT);
+    two->constant = tiny::RuntimeValue::fromInt(2);
+    std::swap(next->instructions[1], next->instructions[2]);
+    next->instructions[1]->operands = {two};
+    ASSERT_EQ(module.verify().size(), 2); // Returns in the middle of the block, and uses an undefined value
+}
+
+TEST(IR, PassManager) {
+    auto module = build("func main(int x) {\n"
+                        "    unused := x * 2\n"
+                        "    return x\n"
+                        "}\n");
+
+    tiny::PassManager manager;
+    manager.add(tiny::deadCodePass());
+    ASSERT_EQ(manager.run(module), 1);
+    ASSERT_EQ(count(module.functions.front(), tiny::IROp::Mul), 0);
+
+    // Broken IR is caught after the pass that broke it
+    manager.add({"break", [](tiny::IRFunction &fn) {
+        fn.blocks.front()->instructions.pop_back();
+        return true;
+    }});
+
+    try {
+        manager.run(module);
+        FAIL();
+    } catch (const tiny::IRError &e) {
+        ASSERT_NE(e.msg.find("after pass 'break'"), std::string::npos);
+    }
+}
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+
+#include "jobserver.h"
+#include "scheduler.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <unistd.h>
+
+TEST(JobServer, FindAuth) {
+    ASSERT_EQ(tiny::JobServer::findAuth(" -j4 --jobserver-auth=3,4"), "3,4");
+    ASSERT_EQ(tiny::JobServer::findAuth("kw -- --jobserver-fds=5,6"), "5,6");
+    ASSERT_EQ(tiny::JobServer::findAuth("-j --jobserver-auth=fifo:/tmp/GMfifo1 --jobserver-auth=fifo:/tmp/GMfifo2"),
+              "fifo:/tmp/GMfifo2");
+    ASSERT_FALSE(tiny::JobServer::findAuth("-k -j4").has_value());
+}
+
+TEST(JobServer, AcquireAndRelease) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(write(fds[1], "++", 2), 2);
+
+    ASSERT_EQ(tiny::JobServer::connect("99999,99998"), nullptr);
+
+    {
+        auto js = tiny::JobServer::connect(std::to_string(fds[0]) + "," + std::to_string(fds[1]));
+        ASSERT_NE(js, nullptr);
+
+        ASSERT_TRUE(js->acquire(std::chrono::milliseconds(0)));
+        ASSERT_TRUE(js->acquire(std::chrono::milliseconds(0)));
+        ASSERT_FALSE(js->acquire(std::chrono::milliseconds(0)));
+        ASSERT_EQ(js->getHeld(), 2);
+
+        js->release();
+        ASSERT_EQ(js->getHeld(), 1);
+    } // The remaining token gets released on destruction
+
+    char tokens[2];
+    ASSERT_EQ(read(fds[0], tokens, 2), 2);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(JobServer, LimitsScheduler) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(write(fds[1], "+", 1), 1); // One token, plus the implicit slot
+
+    auto &scheduler = tiny::Scheduler::get();
+    scheduler.setJobs(4);
+    scheduler.setJobServer(tiny::JobServer::connect(std::to_string(fds[0]) + "," + std::to_string(fds[1])));
+
+    std::atomic<std::int32_t> running{0};
+    std::atomic<std::int32_t> peak{0};
+
+    std::vector<tiny::TaskHandle> tasks;
+    for (std::int32_t i = 0; i < 32; i++) {
+        tasks.push_back(scheduler.submit([&]() {
+            auto now = ++running;
+            auto prev = peak.load();
+            while (now > prev && !peak.compare_exchange_weak(prev, now)) {}
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            running--;
+        }));
+    }
+
+    scheduler.wait(tasks);
+    ASSERT_LE(peak, 2);
+
+    scheduler.setJobServer(nullptr);
+    scheduler.setJobs(0);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+#endif
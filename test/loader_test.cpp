@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+
+#include "loader.h"
+#include "errors.h"
+
+#include <fstream>
+
+namespace {
+    const auto loaderSandboxPath = std::filesystem::temp_directory_path() / "tiny_loader_test";
+
+    //! Writes a set of files with distinct contents, returning their paths
+    std::vector<std::filesystem::path> writeFiles(std::size_t count, std::size_t size) {
+        std::filesystem::create_directories(loaderSandboxPath);
+
+        std::vector<std::filesystem::path> paths;
+        for (std::size_t i = 0; i < count; i++) {
+            auto path = loaderSandboxPath / ("file" + std::to_string(i) + ".ty");
+            std::ofstream out(path, std::ios::binary);
+            out << std::string(size, char('a' + i % 26));
+            paths.push_back(path);
+        }
+
+        return paths;
+    }
+
+    void checkBackend(tiny::LoadBackend backend) {
+        // More files than entries in the ring, so the reads are submitted in several batches
+        auto paths = writeFiles(150, 4096);
+
+        // And one big enough to take more than one read
+        auto big = loaderSandboxPath / "big.ty";
+        std::ofstream(big, std::ios::binary) << std::string(3 * 1024 * 1024, 'z');
+        paths.push_back(big);
+
+        tiny::FileLoader loader(paths, backend);
+        ASSERT_EQ(loader.getBackend(), backend);
+
+        for (std::size_t i = 0; i < 150; i++) {
+            ASSERT_EQ(loader.wait(i), std::string(4096, char('a' + i % 26)));
+        }
+
+        ASSERT_EQ(loader.wait(150), std::string(3 * 1024 * 1024, 'z'));
+
+        std::filesystem::remove_all(loaderSandboxPath);
+    }
+}
+
+TEST(FileLoader, ThreadPool) {
+    checkBackend(tiny::LoadBackend::ThreadPool);
+}
+
+TEST(FileLoader, IoUring) {
+    if (!tiny::FileLoader::isIoUringAvailable()) {
+        GTEST_SKIP() << "io_uring is not supported by the kernel";
+    }
+
+    checkBackend(tiny::LoadBackend::IoUring);
+}
+
+TEST(FileLoader, AutoBackend) {
+    tiny::FileLoader loader({});
+
+    auto expect = tiny::FileLoader::isIoUringAvailable() ? tiny::LoadBackend::IoUring : tiny::LoadBackend::ThreadPool;
+    ASSERT_EQ(loader.getBackend(), expect);
+}
+
+TEST(FileLoader, EmptyFile) {
+    std::filesystem::create_directories(loaderSandboxPath);
+    std::ofstream(loaderSandboxPath / "empty.ty");
+
+    for (auto backend: {tiny::LoadBackend::Auto, tiny::LoadBackend::ThreadPool}) {
+        tiny::FileLoader loader({loaderSandboxPath / "empty.ty"}, backend);
+        ASSERT_TRUE(loader.wait(0).empty());
+    }
+
+    std::filesystem::remove_all(loaderSandboxPath);
+}
+
+TEST(FileLoader, MissingFile) {
+    auto paths = writeFiles(2, 16);
+    paths.insert(paths.begin() + 1, loaderSandboxPath / "missing.ty");
+
+    for (auto backend: {tiny::LoadBackend::Auto, tiny::LoadBackend::ThreadPool}) {
+        tiny::FileLoader loader(paths, backend);
+        ASSERT_EQ(loader.wait(0).size(), 16);
+        ASSERT_THROW(loader.wait(1), tiny::FileError);
+        ASSERT_EQ(loader.wait(2).size(), 16);
+    }
+
+    std::filesystem::remove_all(loaderSandboxPath);
+}
+
+TEST(BufferPool, Reuse) {
+    auto &pool = tiny::BufferPool::get();
+    pool.clear();
+
+    auto paths = writeFiles(4, 64);
+    {
+        tiny::FileLoader loader(paths);
+        for (std::size_t i = 0; i < paths.size(); i++) {
+            loader.wait(i);
+        }
+    }
+
+    ASSERT_EQ(pool.size(), 4);
+
+    auto buffer = pool.acquire(32);
+    ASSERT_EQ(buffer.size(), 32);
+    ASSERT_GE(buffer.capacity(), 64); // Reused rather than allocated
+    ASSERT_EQ(pool.size(), 3);
+
+    pool.clear();
+    std::filesystem::remove_all(loaderSandboxPath);
+}
@@ -0,0 +1,129 @@
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+namespace {
+    //! Redirects the Logger to a temporary file while alive
+    struct LogCapture {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / "tiny_logger_test.log";
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        LogCapture() {
+            tiny::Logger::get().setOutput(fd);
+        }
+
+        ~LogCapture() {
+            tiny::Logger::get().setOutput(STDOUT_FILENO);
+            close(fd);
+            std::filesystem::remove(path);
+        }
+
+        //! Gets the lines written so far
+        std::vector<std::string> lines() const {
+            std::ifstream input(path);
+            std::vector<std::string> result;
+            for (std::string line; std::getline(input, line);) {
+                result.push_back(line);
+            }
+
+            return result;
+        }
+    };
+}
+
+TEST(Logger, KeepsTheOrderOfEachThread) {
+    LogCapture capture;
+
+    constexpr int threadCount = 8;
+    constexpr int messageCount = 2000; // Beyond the size of the rings, so the writer has to catch up
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < messageCount; i++) {
+                tiny::Logger::get().log(tiny::LogLevel::Warning, std::to_string(t) + " " + std::to_string(i));
+            }
+        });
+    }
+
+    for (auto &t: threads) {
+        t.join();
+    }
+
+    tiny::Logger::get().flush();
+
+    std::vector<int> next(threadCount, 0);
+    auto lines = capture.lines();
+    ASSERT_EQ(lines.size(), threadCount * messageCount);
+
+    for (auto const &line: lines) {
+        std::istringstream content(line.substr(line.find("] ") + 2));
+        int t = 0;
+        int i = 0;
+        content >> t >> i;
+
+        ASSERT_EQ(i, next[t]);
+        next[t]++;
+    }
+}
+
+TEST(Logger, LongMessages) {
+    LogCapture capture;
+
+    std::string longMessage(10000, 'x');
+    tiny::Logger::get().log(tiny::LogLevel::Warning, longMessage);
+    tiny::Logger::get().log(tiny::LogLevel::Warning, "after");
+    tiny::Logger::get().flush();
+
+    auto lines = capture.lines();
+    ASSERT_EQ(lines.size(), 2);
+    ASSERT_NE(lines[0].find(longMessage), std::string::npos);
+    ASSERT_NE(lines[1].find("after"), std::string::npos);
+}
+
+TEST(Logger, FatalFlushes) {
+    LogCapture capture;
+
+    tiny::Logger::get().log(tiny::LogLevel::Warning, "first");
+    tiny::Logger::get().log(tiny::LogLevel::Fatal, "fatal");
+
+    // No flush, fatal messages are written before log() returns
+    auto lines = capture.lines();
+    ASSERT_EQ(lines.size(), 2);
+    ASSERT_NE(lines[0].find("WARNING"), std::string::npos);
+    ASSERT_NE(lines[1].find("FATAL"), std::string::npos);
+}
+
+TEST(Logger, SkipsLevelsAboveTheCurrentOne) {
+    LogCapture capture;
+
+    auto level = tiny::Logger::get().getLevel();
+    tiny::Logger::get().setLevel(tiny::LogLevel::Error);
+    tiny::Logger::get().log(tiny::LogLevel::Info, "hidden");
+    tiny::Logger::get().log(tiny::LogLevel::Error, "shown");
+    tiny::Logger::get().setLevel(level);
+    tiny::Logger::get().flush();
+
+    auto lines = capture.lines();
+    ASSERT_EQ(lines.size(), 1);
+    ASSERT_NE(lines[0].find("shown"), std::string::npos);
+}
+
+TEST(Logger, TerminateFlushes) {
+    // Run in a fresh process, since a forked one wouldn't have the writer thread
+    ::testing::GTEST_FLAG(death_test_style) = "threadsafe";
+
+    // The message is still queued when the process ends
+    ASSERT_DEATH({
+        tiny::Logger::get().setOutput(STDERR_FILENO);
+        tiny::Logger::get().log(tiny::LogLevel::Warning, "queued before terminating");
+        std::terminate();
+    }, "queued before terminating");
+}
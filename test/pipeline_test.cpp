@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+
+#include "pipeline.h"
+#include "errors.h"
+
+TEST(Pipeline, EmptyPipe) {
+    tiny::Pipeline pl;
+
+    std::vector<tiny::Lexeme> lexemes{tiny::Lexeme(tiny::Token::KwFunc), tiny::Lexeme(tiny::Token::Id, "foo")};
+    pl.runLexPipe(lexemes);
+
+    std::vector<tiny::Lexeme> expect{tiny::Lexeme(tiny::Token::KwFunc), tiny::Lexeme(tiny::Token::Id, "foo")};
+    ASSERT_EQ(lexemes, expect);
+}
+
+TEST(Pipeline, StagesRunInOrder) {
+    tiny::Pipeline pl;
+
+    pl.addLexStage(tiny::PipelineStage<std::vector<tiny::Lexeme>>("append-1", [](auto lexemes) {
+        lexemes.emplace_back(tiny::Token::Id, "first");
+        return tiny::StageResult(std::move(lexemes));
+    }));
+
+    pl.addLexStage(tiny::PipelineStage<std::vector<tiny::Lexeme>>("append-2", [](auto lexemes) {
+        lexemes.emplace_back(tiny::Token::Id, "second");
+        return tiny::StageResult(std::move(lexemes));
+    }));
+
+    ASSERT_EQ(pl.getPipeLength(tiny::CompilationStep::Lexer), 2);
+
+    std::vector<tiny::Lexeme> lexemes;
+    pl.runLexPipe(lexemes);
+
+    std::vector<tiny::Lexeme> expect{tiny::Lexeme(tiny::Token::Id, "first"), tiny::Lexeme(tiny::Token::Id, "second")};
+    ASSERT_EQ(lexemes, expect);
+}
+
+TEST(Pipeline, StagesDontCopy) {
+    tiny::Pipeline pl;
+
+    const tiny::Lexeme *seen = nullptr;
+    for (auto name: {"inspect-1", "inspect-2", "inspect-3"}) {
+        pl.addLexStage(tiny::PipelineStage<std::vector<tiny::Lexeme>>(name, [&seen](auto lexemes) {
+            // The buffer must be the one handed over by the previous stage
+            if (seen != nullptr && lexemes.data() != seen) {
+                return tiny::StageResult<std::vector<tiny::Lexeme>>(tiny::StageAction::Reject, "Lexemes were copied");
+            }
+
+            seen = lexemes.data();
+            return tiny::StageResult(std::move(lexemes));
+        }));
+    }
+
+    std::vector<tiny::Lexeme> lexemes(1000, tiny::Lexeme(tiny::Token::NewLine));
+    const auto *original = lexemes.data();
+
+    ASSERT_NO_THROW(pl.runLexPipe(lexemes));
+    ASSERT_EQ(lexemes.data(), original);
+}
+
+TEST(Pipeline, RejectThrows) {
+    tiny::Pipeline pl;
+
+    pl.addParseStage(tiny::PipelineStage<tiny::ASTFile>("reject", [](auto) {
+        return tiny::StageResult<tiny::ASTFile>(tiny::StageAction::Reject, "Rejected");
+    }));
+
+    tiny::ASTFile file;
+    ASSERT_THROW(pl.runParsePipe(file), tiny::PipelineRejectError);
+}
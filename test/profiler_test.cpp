@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+
+#include "profiler.h"
+#include "errors.h"
+
+TEST(Profiler, DisabledRecordsNothing) {
+    tiny::Profiler::get().disable();
+    tiny::Profiler::get().clear();
+
+    {
+        tiny::ProfileScope scope("disabled", "test");
+    }
+
+    ASSERT_TRUE(tiny::Profiler::get().getEvents().empty());
+}
+
+TEST(Profiler, NestedScopes) {
+    auto &profiler = tiny::Profiler::get();
+    profiler.enable();
+    profiler.clear();
+
+    {
+        tiny::ProfileScope outer("outer", "test");
+        {
+            tiny::ProfileScope inner("inner", "test");
+        }
+    }
+
+    auto events = profiler.getEvents();
+    ASSERT_EQ(events.size(), 2);
+
+    // Scopes are recorded when they end, so the inner one comes first
+    ASSERT_EQ(events[0].name, "inner");
+    ASSERT_EQ(events[1].name, "outer");
+
+    ASSERT_GE(events[0].start, events[1].start);
+    ASSERT_LE(events[0].start + events[0].duration, events[1].start + events[1].duration);
+    ASSERT_EQ(events[0].tid, events[1].tid);
+}
+
+TEST(Profiler, ThreadIds) {
+    auto &profiler = tiny::Profiler::get();
+    profiler.enable();
+    profiler.clear();
+
+    {
+        tiny::ProfileScope scope("main", "test");
+    }
+
+    std::thread worker([]() {
+        tiny::ProfileScope scope("worker", "test");
+    });
+    worker.join();
+
+    auto events = profiler.getEvents();
+    ASSERT_EQ(events.size(), 2);
+    ASSERT_NE(events[0].tid, events[1].tid);
+}
+
+TEST(Profiler, TraceJson) {
+    auto &profiler = tiny::Profiler::get();
+    profiler.enable();
+    profiler.clear();
+
+    {
+        tiny::ProfileScope scope("step", "test");
+    }
+
+    auto trace = profiler.toTraceJson();
+
+    std::int32_t complete = 0;
+    for (auto const &ev: trace["traceEvents"]) {
+        if (ev["ph"] == "X") {
+            complete++;
+            ASSERT_EQ(ev["name"], "step");
+            ASSERT_EQ(ev["cat"], "test");
+            ASSERT_TRUE(ev.contains("ts"));
+            ASSERT_TRUE(ev.contains("dur"));
+            ASSERT_TRUE(ev.contains("tid"));
+        }
+    }
+
+    ASSERT_EQ(complete, 1);
+
+    profiler.disable();
+    profiler.clear();
+}
+
+TEST(Profiler, TraceWriteFails) {
+    auto missing = std::filesystem::temp_directory_path() / "tiny_missing_dir" / "trace.json";
+    std::filesystem::remove_all(missing.parent_path());
+
+    ASSERT_THROW(tiny::Profiler::get().dumpTrace(missing), tiny::FileError);
+}
@@ -0,0 +1,118 @@
+import gc
+import threading
+import time
+import unittest
+
+import tiny
+
+SOURCE = "module main\n\nfunc main(int n) {\n    return n * 2\n}\n"
+
+
+class Columns(unittest.TestCase):
+    def test_buffer_protocol(self):
+        tokens = tiny.lex(SOURCE)
+        view = memoryview(tokens.kinds)
+
+        self.assertTrue(view.readonly)
+        self.assertEqual(view.format, "H")
+        self.assertEqual(view.ndim, 1)
+        self.assertEqual(len(view), len(tokens))
+        self.assertEqual(view.tolist(), [tokens.kinds[i] for i in range(len(tokens))])
+        self.assertEqual(view[-1], tokens.kinds[-1])
+
+        tree = tiny.parse(SOURCE, "main.ty")
+        parents = memoryview(tree.parents)
+        self.assertEqual(parents.format, "i")
+        self.assertEqual(len(parents), len(tree))
+        self.assertIn(-1, parents.tolist())
+
+        with self.assertRaises(IndexError):
+            tokens.kinds[len(tokens)]
+
+    def test_columns_outlive_their_table(self):
+        tokens = tiny.lex(SOURCE)
+        expected = [tokens.starts[i] for i in range(len(tokens))]
+        del tokens
+
+        view = memoryview(tiny.lex(SOURCE).starts)
+
+        # The view is all that's left of the tokens, so it must be what keeps their table alive
+        gc.collect()
+        garbage = [tiny.lex(SOURCE * 4) for _ in range(16)]
+        del garbage
+        gc.collect()
+
+        self.assertEqual(view.tolist(), expected)
+
+    def test_columns_are_not_copied(self):
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest("numpy isn't installed")
+
+        tree = tiny.parse(SOURCE)
+        first = numpy.asarray(tree.kinds)
+        second = numpy.asarray(tree.kinds)
+
+        # Both arrays read the table's own vector
+        self.assertEqual(first.__array_interface__["data"][0], second.__array_interface__["data"][0])
+        self.assertFalse(first.flags.writeable)
+
+
+class Errors(unittest.TestCase):
+    def check(self, error, source):
+        self.assertIsInstance(error.id, int)
+        self.assertNotEqual(error.id, 0)
+        self.assertIsInstance(error.arguments, list)
+        self.assertLessEqual(0, error.start)
+        self.assertLessEqual(error.start, error.end)
+        self.assertLessEqual(error.end, len(source))
+        self.assertTrue(str(error))
+
+    def test_lex_error(self):
+        source = "x := 007"
+        with self.assertRaises(tiny.CompileError) as raised:
+            tiny.lex(source)
+
+        self.check(raised.exception, source)
+        self.assertEqual(source[raised.exception.start], "0")
+
+    def test_parse_error(self):
+        # Codepoints, not bytes, so the accent before the problem doesn't shift it
+        source = "module main\n\n// é\nfunc main( {\n}\n"
+        with self.assertRaises(tiny.CompileError) as raised:
+            tiny.parse(source, "main.ty")
+
+        self.check(raised.exception, source)
+        self.assertEqual(source[raised.exception.start], "{")
+        self.assertIn("main.ty", str(raised.exception))
+
+
+class Threads(unittest.TestCase):
+    def test_compiling_releases_the_gil(self):
+        functions = "".join(f"func f{i}(int n) {{\n    return n * {i} + {i}\n}}\n\n" for i in range(4000))
+        sources = [(f"m{i}.ty", f"module m{i}\n\n" + functions) for i in range(4)]
+
+        window = []
+
+        def work():
+            start = time.perf_counter()
+            tiny.compile(sources)
+            window.extend([start, time.perf_counter()])
+
+        ticks = []
+        thread = threading.Thread(target=work)
+        thread.start()
+        while thread.is_alive():
+            ticks.append(time.perf_counter())
+        thread.join()
+
+        # Holding the GIL would stop this thread for the whole compilation, so it couldn't tick in the middle of it
+        start, end = window
+        self.assertGreater(end - start, 0.01)
+        middle = [t for t in ticks if start + (end - start) / 4 < t < end - (end - start) / 4]
+        self.assertTrue(middle)
+
+
+if __name__ == "__main__":
+    unittest.main()
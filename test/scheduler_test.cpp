@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "scheduler.h"
+
+TEST(Scheduler, RunsAllTasks) {
+    auto &scheduler = tiny::Scheduler::get();
+    scheduler.setJobs(4);
+
+    std::atomic<std::int32_t> count{0};
+    std::vector<tiny::TaskHandle> tasks;
+    for (std::int32_t i = 0; i < 1000; i++) {
+        tasks.push_back(scheduler.submit([&count]() { count++; }));
+    }
+
+    scheduler.wait(tasks);
+    ASSERT_EQ(count, 1000);
+
+    std::uint64_t executed = 0;
+    for (auto const &s: scheduler.getStats()) {
+        executed += s.tasks;
+    }
+
+    ASSERT_EQ(scheduler.getStats().size(), 4);
+    ASSERT_EQ(executed, 1000);
+}
+
+TEST(Scheduler, RespectsDependencies) {
+    auto &scheduler = tiny::Scheduler::get();
+    scheduler.setJobs(4);
+
+    // A diamond: a -> (b, c) -> d
+    std::vector<std::int32_t> order;
+    std::mutex mtx;
+    auto record = [&](std::int32_t id) {
+        return [&, id]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            std::lock_guard lock(mtx);
+            order.push_back(id);
+        };
+    };
+
+    auto a = scheduler.submit(record(0));
+    auto b = scheduler.submit(record(1), {a});
+    auto c = scheduler.submit(record(2), {a});
+    auto d = scheduler.submit(record(3), {b, c});
+
+    scheduler.wait(d);
+
+    ASSERT_EQ(order.size(), 4);
+    ASSERT_EQ(order.front(), 0);
+    ASSERT_EQ(order.back(), 3);
+}
+
+TEST(Scheduler, NestedTasks) {
+    auto &scheduler = tiny::Scheduler::get();
+    scheduler.setJobs(2);
+
+    std::atomic<std::int32_t> count{0};
+    auto outer = scheduler.submit([&]() {
+        std::vector<tiny::TaskHandle> inner;
+        for (std::int32_t i = 0; i < 16; i++) {
+            inner.push_back(scheduler.submit([&count]() { count++; }));
+        }
+
+        // Waiting from inside a task runs the inner tasks instead of blocking the worker
+        scheduler.wait(inner);
+    });
+
+    scheduler.wait(outer);
+    ASSERT_EQ(count, 16);
+}
+
+TEST(Scheduler, RethrowsExceptions) {
+    auto &scheduler = tiny::Scheduler::get();
+    scheduler.setJobs(2);
+
+    auto failing = scheduler.submit([]() { throw std::runtime_error("failed"); });
+    bool ran = false;
+    auto dependent = scheduler.submit([&ran]() { ran = true; }, {failing});
+
+    ASSERT_THROW(scheduler.wait(failing), std::runtime_error);
+    ASSERT_NO_THROW(scheduler.wait(dependent));
+    ASSERT_TRUE(ran);
+}
+
+TEST(Scheduler, SingleJobRunsInline) {
+    auto &scheduler = tiny::Scheduler::get();
+    scheduler.setJobs(1);
+
+    std::thread::id ranOn;
+    auto task = scheduler.submit([&ranOn]() { ranOn = std::this_thread::get_id(); });
+    scheduler.wait(task);
+
+    ASSERT_EQ(ranOn, std::this_thread::get_id());
+
+    scheduler.setJobs(0);
+}
@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "server.h"
+#include "errors.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+TEST(Server, ReusesUnchangedFiles) {
+    auto root = std::filesystem::temp_directory_path() / "tiny_server_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    std::ofstream(root / "tiny.toml") << "";
+    std::ofstream(root / "main.ty") << "module main\n\nfunc main() {\n    x := 1\n}\n";
+    std::ofstream(root / "util.ty") << "module util\n";
+
+    auto socketPath = root / "server.sock";
+    tiny::Server server(socketPath);
+    std::thread thread([&server]() { server.run(); });
+
+    tiny::Client client(socketPath);
+
+    // Wait for the server to start listening
+    tiny::CompilationResult result;
+    for (std::int32_t i = 0;; i++) {
+        try {
+            result = client.build(root);
+            break;
+        } catch (const tiny::ServerError &) {
+            ASSERT_LT(i, 200);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_EQ(server.getCache().size(), 2);
+    ASSERT_EQ(server.getCache().getMisses(), 2);
+
+    result = client.build(root);
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_EQ(server.getCache().getHits(), 2);
+
+    // Break one of the files, its diagnostic must be streamed back
+    std::ofstream(root / "util.ty") << "module util\n\nfunc broken( {\n";
+
+    result = client.build(root);
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Error);
+    ASSERT_EQ(result.diagnostics.size(), 1);
+    ASSERT_EQ(result.diagnostics[0].file, (root / "util.ty").string());
+
+    // Fields of the wrong type get an error, not a dead server
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+        ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+
+        std::string request = "{\"command\": 1}\n";
+        ASSERT_EQ(write(fd, request.data(), request.size()), ssize_t(request.size()));
+        shutdown(fd, SHUT_WR);
+
+        std::string response;
+        char buffer[256];
+        for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) {
+            response.append(buffer, n);
+        }
+
+        close(fd);
+        ASSERT_NE(response.find("\"error\""), std::string::npos);
+    }
+
+    result = client.build(root);
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Error);
+
+    client.stop();
+    thread.join();
+
+    ASSERT_FALSE(std::filesystem::exists(socketPath));
+    std::filesystem::remove_all(root);
+}
+
+#endif
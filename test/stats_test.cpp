@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+
+#include "stats.h"
+#include "lexer.h"
+#include "parser.h"
+
+TEST(Statistics, DisabledCountsNothing) {
+    auto &stats = tiny::Statistics::get();
+    stats.disable();
+    stats.reset();
+
+    stats.add(tiny::Counter::BytesRead, 100);
+    stats.addLexeme(tiny::Token::Id);
+
+    auto snap = stats.snapshot();
+    ASSERT_EQ(snap.get(tiny::Counter::BytesRead), 0);
+    ASSERT_EQ(snap.lexemes[std::size_t(tiny::Token::Id)], 0);
+}
+
+TEST(Statistics, MergesThreads) {
+    auto &stats = tiny::Statistics::get();
+    stats.enable();
+    stats.reset();
+
+    std::vector<std::thread> threads;
+    for (std::int32_t t = 0; t < 4; t++) {
+        threads.emplace_back([&stats]() {
+            for (std::int32_t i = 0; i < 1000; i++) {
+                stats.add(tiny::Counter::BytesRead, 2);
+                stats.addPromise(tiny::Assertion::IsDefined);
+            }
+        });
+    }
+
+    for (auto &t: threads) {
+        t.join();
+    }
+
+    auto snap = stats.snapshot();
+    ASSERT_EQ(snap.get(tiny::Counter::BytesRead), 8000);
+    ASSERT_EQ(snap.promises[std::size_t(tiny::Assertion::IsDefined)], 4000);
+
+    stats.disable();
+    stats.reset();
+}
+
+TEST(Statistics, CountsLexemesAndNodes) {
+    auto &stats = tiny::Statistics::get();
+    stats.enable();
+    stats.reset();
+
+    std::stringstream data;
+    data << "module test\nx := 1 + 2\n";
+
+    tiny::Lexer lexer(data);
+    auto lexemes = lexer.lexAll();
+
+    tiny::Stream<tiny::Lexeme> lexemeStream(lexemes);
+    tiny::Parser parser(lexemeStream);
+    stats.addAST(parser.file(tiny::File()));
+
+    auto snap = stats.snapshot();
+    ASSERT_EQ(snap.lexemes[std::size_t(tiny::Token::KwModule)], 1);
+    ASSERT_EQ(snap.lexemes[std::size_t(tiny::Token::Id)], 2);
+    ASSERT_EQ(snap.lexemes[std::size_t(tiny::Token::LiteralNum)], 2);
+    ASSERT_EQ(snap.astNodes[std::size_t(tiny::ASTNodeType::OpAddition)], 1);
+    ASSERT_EQ(snap.astNodes[std::size_t(tiny::ASTNodeType::LiteralInt)], 2);
+    ASSERT_EQ(snap.astNodes[std::size_t(tiny::ASTNodeType::Initialization)], 1);
+    ASSERT_GT(snap.peakRSS, 0);
+
+    stats.disable();
+    stats.reset();
+}
@@ -0,0 +1,44 @@
+#include "gtest/gtest.h"
+
+#include "tables.h"
+#include "compiler.h"
+
+TEST(Tables, Tokens) {
+    tiny::Stream<std::uint32_t> charStream(tiny::String(std::string_view("module a\n\nx := 1 + 2\n")).data());
+    tiny::Lexer lexer(charStream);
+    lexer.setMetadataFile(tiny::File{tiny::FileType::Source, "a.ty"});
+
+    auto lexemes = lexer.lexAll();
+    auto table = tiny::TokenTable::build(lexemes);
+
+    ASSERT_EQ(table.size(), lexemes.size());
+    ASSERT_EQ(table.kinds[0], std::uint16_t(tiny::Token::KwModule));
+    ASSERT_EQ(table.starts[0], 0);
+
+    auto names = tiny::getTokenNames();
+    ASSERT_EQ(names[std::size_t(tiny::Token::KwModule)], "KwModule");
+    ASSERT_EQ(names.back(), "MultilineComment");
+}
+
+TEST(Tables, Nodes) {
+    tiny::Compiler compiler;
+    auto result = compiler.compile({{"a.ty", "module a\n\nx := 1 + 2\ny := 3\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+    auto table = tiny::NodeTable::build(result.files[0]);
+    ASSERT_GT(table.size(), 2);
+    ASSERT_EQ(table.parents[0], -1);
+
+    // Pre-order: the first statement's subtree is followed by the second statement
+    auto second = table.sizes[0];
+    ASSERT_LT(second, table.size());
+    ASSERT_EQ(table.parents[second], -1);
+    ASSERT_EQ(table.sizes[0] + table.sizes[second], table.size());
+
+    for (std::size_t i = 1; i < table.size(); i++) {
+        ASSERT_LT(table.parents[i], std::int32_t(i));
+    }
+
+    auto names = tiny::getNodeTypeNames();
+    ASSERT_EQ(names[std::size_t(tiny::ASTNodeType::Composition)], "Composition");
+}
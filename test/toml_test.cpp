@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+#include "toml.h"
+#include "project.h"
+#include "errors.h"
+
+TEST(Toml, Scalars) {
+    auto root = tiny::parseToml(R"(
+# A comment
+name = "tiny"   # Trailing comment
+literal = 'C:\path'
+escaped = "a\tb\u00f1\"c"
+int = +1_000
+neg = -17
+hex = 0xff
+oct = 0o17
+bin = 0b101
+float = 6.25e-1
+inf = -inf
+yes = true
+no = false
+)");
+
+    ASSERT_EQ(root.find("name")->as<std::string>(), "tiny");
+    ASSERT_EQ(root.find("literal")->as<std::string>(), "C:\\path");
+    ASSERT_EQ(root.find("escaped")->as<std::string>(), "a\tb\xc3\xb1\"c");
+    ASSERT_EQ(root.find("int")->as<std::int64_t>(), 1000);
+    ASSERT_EQ(root.find("neg")->as<std::int64_t>(), -17);
+    ASSERT_EQ(root.find("hex")->as<std::int64_t>(), 255);
+    ASSERT_EQ(root.find("oct")->as<std::int64_t>(), 15);
+    ASSERT_EQ(root.find("bin")->as<std::int64_t>(), 5);
+    ASSERT_DOUBLE_EQ(root.find("float")->as<double>(), 0.625);
+    ASSERT_TRUE(std::isinf(root.find("inf")->as<double>()));
+    ASSERT_TRUE(root.find("yes")->as<bool>());
+    ASSERT_FALSE(root.find("no")->as<bool>());
+    ASSERT_EQ(root.find("missing"), nullptr);
+}
+
+TEST(Toml, MultilineStrings) {
+    auto root = tiny::parseToml("basic = \"\"\"\nline one\nline \\\n    two\"\"\"\nliteral = '''\nraw \\n'''\n");
+
+    ASSERT_EQ(root.find("basic")->as<std::string>(), "line one\nline two");
+    ASSERT_EQ(root.find("literal")->as<std::string>(), "raw \\n");
+}
+
+TEST(Toml, Tables) {
+    auto root = tiny::parseToml(R"(
+top.dotted = 1
+
+[build]
+jobs = 4
+
+[build.nested]
+"quoted key" = 'x'
+
+[[targets]]
+name = "a"
+
+[[targets]]
+name = "b"
+point = { x = 1, y = 2 }
+)");
+
+    ASSERT_EQ(root.find("top")->find("dotted")->as<std::int64_t>(), 1);
+    ASSERT_EQ(root.find("build")->find("jobs")->as<std::int64_t>(), 4);
+    ASSERT_EQ(root.find("build")->find("nested")->find("quoted key")->as<std::string>(), "x");
+
+    auto const &targets = root.find("targets")->as<tiny::TomlValue::Array>();
+    ASSERT_EQ(targets.size(), 2);
+    ASSERT_EQ(targets[1].find("name")->as<std::string>(), "b");
+    ASSERT_EQ(targets[1].find("point")->find("y")->as<std::int64_t>(), 2);
+}
+
+TEST(Toml, Arrays) {
+    auto root = tiny::parseToml(R"(
+list = [
+    "a", # Comments and newlines are allowed
+    "b",
+]
+nested = [[1, 2], ["x"]]
+empty = []
+)");
+
+    auto const &list = root.find("list")->as<tiny::TomlValue::Array>();
+    ASSERT_EQ(list.size(), 2);
+    ASSERT_EQ(list[1].as<std::string>(), "b");
+
+    auto const &nested = root.find("nested")->as<tiny::TomlValue::Array>();
+    ASSERT_EQ(nested[0].as<tiny::TomlValue::Array>()[1].as<std::int64_t>(), 2);
+    ASSERT_TRUE(root.find("empty")->as<tiny::TomlValue::Array>().empty());
+}
+
+TEST(Toml, Errors) {
+    auto errorAt = [](std::string_view doc) -> std::pair<std::size_t, std::size_t> {
+        try {
+            tiny::parseToml(doc);
+        } catch (const tiny::TomlError &e) {
+            return {e.line, e.column};
+        }
+
+        return {0, 0};
+    };
+
+    ASSERT_EQ(errorAt("a = 1\nb = \"open\n"), std::make_pair(std::size_t(2), std::size_t(10)));
+    ASSERT_EQ(errorAt("a = 1\na = 2\n").first, 2);                // Duplicate key
+    ASSERT_EQ(errorAt("[t]\n[t]\n").first, 2);                    // Duplicate table
+    ASSERT_EQ(errorAt("t = {a = 1}\n[t]\n").first, 2);            // Inline tables can't be extended
+    ASSERT_EQ(errorAt("a = 1 b = 2\n").first, 1);                 // Two pairs in a line
+    ASSERT_EQ(errorAt("a = 007\n").first, 1);                     // Leading zeros
+    ASSERT_EQ(errorAt("a = 1__0\n").first, 1);                    // Misplaced underscore
+    ASSERT_EQ(errorAt("a = 1979-05-27\n").first, 1);              // Dates aren't supported
+    ASSERT_EQ(errorAt("a = [1, 2\n").first, 2);                   // Unterminated array
+    ASSERT_EQ(errorAt("a = \"\\q\"\n").first, 1);                 // Invalid escape
+    ASSERT_EQ(errorAt("a = 99999999999999999999\n").first, 1);    // Overflow
+}
+
+TEST(ProjectSettings, Parse) {
+    auto settings = tiny::ProjectSettings::parse(R"(
+[package]
+name = "example"
+
+[build]
+jobs = 3
+log = "warn"
+include = ["src/**/*.ty"]
+exclude = ["gen/"]
+output = ["ast-json"]
+)");
+
+    ASSERT_EQ(settings.jobs, 3);
+    ASSERT_EQ(settings.log, tiny::LogLevel::Warning);
+    ASSERT_EQ(settings.include, std::vector<std::string>{"src/**/*.ty"});
+    ASSERT_EQ(settings.exclude, std::vector<std::string>{"gen/"});
+    ASSERT_TRUE(settings.outputASTJSON);
+
+    auto empty = tiny::ProjectSettings::parse("");
+    ASSERT_FALSE(empty.jobs);
+    ASSERT_TRUE(empty.include.empty());
+}
+
+TEST(ProjectSettings, InvalidValues) {
+    ASSERT_THROW(tiny::ProjectSettings::parse("[build]\njobs = 0\n"), tiny::TomlError);
+    ASSERT_THROW(tiny::ProjectSettings::parse("[build]\njobs = \"4\"\n"), tiny::TomlError);
+    ASSERT_THROW(tiny::ProjectSettings::parse("[build]\nlog = \"loud\"\n"), tiny::TomlError);
+    ASSERT_THROW(tiny::ProjectSettings::parse("[build]\ninclude = \"src\"\n"), tiny::TomlError);
+    ASSERT_THROW(tiny::ProjectSettings::parse("[build]\noutput = [\"pdf\"]\n"), tiny::TomlError);
+    ASSERT_THROW(tiny::ProjectSettings::parse("build = 1\n"), tiny::TomlError);
+
+    try {
+        tiny::ProjectSettings::parse("[build]\njobs = 4\ninclude = [\"a\", 1]\n");
+        FAIL();
+    } catch (const tiny::TomlError &e) {
+        ASSERT_EQ(e.line, 3);
+        ASSERT_EQ(e.column, 17);
+    }
+
+    try {
+        tiny::ProjectSettings::parse("[build]\nexclude = [\"gen/\", \"[z-a]\"]\n");
+        FAIL();
+    } catch (const tiny::TomlError &e) {
+        ASSERT_EQ(e.line, 2);
+        ASSERT_EQ(e.column, 20);
+    }
+}
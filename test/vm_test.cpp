@@ -0,0 +1,222 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "compiler.h"
+#include "errors.h"
+#include "bytecode.h"
+#include "vm.h"
+
+namespace {
+    tiny::BytecodeProgram compileProgram(const std::string &code) {
+        tiny::Compiler compiler;
+        auto result = compiler.compile({{"main.ty", "module main\n\n" + code}});
+        EXPECT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+        return tiny::BytecodeCompiler::compile(result.files);
+    }
+
+    tiny::RuntimeValue run(const std::string &code, const std::vector<tiny::RuntimeValue> &args = {}) {
+        auto program = compileProgram(code);
+        tiny::VM vm(program);
+
+        auto results = vm.call("main", args);
+        EXPECT_EQ(results.size(), 1);
+
+        return results.empty() ? tiny::RuntimeValue() : results.front();
+    }
+
+    tiny::RuntimeValue integer(std::int64_t v) {
+        return tiny::RuntimeValue::fromInt(v);
+    }
+}
+
+TEST(VM, Arithmetic) {
+    ASSERT_EQ(run("func main() {\n    return 2 + 3 * 4\n}\n"), integer(14));
+    ASSERT_EQ(run("func main() {\n    return (2 + 3) * 4\n}\n"), integer(20));
+    ASSERT_EQ(run("func main() {\n    return 7 / 2\n}\n"), integer(3));
+    ASSERT_EQ(run("func main() {\n    return -7 / 2\n}\n"), integer(-3));
+    ASSERT_EQ(run("func main() {\n    return 2 ** 10\n}\n"), integer(1024));
+    ASSERT_EQ(run("func main() {\n    return 1 + 0.5\n}\n"), tiny::RuntimeValue::fromFloat(1.5));
+    ASSERT_EQ(run("func main() {\n    return 100000 * 100000\n}\n"), integer(10000000000));
+
+    // Integers wrap around
+    ASSERT_EQ(run("func main() {\n    return 9223372036854775807 + 1\n}\n"),
+              integer(std::numeric_limits<std::int64_t>::min()));
+}
+
+TEST(VM, Comparisons) {
+    auto yes = tiny::RuntimeValue::fromBool(true);
+    auto no = tiny::RuntimeValue::fromBool(false);
+
+    ASSERT_EQ(run("func main() {\n    return 1 < 2\n}\n"), yes);
+    ASSERT_EQ(run("func main() {\n    return 2 <= 1\n}\n"), no);
+    ASSERT_EQ(run("func main() {\n    return 1.5 > 1\n}\n"), yes);
+    ASSERT_EQ(run("func main() {\n    return 3 == 3 and 2 != 2\n}\n"), no);
+    ASSERT_EQ(run("func main() {\n    return 3 == 4 or 2 >= 2\n}\n"), yes);
+    ASSERT_EQ(run("func main() {\n    return !(1 > 2)\n}\n"), yes);
+}
+
+TEST(VM, Variables) {
+    ASSERT_EQ(run("func main(int a) {\n"
+                  "    x := a + 1\n"
+                  "    x = x * 2\n"
+                  "    x += 3\n"
+                  "    int64 y\n"
+                  "    y -= x\n"
+                  "    {\n"
+                  "        x := 100\n"
+                  "        y += x\n"
+                  "    }\n"
+                  "    return y\n"
+                  "}\n", {integer(4)}), integer(87));
+}
+
+TEST(VM, Branches) {
+    auto code = "func main(int a) {\n"
+                "    if a > 10 {\n"
+                "        return 1\n"
+                "    } else {\n"
+                "        if a > 5 {\n"
+                "            return 2\n"
+                "        }\n"
+                "    }\n"
+                "    return 3\n"
+                "}\n";
+
+    ASSERT_EQ(run(code, {integer(11)}), integer(1));
+    ASSERT_EQ(run(code, {integer(6)}), integer(2));
+    ASSERT_EQ(run(code, {integer(5)}), integer(3));
+}
+
+TEST(VM, Loops) {
+    // Ranges exclude their upper bound
+    ASSERT_EQ(run("func main() {\n"
+                  "    sum := 0\n"
+                  "    for i := 0..10 {\n"
+                  "        sum += i\n"
+                  "    }\n"
+                  "    return sum\n"
+                  "}\n"), integer(45));
+
+    ASSERT_EQ(run("func main() {\n"
+                  "    sum := 0\n"
+                  "    for i := 10..0 -> -3 {\n"
+                  "        sum += i\n"
+                  "    }\n"
+                  "    return sum\n"
+                  "}\n"), integer(22));
+
+    ASSERT_EQ(run("func main() {\n"
+                  "    n := 1\n"
+                  "    for n < 1000 {\n"
+                  "        n *= 2\n"
+                  "    }\n"
+                  "    return n\n"
+                  "}\n"), integer(1024));
+}
+
+TEST(VM, Calls) {
+    auto program = compileProgram("func main(int n) {\n"
+                                  "    return fib(n)\n"
+                                  "}\n\n"
+                                  "func fib(int n) {\n"
+                                  "    if n < 2 {\n"
+                                  "        return n\n"
+                                  "    }\n"
+                                  "    return fib(n - 1) + fib(n - 2)\n"
+                                  "}\n\n"
+                                  "func pair(int a, int b) {\n"
+                                  "    return b, a\n"
+                                  "}\n");
+
+    tiny::VM vm(program);
+    ASSERT_EQ(vm.call("main", {integer(20)}), std::vector<tiny::RuntimeValue>{integer(6765)});
+    ASSERT_EQ(vm.call("pair", {integer(1), integer(2)}), (std::vector<tiny::RuntimeValue>{integer(2), integer(1)}));
+    ASSERT_THROW(vm.call("main", {}), tiny::ExecutionError);
+    ASSERT_THROW(vm.call("nope", {}), tiny::ExecutionError);
+}
+
+TEST(VM, Modules) {
+    tiny::Compiler compiler;
+    auto result = compiler.compile({{"main.ty", "module main\n\nimport (\n    a,\n    b as other\n)\n\n"
+                                                "func main(int n) {\n"
+                                                "    return helper(n) + a.helper(n) + other.helper(n) + twice(n)\n"
+                                                "}\n\n"
+                                                "func helper(int n) {\n    return n\n}\n"},
+                                    {"a.ty", "module a\n\nfunc helper(int n) {\n    return n * 10\n}\n\n"
+                                             "func twice(int n) {\n    return helper(n) * 2\n}\n"},
+                                    {"b.ty", "module b\n\nfunc helper(int n) {\n    return n * 100\n}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+
+    // Bare names go to the caller's module first, and qualified ones through the imports
+    auto program = tiny::BytecodeCompiler::compile(result.files);
+    tiny::VM vm(program);
+    ASSERT_EQ(vm.call("main", {integer(1)}), std::vector<tiny::RuntimeValue>{integer(1 + 10 + 100 + 20)});
+    ASSERT_EQ(vm.call("b.helper", {integer(1)}), std::vector<tiny::RuntimeValue>{integer(100)});
+    ASSERT_THROW(vm.call("helper", {integer(1)}), tiny::ExecutionError);
+
+    // A bare name declared by more than one import must be qualified, and only imported modules can be called
+    result = compiler.compile({{"main.ty", "module main\n\nimport (\n    a,\n    b\n)\n\n"
+                                           "func main(int n) {\n    return helper(n)\n}\n"},
+                               {"a.ty", "module a\n\nfunc helper(int n) {\n    return n\n}\n"},
+                               {"b.ty", "module b\n\nfunc helper(int n) {\n    return n\n}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_THROW(tiny::BytecodeCompiler::compile(result.files), tiny::BytecodeError);
+
+    result = compiler.compile({{"main.ty", "module main\n\nfunc main(int n) {\n    return a.helper(n)\n}\n"},
+                               {"a.ty", "module a\n\nfunc helper(int n) {\n    return n\n}\n"}});
+    ASSERT_EQ(result.status, tiny::CompilationStatus::Ok);
+    ASSERT_THROW(tiny::BytecodeCompiler::compile(result.files), tiny::BytecodeError);
+}
+
+TEST(VM, Errors) {
+    ASSERT_THROW(run("func main() {\n    x := 0\n    return 1 / x\n}\n"), tiny::ExecutionError);
+    ASSERT_THROW(run("func main() {\n    if 1 {\n        return 1\n    }\n}\n"), tiny::ExecutionError);
+    ASSERT_THROW(run("func main() {\n    return main()\n}\n"), tiny::ExecutionError); // Stack overflow
+
+    ASSERT_THROW(compileProgram("func main() {\n    return x\n}\n"), tiny::BytecodeError);
+    ASSERT_THROW(compileProgram("func main() {\n    return f(1)\n}\n"), tiny::BytecodeError);
+    ASSERT_THROW(compileProgram("func main() {\n    return main(1)\n}\n"), tiny::BytecodeError);
+}
+
+TEST(VM, Benchmark) {
+    auto program = compileProgram("func fib(int n) {\n"
+                                  "    if n < 2 {\n"
+                                  "        return n\n"
+                                  "    }\n"
+                                  "    return fib(n - 1) + fib(n - 2)\n"
+                                  "}\n\n"
+                                  "func loop(int n) {\n"
+                                  "    sum := 0\n"
+                                  "    for i := 0..n {\n"
+                                  "        if i * 3 > sum {\n"
+                                  "            sum += i\n"
+                                  "        } else {\n"
+                                  "            sum -= 1\n"
+                                  "        }\n"
+                                  "    }\n"
+                                  "    return sum\n"
+                                  "}\n");
+
+    tiny::VM vm(program);
+    auto dispatch = tiny::VM::isThreaded() ? "threaded" : "switch";
+
+    auto start = std::chrono::steady_clock::now();
+    auto fib = vm.call("fib", {integer(27)});
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(fib.front(), integer(196418));
+    std::cout << "VM benchmark (" << dispatch << ") -> fib(27) in " << std::int64_t(elapsed * 1000) << "ms"
+              << std::endl;
+
+    const std::int64_t iterations = 10000000;
+    start = std::chrono::steady_clock::now();
+    vm.call("loop", {integer(iterations)});
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "VM benchmark (" << dispatch << ") -> " << iterations << " loop iterations in "
+              << std::int64_t(elapsed * 1000) << "ms (" << std::int64_t(double(iterations) / elapsed)
+              << " iterations/second)" << std::endl;
+}
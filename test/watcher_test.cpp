@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "watcher.h"
+
+#if defined(__linux__)
+
+TEST(Watcher, RecompilesDependents) {
+    auto root = std::filesystem::temp_directory_path() / "tiny_watcher_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    std::ofstream(root / "tiny.toml") << "";
+    std::ofstream(root / "a.ty") << "module a\n";
+    std::ofstream(root / "b.ty") << "module b\nimport (a)\n\nfunc g() {\n}\n";
+    std::ofstream(root / "c.ty") << "module c\n";
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<tiny::WatchBuild> builds;
+
+    tiny::Watcher watcher(root);
+    watcher.setOnBuild([&](const tiny::WatchBuild &build) {
+        std::lock_guard lock(mtx);
+        builds.push_back(build);
+        cv.notify_all();
+    });
+
+    std::thread thread([&watcher]() { watcher.run(); });
+
+    auto waitForBuilds = [&](std::size_t count) {
+        std::unique_lock lock(mtx);
+        return cv.wait_for(lock, std::chrono::seconds(5), [&]() { return builds.size() >= count; });
+    };
+
+    ASSERT_TRUE(waitForBuilds(1));
+    ASSERT_EQ(builds[0].result.status, tiny::CompilationStatus::Ok);
+    ASSERT_EQ(builds[0].recompiled.size(), 3);
+
+    std::ofstream(root / "a.ty") << "module a\n\nfunc f() {\n}\n";
+
+    ASSERT_TRUE(waitForBuilds(2));
+    std::set<std::filesystem::path> expect{root / "a.ty", root / "b.ty"};
+    ASSERT_EQ(builds[1].result.status, tiny::CompilationStatus::Ok);
+    ASSERT_EQ(builds[1].recompiled, expect);
+
+    watcher.stop();
+    thread.join();
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(Watcher, FollowsTheProjectFile) {
+    auto root = std::filesystem::temp_directory_path() / "tiny_watcher_project_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "gen");
+
+    std::ofstream(root / "tiny.toml") << "[build]\nexclude = [\"gen/\"]\n";
+    std::ofstream(root / "a.ty") << "module a\n";
+    std::ofstream(root / "gen" / "g.ty") << "module g\n";
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<tiny::WatchBuild> builds;
+
+    tiny::Watcher watcher(root);
+    watcher.setOnBuild([&](const tiny::WatchBuild &build) {
+        std::lock_guard lock(mtx);
+        builds.push_back(build);
+        cv.notify_all();
+    });
+
+    std::thread thread([&watcher]() { watcher.run(); });
+
+    auto waitForBuilds = [&](std::size_t count) {
+        std::unique_lock lock(mtx);
+        return cv.wait_for(lock, std::chrono::seconds(5), [&]() { return builds.size() >= count; });
+    };
+
+    ASSERT_TRUE(waitForBuilds(1));
+
+    // No longer excluded, so the directory must be watched from now on
+    std::ofstream(root / "tiny.toml") << "[build]\ninclude = [\"**/*.ty\"]\n";
+    ASSERT_TRUE(waitForBuilds(2));
+
+    std::ofstream(root / "gen" / "g.ty") << "module g\n\nfunc f() {\n}\n";
+    ASSERT_TRUE(waitForBuilds(3));
+    ASSERT_EQ(builds[2].recompiled.count(root / "gen" / "g.ty"), 1);
+
+    watcher.stop();
+    thread.join();
+
+    std::filesystem::remove_all(root);
+}
+
+#endif